@@ -0,0 +1,627 @@
+//
+//  slim_bench.cpp
+//  SLiM
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of SLiM.
+//
+//	SLiM is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	SLiM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with SLiM.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+
+ This file defines main() for slim_bench, which runs a fixed suite of benchmark models and reports their performance in a
+ stable, tab-separated format.  The models are representative of the main ways SLiM is used; their scripts, seeds, and
+ run lengths should not be changed, since the point is to compare timings across versions of SLiM.  If a model needs to
+ change, give it a new name, so that old results are not compared against it.
+
+ Each model runs in a forked child process, so that its peak memory usage is measured in isolation.  The wall time is
+ the best of the requested number of repeats; the generation stage breakdown comes from one additional run with
+ profiling enabled (see slim -profile), since profiling adds overhead that would distort the wall time.  Given a
+ previous results file with -baseline, slim_bench also reports the ratio of each wall time to its baseline, and exits
+ with a non-zero status if any model has become slower than the baseline by more than the tolerance.
+
+ With -kernels, slim_bench instead times low-level kernels against the reference implementations they replaced, such as
+ EidosAliasTable against gsl_ran_discrete(); each kernel also checks that it gives the same results as its reference.
+
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "slim_sim.h"
+#include "slim_globals.h"
+#include "eidos_globals.h"
+#include "eidos_rng.h"
+#include "eidos_alias_table.h"
+
+
+typedef struct {
+	const char *name_;
+	unsigned long int seed_;
+	const char *script_;
+} SLiMBenchModel;
+
+typedef struct {
+	int64_t generations_;
+	double wall_time_;				// the best wall time across repeats, in seconds
+	size_t peak_rss_;				// the peak RSS of the process running the model, in bytes
+	bool has_stage_times_;			// false if this build does not support profiling
+	double stage_times_[8];			// the profiled time in each generation stage; see SLiMSim::profile_stage_totals_
+} SLiMBenchResult;
+
+static const SLiMBenchModel gSLiMBenchModels[] = {
+
+	// A neutral WF model with a moderate mutation load; this exercises the core of offspring generation and bookkeeping
+	{"neutral_wf", 1, R"SCRIPT(
+initialize() {
+	initializeMutationRate(1e-7);
+	initializeMutationType("m1", 0.5, "f", 0.0);
+	initializeGenomicElementType("g1", m1, 1.0);
+	initializeGenomicElement(g1, 0, 999999);
+	initializeRecombinationRate(1e-8);
+}
+1 { sim.addSubpop("p1", 5000); }
+1000 late() { }
+)SCRIPT"},
+
+	// A QTL model, with a neutral fitness(m2) callback for the QTLs and a fitness(NULL) callback for stabilizing selection
+	{"qtl_fitness", 2, R"SCRIPT(
+initialize() {
+	initializeMutationRate(1e-7);
+	initializeMutationType("m1", 0.5, "f", 0.0);
+	initializeMutationType("m2", 0.5, "n", 0.0, 0.5);
+	m2.convertToSubstitution = F;
+	initializeGenomicElementType("g1", c(m1, m2), c(1.0, 0.1));
+	initializeGenomicElement(g1, 0, 999999);
+	initializeRecombinationRate(1e-8);
+}
+fitness(m2) { return 1.0; }
+1 { sim.addSubpop("p1", 2000); }
+1: late() {
+	inds = sim.subpopulations.individuals;
+	inds.tagF = inds.sumOfMutationsOfType(m2);
+}
+fitness(NULL) { return 1.0 + dnorm(10.0 - individual.tagF, 0.0, 5.0); }
+1000 late() { }
+)SCRIPT"},
+
+	// A nonWF model in continuous space, with local competition and spatial mate choice through interactions
+	{"nonwf_spatial", 3, R"SCRIPT(
+initialize() {
+	initializeSLiMModelType("nonWF");
+	initializeSLiMOptions(dimensionality="xy");
+	defineConstant("K", 5000);
+	defineConstant("S", 0.02);
+	initializeMutationRate(1e-7);
+	initializeMutationType("m1", 0.5, "f", 0.0);
+	m1.convertToSubstitution = T;
+	initializeGenomicElementType("g1", m1, 1.0);
+	initializeGenomicElement(g1, 0, 99999);
+	initializeRecombinationRate(1e-8);
+	initializeInteractionType(1, "xy", reciprocal=T, maxDistance=S * 3);
+	i1.setInteractionFunction("n", 1.0, S);
+	initializeInteractionType(2, "xy", reciprocal=T, maxDistance=0.05);
+}
+reproduction() {
+	mate = i2.drawByStrength(individual, 1);
+	if (mate.size())
+		subpop.addCrossed(individual, mate);
+}
+1 early() {
+	sim.addSubpop("p1", K);
+	p1.individuals.setSpatialPosition(p1.pointUniform(K));
+}
+early() {
+	i1.evaluate();
+	inds = p1.individuals;
+	competition = i1.totalOfNeighborStrengths(inds);
+	inds.fitnessScaling = 1.0 / (1.0 + competition / (K * 2 * PI * S^2));
+}
+late() {
+	inds = p1.individuals;
+	pos = inds.spatialPosition + rnorm(size(inds) * 2, 0, 0.01);
+	inds.setSpatialPosition(p1.pointReflected(pos));
+	i2.evaluate();
+}
+200 late() { }
+)SCRIPT"},
+
+	// A neutral WF model with tree-sequence recording and regular simplification, over a long chromosome
+	{"treeseq", 4, R"SCRIPT(
+initialize() {
+	initializeTreeSeq(simplificationRatio=10);
+	initializeMutationRate(0);
+	initializeMutationType("m1", 0.5, "f", 0.0);
+	initializeGenomicElementType("g1", m1, 1.0);
+	initializeGenomicElement(g1, 0, 9999999);
+	initializeRecombinationRate(1e-8);
+}
+1 { sim.addSubpop("p1", 5000); }
+500 late() { }
+)SCRIPT"},
+
+	// A nucleotide-based model with a Jukes-Cantor mutation matrix
+	{"nucleotide", 5, R"SCRIPT(
+initialize() {
+	initializeSLiMOptions(nucleotideBased=T);
+	defineConstant("L", 1e6);
+	initializeAncestralNucleotides(randomNucleotides(L));
+	initializeMutationTypeNuc("m1", 0.5, "f", 0.0);
+	initializeGenomicElementType("g1", m1, 1.0, mmJukesCantor(1e-7 / 3));
+	initializeGenomicElement(g1, 0, L - 1);
+	initializeRecombinationRate(1e-8);
+}
+1 { sim.addSubpop("p1", 2000); }
+1000 late() { }
+)SCRIPT"},
+
+	// A WF model with non-trivial fitness(m2) and fitness(NULL) callbacks, dominated by the cost of running the callbacks
+	{"fitness_callbacks", 6, R"SCRIPT(
+initialize() {
+	initializeMutationRate(1e-7);
+	initializeMutationType("m1", 0.5, "f", 0.0);
+	initializeMutationType("m2", 0.3, "g", -0.02, 0.5);
+	initializeMutationType("m3", 0.5, "n", 0.0, 0.5);
+	m3.convertToSubstitution = F;
+	initializeGenomicElementType("g1", c(m1, m2, m3), c(1.0, 0.5, 0.1));
+	initializeGenomicElement(g1, 0, 999999);
+	initializeRecombinationRate(1e-8);
+	defineConstant("OPT", 2.0);
+}
+fitness(m2) {
+	if (homozygous)
+		return relFitness * (1.0 + mut.selectionCoeff);
+	h = mut.mutationType.dominanceCoeff;
+	return relFitness * (1.0 + h * mut.selectionCoeff);
+}
+fitness(m3) { return 1.0; }
+fitness(NULL) {
+	z = individual.tagF;
+	return 0.1 + exp(-((z - OPT) ^ 2) / (2 * 1.5 ^ 2)) * (individual.index % 2 == 0 ? 1.0 else 0.95);
+}
+1 { sim.addSubpop("p1", 2000); }
+1: late() {
+	inds = sim.subpopulations.individuals;
+	inds.tagF = inds.sumOfMutationsOfType(m3);
+}
+500 late() { }
+)SCRIPT"},
+};
+
+static const int gSLiMBenchModelCount = (int)(sizeof(gSLiMBenchModels) / sizeof(SLiMBenchModel));
+
+
+static void PrintUsageAndDie(void)
+{
+	std::cout << "usage: slim_bench -u[sage] | -l[ist] | -k[ernels] |" << std::endl;
+	std::cout << "   [-r[epeats] <n>] [-threads <n>] [-b[aseline] <file> [-t[olerance] <f>]] [<model> ...]" << std::endl;
+	std::cout << std::endl;
+	std::cout << "   -u[sage]          : print command-line usage help" << std::endl;
+	std::cout << "   -l[ist]           : list the benchmark models" << std::endl;
+	std::cout << "   -k[ernels]        : time low-level kernels against their reference implementations" << std::endl;
+	std::cout << "   -r[epeats] <n>    : time each model <n> times and report the best time (default 1)" << std::endl;
+	std::cout << "   -threads <n>      : run the models with up to <n> threads, as with slim -threads" << std::endl;
+	std::cout << "   -b[aseline] <file>: compare wall times with those in <file>, previous output of slim_bench" << std::endl;
+	std::cout << "   -t[olerance] <f>  : the fractional slowdown relative to the baseline that is a regression (default 0.1)" << std::endl;
+	std::cout << "   <model> ...       : the models to run (default all)" << std::endl;
+	
+	exit(0);
+}
+
+static SLiMSim *NewBenchSim(const SLiMBenchModel &p_model)
+{
+	std::istringstream script_stream(p_model.script_);
+	SLiMSim *sim = new SLiMSim(script_stream);
+	unsigned long int seed = p_model.seed_;
+	
+	sim->InitializeRNGFromSeed(&seed);
+	
+	return sim;
+}
+
+static void RunBenchModel(const SLiMBenchModel &p_model, int p_repeats, SLiMBenchResult *p_result)
+{
+	p_result->generations_ = 0;
+	p_result->wall_time_ = std::numeric_limits<double>::infinity();
+	p_result->has_stage_times_ = false;
+	
+	for (int stage = 0; stage < 8; ++stage)
+		p_result->stage_times_[stage] = 0.0;
+	
+	// Timed runs, without profiling
+	for (int repeat = 0; repeat < p_repeats; ++repeat)
+	{
+		SLiMSim *sim = NewBenchSim(p_model);
+		int64_t generations = 0;
+		std::chrono::steady_clock::time_point begin_wall = std::chrono::steady_clock::now();
+		
+		while (sim->RunOneGeneration())
+			generations++;
+		
+		double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_wall).count();
+		
+		p_result->generations_ = generations;
+		p_result->wall_time_ = std::min(p_result->wall_time_, wall_time);
+		
+		delete sim;
+	}
+	
+	p_result->peak_rss_ = Eidos_GetPeakRSS();
+
+#if (SLIMPROFILING == 1)
+	// A profiled run, for the generation stage breakdown
+	{
+		SLiMSim *sim = NewBenchSim(p_model);
+		
+		gEidosProfilingClientCount++;
+		sim->StartProfiling();
+		
+		while (sim->RunOneGeneration())
+			;
+		
+		for (int stage = 0; stage < 8; ++stage)
+			p_result->stage_times_[stage] = Eidos_ElapsedProfileTime(sim->profile_stage_totals_[stage]);
+		p_result->has_stage_times_ = true;
+		
+		gEidosProfilingClientCount--;
+		delete sim;
+	}
+#endif
+}
+
+static bool RunBenchModelInChild(const SLiMBenchModel &p_model, int p_repeats, SLiMBenchResult *p_result)
+{
+	int result_pipe[2];
+	
+	if (pipe(result_pipe) != 0)
+		return false;
+	
+	pid_t pid = fork();
+	
+	if (pid < 0)
+	{
+		close(result_pipe[0]);
+		close(result_pipe[1]);
+		return false;
+	}
+	
+	if (pid == 0)
+	{
+		// In the child: discard the model's output, run it, and send the result back through the pipe
+		close(result_pipe[0]);
+		
+		int null_fd = open("/dev/null", O_WRONLY);
+		
+		if (null_fd >= 0)
+		{
+			dup2(null_fd, STDOUT_FILENO);
+			close(null_fd);
+		}
+		
+		SLiMBenchResult result;
+		
+		RunBenchModel(p_model, p_repeats, &result);
+		
+		ssize_t written = write(result_pipe[1], &result, sizeof(SLiMBenchResult));
+		
+		close(result_pipe[1]);
+		_exit((written == (ssize_t)sizeof(SLiMBenchResult)) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	
+	// In the parent: collect the result; a model that raises an error exits its child without sending a result
+	close(result_pipe[1]);
+	
+	ssize_t read_count = read(result_pipe[0], p_result, sizeof(SLiMBenchResult));
+	int status = 0;
+	
+	close(result_pipe[0]);
+	waitpid(pid, &status, 0);
+	
+	return ((read_count == (ssize_t)sizeof(SLiMBenchResult)) && WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS));
+}
+
+static void RunAliasTableKernels(void)
+{
+	// Compare EidosAliasTable with the GSL's gsl_ran_discrete() for the per-generation pattern of fitness-proportional
+	// parent draws: rebuild the table from new weights, then draw two parents for each individual.  Each size is run for
+	// roughly the same total number of draws.  The draws are checked against the GSL's, from identically seeded RNGs.
+	std::cout << "kernel\tsize\treference_time\tkernel_time\tspeedup\tidentical" << std::endl;
+	
+	for (size_t size : {100, 1000, 10000, 100000, 1000000})
+	{
+		int rounds = (int)std::max((size_t)1, (size_t)10000000 / size);
+		std::vector<double> weights(size);
+		std::vector<int32_t> gsl_draws(size * 2), alias_draws(size * 2);
+		Eidos_RNG_State weight_rng, reference_rng, alias_rng;
+		
+		Eidos_InitializeRNG(weight_rng);
+		Eidos_InitializeRNG(reference_rng);
+		Eidos_InitializeRNG(alias_rng);
+		Eidos_SetRNGSeed(weight_rng, 17);
+		Eidos_SetRNGSeed(reference_rng, 23);
+		Eidos_SetRNGSeed(alias_rng, 23);
+		
+		for (double &weight : weights)
+			weight = Eidos_rng_uniform(weight_rng.gsl_rng_);
+		
+		// the reference: a new GSL table each generation, and a call to gsl_ran_discrete() for each draw
+		std::chrono::steady_clock::time_point begin_gsl = std::chrono::steady_clock::now();
+		
+		for (int round = 0; round < rounds; ++round)
+		{
+			gsl_ran_discrete_t *lookup = gsl_ran_discrete_preproc(size, weights.data());
+			
+			for (size_t draw_index = 0; draw_index < size * 2; ++draw_index)
+				gsl_draws[draw_index] = (int32_t)gsl_ran_discrete(reference_rng.gsl_rng_, lookup);
+			
+			gsl_ran_discrete_free(lookup);
+		}
+		
+		double gsl_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_gsl).count();
+		
+		// the kernel: one EidosAliasTable rebuilt in place each generation, with inline draws
+		EidosAliasTable table;
+		std::chrono::steady_clock::time_point begin_alias = std::chrono::steady_clock::now();
+		
+		for (int round = 0; round < rounds; ++round)
+		{
+			table.Rebuild(size, weights.data());
+			
+			for (size_t draw_index = 0; draw_index < size * 2; ++draw_index)
+				alias_draws[draw_index] = (int32_t)table.Draw(alias_rng);
+		}
+		
+		double alias_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_alias).count();
+		
+		std::cout << "alias_table_draw\t" << size << "\t" << gsl_time << "\t" << alias_time << "\t" << (gsl_time / alias_time) << "\t" << ((gsl_draws == alias_draws) ? "T" : "F") << std::endl;
+		
+		// the batched kernel: the same, with all of the draws for a generation made by one call
+		Eidos_SetRNGSeed(alias_rng, 23);
+		begin_alias = std::chrono::steady_clock::now();
+		
+		for (int round = 0; round < rounds; ++round)
+		{
+			table.Rebuild(size, weights.data());
+			table.DrawMany(alias_rng, alias_draws.data(), size * 2);
+		}
+		
+		alias_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_alias).count();
+		
+		std::cout << "alias_table_draw_many\t" << size << "\t" << gsl_time << "\t" << alias_time << "\t" << (gsl_time / alias_time) << "\t" << ((gsl_draws == alias_draws) ? "T" : "F") << std::endl;
+		
+		Eidos_FreeRNG(weight_rng);
+		Eidos_FreeRNG(reference_rng);
+		Eidos_FreeRNG(alias_rng);
+	}
+}
+
+static std::map<std::string, double> ReadBaselineWallTimes(const char *p_path)
+{
+	// Read the model names and wall times from a previous slim_bench output file; comment and header lines are skipped
+	std::ifstream infile(p_path);
+	std::map<std::string, double> wall_times;
+	std::string line;
+	
+	if (!infile.is_open())
+	{
+		std::cerr << "slim_bench: could not open baseline file " << p_path << "." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	
+	while (std::getline(infile, line))
+	{
+		if ((line.length() == 0) || (line[0] == '#'))
+			continue;
+		
+		std::vector<std::string> fields;
+		std::istringstream line_stream(line);
+		std::string field;
+		
+		while (std::getline(line_stream, field, '\t'))
+			fields.push_back(field);
+		
+		if ((fields.size() < 3) || (fields[0] == "model") || (fields[1] == "FAILED"))
+			continue;
+		
+		wall_times[fields[0]] = strtod(fields[2].c_str(), NULL);
+	}
+	
+	return wall_times;
+}
+
+int main(int argc, char *argv[])
+{
+	gEidosTerminateThrows = false;
+	
+	// parse command-line arguments
+	int repeats = 1;
+	const char *baseline_file = nullptr;
+	double tolerance = 0.1;
+	std::vector<const SLiMBenchModel *> models;
+	
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		const char *arg = argv[arg_index];
+		
+		if (strcmp(arg, "-usage") == 0 || strcmp(arg, "-u") == 0 || strcmp(arg, "-?") == 0)
+			PrintUsageAndDie();
+		
+		if (strcmp(arg, "-list") == 0 || strcmp(arg, "-l") == 0)
+		{
+			for (int model_index = 0; model_index < gSLiMBenchModelCount; ++model_index)
+				std::cout << gSLiMBenchModels[model_index].name_ << std::endl;
+			exit(0);
+		}
+		
+		if (strcmp(arg, "-kernels") == 0 || strcmp(arg, "-k") == 0)
+		{
+			RunAliasTableKernels();
+			exit(0);
+		}
+		
+		if (strcmp(arg, "-repeats") == 0 || strcmp(arg, "-r") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie();
+			
+			repeats = (int)strtol(argv[arg_index], NULL, 10);
+			
+			if ((repeats < 1) || (repeats > 100))
+			{
+				std::cerr << "Repeat count supplied to -repeats must be in [1, 100]." << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		
+		if (strcmp(arg, "-threads") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie();
+			
+			long thread_count = strtol(argv[arg_index], NULL, 10);
+			
+			if ((thread_count < 1) || (thread_count > 1024))
+			{
+				std::cerr << "Thread count supplied to -threads must be in [1, 1024]." << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			
+			gEidosMaxThreads = (int)thread_count;
+			continue;
+		}
+		
+		if (strcmp(arg, "-baseline") == 0 || strcmp(arg, "-b") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie();
+			
+			baseline_file = argv[arg_index];
+			continue;
+		}
+		
+		if (strcmp(arg, "-tolerance") == 0 || strcmp(arg, "-t") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie();
+			
+			tolerance = strtod(argv[arg_index], NULL);
+			
+			if (!(tolerance >= 0.0))
+			{
+				std::cerr << "Tolerance supplied to -tolerance must be >= 0." << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		
+		if (arg[0] == '-')
+			PrintUsageAndDie();
+		
+		// anything else must be a model name
+		const SLiMBenchModel *model = nullptr;
+		
+		for (int model_index = 0; model_index < gSLiMBenchModelCount; ++model_index)
+			if (strcmp(arg, gSLiMBenchModels[model_index].name_) == 0)
+				model = &gSLiMBenchModels[model_index];
+		
+		if (!model)
+		{
+			std::cerr << "slim_bench: unknown model " << arg << "; use -list to list the benchmark models." << std::endl;
+			exit(EXIT_FAILURE);
+		}
+		
+		models.push_back(model);
+	}
+	
+	if (models.size() == 0)
+		for (int model_index = 0; model_index < gSLiMBenchModelCount; ++model_index)
+			models.push_back(&gSLiMBenchModels[model_index]);
+	
+	std::map<std::string, double> baseline_wall_times;
+	
+	if (baseline_file)
+		baseline_wall_times = ReadBaselineWallTimes(baseline_file);
+	
+	Eidos_WarmUp();
+	SLiM_WarmUp();
+	
+	// The header and result lines are a stable format; new columns should only ever be appended at the end
+	std::cout << "# slim_bench: SLiM version " << SLIM_VERSION_STRING << ", built " << __DATE__ << " " __TIME__ << ", " << gEidosMaxThreads << " thread(s), best of " << repeats << std::endl;
+	std::cout << "model\tgenerations\twall_time\tgenerations_per_sec\tpeak_rss_mb";
+	for (int stage = 0; stage < 8; ++stage)
+		std::cout << "\tstage" << stage;
+	if (baseline_file)
+		std::cout << "\tbaseline_wall_time\tratio\tstatus";
+	std::cout << std::endl;
+	
+	bool any_failure = false, any_regression = false;
+	
+	for (const SLiMBenchModel *model : models)
+	{
+		SLiMBenchResult result;
+		
+		if (!RunBenchModelInChild(*model, repeats, &result))
+		{
+			std::cout << model->name_ << "\tFAILED" << std::endl;
+			any_failure = true;
+			continue;
+		}
+		
+		std::cout << model->name_ << "\t" << result.generations_ << "\t" << result.wall_time_ << "\t" << (result.generations_ / result.wall_time_) << "\t" << (result.peak_rss_ / (1024.0 * 1024.0));
+		
+		for (int stage = 0; stage < 8; ++stage)
+		{
+			if (result.has_stage_times_)
+				std::cout << "\t" << result.stage_times_[stage];
+			else
+				std::cout << "\tNA";
+		}
+		
+		if (baseline_file)
+		{
+			auto baseline_iter = baseline_wall_times.find(model->name_);
+			
+			if (baseline_iter == baseline_wall_times.end())
+			{
+				std::cout << "\tNA\tNA\tNEW";
+			}
+			else
+			{
+				double ratio = result.wall_time_ / baseline_iter->second;
+				bool regression = (ratio > 1.0 + tolerance);
+				
+				std::cout << "\t" << baseline_iter->second << "\t" << ratio << "\t" << (regression ? "REGRESSION" : "OK");
+				
+				if (regression)
+					any_regression = true;
+			}
+		}
+		
+		std::cout << std::endl;
+	}
+	
+	return ((any_failure || any_regression) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
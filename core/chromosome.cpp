@@ -63,8 +63,6 @@ Chromosome::Chromosome(SLiMSim *p_sim) :
 	sim_(p_sim),
 	single_recombination_map_(true), 
 	single_mutation_map_(true),
-	lookup_mutation_H_(nullptr), lookup_mutation_M_(nullptr), lookup_mutation_F_(nullptr), 
-	lookup_recombination_H_(nullptr), lookup_recombination_M_(nullptr), lookup_recombination_F_(nullptr),
 	exp_neg_overall_mutation_rate_H_(0.0), exp_neg_overall_mutation_rate_M_(0.0), exp_neg_overall_mutation_rate_F_(0.0),
 	exp_neg_overall_recombination_rate_H_(0.0), exp_neg_overall_recombination_rate_M_(0.0), exp_neg_overall_recombination_rate_F_(0.0), 
 	
@@ -92,24 +90,6 @@ Chromosome::~Chromosome(void)
 {
 	//EIDOS_ERRSTREAM << "Chromosome::~Chromosome" << std::endl;
 	
-	if (lookup_mutation_H_)
-		gsl_ran_discrete_free(lookup_mutation_H_);
-	
-	if (lookup_mutation_M_)
-		gsl_ran_discrete_free(lookup_mutation_M_);
-	
-	if (lookup_mutation_F_)
-		gsl_ran_discrete_free(lookup_mutation_F_);
-	
-	if (lookup_recombination_H_)
-		gsl_ran_discrete_free(lookup_recombination_H_);
-	
-	if (lookup_recombination_M_)
-		gsl_ran_discrete_free(lookup_recombination_M_);
-	
-	if (lookup_recombination_F_)
-		gsl_ran_discrete_free(lookup_recombination_F_);
-	
 	// Dispose of any nucleotide sequence
 	delete ancestral_seq_buffer_;
 	ancestral_seq_buffer_ = nullptr;
@@ -352,7 +332,7 @@ void Chromosome::ChooseMutationRunLayout(int p_preferred_count)
 }
 
 // initialize one recombination map, used internally by InitializeDraws() to avoid code duplication
-void Chromosome::_InitializeOneRecombinationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, double &p_overall_rate_userlevel)
+void Chromosome::_InitializeOneRecombinationMap(EidosAliasTable &p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, double &p_overall_rate_userlevel)
 {
 	// Patch the recombination interval end vector if it is empty; see setRecombinationRate() and initializeRecombinationRate().
 	// Basically, the length of the chromosome might not have been known yet when the user set the rate.
@@ -470,14 +450,11 @@ void Chromosome::_InitializeOneRecombinationMap(gsl_ran_discrete_t *&p_lookup, s
 	p_exp_neg_overall_rate = Eidos_FastRandomPoisson_PRECALCULATE(p_overall_rate);				// exp(-mu); can be 0 due to underflow
 #endif
 	
-	if (p_lookup)
-		gsl_ran_discrete_free(p_lookup);
-	
-	p_lookup = gsl_ran_discrete_preproc(reparameterized_rates.size(), B.data());
+	p_lookup.Rebuild(reparameterized_rates.size(), B.data());
 }
 
 // initialize one mutation map, used internally by InitializeDraws() to avoid code duplication
-void Chromosome::_InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_requested_overall_rate, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges)
+void Chromosome::_InitializeOneMutationMap(EidosAliasTable &p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_requested_overall_rate, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges)
 {
 	// Patch the mutation interval end vector if it is empty; see setMutationRate() and initializeMutationRate().
 	// Basically, the length of the chromosome might not have been known yet when the user set the rate.
@@ -580,10 +557,7 @@ void Chromosome::_InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::v
 	p_exp_neg_overall_rate = Eidos_FastRandomPoisson_PRECALCULATE(p_overall_rate);				// exp(-mu); can be 0 due to underflow
 #endif
 	
-	if (p_lookup)
-		gsl_ran_discrete_free(p_lookup);
-	
-	p_lookup = gsl_ran_discrete_preproc(B.size(), B.data());
+	p_lookup.Rebuild(B.size(), B.data());
 }
 
 // prints an error message and exits
@@ -596,7 +570,37 @@ void Chromosome::RecombinationMapConfigError(void) const
 	EIDOS_TERMINATION << "ERROR (Chromosome::RecombinationMapConfigError): (internal error) an error occurred in the configuration of recombination maps." << EidosTerminate();
 }
 
-int Chromosome::DrawSortedUniquedMutationPositions(int p_count, IndividualSex p_sex, std::vector<std::pair<slim_position_t, GenomicElement *>> &p_positions)
+// Sort a range of drawn positions by a key and remove entries with duplicate keys, returning the new end of the range.  Each gamete
+// usually draws just a few breakpoints or mutations, so small ranges get an insertion sort, which avoids std::sort()'s overhead.
+template <typename T, typename KEY>
+static inline T *SortAndUniqueDrawnPositions(T *p_begin, T *p_end, KEY p_key)
+{
+	if (p_end - p_begin <= 16)
+	{
+		for (T *iter = p_begin + 1; iter < p_end; ++iter)
+		{
+			T value = *iter;
+			slim_position_t value_key = p_key(value);
+			T *insert = iter;
+			
+			while ((insert > p_begin) && (p_key(*(insert - 1)) > value_key))
+			{
+				*insert = *(insert - 1);
+				--insert;
+			}
+			
+			*insert = value;
+		}
+	}
+	else
+	{
+		std::sort(p_begin, p_end, [&p_key](const T &p1, const T &p2) { return p_key(p1) < p_key(p2); });
+	}
+	
+	return std::unique(p_begin, p_end, [&p_key](const T &p1, const T &p2) { return p_key(p1) == p_key(p2); });
+}
+
+int Chromosome::DrawSortedUniquedMutationPositions(Eidos_RNG_State &p_rng, int p_count, IndividualSex p_sex, std::vector<std::pair<slim_position_t, GenomicElement *>> &p_positions)
 {
 	// BCH 1 September 2020: This method generates a vector of positions, sorted and uniqued for the caller.  This avoid various issues
 	// with two mutations occurring at the same position in the same gamete.  For example, nucleotide states in the tree-seq tables could
@@ -607,13 +611,13 @@ int Chromosome::DrawSortedUniquedMutationPositions(int p_count, IndividualSex p_
 	// position in the same gamete, the first might be accepted, and then second – which should unique down to the first – would also be
 	// accepted.  The right fix seems to be to unique the drawn mutation positions before creating mutations, avoiding all these issues;
 	// multiple mutations at the same position in the same gamete seems unbiological anyway.
-	gsl_ran_discrete_t *lookup;
+	const EidosAliasTable *lookup;
 	const std::vector<GESubrange> *subranges;
 	
 	if (single_mutation_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		lookup = lookup_mutation_H_;
+		lookup = &lookup_mutation_H_;
 		subranges = &mutation_subranges_H_;
 	}
 	else
@@ -621,12 +625,12 @@ int Chromosome::DrawSortedUniquedMutationPositions(int p_count, IndividualSex p_
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_sex == IndividualSex::kMale)
 		{
-			lookup = lookup_mutation_M_;
+			lookup = &lookup_mutation_M_;
 			subranges = &mutation_subranges_M_;
 		}
 		else if (p_sex == IndividualSex::kFemale)
 		{
-			lookup = lookup_mutation_F_;
+			lookup = &lookup_mutation_F_;
 			subranges = &mutation_subranges_F_;
 		}
 		else
@@ -635,40 +639,39 @@ int Chromosome::DrawSortedUniquedMutationPositions(int p_count, IndividualSex p_
 		}
 	}
 	
-	// draw all the positions, and keep track of the genomic element type for each
+	// draw all the positions, and keep track of the genomic element type for each; they are drawn into the end of p_positions, so
+	// that callers can accumulate the positions for many gametes in one buffer.  All of the subranges are drawn first, and then
+	// all of the positions within them; the subranges come from the taus2 generator and the positions from the MT64 generator,
+	// which are independent streams, so this draws the same positions as drawing each mutation in turn, with tighter loops.
+	size_t start_index = p_positions.size();
+	
+	p_positions.resize(start_index + p_count);
+	
+	std::pair<slim_position_t, GenomicElement *> *positions = p_positions.data() + start_index;
+	
+	for (int i = 0; i < p_count; ++i)
+		positions[i].first = lookup->Draw(p_rng);
+	
 	for (int i = 0; i < p_count; ++i)
 	{
-		int mut_subrange_index = static_cast<int>(gsl_ran_discrete(EIDOS_GSL_RNG, lookup));
-		const GESubrange &subrange = (*subranges)[mut_subrange_index];
-		GenomicElement *source_element = subrange.genomic_element_ptr_;
+		const GESubrange &subrange = (*subranges)[positions[i].first];
 		
 		// Draw the position along the chromosome for the mutation, within the genomic element
-		slim_position_t position = subrange.start_position_ + static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64(subrange.end_position_ - subrange.start_position_ + 1));
+		positions[i].first = subrange.start_position_ + static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64(p_rng, subrange.end_position_ - subrange.start_position_ + 1));
+		positions[i].second = subrange.genomic_element_ptr_;
 		// old 32-bit position not MT64 code:
 		//slim_position_t position = subrange.start_position_ + static_cast<slim_position_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, (uint32_t)(subrange.end_position_ - subrange.start_position_ + 1)));
-		
-		p_positions.emplace_back(std::pair<slim_position_t, GenomicElement *>(position, source_element));
 	}
 	
-	// sort and unique by position; 1 and 2 mutations are particularly common, so try to speed those up
+	// sort and unique by position; genomic elements do not overlap, so positions that are equal have the same genomic element
 	if (p_count > 1)
 	{
-		if (p_count == 2)
-		{
-			if (p_positions[0].first > p_positions[1].first)
-				std::swap(p_positions[0], p_positions[1]);
-			else if (p_positions[0].first == p_positions[1].first)
-				p_positions.resize(1);
-		}
-		else
-		{
-			std::sort(p_positions.begin(), p_positions.end(), [](const std::pair<slim_position_t, GenomicElement *> &p1, const std::pair<slim_position_t, GenomicElement *> &p2) { return p1.first < p2.first; });
-			auto unique_iter = std::unique(p_positions.begin(), p_positions.end(), [](const std::pair<slim_position_t, GenomicElement *> &p1, const std::pair<slim_position_t, GenomicElement *> &p2) { return p1.first == p2.first; });
-			p_positions.resize(std::distance(p_positions.begin(), unique_iter));
-		}
+		std::pair<slim_position_t, GenomicElement *> *positions_end = SortAndUniqueDrawnPositions(positions, positions + p_count, [](const std::pair<slim_position_t, GenomicElement *> &p) { return p.first; });
+		
+		p_positions.resize(positions_end - p_positions.data());
 	}
 	
-	return (int)p_positions.size();
+	return (int)(p_positions.size() - start_index);
 }
 
 // draw a new mutation, based on the genomic element types present and their mutational proclivities
@@ -696,7 +699,7 @@ MutationIndex Chromosome::DrawNewMutation(std::pair<slim_position_t, GenomicElem
 // apply mutation() to a generated mutation; we might return nullptr (proposed mutation rejected), the original proposed mutation (it was accepted), or a replacement Mutation *
 Mutation *Chromosome::ApplyMutationCallbacks(Mutation *p_mut, Genome *p_genome, GenomicElement *p_genomic_element, int8_t p_original_nucleotide, std::vector<SLiMEidosBlock*> &p_mutation_callbacks) const
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -836,7 +839,7 @@ Mutation *Chromosome::ApplyMutationCallbacks(Mutation *p_mut, Genome *p_genome,
 	
 	sim_->executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMutationCallback)]);
 #endif
@@ -1046,7 +1049,7 @@ MutationIndex Chromosome::DrawNewMutationExtended(std::pair<slim_position_t, Gen
 }
 
 // draw a set of uniqued breakpoints according to the "crossover breakpoint" model and run them through recombination() callbacks, returning the final usable set
-void Chromosome::DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int p_num_breakpoints, std::vector<slim_position_t> &p_crossovers) const
+int Chromosome::DrawCrossoverBreakpoints(Eidos_RNG_State &p_rng, IndividualSex p_parent_sex, const int p_num_breakpoints, std::vector<slim_position_t> &p_crossovers) const
 {
 	// BEWARE! Chromosome::DrawDSBBreakpoints() below must be altered in parallel with this method!
 #if DEBUG
@@ -1054,13 +1057,13 @@ void Chromosome::DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int
 		EIDOS_TERMINATION << "ERROR (Chromosome::DrawCrossoverBreakpoints): (internal error) this method should not be called when the DSB recombination model is being used." << EidosTerminate();
 #endif
 	
-	gsl_ran_discrete_t *lookup;
+	const EidosAliasTable *lookup;
 	const std::vector<slim_position_t> *end_positions;
 	
 	if (single_recombination_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		lookup = lookup_recombination_H_;
+		lookup = &lookup_recombination_H_;
 		end_positions = &recombination_end_positions_H_;
 	}
 	else
@@ -1068,12 +1071,12 @@ void Chromosome::DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_parent_sex == IndividualSex::kMale)
 		{
-			lookup = lookup_recombination_M_;
+			lookup = &lookup_recombination_M_;
 			end_positions = &recombination_end_positions_M_;
 		}
 		else if (p_parent_sex == IndividualSex::kFemale)
 		{
-			lookup = lookup_recombination_F_;
+			lookup = &lookup_recombination_F_;
 			end_positions = &recombination_end_positions_F_;
 		}
 		else
@@ -1082,11 +1085,22 @@ void Chromosome::DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int
 		}
 	}
 	
-	// draw recombination breakpoints
+	// draw recombination breakpoints into the end of p_crossovers, so that callers can accumulate the breakpoints for many gametes
+	// in one buffer.  As in DrawSortedUniquedMutationPositions(), all of the intervals are drawn first, from the taus2 generator,
+	// and then all of the positions within them, from the MT64 generator; this draws the same breakpoints as drawing each in turn.
+	size_t start_index = p_crossovers.size();
+	
+	p_crossovers.resize(start_index + p_num_breakpoints);
+	
+	slim_position_t *breakpoints = p_crossovers.data() + start_index;
+	
+	for (int i = 0; i < p_num_breakpoints; i++)
+		breakpoints[i] = lookup->Draw(p_rng);
+	
 	for (int i = 0; i < p_num_breakpoints; i++)
 	{
 		slim_position_t breakpoint = 0;
-		int recombination_interval = static_cast<int>(gsl_ran_discrete(EIDOS_GSL_RNG, lookup));
+		int recombination_interval = static_cast<int>(breakpoints[i]);
 		
 		// choose a breakpoint anywhere in the chosen recombination interval with equal probability
 		
@@ -1115,38 +1129,27 @@ void Chromosome::DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int
 		// happen, and we don't want to waste time checking for that condition here.  For a 1-base model, we are guaranteed that
 		// the overall recombination rate will be zero, by the logic in InitializeDraws(), and so we should not be called in the
 		// first place.  For longer chromosomes that start with a 1-base recombination interval, the rate calculated by
-		// InitializeDraws() for the first interval should be 0, so gsl_ran_discrete() should never return the first interval to
+		// InitializeDraws() for the first interval should be 0, so the lookup table should never return the first interval to
 		// us here.  For all other recombination intervals, the math of pos[x]-pos[x-1] should always result in a value >0,
 		// since we guarantee that recombination end positions are in strictly ascending order.  So we should never crash.  :->
 		
 		if (recombination_interval == 0)
-			breakpoint = static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64((*end_positions)[recombination_interval]) + 1);
+			breakpoint = static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64(p_rng, (*end_positions)[recombination_interval]) + 1);
 		else
-			breakpoint = (*end_positions)[recombination_interval - 1] + 1 + static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64((*end_positions)[recombination_interval] - (*end_positions)[recombination_interval - 1]));
+			breakpoint = (*end_positions)[recombination_interval - 1] + 1 + static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64(p_rng, (*end_positions)[recombination_interval] - (*end_positions)[recombination_interval - 1]));
 		
-		p_crossovers.emplace_back(breakpoint);
+		breakpoints[i] = breakpoint;
 	}
 	
 	// sort and unique
-	if (p_num_breakpoints > 2)
-	{
-		std::sort(p_crossovers.begin(), p_crossovers.end());
-		p_crossovers.erase(std::unique(p_crossovers.begin(), p_crossovers.end()), p_crossovers.end());
-	}
-	else if (p_num_breakpoints == 2)
+	if (p_num_breakpoints > 1)
 	{
-		// do our own dumb inline sort/unique if we have just two elements, to avoid the calls above
-		// I didn't actually test this to confirm that it's faster, but models that generate many
-		// breakpoints will generally hit the case above anyway, and models that generate few will
-		// suffer only the additional (num_breakpoints == 2) test before falling through...
-		slim_position_t bp1 = p_crossovers[0];
-		slim_position_t bp2 = p_crossovers[1];
-		
-		if (bp1 > bp2)
-			std::swap(p_crossovers[0], p_crossovers[1]);
-		else if (bp1 == bp2)
-			p_crossovers.resize(1);
+		slim_position_t *breakpoints_end = SortAndUniqueDrawnPositions(breakpoints, breakpoints + p_num_breakpoints, [](slim_position_t p) { return p; });
+		
+		p_crossovers.resize(breakpoints_end - p_crossovers.data());
 	}
+	
+	return (int)(p_crossovers.size() - start_index);
 }
 
 // draw a set of uniqued breakpoints according to the "double-stranded break" model and run them through recombination() callbacks, returning the final usable set
@@ -1159,14 +1162,14 @@ void Chromosome::DrawDSBBreakpoints(IndividualSex p_parent_sex, const int p_num_
 		EIDOS_TERMINATION << "ERROR (Chromosome::DrawDSBBreakpoints): (internal error) this method should not be called when the crossover breakpoints recombination model is being used." << EidosTerminate();
 #endif
 	
-	gsl_ran_discrete_t *lookup;
+	const EidosAliasTable *lookup;
 	const std::vector<slim_position_t> *end_positions;
 	const std::vector<double> *rates;
 	
 	if (single_recombination_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		lookup = lookup_recombination_H_;
+		lookup = &lookup_recombination_H_;
 		end_positions = &recombination_end_positions_H_;
 		rates = &recombination_rates_H_;
 	}
@@ -1175,13 +1178,13 @@ void Chromosome::DrawDSBBreakpoints(IndividualSex p_parent_sex, const int p_num_
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_parent_sex == IndividualSex::kMale)
 		{
-			lookup = lookup_recombination_M_;
+			lookup = &lookup_recombination_M_;
 			end_positions = &recombination_end_positions_M_;
 			rates = &recombination_rates_M_;
 		}
 		else if (p_parent_sex == IndividualSex::kFemale)
 		{
-			lookup = lookup_recombination_F_;
+			lookup = &lookup_recombination_F_;
 			end_positions = &recombination_end_positions_F_;
 			rates = &recombination_rates_F_;
 		}
@@ -1236,7 +1239,7 @@ generateDSBs:
 	for (int i = 0; i < p_num_breakpoints; i++)
 	{
 		slim_position_t breakpoint = 0;
-		int recombination_interval = static_cast<int>(gsl_ran_discrete(EIDOS_GSL_RNG, lookup));
+		int recombination_interval = static_cast<int>(lookup->Draw(gEidos_RNG));
 		
 		if (recombination_interval == 0)
 			breakpoint = static_cast<slim_position_t>(Eidos_rng_uniform_int_MT64((*end_positions)[recombination_interval]) + 1);
@@ -1332,14 +1335,7 @@ size_t Chromosome::MemoryUsageForMutationMaps(void)
 	usage += (hotspot_multipliers_H_.size() + hotspot_multipliers_M_.size() + hotspot_multipliers_F_.size()) * sizeof(double);
 	usage += (hotspot_end_positions_H_.size() + hotspot_end_positions_M_.size() + hotspot_end_positions_F_.size()) * sizeof(slim_position_t);
 	
-	if (lookup_mutation_H_)
-		usage += lookup_mutation_H_->K * (sizeof(size_t) + sizeof(double));
-	
-	if (lookup_mutation_M_)
-		usage += lookup_mutation_M_->K * (sizeof(size_t) + sizeof(double));
-	
-	if (lookup_mutation_F_)
-		usage += lookup_mutation_F_->K * (sizeof(size_t) + sizeof(double));
+	usage += lookup_mutation_H_.MemoryUsage() + lookup_mutation_M_.MemoryUsage() + lookup_mutation_F_.MemoryUsage();
 	
 	return usage;
 }
@@ -1351,14 +1347,7 @@ size_t Chromosome::MemoryUsageForRecombinationMaps(void)
 	usage = (recombination_rates_H_.size() + recombination_rates_M_.size() + recombination_rates_F_.size()) * sizeof(double);
 	usage += (recombination_end_positions_H_.size() + recombination_end_positions_M_.size() + recombination_end_positions_F_.size()) * sizeof(slim_position_t);
 	
-	if (lookup_recombination_H_)
-		usage += lookup_recombination_H_->K * (sizeof(size_t) + sizeof(double));
-	
-	if (lookup_recombination_M_)
-		usage += lookup_recombination_M_->K * (sizeof(size_t) + sizeof(double));
-	
-	if (lookup_recombination_F_)
-		usage += lookup_recombination_F_->K * (sizeof(size_t) + sizeof(double));
+	usage += lookup_recombination_H_.MemoryUsage() + lookup_recombination_M_.MemoryUsage() + lookup_recombination_F_.MemoryUsage();
 	
 	return usage;
 }
@@ -37,6 +37,7 @@
 #include "genomic_element.h"
 #include "genomic_element_type.h"
 #include "eidos_rng.h"
+#include "eidos_alias_table.h"
 #include "eidos_value.h"
 
 struct GESubrange;
@@ -74,13 +75,13 @@ private:
 	// maps.  This flag indicates which option has been chosen; after initialize() time this cannot be changed.
 	bool single_mutation_map_ = true;
 	
-	gsl_ran_discrete_t *lookup_mutation_H_ = nullptr;		// OWNED POINTER: lookup table for drawing mutations
-	gsl_ran_discrete_t *lookup_mutation_M_ = nullptr;
-	gsl_ran_discrete_t *lookup_mutation_F_ = nullptr;
+	EidosAliasTable lookup_mutation_H_;			// lookup table for drawing mutations; not built until the mutation map is initialized
+	EidosAliasTable lookup_mutation_M_;
+	EidosAliasTable lookup_mutation_F_;
 	
-	gsl_ran_discrete_t *lookup_recombination_H_ = nullptr;	// OWNED POINTER: lookup table for drawing recombination breakpoints
-	gsl_ran_discrete_t *lookup_recombination_M_ = nullptr;
-	gsl_ran_discrete_t *lookup_recombination_F_ = nullptr;
+	EidosAliasTable lookup_recombination_H_;	// lookup table for drawing recombination breakpoints
+	EidosAliasTable lookup_recombination_M_;
+	EidosAliasTable lookup_recombination_F_;
 	
 	// caches to speed up Poisson draws in CrossoverMutation()
 	double exp_neg_overall_mutation_rate_H_;			
@@ -186,8 +187,8 @@ public:
 	
 	// initialize the random lookup tables used by Chromosome to draw mutation and recombination events
 	void InitializeDraws(void);
-	void _InitializeOneRecombinationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, double &p_overall_rate_userlevel);
-	void _InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_requested_overall_rate, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges);
+	void _InitializeOneRecombinationMap(EidosAliasTable &p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, double &p_overall_rate_userlevel);
+	void _InitializeOneMutationMap(EidosAliasTable &p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_requested_overall_rate, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges);
 	void ChooseMutationRunLayout(int p_preferred_count);
 	
 	inline bool UsingSingleRecombinationMap(void) const { return single_recombination_map_; }
@@ -195,10 +196,13 @@ public:
 	inline size_t GenomicElementCount(void) const { return genomic_elements_.size(); }
 	
 	// draw the number of mutations that occur, based on the overall mutation rate
-	int DrawMutationCount(IndividualSex p_sex) const;
+	int DrawMutationCount(Eidos_RNG_State &p_rng, IndividualSex p_sex) const;
+	inline int DrawMutationCount(IndividualSex p_sex) const { return DrawMutationCount(gEidos_RNG, p_sex); }
 	
-	// draw a vector of mutation positions (and the corresponding GenomicElementType objects), which is sorted and uniqued for the caller
-	int DrawSortedUniquedMutationPositions(int p_count, IndividualSex p_sex, std::vector<std::pair<slim_position_t, GenomicElement *>> &p_positions);
+	// draw mutation positions (and the corresponding GenomicElement objects), appended to p_positions; the appended positions are sorted
+	// and uniqued for the caller, and their number is returned, so the positions for many gametes can be drawn into one buffer
+	int DrawSortedUniquedMutationPositions(Eidos_RNG_State &p_rng, int p_count, IndividualSex p_sex, std::vector<std::pair<slim_position_t, GenomicElement *>> &p_positions);
+	inline int DrawSortedUniquedMutationPositions(int p_count, IndividualSex p_sex, std::vector<std::pair<slim_position_t, GenomicElement *>> &p_positions) { return DrawSortedUniquedMutationPositions(gEidos_RNG, p_count, p_sex, p_positions); }
 	
 	// draw a new mutation, based on the genomic element types present and their mutational proclivities
 	MutationIndex DrawNewMutation(std::pair<slim_position_t, GenomicElement *> &p_position, slim_objectid_t p_subpop_index, slim_generation_t p_generation) const;
@@ -208,15 +212,19 @@ public:
 	MutationIndex DrawNewMutationExtended(std::pair<slim_position_t, GenomicElement *> &p_position, slim_objectid_t p_subpop_index, slim_generation_t p_generation, Genome *parent_genome_1, Genome *parent_genome_2, std::vector<slim_position_t> *all_breakpoints, std::vector<SLiMEidosBlock*> *p_mutation_callbacks) const;
 	
 	// draw the number of breakpoints that occur, based on the overall recombination rate
-	int DrawBreakpointCount(IndividualSex p_sex) const;
+	int DrawBreakpointCount(Eidos_RNG_State &p_rng, IndividualSex p_sex) const;
+	inline int DrawBreakpointCount(IndividualSex p_sex) const { return DrawBreakpointCount(gEidos_RNG, p_sex); }
 	
 	// choose a set of recombination breakpoints, based on recomb. intervals, overall recomb. rate, and gene conversion parameters
-	void DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int p_num_breakpoints, std::vector<slim_position_t> &p_crossovers) const;
+	// DrawCrossoverBreakpoints() appends its sorted, uniqued breakpoints to p_crossovers and returns their number, like DrawSortedUniquedMutationPositions()
+	int DrawCrossoverBreakpoints(Eidos_RNG_State &p_rng, IndividualSex p_parent_sex, const int p_num_breakpoints, std::vector<slim_position_t> &p_crossovers) const;
+	inline int DrawCrossoverBreakpoints(IndividualSex p_parent_sex, const int p_num_breakpoints, std::vector<slim_position_t> &p_crossovers) const { return DrawCrossoverBreakpoints(gEidos_RNG, p_parent_sex, p_num_breakpoints, p_crossovers); }
 	void DrawDSBBreakpoints(IndividualSex p_parent_sex, const int p_num_breakpoints, std::vector<slim_position_t> &p_crossovers, std::vector<slim_position_t> &p_heteroduplex) const;
 	
 #ifndef USE_GSL_POISSON
 	// draw both the mutation count and breakpoint count, using a single Poisson draw for speed
-	void DrawMutationAndBreakpointCounts(IndividualSex p_sex, int *p_mut_count, int *p_break_count) const;
+	void DrawMutationAndBreakpointCounts(Eidos_RNG_State &p_rng, IndividualSex p_sex, int *p_mut_count, int *p_break_count) const;
+	inline void DrawMutationAndBreakpointCounts(IndividualSex p_sex, int *p_mut_count, int *p_break_count) const { DrawMutationAndBreakpointCounts(gEidos_RNG, p_sex, p_mut_count, p_break_count); }
 	
 	// initialize the joint probabilities used by DrawMutationAndBreakpointCounts()
 	void _InitializeJointProbabilities(double p_overall_mutation_rate, double p_exp_neg_overall_mutation_rate,
@@ -254,24 +262,24 @@ public:
 };
 
 // draw the number of mutations that occur, based on the overall mutation rate
-inline __attribute__((always_inline)) int Chromosome::DrawMutationCount(IndividualSex p_sex) const
+inline __attribute__((always_inline)) int Chromosome::DrawMutationCount(Eidos_RNG_State &p_rng, IndividualSex p_sex) const
 {
 #ifdef USE_GSL_POISSON
 	if (single_mutation_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		return gsl_ran_poisson(EIDOS_GSL_RNG, overall_mutation_rate_H_);
+		return gsl_ran_poisson(p_rng.gsl_rng_, overall_mutation_rate_H_);
 	}
 	else
 	{
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_sex == IndividualSex::kMale)
 		{
-			return gsl_ran_poisson(EIDOS_GSL_RNG, overall_mutation_rate_M_);
+			return gsl_ran_poisson(p_rng.gsl_rng_, overall_mutation_rate_M_);
 		}
 		else if (p_sex == IndividualSex::kFemale)
 		{
-			return gsl_ran_poisson(EIDOS_GSL_RNG, overall_mutation_rate_F_);
+			return gsl_ran_poisson(p_rng.gsl_rng_, overall_mutation_rate_F_);
 		}
 		else
 		{
@@ -282,18 +290,18 @@ inline __attribute__((always_inline)) int Chromosome::DrawMutationCount(Individu
 	if (single_mutation_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		return Eidos_FastRandomPoisson(overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_);
+		return Eidos_FastRandomPoisson(p_rng, overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_);
 	}
 	else
 	{
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_sex == IndividualSex::kMale)
 		{
-			return Eidos_FastRandomPoisson(overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_);
+			return Eidos_FastRandomPoisson(p_rng, overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_);
 		}
 		else if (p_sex == IndividualSex::kFemale)
 		{
-			return Eidos_FastRandomPoisson(overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_);
+			return Eidos_FastRandomPoisson(p_rng, overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_);
 		}
 		else
 		{
@@ -304,24 +312,24 @@ inline __attribute__((always_inline)) int Chromosome::DrawMutationCount(Individu
 }
 
 // draw the number of breakpoints that occur, based on the overall recombination rate
-inline __attribute__((always_inline)) int Chromosome::DrawBreakpointCount(IndividualSex p_sex) const
+inline __attribute__((always_inline)) int Chromosome::DrawBreakpointCount(Eidos_RNG_State &p_rng, IndividualSex p_sex) const
 {
 #ifdef USE_GSL_POISSON
 	if (single_recombination_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		return gsl_ran_poisson(EIDOS_GSL_RNG, overall_recombination_rate_H_);
+		return gsl_ran_poisson(p_rng.gsl_rng_, overall_recombination_rate_H_);
 	}
 	else
 	{
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_sex == IndividualSex::kMale)
 		{
-			return gsl_ran_poisson(EIDOS_GSL_RNG, overall_recombination_rate_M_);
+			return gsl_ran_poisson(p_rng.gsl_rng_, overall_recombination_rate_M_);
 		}
 		else if (p_sex == IndividualSex::kFemale)
 		{
-			return gsl_ran_poisson(EIDOS_GSL_RNG, overall_recombination_rate_F_);
+			return gsl_ran_poisson(p_rng.gsl_rng_, overall_recombination_rate_F_);
 		}
 		else
 		{
@@ -332,18 +340,18 @@ inline __attribute__((always_inline)) int Chromosome::DrawBreakpointCount(Indivi
 	if (single_recombination_map_)
 	{
 		// With a single map, we don't care what sex we are passed; same map for all, and sex may be enabled or disabled
-		return Eidos_FastRandomPoisson(overall_recombination_rate_H_, exp_neg_overall_recombination_rate_H_);
+		return Eidos_FastRandomPoisson(p_rng, overall_recombination_rate_H_, exp_neg_overall_recombination_rate_H_);
 	}
 	else
 	{
 		// With sex-specific maps, we treat males and females separately, and the individual we're given better be one of the two
 		if (p_sex == IndividualSex::kMale)
 		{
-			return Eidos_FastRandomPoisson(overall_recombination_rate_M_, exp_neg_overall_recombination_rate_M_);
+			return Eidos_FastRandomPoisson(p_rng, overall_recombination_rate_M_, exp_neg_overall_recombination_rate_M_);
 		}
 		else if (p_sex == IndividualSex::kFemale)
 		{
-			return Eidos_FastRandomPoisson(overall_recombination_rate_F_, exp_neg_overall_recombination_rate_F_);
+			return Eidos_FastRandomPoisson(p_rng, overall_recombination_rate_F_, exp_neg_overall_recombination_rate_F_);
 		}
 		else
 		{
@@ -356,9 +364,9 @@ inline __attribute__((always_inline)) int Chromosome::DrawBreakpointCount(Indivi
 #ifndef USE_GSL_POISSON
 // determine both the mutation count and the breakpoint count with (usually) a single RNG draw
 // this method relies on Eidos_FastRandomPoisson_NONZERO() and cannot be called when USE_GSL_POISSON is defined
-inline __attribute__((always_inline)) void Chromosome::DrawMutationAndBreakpointCounts(IndividualSex p_sex, int *p_mut_count, int *p_break_count) const
+inline __attribute__((always_inline)) void Chromosome::DrawMutationAndBreakpointCounts(Eidos_RNG_State &p_rng, IndividualSex p_sex, int *p_mut_count, int *p_break_count) const
 {
-	double u = Eidos_rng_uniform(EIDOS_GSL_RNG);
+	double u = Eidos_rng_uniform(p_rng.gsl_rng_);
 	
 	if (single_recombination_map_ && single_mutation_map_)
 	{
@@ -372,17 +380,17 @@ inline __attribute__((always_inline)) void Chromosome::DrawMutationAndBreakpoint
 		else if (u <= probability_both_0_OR_mut_0_break_non0_H_)
 		{
 			*p_mut_count = 0;
-			*p_break_count = Eidos_FastRandomPoisson_NONZERO(overall_recombination_rate_H_, exp_neg_overall_recombination_rate_H_);
+			*p_break_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_recombination_rate_H_, exp_neg_overall_recombination_rate_H_);
 		}
 		else if (u <= probability_both_0_OR_mut_0_break_non0_OR_mut_non0_break_0_H_)
 		{
-			*p_mut_count = Eidos_FastRandomPoisson_NONZERO(overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_);
+			*p_mut_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_);
 			*p_break_count = 0;
 		}
 		else
 		{
-			*p_mut_count = Eidos_FastRandomPoisson_NONZERO(overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_);
-			*p_break_count = Eidos_FastRandomPoisson_NONZERO(overall_recombination_rate_H_, exp_neg_overall_recombination_rate_H_);
+			*p_mut_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_);
+			*p_break_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_recombination_rate_H_, exp_neg_overall_recombination_rate_H_);
 		}
 	}
 	else
@@ -401,17 +409,17 @@ inline __attribute__((always_inline)) void Chromosome::DrawMutationAndBreakpoint
 			else if (u <= probability_both_0_OR_mut_0_break_non0_M_)
 			{
 				*p_mut_count = 0;
-				*p_break_count = Eidos_FastRandomPoisson_NONZERO(overall_recombination_rate_M_, exp_neg_overall_recombination_rate_M_);
+				*p_break_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_recombination_rate_M_, exp_neg_overall_recombination_rate_M_);
 			}
 			else if (u <= probability_both_0_OR_mut_0_break_non0_OR_mut_non0_break_0_M_)
 			{
-				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_);
+				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_);
 				*p_break_count = 0;
 			}
 			else
 			{
-				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_);
-				*p_break_count = Eidos_FastRandomPoisson_NONZERO(overall_recombination_rate_M_, exp_neg_overall_recombination_rate_M_);
+				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_);
+				*p_break_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_recombination_rate_M_, exp_neg_overall_recombination_rate_M_);
 			}
 		}
 		else if (p_sex == IndividualSex::kFemale)
@@ -424,17 +432,17 @@ inline __attribute__((always_inline)) void Chromosome::DrawMutationAndBreakpoint
 			else if (u <= probability_both_0_OR_mut_0_break_non0_F_)
 			{
 				*p_mut_count = 0;
-				*p_break_count = Eidos_FastRandomPoisson_NONZERO(overall_recombination_rate_F_, exp_neg_overall_recombination_rate_F_);
+				*p_break_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_recombination_rate_F_, exp_neg_overall_recombination_rate_F_);
 			}
 			else if (u <= probability_both_0_OR_mut_0_break_non0_OR_mut_non0_break_0_F_)
 			{
-				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_);
+				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_);
 				*p_break_count = 0;
 			}
 			else
 			{
-				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_);
-				*p_break_count = Eidos_FastRandomPoisson_NONZERO(overall_recombination_rate_F_, exp_neg_overall_recombination_rate_F_);
+				*p_mut_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_);
+				*p_break_count = Eidos_FastRandomPoisson_NONZERO(p_rng, overall_recombination_rate_F_, exp_neg_overall_recombination_rate_F_);
 			}
 		}
 		else
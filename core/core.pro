@@ -82,6 +82,7 @@ else:unix: PRE_TARGETDEPS += $$OUT_PWD/../treerec/tskit/libtskit.a
 SOURCES += \
     chromosome.cpp \
     genome.cpp \
+    genotype_matrix.cpp \
     genomic_element_type.cpp \
     genomic_element.cpp \
     individual.cpp \
@@ -108,6 +109,7 @@ SOURCES += \
 HEADERS += \
     chromosome.h \
     genome.h \
+    genotype_matrix.h \
     genomic_element_type.h \
     genomic_element.h \
     individual.h \
@@ -25,6 +25,7 @@
 #include "slim_sim.h"
 #include "polymorphism.h"
 #include "subpopulation.h"
+#include "genotype_matrix.h"
 
 #include <algorithm>
 #include <string>
@@ -59,10 +60,7 @@ Genome::Genome(Subpopulation *p_subpop, int p_mutrun_count, slim_position_t p_mu
 		mutrun_count_ = p_mutrun_count;
 		mutrun_length_ = p_mutrun_length;
 		
-		if (mutrun_count_ <= SLIM_GENOME_MUTRUN_BUFSIZE)
-			mutruns_ = run_buffer_;
-		else
-			mutruns_ = new MutationRun_SP[mutrun_count_];
+		AllocateMutrunBuffer();
 	}
 }
 
@@ -71,13 +69,26 @@ Genome::~Genome(void)
 	for (int run_index = 0; run_index < mutrun_count_; ++run_index)
 		mutruns_[run_index].reset();
 	
-	if (mutruns_ != run_buffer_)
-		delete[] mutruns_;
-	mutruns_ = nullptr;
+	FreeMutrunBuffer();
 	
 	mutrun_count_ = 0;
 }
 
+void Genome::AllocateMutrunBuffer(void)
+{
+	if (mutrun_count_ <= SLIM_GENOME_MUTRUN_BUFSIZE)
+		mutruns_ = run_buffer_;
+	else
+		mutruns_ = subpop_->AllocateMutrunBuffer(mutrun_count_);
+}
+
+void Genome::FreeMutrunBuffer(void)
+{
+	if (mutruns_ && (mutruns_ != run_buffer_))
+		subpop_->DisposeMutrunBuffer(mutruns_, mutrun_count_);
+	mutruns_ = nullptr;
+}
+
 // prints an error message, a stacktrace, and exits; called only for DEBUG
 void Genome::NullGenomeAccessError(void) const
 {
@@ -93,6 +104,10 @@ void Genome::WillModifyRun(slim_mutrun_index_t p_run_index)
 	
 	MutationRun *original_run = mutruns_[p_run_index].get();
 	
+	// the modification will change mutation tallies, so cached tallies must be discarded
+	if (subpop_)
+		subpop_->population_.InvalidateMutationTallies();
+	
 	if (original_run->UseCount() > 1)
 	{
 		MutationRun *new_run = MutationRun::NewMutationRun();	// take from shared pool of used objects
@@ -283,9 +298,7 @@ void Genome::MakeNull(void)
 		for (int run_index = 0; run_index < mutrun_count_; ++run_index)
 			mutruns_[run_index].reset();
 		
-		if (mutruns_ != run_buffer_)
-			delete[] mutruns_;
-		mutruns_ = nullptr;
+		FreeMutrunBuffer();
 		
 		mutrun_count_ = 0;
 		mutrun_length_ = 0;
@@ -304,10 +317,7 @@ void Genome::ReinitializeGenomeToMutrun(GenomeType p_genome_type, int32_t p_mutr
 			mutrun_count_ = p_mutrun_count;
 			mutrun_length_ = p_mutrun_length;
 			
-			if (mutrun_count_ <= SLIM_GENOME_MUTRUN_BUFSIZE)
-				mutruns_ = run_buffer_;
-			else
-				mutruns_ = new MutationRun_SP[mutrun_count_];
+			AllocateMutrunBuffer();
 		}
 		else if (mutrun_count_ != p_mutrun_count)
 		{
@@ -315,16 +325,12 @@ void Genome::ReinitializeGenomeToMutrun(GenomeType p_genome_type, int32_t p_mutr
 			for (int run_index = 0; run_index < mutrun_count_; ++run_index)
 				mutruns_[run_index].reset();
 			
-			if (mutruns_ != run_buffer_)
-				delete[] mutruns_;
+			FreeMutrunBuffer();
 			
 			mutrun_count_ = p_mutrun_count;
 			mutrun_length_ = p_mutrun_length;
 			
-			if (mutrun_count_ <= SLIM_GENOME_MUTRUN_BUFSIZE)
-				mutruns_ = run_buffer_;
-			else
-				mutruns_ = new MutationRun_SP[mutrun_count_];
+			AllocateMutrunBuffer();
 		}
 		
 		for (int run_index = 0; run_index < mutrun_count_; ++run_index)
@@ -338,9 +344,7 @@ void Genome::ReinitializeGenomeToMutrun(GenomeType p_genome_type, int32_t p_mutr
 			for (int run_index = 0; run_index < mutrun_count_; ++run_index)
 				mutruns_[run_index].reset();
 			
-			if (mutruns_ != run_buffer_)
-				delete[] mutruns_;
-			mutruns_ = nullptr;
+			FreeMutrunBuffer();
 			
 			mutrun_count_ = 0;
 			mutrun_length_ = 0;
@@ -367,24 +371,17 @@ void Genome::ReinitializeGenomeNullptr(GenomeType p_genome_type, int32_t p_mutru
 			mutrun_count_ = p_mutrun_count;
 			mutrun_length_ = p_mutrun_length;
 			
-			if (mutrun_count_ <= SLIM_GENOME_MUTRUN_BUFSIZE)
-				mutruns_ = run_buffer_;
-			else
-				mutruns_ = new MutationRun_SP[mutrun_count_];
+			AllocateMutrunBuffer();
 		}
 		else if (mutrun_count_ != p_mutrun_count)
 		{
 			// the number of mutruns has changed; need to reallocate
-			if (mutruns_ != run_buffer_)
-				delete[] mutruns_;
+			FreeMutrunBuffer();
 			
 			mutrun_count_ = p_mutrun_count;
 			mutrun_length_ = p_mutrun_length;
 			
-			if (mutrun_count_ <= SLIM_GENOME_MUTRUN_BUFSIZE)
-				mutruns_ = run_buffer_;
-			else
-				mutruns_ = new MutationRun_SP[mutrun_count_];
+			AllocateMutrunBuffer();
 		}
 		
 		// we leave the new mutruns_ buffer filled with nullptr
@@ -394,9 +391,7 @@ void Genome::ReinitializeGenomeNullptr(GenomeType p_genome_type, int32_t p_mutru
 		if (mutrun_count_)
 		{
 			// was a non-null genome, needs to become null
-			if (mutruns_ != run_buffer_)
-				delete[] mutruns_;
-			mutruns_ = nullptr;
+			FreeMutrunBuffer();
 			
 			mutrun_count_ = 0;
 			mutrun_length_ = 0;
@@ -1590,6 +1585,18 @@ void Genome::PrintGenomes_VCF(std::ostream &p_out, std::vector<Genome *> &p_geno
 	
 	std::sort(sorted_polymorphisms.begin(), sorted_polymorphisms.end());
 	
+	// Build a compressed genotype matrix for the sample, with a row for each genome and a column for each polymorphism in
+	// sorted_polymorphisms; the calls below look up carriers in it, instead of searching every genome for every polymorphism
+	std::vector<const Mutation *> genotype_columns;
+	
+	genotype_columns.reserve(sorted_polymorphisms.size());
+	
+	for (const Polymorphism &polymorphism : sorted_polymorphisms)
+		genotype_columns.emplace_back(polymorphism.mutation_ptr_);
+	
+	GenotypeMatrix genotypes(p_genomes, genotype_columns);
+	const Polymorphism *polymorphisms_base = sorted_polymorphisms.data();
+	
 	// Print a line for each mutation.  Note that we do NOT treat multiple mutations at the same position at being different alleles,
 	// output on the same line.  This is because a single individual can carry more than one mutation at the same position, so it is
 	// not really a question of different alleles; if there are N mutations at a given position, there are 2^N possible "alleles",
@@ -1738,9 +1745,9 @@ void Genome::PrintGenomes_VCF(std::ostream &p_out, std::vector<Genome *> &p_geno
 								
 								for (int muts_index = 0; muts_index < (int)nuc_based.size(); ++muts_index)
 								{
-									const Mutation *mutation = nuc_based[muts_index]->mutation_ptr_;
+									int32_t column = (int32_t)(nuc_based[muts_index] - polymorphisms_base);
 									
-									if (genome.contains_mutation(mutation->BlockIndex()))
+									if (genotypes.Contains(s * 2 + genome_index, column))
 									{
 										if (contained_mut_index == -1)
 											contained_mut_index = muts_index;
@@ -1880,9 +1887,9 @@ void Genome::PrintGenomes_VCF(std::ostream &p_out, std::vector<Genome *> &p_geno
 							
 							for (int muts_index = 0; muts_index < (int)nuc_based.size(); ++muts_index)
 							{
-								const Mutation *mutation = nuc_based[muts_index]->mutation_ptr_;
+								int32_t column = (int32_t)(nuc_based[muts_index] - polymorphisms_base);
 								
-								if (genome.contains_mutation(mutation->BlockIndex()))
+								if (genotypes.Contains(s * 2 + genome_index, column))
 								{
 									if (contained_mut_index == -1)
 										contained_mut_index = muts_index;
@@ -1914,6 +1921,7 @@ void Genome::PrintGenomes_VCF(std::ostream &p_out, std::vector<Genome *> &p_geno
 			for (Polymorphism *polymorphism : nonnuc_based)
 			{
 				const Mutation *mutation = polymorphism->mutation_ptr_;
+				int32_t column = (int32_t)(polymorphism - polymorphisms_base);
 				
 				// Count the mutations at the given position to determine if we are multiallelic
 				int allele_count = (int)nonnuc_based.size();
@@ -1959,18 +1967,18 @@ void Genome::PrintGenomes_VCF(std::ostream &p_out, std::vector<Genome *> &p_geno
 						else if (g1_null)
 						{
 							// An unpaired X or Y; we emit this as haploid, I think that is the right call...
-							p_out << (g2.contains_mutation(mutation->BlockIndex()) ? "\t1" : "\t0");
+							p_out << (genotypes.Contains(s * 2 + 1, column) ? "\t1" : "\t0");
 						}
 						else if (g2_null)
 						{
 							// An unpaired X or Y; we emit this as haploid, I think that is the right call...
-							p_out << (g1.contains_mutation(mutation->BlockIndex()) ? "\t1" : "\t0");
+							p_out << (genotypes.Contains(s * 2, column) ? "\t1" : "\t0");
 						}
 						else
 						{
 							// Both genomes are non-null; emit an x|y pair that indicates the data is phased
-							bool g1_has_mut = g1.contains_mutation(mutation->BlockIndex());
-							bool g2_has_mut = g2.contains_mutation(mutation->BlockIndex());
+							bool g1_has_mut = genotypes.Contains(s * 2, column);
+							bool g2_has_mut = genotypes.Contains(s * 2 + 1, column);
 							
 							if (g1_has_mut && g2_has_mut)	p_out << "\t1|1";
 							else if (g1_has_mut)			p_out << "\t1|0";
@@ -2315,7 +2323,7 @@ EidosValue_SP Genome_Class::ExecuteMethod_addMutations(EidosGlobalStringID p_met
 		last_handled_mutrun_index = mutrun_index;
 		
 		// invalidate cached mutation refcounts; refcounts have changed
-		pop.cached_tally_genome_count_ = 0;
+		pop.InvalidateMutationTallies();
 	}
 	
 	// TREE SEQUENCE RECORDING
@@ -2758,7 +2766,7 @@ EidosValue_SP Genome_Class::ExecuteMethod_addNewMutation(EidosGlobalStringID p_m
 		MutationRun::FreeMutationRun(&mutations_to_add);
 		
 		// invalidate cached mutation refcounts; refcounts have changed
-		pop.cached_tally_genome_count_ = 0;
+		pop.InvalidateMutationTallies();
 	}
 	
 	return retval;
@@ -3782,7 +3790,7 @@ EidosValue_SP Genome_Class::ExecuteMethod_removeMutations(EidosGlobalStringID p_
 		}
 		
 		// invalidate cached mutation refcounts; refcounts have changed
-		pop.cached_tally_genome_count_ = 0;
+		pop.InvalidateMutationTallies();
 		
 		// in this code path we just assume that nonneutral mutations might have been removed
 		any_nonneutral_removed = true;
@@ -4024,7 +4032,7 @@ EidosValue_SP Genome_Class::ExecuteMethod_removeMutations(EidosGlobalStringID p_
 			last_handled_mutrun_index = mutrun_index;
 			
 			// invalidate cached mutation refcounts; refcounts have changed
-			pop.cached_tally_genome_count_ = 0;
+			pop.InvalidateMutationTallies();
 		}
 		
 		// TREE SEQUENCE RECORDING
@@ -59,6 +59,7 @@ class Population;
 class Subpopulation;
 class Individual;
 class GenomeWalker;
+class GenotypeMatrix;
 
 
 extern EidosClass *gSLiM_Genome_Class;
@@ -150,6 +151,11 @@ public:
 	
 	void MakeNull(void) __attribute__((cold));	// transform into a null genome
 	
+	// Set up mutruns_ for mutrun_count_ runs, all nullptr, using run_buffer_ or a buffer from our subpopulation's slab; and give that
+	// buffer back, leaving mutruns_ nullptr.  FreeMutrunBuffer() requires that the runs have already been cleared to nullptr.
+	void AllocateMutrunBuffer(void);
+	void FreeMutrunBuffer(void);
+	
 	// used to re-initialize Genomes to a new state, reusing them for efficiency
 	void ReinitializeGenomeToMutrun(GenomeType p_genome_type, int32_t p_mutrun_count, slim_position_t p_mutrun_length, MutationRun *p_run);
 	void ReinitializeGenomeNullptr(GenomeType p_genome_type, int32_t p_mutrun_count, slim_position_t p_mutrun_length);
@@ -425,6 +431,7 @@ public:
 	friend Subpopulation;
 	friend Individual;
 	friend GenomeWalker;
+	friend GenotypeMatrix;
 };
 
 class Genome_Class : public EidosClass
@@ -95,12 +95,12 @@ void GenomicElementType::InitializeDraws(void)
 	}
 }
 
-MutationType *GenomicElementType::DrawMutationType(void) const
+MutationType *GenomicElementType::DrawMutationType(Eidos_RNG_State &p_rng) const
 {
 	if (!lookup_mutation_type_)
 		EIDOS_TERMINATION << "ERROR (GenomicElementType::DrawMutationType): empty mutation type vector for genomic element type." << EidosTerminate();
 	
-	return mutation_type_ptrs_[gsl_ran_discrete(EIDOS_GSL_RNG, lookup_mutation_type_)];
+	return mutation_type_ptrs_[gsl_ran_discrete(p_rng.gsl_rng_, lookup_mutation_type_)];
 }
 
 void GenomicElementType::SetNucleotideMutationMatrix(EidosValue_Float_vector_SP p_mutation_matrix)
@@ -81,7 +81,8 @@ public:
 	~GenomicElementType(void);
 	
 	void InitializeDraws(void);									// reinitialize our mutation-type lookup after changing our mutation type or proportions
-	MutationType *DrawMutationType(void) const;					// draw a mutation type from the distribution for this genomic element type
+	MutationType *DrawMutationType(Eidos_RNG_State &p_rng) const;	// draw a mutation type from the distribution for this genomic element type
+	inline MutationType *DrawMutationType(void) const { return DrawMutationType(gEidos_RNG); }
 	
 	void SetNucleotideMutationMatrix(EidosValue_Float_vector_SP p_mutation_matrix);
 	
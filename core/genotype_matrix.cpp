@@ -0,0 +1,168 @@
+//
+//  genotype_matrix.cpp
+//  SLiM
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of SLiM.
+//
+//	SLiM is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	SLiM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with SLiM.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "genotype_matrix.h"
+#include "genome.h"
+
+#include <algorithm>
+#include <utility>
+
+
+GenotypeMatrix::GenotypeMatrix(const std::vector<Genome *> &p_genomes, const std::vector<const Mutation *> &p_columns) :
+	row_count_((int32_t)p_genomes.size()), column_count_((int32_t)p_columns.size()), columns_(p_columns)
+{
+	// Map each column's mutation, by its index in the mutation block, to its column; other mutations map to -1
+	MutationIndex max_index = -1;
+	
+	for (const Mutation *mutation : p_columns)
+		max_index = std::max(max_index, mutation->BlockIndex());
+	
+	std::vector<int32_t> column_for_index(max_index + 1, -1);
+	
+	for (int32_t column = 0; column < column_count_; ++column)
+		column_for_index[p_columns[column]->BlockIndex()] = column;
+	
+	// Work through the rows one block at a time, gathering the carriers in the block as (column, row offset) pairs; sorting
+	// those groups them into the column's block, with the row offsets in order.  Each non-empty block's data is appended to
+	// the appropriate buffer as we go, and the blocks are then distributed to their columns, preserving their row order.
+	std::vector<std::pair<int32_t, uint8_t>> carriers;
+	std::vector<std::pair<int32_t, GenotypeBlock>> column_blocks;
+	uint32_t row_block_count = (uint32_t)((row_count_ + SLIM_GENOTYPE_BLOCK_ROWS - 1) / SLIM_GENOTYPE_BLOCK_ROWS);
+	
+	for (uint32_t row_block = 0; row_block < row_block_count; ++row_block)
+	{
+		int32_t row_start = (int32_t)(row_block * SLIM_GENOTYPE_BLOCK_ROWS);
+		int32_t row_end = std::min(row_start + SLIM_GENOTYPE_BLOCK_ROWS, row_count_);
+		
+		carriers.clear();
+		
+		for (int32_t row = row_start; row < row_end; ++row)
+		{
+			Genome *genome = p_genomes[row];
+			uint8_t row_offset = (uint8_t)(row - row_start);
+			
+			for (int run_index = 0; run_index < genome->mutrun_count_; ++run_index)
+			{
+				const MutationRun *mutrun = genome->mutruns_[run_index].get();
+				const MutationIndex *mut_ptr = mutrun->begin_pointer_const();
+				const MutationIndex *mut_end_ptr = mutrun->end_pointer_const();
+				
+				for ( ; mut_ptr != mut_end_ptr; ++mut_ptr)
+				{
+					MutationIndex mut_index = *mut_ptr;
+					
+					if (mut_index <= max_index)
+					{
+						int32_t column = column_for_index[mut_index];
+						
+						if (column >= 0)
+							carriers.emplace_back(column, row_offset);
+					}
+				}
+			}
+		}
+		
+		std::sort(carriers.begin(), carriers.end());
+		
+		for (auto carrier_iter = carriers.begin(); carrier_iter != carriers.end(); )
+		{
+			int32_t column = carrier_iter->first;
+			auto group_end = carrier_iter;
+			
+			while ((group_end != carriers.end()) && (group_end->first == column))
+				++group_end;
+			
+			GenotypeBlock block;
+			
+			block.block_ = row_block;
+			block.count_ = (uint32_t)(group_end - carrier_iter);
+			
+			if (block.count_ > SLIM_GENOTYPE_SPARSE_MAX)
+			{
+				block.offset_ = (uint32_t)dense_words_.size();
+				dense_words_.resize(dense_words_.size() + SLIM_GENOTYPE_BLOCK_WORDS, 0);
+				
+				uint64_t *words = dense_words_.data() + block.offset_;
+				
+				for ( ; carrier_iter != group_end; ++carrier_iter)
+					words[carrier_iter->second >> 6] |= ((uint64_t)1 << (carrier_iter->second & 63));
+			}
+			else
+			{
+				block.offset_ = (uint32_t)sparse_rows_.size();
+				
+				for ( ; carrier_iter != group_end; ++carrier_iter)
+					sparse_rows_.emplace_back(carrier_iter->second);
+			}
+			
+			column_blocks.emplace_back(column, block);
+		}
+	}
+	
+	// Distribute the blocks to their columns with a counting sort, which keeps each column's blocks in row order
+	column_starts_.resize(column_count_ + 1, 0);
+	
+	for (auto &column_block : column_blocks)
+		column_starts_[column_block.first + 1]++;
+	
+	for (int32_t column = 0; column < column_count_; ++column)
+		column_starts_[column + 1] += column_starts_[column];
+	
+	std::vector<uint32_t> column_fill(column_starts_.begin(), column_starts_.end() - 1);
+	
+	blocks_.resize(column_blocks.size());
+	
+	for (auto &column_block : column_blocks)
+		blocks_[column_fill[column_block.first]++] = column_block.second;
+}
+
+const GenotypeMatrix::GenotypeBlock *GenotypeMatrix::FindBlock(int32_t p_column, uint32_t p_block) const
+{
+	const GenotypeBlock *blocks_begin = blocks_.data() + column_starts_[p_column];
+	const GenotypeBlock *blocks_end = blocks_.data() + column_starts_[p_column + 1];
+	const GenotypeBlock *found = std::lower_bound(blocks_begin, blocks_end, p_block, [](const GenotypeBlock &block, uint32_t block_index) { return block.block_ < block_index; });
+	
+	if ((found != blocks_end) && (found->block_ == p_block))
+		return found;
+	
+	return nullptr;
+}
+
+bool GenotypeMatrix::Contains(int32_t p_row, int32_t p_column) const
+{
+	const GenotypeBlock *block = FindBlock(p_column, (uint32_t)p_row / SLIM_GENOTYPE_BLOCK_ROWS);
+	
+	if (!block)
+		return false;
+	
+	uint32_t row_offset = (uint32_t)p_row % SLIM_GENOTYPE_BLOCK_ROWS;
+	
+	if (block->count_ > SLIM_GENOTYPE_SPARSE_MAX)
+		return (dense_words_[block->offset_ + (row_offset >> 6)] >> (row_offset & 63)) & 1;
+	
+	const uint8_t *rows = sparse_rows_.data() + block->offset_;
+	
+	for (uint32_t index = 0; index < block->count_; ++index)
+	{
+		if (rows[index] >= row_offset)
+			return (rows[index] == row_offset);
+	}
+	
+	return false;
+}
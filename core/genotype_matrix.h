@@ -0,0 +1,103 @@
+//
+//  genotype_matrix.h
+//  SLiM
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of SLiM.
+//
+//	SLiM is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	SLiM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with SLiM.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+
+ The class GenotypeMatrix is a compressed, read-only snapshot of which genomes carry which mutations.  Rows are genomes and columns
+ are mutations, both in an order chosen by the client; typically the columns are the polymorphisms of a sample, sorted by position.
+ Genomes store their mutations as runs of mutation indices, which is efficient for the simulation itself, but asking "does genome g
+ carry mutation m" of them costs a search of a mutation run, and output code that makes a call for every genome at every segregating
+ site asks that question P x N times.  The matrix answers it in constant time, from a small amount of memory.
+
+ Storage is column-major.  Each column is divided into blocks of SLIM_GENOTYPE_BLOCK_ROWS rows, and only blocks containing at least
+ one carrier are stored.  A block with few carriers is kept sparse, as a sorted list of 8-bit row offsets within the block; a block
+ with more is kept dense, as a bitset.  Rare mutations, which are the large majority in most models, therefore cost a few bytes each,
+ while common mutations cost SLIM_GENOTYPE_BLOCK_ROWS bits per block.
+
+ The matrix does not retain the genomes it was built from, and it does not track changes to them; it should be built, used, and
+ discarded while the genomes are unchanged.  It is a copy made for output, not a storage mode for genomes, which keep their mutation
+ runs; while it exists it adds to memory usage rather than reducing it.  At present it is used only by Genome::PrintGenomes_VCF().
+
+ */
+
+#ifndef __SLiM__genotype_matrix__
+#define __SLiM__genotype_matrix__
+
+
+#include "slim_globals.h"
+#include "mutation.h"
+
+#include <vector>
+
+
+class Genome;
+
+
+// The number of rows in one block of a column; this must be 256 so that row offsets within a block fit in a uint8_t
+#define SLIM_GENOTYPE_BLOCK_ROWS		256
+#define SLIM_GENOTYPE_BLOCK_WORDS		(SLIM_GENOTYPE_BLOCK_ROWS / 64)
+
+// Blocks with more carriers than this are stored dense; at 32 carriers, a sparse block and a dense block are the same size
+#define SLIM_GENOTYPE_SPARSE_MAX		(SLIM_GENOTYPE_BLOCK_WORDS * 8)
+
+
+class GenotypeMatrix
+{
+	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
+
+private:
+	
+	typedef struct {
+		uint32_t block_;		// the index of the row block; the block covers rows [block_ * SLIM_GENOTYPE_BLOCK_ROWS, (block_ + 1) * SLIM_GENOTYPE_BLOCK_ROWS)
+		uint32_t offset_;		// the index of the block's data in dense_words_ (if dense) or sparse_rows_ (if sparse)
+		uint32_t count_;		// the number of carriers in the block; the block is dense if count_ > SLIM_GENOTYPE_SPARSE_MAX
+	} GenotypeBlock;
+	
+	int32_t row_count_ = 0;
+	int32_t column_count_ = 0;
+	
+	std::vector<const Mutation *> columns_;		// the mutation for each column
+	std::vector<uint32_t> column_starts_;		// column_count_ + 1 entries; the blocks of column c are blocks_[column_starts_[c]] .. blocks_[column_starts_[c + 1] - 1]
+	std::vector<GenotypeBlock> blocks_;			// the non-empty blocks of all columns, by column and then in ascending row order
+	std::vector<uint64_t> dense_words_;			// SLIM_GENOTYPE_BLOCK_WORDS words for each dense block
+	std::vector<uint8_t> sparse_rows_;			// count_ sorted row offsets for each sparse block
+	
+	const GenotypeBlock *FindBlock(int32_t p_column, uint32_t p_block) const;
+
+public:
+	
+	GenotypeMatrix(const GenotypeMatrix&) = delete;					// no copying
+	GenotypeMatrix& operator=(const GenotypeMatrix&) = delete;		// no copying
+	GenotypeMatrix(void) = delete;									// no default constructor
+	
+	// Build a matrix with a row for each genome in p_genomes and a column for each mutation in p_columns; null genomes
+	// yield empty rows, and mutations carried by a genome that are not in p_columns are ignored.  p_columns must not
+	// contain duplicates.
+	GenotypeMatrix(const std::vector<Genome *> &p_genomes, const std::vector<const Mutation *> &p_columns);
+	~GenotypeMatrix(void) { }
+	
+	inline __attribute__((always_inline)) int32_t RowCount(void) const { return row_count_; }
+	inline __attribute__((always_inline)) int32_t ColumnCount(void) const { return column_count_; }
+	inline __attribute__((always_inline)) const Mutation *ColumnMutation(int32_t p_column) const { return columns_[p_column]; }
+	
+	// Returns true if the genome for row p_row carries the mutation for column p_column
+	bool Contains(int32_t p_row, int32_t p_column) const;
+};
+
+
+#endif /* __SLiM__genotype_matrix__ */
@@ -264,7 +264,7 @@ EidosValue_SP Individual::GetProperty(EidosGlobalStringID p_property_id)
 			
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(reproductive_output_));
 		}
-		case gID_spatialPosition:
+		case gID_spatialPosition:				// ACCELERATED
 		{
 			SLiMSim &sim = subpopulation_.population_.sim_;
 			
@@ -664,6 +664,49 @@ EidosValue *Individual::GetProperty_Accelerated_z(EidosObject **p_values, size_t
 	return float_result;
 }
 
+EidosValue *Individual::GetProperty_Accelerated_spatialPosition(EidosObject **p_values, size_t p_values_size)
+{
+	// The result interleaves the coordinates of each individual, as concatenating the singleton results would; each
+	// dimensionality gets its own loop so that the gather is a simple strided copy
+	SLiMSim &sim = ((Individual *)(p_values[0]))->subpopulation_.population_.sim_;
+	int dimensionality = sim.SpatialDimensionality();
+	
+	if (dimensionality == 0)
+		EIDOS_TERMINATION << "ERROR (Individual::GetProperty): position cannot be accessed in non-spatial simulations." << EidosTerminate();
+	
+	EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(p_values_size * dimensionality);
+	double *result_data = float_result->data();
+	
+	if (dimensionality == 1)
+	{
+		for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+			*(result_data++) = ((Individual *)(p_values[value_index]))->spatial_x_;
+	}
+	else if (dimensionality == 2)
+	{
+		for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+		{
+			Individual *value = (Individual *)(p_values[value_index]);
+			
+			*(result_data++) = value->spatial_x_;
+			*(result_data++) = value->spatial_y_;
+		}
+	}
+	else
+	{
+		for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+		{
+			Individual *value = (Individual *)(p_values[value_index]);
+			
+			*(result_data++) = value->spatial_x_;
+			*(result_data++) = value->spatial_y_;
+			*(result_data++) = value->spatial_z_;
+		}
+	}
+	
+	return float_result;
+}
+
 EidosValue *Individual::GetProperty_Accelerated_subpopulation(EidosObject **p_values, size_t p_values_size)
 {
 	EidosValue_Object_vector *object_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Subpopulation_Class))->resize_no_initialize(p_values_size);
@@ -1447,7 +1490,7 @@ const std::vector<EidosPropertySignature_CSP> *Individual_Class::Properties(void
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeParentIDs,		true,	kEidosValueMaskInt)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeGrandparentIDs,	true,	kEidosValueMaskInt)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_reproductiveOutput,		true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_reproductiveOutput));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_spatialPosition,		true,	kEidosValueMaskFloat)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_spatialPosition,		true,	kEidosValueMaskFloat))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_spatialPosition));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_uniqueMutations,		true,	kEidosValueMaskObject, gSLiM_Mutation_Class)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gEidosStr_color,				false,	kEidosValueMaskString | kEidosValueMaskSingleton))->DeclareAcceleratedSet(Individual::SetProperty_Accelerated_color));
 		
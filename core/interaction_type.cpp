@@ -28,6 +28,20 @@
 #include <utility>
 #include <algorithm>
 #include <cmath>
+#include <exception>
+#include <cstring>
+#include <limits>
+
+// Vectorized kernels for distances and interaction strengths are used when the compiler targets AVX or SSE2 (SSE2 is always available
+// on x86-64); otherwise the scalar loops below do all of the work.  Either way the results are identical, since the vector code does
+// the same floating-point operations, in the same order, as the scalar code.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SLIM_SIMD_AVX	1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SLIM_SIMD_SSE2	1
+#endif
 
 
 // stream output for enumerations
@@ -46,6 +60,177 @@ std::ostream& operator<<(std::ostream& p_out, IFType p_if_type)
 }
 
 
+#pragma mark -
+#pragma mark SIMD kernels
+#pragma mark -
+
+// Accumulate the squared distance along one dimension between p_focal and p_count coordinates, into p_dist_sq; if p_first is true,
+// p_dist_sq is overwritten rather than added to.  A periodic dimension (p_period != 0) uses the shorter way around, as in
+// CalculateDistanceWithPeriodicity(); taking the smaller and larger of the two coordinates avoids a branch, with the same result.
+static inline void accumulate_dim_dist_sq(const double *p_coords, uint32_t p_count, double p_focal, double p_period, double *p_dist_sq, bool p_first)
+{
+	uint32_t i = 0;
+	
+#if defined(SLIM_SIMD_AVX)
+	__m256d focal = _mm256_set1_pd(p_focal);
+	__m256d period = _mm256_set1_pd(p_period);
+	
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m256d x = _mm256_loadu_pd(p_coords + i);
+		__m256d t;
+		
+		if (p_period != 0.0)
+		{
+			__m256d lo = _mm256_min_pd(x, focal);
+			__m256d hi = _mm256_max_pd(x, focal);
+			
+			t = _mm256_min_pd(_mm256_sub_pd(hi, lo), _mm256_sub_pd(_mm256_add_pd(lo, period), hi));
+		}
+		else
+		{
+			t = _mm256_sub_pd(x, focal);
+		}
+		
+		t = _mm256_mul_pd(t, t);
+		
+		if (!p_first)
+			t = _mm256_add_pd(_mm256_loadu_pd(p_dist_sq + i), t);
+		
+		_mm256_storeu_pd(p_dist_sq + i, t);
+	}
+#elif defined(SLIM_SIMD_SSE2)
+	__m128d focal = _mm_set1_pd(p_focal);
+	__m128d period = _mm_set1_pd(p_period);
+	
+	for (; i + 2 <= p_count; i += 2)
+	{
+		__m128d x = _mm_loadu_pd(p_coords + i);
+		__m128d t;
+		
+		if (p_period != 0.0)
+		{
+			__m128d lo = _mm_min_pd(x, focal);
+			__m128d hi = _mm_max_pd(x, focal);
+			
+			t = _mm_min_pd(_mm_sub_pd(hi, lo), _mm_sub_pd(_mm_add_pd(lo, period), hi));
+		}
+		else
+		{
+			t = _mm_sub_pd(x, focal);
+		}
+		
+		t = _mm_mul_pd(t, t);
+		
+		if (!p_first)
+			t = _mm_add_pd(_mm_loadu_pd(p_dist_sq + i), t);
+		
+		_mm_storeu_pd(p_dist_sq + i, t);
+	}
+#endif
+	
+	for (; i < p_count; ++i)
+	{
+		double x = p_coords[i], t;
+		
+		if (p_period != 0.0)
+		{
+			double lo = std::min(x, p_focal), hi = std::max(x, p_focal);
+			
+			t = std::min(hi - lo, (lo + p_period) - hi);
+		}
+		else
+		{
+			t = x - p_focal;
+		}
+		
+		p_dist_sq[i] = p_first ? t * t : p_dist_sq[i] + t * t;
+	}
+}
+
+// Calculate the squared distances from p_point to p_count points whose coordinates are in structure-of-arrays form, with the
+// coordinates for each dimension p_stride apart; this is the layout of the uniform grid's grid_coords_
+static inline void grid_squared_distances(const double *p_coords, int p_stride, uint32_t p_count, const double *p_point, const double *p_period, int p_spatiality, double *p_dist_sq)
+{
+	for (int dim = 0; dim < p_spatiality; ++dim)
+		accumulate_dim_dist_sq(p_coords + (size_t)dim * p_stride, p_count, p_point[dim], p_period[dim], p_dist_sq, (dim == 0));
+}
+
+// Linear interaction strengths for a row of distances: fmax * (1 − d/dmax)
+static inline void strengths_linear(const sa_distance_t *p_distances, sa_strength_t *p_strengths, uint32_t p_count, double p_fmax, double p_max_distance)
+{
+	uint32_t i = 0;
+	
+#if defined(SLIM_SIMD_AVX)
+	__m256d fmax = _mm256_set1_pd(p_fmax);
+	__m256d dmax = _mm256_set1_pd(p_max_distance);
+	__m256d one = _mm256_set1_pd(1.0);
+	
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m256d d = _mm256_cvtps_pd(_mm_loadu_ps(p_distances + i));
+		__m256d strength = _mm256_mul_pd(fmax, _mm256_sub_pd(one, _mm256_div_pd(d, dmax)));
+		
+		_mm_storeu_ps(p_strengths + i, _mm256_cvtpd_ps(strength));
+	}
+#elif defined(SLIM_SIMD_SSE2)
+	__m128d fmax = _mm_set1_pd(p_fmax);
+	__m128d dmax = _mm_set1_pd(p_max_distance);
+	__m128d one = _mm_set1_pd(1.0);
+	
+	for (; i + 2 <= p_count; i += 2)
+	{
+		__m128d d = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)(p_distances + i))));
+		__m128d strength = _mm_mul_pd(fmax, _mm_sub_pd(one, _mm_div_pd(d, dmax)));
+		
+		_mm_storel_epi64((__m128i *)(p_strengths + i), _mm_castps_si128(_mm_cvtpd_ps(strength)));
+	}
+#endif
+	
+	for (; i < p_count; ++i)
+		p_strengths[i] = (sa_strength_t)(p_fmax * (1.0 - p_distances[i] / p_max_distance));
+}
+
+// Cauchy interaction strengths for a row of distances: fmax / (1+(d/λ)^2)
+static inline void strengths_cauchy(const sa_distance_t *p_distances, sa_strength_t *p_strengths, uint32_t p_count, double p_fmax, double p_lambda)
+{
+	uint32_t i = 0;
+	
+#if defined(SLIM_SIMD_AVX)
+	__m256d fmax = _mm256_set1_pd(p_fmax);
+	__m256d lambda = _mm256_set1_pd(p_lambda);
+	__m256d one = _mm256_set1_pd(1.0);
+	
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m256d temp = _mm256_div_pd(_mm256_cvtps_pd(_mm_loadu_ps(p_distances + i)), lambda);
+		__m256d strength = _mm256_div_pd(fmax, _mm256_add_pd(one, _mm256_mul_pd(temp, temp)));
+		
+		_mm_storeu_ps(p_strengths + i, _mm256_cvtpd_ps(strength));
+	}
+#elif defined(SLIM_SIMD_SSE2)
+	__m128d fmax = _mm_set1_pd(p_fmax);
+	__m128d lambda = _mm_set1_pd(p_lambda);
+	__m128d one = _mm_set1_pd(1.0);
+	
+	for (; i + 2 <= p_count; i += 2)
+	{
+		__m128d temp = _mm_div_pd(_mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)(p_distances + i)))), lambda);
+		__m128d strength = _mm_div_pd(fmax, _mm_add_pd(one, _mm_mul_pd(temp, temp)));
+		
+		_mm_storel_epi64((__m128i *)(p_strengths + i), _mm_castps_si128(_mm_cvtpd_ps(strength)));
+	}
+#endif
+	
+	for (; i < p_count; ++i)
+	{
+		double temp = p_distances[i] / p_lambda;
+		
+		p_strengths[i] = (sa_strength_t)(p_fmax / (1.0 + temp * temp));
+	}
+}
+
+
 #pragma mark -
 #pragma mark InteractionType
 #pragma mark -
@@ -73,7 +258,20 @@ InteractionType::~InteractionType(void)
 {
 }
 
-void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_immediate)
+// free the k-d tree retained from a previous incremental evaluation, if any; see RepairKDTree()
+static void free_retained_kd_tree(InteractionsData &p_subpop_data)
+{
+	if (p_subpop_data.kd_retained_nodes_)
+	{
+		free(p_subpop_data.kd_retained_nodes_);
+		p_subpop_data.kd_retained_nodes_ = nullptr;
+	}
+	
+	p_subpop_data.kd_retained_root_ = nullptr;
+	p_subpop_data.kd_retained_individuals_.clear();
+}
+
+void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_immediate, bool p_incremental)
 {
 	SLiMSim &sim = p_subpop->population_.sim_;
 	slim_objectid_t subpop_id = p_subpop->subpopulation_id_;
@@ -110,14 +308,18 @@ void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_imme
 			subpop_data->positions_ = nullptr;
 		}
 		
-		if (subpop_data->kd_nodes_)
+		RetireKDTree(*subpop_data);
+		
+		if (subpop_data->grid_indices_)
 		{
-			free(subpop_data->kd_nodes_);
-			subpop_data->kd_nodes_ = nullptr;
+			free(subpop_data->grid_indices_);
+			free(subpop_data->grid_coords_);
+			free(subpop_data->grid_cell_starts_);
+			subpop_data->grid_indices_ = nullptr;
+			subpop_data->grid_coords_ = nullptr;
+			subpop_data->grid_cell_starts_ = nullptr;
 		}
 		
-		subpop_data->kd_root_ = nullptr;
-		
 		subpop_data->evaluation_interaction_callbacks_.clear();
 	}
 	
@@ -127,6 +329,19 @@ void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_imme
 	subpop_data->distances_calculated_ = false;
 	subpop_data->strengths_calculated_ = false;
 	
+	// With incremental evaluation, remember which individuals were evaluated, so that the k-d tree can be repaired next time
+	subpop_data->kd_incremental_ = p_incremental;
+	
+	if (p_incremental)
+	{
+		subpop_data->kd_individuals_.assign(subpop_individuals, subpop_individuals + subpop_size);
+	}
+	else
+	{
+		free_retained_kd_tree(*subpop_data);
+		subpop_data->kd_individuals_.clear();
+	}
+	
 	// At a minimum, fetch positional data from the subpopulation; this is guaranteed to be present (for spatiality > 0)
 	if (spatiality_ > 0)
 	{
@@ -454,7 +669,9 @@ void InteractionType::Invalidate(void)
 	// Called by SLiM when the old generation goes away; should invalidate all evaluation.  We avoid actually freeing the
 	// big blocks if possible, though, since that can incur large overhead from madvise() – see header comments.  We do free
 	// the positional data and the k-d tree, though, in an attempt to make fatal errors occur if somebody doesn't manage
-	// the buffers and evaluated state correctly.  They should be smaller, and thus not trigger madvise(), anyway.
+	// the buffers and evaluated state correctly.  They should be smaller, and thus not trigger madvise(), anyway.  The same
+	// goes for the uniform grid, when it is used instead of the k-d tree.  With incremental evaluation the k-d tree is
+	// retained instead, for repair by the next evaluation, but it is no longer used for queries.
 	for (auto &data_iter : data_)
 	{
 		InteractionsData &data = data_iter.second;
@@ -471,14 +688,18 @@ void InteractionType::Invalidate(void)
 		if (data.dist_str_)
 			data.dist_str_->Reset();
 		
-		if (data.kd_nodes_)
+		RetireKDTree(data);
+		
+		if (data.grid_indices_)
 		{
-			free(data.kd_nodes_);
-			data.kd_nodes_ = nullptr;
+			free(data.grid_indices_);
+			free(data.grid_coords_);
+			free(data.grid_cell_starts_);
+			data.grid_indices_ = nullptr;
+			data.grid_coords_ = nullptr;
+			data.grid_cell_starts_ = nullptr;
 		}
 		
-		data.kd_root_ = nullptr;
-		
 		data.evaluation_interaction_callbacks_.clear();
 	}
 }
@@ -495,9 +716,9 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 		
 		if (spatiality_ > 0)
 		{
-			// Here we use the k-d tree to find all interacting pairs, and calculate their distances.
+			// Here we use the k-d tree (or the grid) to find all interacting pairs, and calculate their distances.
 			// This does not use reciprocality at all, but I don't think there's a good way to do so, so that's OK.
-			EnsureKDTreePresent(subpop_data);
+			EnsureSpatialIndexPresent(subpop_data);
 			
 			slim_popsize_t subpop_size = p_subpop->parent_subpop_size_;
 			
@@ -506,8 +727,8 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 			else
 				subpop_data.dist_str_ = new SparseArray(subpop_size, subpop_size);
 			
-			double *position_data = subpop_data.positions_;
-			int start_row = 0, after_end_row = subpop_size, row;
+			int start_row = 0, after_end_row = subpop_size;
+			int start_exerter = 0, after_end_exerter = subpop_size;
 			
 			if (receiver_sex_ == IndividualSex::kUnspecified)
 				;
@@ -519,51 +740,51 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 				EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for receiver_sex_." << EidosTerminate();
 			
 			if (exerter_sex_ == IndividualSex::kUnspecified)
-			{
-				// Without a specified exerter sex, we can add each exerter with no sex test
-				switch (spatiality_)
-				{
-					case 1:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_1(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_);
-						break;
-					case 2:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_2(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, 0);
-						break;
-					case 3:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_3(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, 0);
-						break;
-				}
-			}
+				;
+			else if (exerter_sex_ == IndividualSex::kMale)
+				start_exerter = subpop_data.first_male_index_;
+			else if (exerter_sex_ == IndividualSex::kFemale)
+				after_end_exerter = subpop_data.first_male_index_;
 			else
+				EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for exerter_sex_." << EidosTerminate();
+			
+			if ((gEidosMaxThreads > 1) && (after_end_row - start_row >= SLIM_INTERACTION_PARALLEL_MIN_SIZE))
 			{
-				// With a specified exerter sex, we use a special version of BuildSA_X() that tests for that by range
-				int start_exerter = 0, after_end_exerter = subpop_size;
+				// With multiple threads (slim -threads), the receivers are divided into chunks of rows, each of which is built into
+				// its own chunk of the sparse array on one thread; Finished() then merges the chunks, in order.  Each row's entries
+				// are found by the same k-d tree traversal either way, so the sparse array is the same as when built serially.
+				int chunk_count = (after_end_row - start_row + SLIM_INTERACTION_PARALLEL_CHUNK_SIZE - 1) / SLIM_INTERACTION_PARALLEL_CHUNK_SIZE;
+				std::vector<SparseArray *> chunks(chunk_count);
+				std::vector<std::exception_ptr> chunk_exceptions(chunk_count);
 				
-				if (exerter_sex_ == IndividualSex::kMale)
-					start_exerter = subpop_data.first_male_index_;
-				else if (exerter_sex_ == IndividualSex::kFemale)
-					after_end_exerter = subpop_data.first_male_index_;
-				else
-					EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for exerter_sex_." << EidosTerminate();
+				for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+				{
+					int chunk_start = start_row + chunk_index * SLIM_INTERACTION_PARALLEL_CHUNK_SIZE;
+					int chunk_end = std::min(chunk_start + SLIM_INTERACTION_PARALLEL_CHUNK_SIZE, after_end_row);
+					
+					chunks[chunk_index] = subpop_data.dist_str_->ChunkForRows(chunk_start, chunk_end);
+				}
 				
-				switch (spatiality_)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(std::min(gEidosMaxThreads, chunk_count))
+				for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
 				{
-					case 1:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_1(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter);
-						break;
-					case 2:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_2(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter, 0);
-						break;
-					case 3:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_3(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter, 0);
-						break;
+					int chunk_start = start_row + chunk_index * SLIM_INTERACTION_PARALLEL_CHUNK_SIZE;
+					int chunk_end = std::min(chunk_start + SLIM_INTERACTION_PARALLEL_CHUNK_SIZE, after_end_row);
+					
+					try {
+						BuildSARows(subpop_data, chunks[chunk_index], chunk_start, chunk_end, start_exerter, after_end_exerter);
+					} catch (...) {
+						chunk_exceptions[chunk_index] = std::current_exception();
+					}
 				}
+				
+				for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+					if (chunk_exceptions[chunk_index])
+						std::rethrow_exception(chunk_exceptions[chunk_index]);
+			}
+			else
+			{
+				BuildSARows(subpop_data, subpop_data.dist_str_, start_row, after_end_row, start_exerter, after_end_exerter);
 			}
 			
 			subpop_data.dist_str_->Finished();
@@ -602,6 +823,10 @@ void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 			{
 				// No callbacks; strength calculations come from the interaction function only
 				// We do not use reciprocity here, as searching for the mirrored entry would probably take longer than just calculating twice
+				// Each row is independent, so with multiple threads (slim -threads) the rows are simply divided among the threads
+				bool parallel_strengths = (gEidosMaxThreads > 1) && (subpop_size >= SLIM_INTERACTION_PARALLEL_MIN_SIZE);
+				
+#pragma omp parallel for schedule(dynamic, SLIM_INTERACTION_PARALLEL_CHUNK_SIZE) num_threads(gEidosMaxThreads) if(parallel_strengths)
 				for (uint32_t row = 0; row < (uint32_t)subpop_size; ++row)
 				{
 					uint32_t row_nnz, *row_columns;
@@ -611,6 +836,8 @@ void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 					dist_str.InteractionsForRow(row, &row_nnz, &row_columns, &row_distances, &row_strengths);
 					
 					// CalculateStrengthNoCallbacks() is basically inlined here, moved outside the loop; see that function for comments
+					// The linear and Cauchy kernels are vectorized; the exponential and normal kernels are dominated by exp(), which we
+					// call from the scalar loop so that strengths do not depend upon the vector math library in use
 					switch (if_type_)
 					{
 						case IFType::kFixed:
@@ -621,12 +848,7 @@ void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 						}
 						case IFType::kLinear:
 						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								
-								row_strengths[col_iter] = (sa_strength_t)(if_param1_ * (1.0 - distance / max_distance_));
-							}
+							strengths_linear(row_distances, row_strengths, row_nnz, if_param1_, max_distance_);
 							break;
 						}
 						case IFType::kExponential:
@@ -651,13 +873,7 @@ void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 						}
 						case IFType::kCauchy:
 						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								double temp = distance / if_param2_;
-								
-								row_strengths[col_iter] = (sa_strength_t)(if_param1_ / (1.0 + temp * temp));
-							}
+							strengths_cauchy(row_distances, row_strengths, row_nnz, if_param1_, if_param2_);
 							break;
 						}
 						default:
@@ -945,7 +1161,7 @@ double InteractionType::CalculateStrengthNoCallbacks(double p_distance)
 	// logic in CalculateAllDistances().  (If CalculateAllDistances() is not involved, then
 	// ruling out the self-interaction case is indeed the caller's responsibility.)
 	
-	// MAINTAIN IN PARALLEL: InteractionType::CalculateAllStrengths()
+	// MAINTAIN IN PARALLEL: InteractionType::CalculateAllStrengths(), strengths_linear(), strengths_cauchy()
 	switch (if_type_)
 	{
 		case IFType::kFixed:
@@ -982,7 +1198,7 @@ double InteractionType::CalculateStrengthWithCallbacks(double p_distance, Indivi
 
 double InteractionType::ApplyInteractionCallbacks(Individual *p_receiver, Individual *p_exerter, Subpopulation *p_subpop, double p_strength, double p_distance, std::vector<SLiMEidosBlock*> &p_interaction_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -1052,20 +1268,33 @@ double InteractionType::ApplyInteractionCallbacks(Individual *p_receiver, Indivi
 					
 					try
 					{
-						// Interpret the script; the result from the interpretation must be a singleton double used as a new fitness value
-						EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(interaction_callback->script_);
-						EidosValue *result = result_SP.get();
-						
-						if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
-							EIDOS_TERMINATION << "ERROR (InteractionType::ApplyInteractionCallbacks): interaction() callbacks must provide a float singleton return value." << EidosTerminate(interaction_callback->identifier_token_);
+						// Run the compiled callback if there is one; if it cannot handle this call, or its result is illegal, the
+						// interpreter runs the callback instead, and raises any errors
+						EidosBytecode *bytecode = interaction_callback->bytecode_;
+						EidosBytecodeSlot bytecode_result;
 						
-						p_strength = result->FloatAtIndex(0, nullptr);
-						
-						if (std::isnan(p_strength) || std::isinf(p_strength) || (p_strength < 0.0))
-							EIDOS_TERMINATION << "ERROR (InteractionType::ApplyInteractionCallbacks): interaction() callbacks must return a finite value >= 0.0." << EidosTerminate(interaction_callback->identifier_token_);
-						
-						// Output generated by the interpreter goes to our output stream
-						interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+						if (bytecode && bytecode->ShouldExecute() && bytecode->Execute(client_symbols, interaction_callback->script_, &bytecode_result) &&
+							(bytecode_result.type_ == EidosValueType::kValueFloat) && std::isfinite(bytecode_result.float_) && (bytecode_result.float_ >= 0.0))
+						{
+							p_strength = bytecode_result.float_;
+						}
+						else
+						{
+							// Interpret the script; the result from the interpretation must be a singleton double used as a new fitness value
+							EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(interaction_callback->script_);
+							EidosValue *result = result_SP.get();
+							
+							if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
+								EIDOS_TERMINATION << "ERROR (InteractionType::ApplyInteractionCallbacks): interaction() callbacks must provide a float singleton return value." << EidosTerminate(interaction_callback->identifier_token_);
+							
+							p_strength = result->FloatAtIndex(0, nullptr);
+							
+							if (std::isnan(p_strength) || std::isinf(p_strength) || (p_strength < 0.0))
+								EIDOS_TERMINATION << "ERROR (InteractionType::ApplyInteractionCallbacks): interaction() callbacks must return a finite value >= 0.0." << EidosTerminate(interaction_callback->identifier_token_);
+							
+							// Output generated by the interpreter goes to our output stream
+							interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+						}
 					}
 					catch (...)
 					{
@@ -1081,7 +1310,7 @@ double InteractionType::ApplyInteractionCallbacks(Individual *p_receiver, Indivi
 	
 	sim.executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosInteractionCallback)]);
 #endif
@@ -1096,7 +1325,16 @@ size_t InteractionType::MemoryUsageForKDTrees(void)
 	for (auto &iter : data_)
 	{
 		const InteractionsData &data = iter.second;
-		usage += sizeof(SLiM_kdNode) * data.individual_count_;
+		
+		if (data.grid_indices_)
+			usage += (sizeof(slim_popsize_t) + sizeof(double) * SLIM_MAX_DIMENSIONALITY) * data.individual_count_ + sizeof(uint32_t) * (data.grid_total_cells_ + 1);
+		else
+			usage += sizeof(SLiM_kdNode) * data.individual_count_;
+		
+		if (data.kd_retained_nodes_)
+			usage += sizeof(SLiM_kdNode) * data.kd_retained_individuals_.size();
+		
+		usage += sizeof(Individual *) * (data.kd_individuals_.capacity() + data.kd_retained_individuals_.capacity());
 	}
 	
 	return usage;
@@ -1342,6 +1580,77 @@ SLiM_kdNode *InteractionType::MakeKDTree3_p2(SLiM_kdNode *t, int len)
 	return n;
 }
 
+// make a k-d tree for the current spatiality, for a given phase; this dispatches to the phase-specific functions above
+SLiM_kdNode *InteractionType::MakeKDSubtree(SLiM_kdNode *t, int len, int p_phase)
+{
+	switch (spatiality_)
+	{
+		case 1: return MakeKDTree1_p0(t, len);
+		case 2: return (p_phase == 0) ? MakeKDTree2_p0(t, len) : MakeKDTree2_p1(t, len);
+		case 3: return (p_phase == 0) ? MakeKDTree3_p0(t, len) : ((p_phase == 1) ? MakeKDTree3_p1(t, len) : MakeKDTree3_p2(t, len));
+	}
+	return nullptr;
+}
+
+// make the top p_depth levels of a k-d tree, and add each subtree below that level to p_subtrees to be built later
+void InteractionType::SplitKDTree(SLiM_kdNode *t, int len, int p_phase, int p_depth, SLiM_kdNode **p_link, std::vector<SLiM_kdSubtree> &p_subtrees)
+{
+	if (len == 0)
+	{
+		*p_link = nullptr;
+		return;
+	}
+	
+	if ((p_depth == 0) || (len < SLIM_INTERACTION_PARALLEL_CHUNK_SIZE))
+	{
+		p_subtrees.emplace_back(SLiM_kdSubtree{t, len, p_phase, p_link});
+		return;
+	}
+	
+	SLiM_kdNode *n;
+	
+	switch (p_phase)
+	{
+		case 0:		n = FindMedian_p0(t, t + len); break;
+		case 1:		n = FindMedian_p1(t, t + len); break;
+		default:	n = FindMedian_p2(t, t + len); break;
+	}
+	
+	int next_phase = (p_phase + 1 < spatiality_) ? p_phase + 1 : 0;
+	
+	*p_link = n;
+	SplitKDTree(t, (int)(n - t), next_phase, p_depth - 1, &n->left, p_subtrees);
+	SplitKDTree(n + 1, (int)(t + len - (n + 1)), next_phase, p_depth - 1, &n->right, p_subtrees);
+}
+
+// make a k-d tree on multiple threads; the top of the tree is made on the main thread, and then its subtrees are made in parallel.
+// The median for each range of nodes is found exactly as in the recursive functions above, so the tree is identical to theirs.
+SLiM_kdNode *InteractionType::MakeKDTree_Parallel(SLiM_kdNode *t, int len)
+{
+	// split off about four subtrees per thread, so that the threads stay busy even though the subtrees differ in size
+	int split_depth = 0;
+	
+	while ((1 << split_depth) < gEidosMaxThreads * 4)
+		split_depth++;
+	
+	std::vector<SLiM_kdSubtree> subtrees;
+	SLiM_kdNode *root;
+	
+	SplitKDTree(t, len, 0, split_depth, &root, subtrees);
+	
+	int subtree_count = (int)subtrees.size();
+	
+#pragma omp parallel for schedule(dynamic, 1) num_threads(gEidosMaxThreads)
+	for (int subtree_index = 0; subtree_index < subtree_count; ++subtree_index)
+	{
+		SLiM_kdSubtree &subtree = subtrees[subtree_index];
+		
+		*subtree.link_ = MakeKDSubtree(subtree.start_, subtree.length_, subtree.phase_);
+	}
+	
+	return root;
+}
+
 void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 {
 	if (!p_subpop_data.evaluated_)
@@ -1353,6 +1662,17 @@ void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 	}
 	else if (!p_subpop_data.kd_nodes_)
 	{
+		// With incremental evaluation, repair the retained k-d tree if possible rather than building a new one
+		if (p_subpop_data.kd_retained_nodes_)
+		{
+			bool repaired = RepairKDTree(p_subpop_data);
+			
+			free_retained_kd_tree(p_subpop_data);
+			
+			if (repaired)
+				return;
+		}
+		
 		int individual_count = p_subpop_data.individual_count_;
 		int count = individual_count;
 		
@@ -1504,12 +1824,19 @@ void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 		}
 		else
 		{
-			// Now call out to recursively construct the tree
-			switch (spatiality_)
+			// Now call out to recursively construct the tree; with multiple threads (slim -threads), large trees are built in parallel
+			if ((gEidosMaxThreads > 1) && (p_subpop_data.kd_node_count_ >= SLIM_INTERACTION_PARALLEL_MIN_SIZE))
 			{
-				case 1: p_subpop_data.kd_root_ = MakeKDTree1_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-				case 2: p_subpop_data.kd_root_ = MakeKDTree2_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-				case 3: p_subpop_data.kd_root_ = MakeKDTree3_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+				p_subpop_data.kd_root_ = MakeKDTree_Parallel(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);
+			}
+			else
+			{
+				switch (spatiality_)
+				{
+					case 1: p_subpop_data.kd_root_ = MakeKDTree1_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+					case 2: p_subpop_data.kd_root_ = MakeKDTree2_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+					case 3: p_subpop_data.kd_root_ = MakeKDTree3_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+				}
 			}
 			
 			// Check the tree for correctness; for now I will leave this enabled in the DEBUG case,
@@ -1533,6 +1860,723 @@ void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 }
 
 
+#pragma mark -
+#pragma mark incremental k-d tree repair
+#pragma mark -
+
+// With incremental evaluation, the k-d tree built for one evaluation is retained when the interaction is invalidated, and is then
+// repaired, rather than rebuilt, when a k-d tree is needed by the next evaluation.  In the repaired tree each node of the old tree
+// keeps its individual, now at that individual's new position, which becomes the node's new split.  If a node's individual has died,
+// or has moved across the split of one of the node's ancestors, the node's subtree is rebuilt from scratch; any individuals in that
+// subtree that have moved out of it are re-inserted, like new individuals, by routing them down the tree by the new splits.  Subtrees
+// that have become too unbalanced are also rebuilt.  In a typical nonWF model most individuals survive from one evaluation to the next
+// and move only a little, so most of the tree is kept and only small subtrees are rebuilt.
+// Repair produces a valid k-d tree, but generally not the tree that would be built from scratch, so results that depend upon the
+// order in which neighbors are found (such as the order of the individuals returned by interactingNeighbors(), and draws from
+// drawByStrength()) may differ from those without incremental evaluation; they are still reproducible, however.  Periodic
+// interactions always rebuild the tree, since their replicated nodes would make repair more complex than it is worth.
+
+struct _SLiM_kdRepairState
+{
+	SLiM_kdNode *old_nodes_;						// the retained nodes
+	SLiM_kdNode *new_nodes_;						// the nodes being laid out, for the current individuals
+	double *positions_;								// the current positions, from InteractionsData
+	int cursor_;									// the number of new nodes laid out so far
+	std::vector<slim_popsize_t> new_index_;			// for each old individual index, the current index of that individual, or -1
+	std::vector<char> kept_;						// for each old node, true if it is kept, false if its subtree is to be rebuilt
+	std::vector<double> split_;						// for each kept old node, its new split: the new position of its individual
+	std::vector<uint32_t> placement_bins_;			// the bin for each individual placed in a bin; see place_in_retained_kd_bin()
+	std::vector<slim_popsize_t> placement_indices_;	// the current index of each individual placed in a bin
+	std::vector<slim_popsize_t> rerouted_;			// the individuals that need to be routed down the tree to a bin
+	std::vector<uint32_t> bin_starts_;				// for each bin, the start of its individuals in bin_members_
+	std::vector<slim_popsize_t> bin_members_;		// the current indices of the individuals in the bins, grouped by bin
+	std::vector<int> subtree_start_;				// for each old node, the first new node of the range for its subtree
+	std::vector<int> subtree_length_;				// for each old node, the number of new nodes in the range for its subtree
+	std::vector<int> root_position_;				// for each kept old node, the new node for its individual
+};
+
+// Individuals that are not at a kept node are placed in bins: bin 3*slot is the empty left branch of the old node at index slot in
+// the old node buffer, bin 3*slot+1 is its empty right branch, and bin 3*slot+2 holds all of the individuals in its subtree if the
+// subtree is to be rebuilt
+static inline void place_in_retained_kd_bin(SLiM_kdRepairState &p_state, uint32_t p_bin, slim_popsize_t p_index)
+{
+	p_state.placement_bins_.push_back(p_bin);
+	p_state.placement_indices_.push_back(p_index);
+}
+
+// true if a position lies within the region of a subtree: p_lo[dim] <= x[dim] < p_hi[dim] along every dimension
+static inline bool in_retained_kd_region(const double *p_position, const double *p_lo, const double *p_hi, int p_spatiality)
+{
+	for (int dim = 0; dim < p_spatiality; ++dim)
+		if ((p_position[dim] < p_lo[dim]) || !(p_position[dim] < p_hi[dim]))
+			return false;
+	
+	return true;
+}
+
+// free the k-d tree, or with incremental evaluation retain it (replacing any tree already retained) for repair by the next evaluation
+void InteractionType::RetireKDTree(InteractionsData &p_subpop_data)
+{
+	if (p_subpop_data.kd_nodes_)
+	{
+		if (p_subpop_data.kd_incremental_ && !periodic_x_ && !periodic_y_ && !periodic_z_)
+		{
+			free_retained_kd_tree(p_subpop_data);
+			
+			p_subpop_data.kd_retained_nodes_ = p_subpop_data.kd_nodes_;
+			p_subpop_data.kd_retained_root_ = p_subpop_data.kd_root_;
+			p_subpop_data.kd_retained_individuals_.swap(p_subpop_data.kd_individuals_);
+		}
+		else
+		{
+			free(p_subpop_data.kd_nodes_);
+		}
+		
+		p_subpop_data.kd_nodes_ = nullptr;
+	}
+	
+	p_subpop_data.kd_root_ = nullptr;
+}
+
+// decide which old nodes are kept, top-down; p_lo and p_hi give the region of the subtree, as bounded by its ancestors' new splits
+void InteractionType::ClassifyRetainedKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node, int p_phase, double *p_lo, double *p_hi)
+{
+	int slot = (int)(p_old_node - p_state.old_nodes_);
+	slim_popsize_t index = p_state.new_index_[p_old_node->individual_index_];
+	double *position = (index >= 0) ? p_state.positions_ + index * SLIM_MAX_DIMENSIONALITY : nullptr;
+	
+	if (!position || !in_retained_kd_region(position, p_lo, p_hi, spatiality_))
+	{
+		// the subtree's root has died or moved out of the subtree's region, so the subtree will be rebuilt
+		p_state.kept_[slot] = false;
+		GatherRetainedKDSubtree(p_state, p_old_node, slot, p_lo, p_hi);
+		return;
+	}
+	
+	double split = position[p_phase];
+	int next_phase = (p_phase + 1 >= spatiality_) ? 0 : p_phase + 1;
+	
+	p_state.kept_[slot] = true;
+	p_state.split_[slot] = split;
+	
+	if (p_old_node->left)
+	{
+		double saved_hi = p_hi[p_phase];
+		
+		p_hi[p_phase] = std::min(saved_hi, split);
+		ClassifyRetainedKDSubtree(p_state, p_old_node->left, next_phase, p_lo, p_hi);
+		p_hi[p_phase] = saved_hi;
+	}
+	
+	if (p_old_node->right)
+	{
+		double saved_lo = p_lo[p_phase];
+		
+		p_lo[p_phase] = std::max(saved_lo, split);
+		ClassifyRetainedKDSubtree(p_state, p_old_node->right, next_phase, p_lo, p_hi);
+		p_lo[p_phase] = saved_lo;
+	}
+}
+
+// collect the surviving individuals of an old subtree that is to be rebuilt; those still within the region of the subtree rooted at
+// old node p_rebuilt_slot go into its rebuild bin, and those that have moved out of it are re-routed
+void InteractionType::GatherRetainedKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node, int p_rebuilt_slot, double *p_lo, double *p_hi)
+{
+	slim_popsize_t index = p_state.new_index_[p_old_node->individual_index_];
+	
+	if (index >= 0)
+	{
+		if (in_retained_kd_region(p_state.positions_ + index * SLIM_MAX_DIMENSIONALITY, p_lo, p_hi, spatiality_))
+			place_in_retained_kd_bin(p_state, 3 * p_rebuilt_slot + 2, index);
+		else
+			p_state.rerouted_.push_back(index);
+	}
+	
+	if (p_old_node->left)
+		GatherRetainedKDSubtree(p_state, p_old_node->left, p_rebuilt_slot, p_lo, p_hi);
+	if (p_old_node->right)
+		GatherRetainedKDSubtree(p_state, p_old_node->right, p_rebuilt_slot, p_lo, p_hi);
+}
+
+// add a new node for the current individual p_index
+static inline void add_retained_kd_node(SLiM_kdRepairState &p_state, slim_popsize_t p_index, int p_spatiality)
+{
+	SLiM_kdNode *node = p_state.new_nodes_ + p_state.cursor_++;
+	double *position = p_state.positions_ + p_index * SLIM_MAX_DIMENSIONALITY;
+	
+	for (int dim = 0; dim < p_spatiality; ++dim)
+		node->x[dim] = position[dim];
+	
+	node->individual_index_ = p_index;
+}
+
+// lay out the new nodes for the range of an old subtree, in the old tree's order: for a kept node, first the range for its left
+// subtree (or the individuals in its empty left branch), then its own individual, then the range for its right subtree; for a node
+// whose subtree is to be rebuilt, the individuals in its rebuild bin
+void InteractionType::LayOutRetainedKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node)
+{
+	int slot = (int)(p_old_node - p_state.old_nodes_);
+	
+	p_state.subtree_start_[slot] = p_state.cursor_;
+	
+	if (p_state.kept_[slot])
+	{
+		if (p_old_node->left)
+			LayOutRetainedKDSubtree(p_state, p_old_node->left);
+		else
+			for (uint32_t member = p_state.bin_starts_[3 * slot]; member < p_state.bin_starts_[3 * slot + 1]; ++member)
+				add_retained_kd_node(p_state, p_state.bin_members_[member], spatiality_);
+		
+		p_state.root_position_[slot] = p_state.cursor_;
+		add_retained_kd_node(p_state, p_state.new_index_[p_old_node->individual_index_], spatiality_);
+		
+		if (p_old_node->right)
+			LayOutRetainedKDSubtree(p_state, p_old_node->right);
+		else
+			for (uint32_t member = p_state.bin_starts_[3 * slot + 1]; member < p_state.bin_starts_[3 * slot + 2]; ++member)
+				add_retained_kd_node(p_state, p_state.bin_members_[member], spatiality_);
+	}
+	else
+	{
+		for (uint32_t member = p_state.bin_starts_[3 * slot + 2]; member < p_state.bin_starts_[3 * slot + 3]; ++member)
+			add_retained_kd_node(p_state, p_state.bin_members_[member], spatiality_);
+	}
+	
+	p_state.subtree_length_[slot] = p_state.cursor_ - p_state.subtree_start_[slot];
+}
+
+// link up the new nodes for the range of an old subtree, keeping the old subtree's root as the split if the subtree is kept and
+// is not too unbalanced, and otherwise rebuilding the range from scratch; the root of the resulting subtree is returned
+SLiM_kdNode *InteractionType::RepairKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node, int p_phase)
+{
+	int slot = (int)(p_old_node - p_state.old_nodes_);
+	int start = p_state.subtree_start_[slot];
+	int length = p_state.subtree_length_[slot];
+	SLiM_kdNode *first = p_state.new_nodes_ + start;
+	
+	if (length == 0)
+		return nullptr;
+	
+	if (!p_state.kept_[slot])
+		return MakeKDSubtree(first, length, p_phase);
+	
+	int position = p_state.root_position_[slot];
+	int left_length = position - start;
+	int right_length = length - left_length - 1;
+	
+	if (std::max(left_length, right_length) > length * SLIM_INTERACTION_KD_MAX_IMBALANCE)
+		return MakeKDSubtree(first, length, p_phase);
+	
+	SLiM_kdNode *root = p_state.new_nodes_ + position;
+	int next_phase = (p_phase + 1 >= spatiality_) ? 0 : p_phase + 1;
+	
+	if (p_old_node->left)
+		root->left = RepairKDSubtree(p_state, p_old_node->left, next_phase);
+	else
+		root->left = (left_length ? MakeKDSubtree(first, left_length, next_phase) : nullptr);
+	
+	if (p_old_node->right)
+		root->right = RepairKDSubtree(p_state, p_old_node->right, next_phase);
+	else
+		root->right = (right_length ? MakeKDSubtree(root + 1, right_length, next_phase) : nullptr);
+	
+	return root;
+}
+
+// repair the retained k-d tree to fit the current individuals and their positions, making it the k-d tree for the current evaluation.
+// Individuals present in both evaluations are matched up by identity; individuals that have died are dropped, and new individuals are
+// routed down the tree to the empty branches where they belong.  Returns false, having done nothing, if repair looks unlikely to be
+// cheaper than building a new tree.  The caller remains responsible for freeing the retained tree.
+bool InteractionType::RepairKDTree(InteractionsData &p_subpop_data)
+{
+	SLiM_kdNode *old_root = p_subpop_data.kd_retained_root_;
+	std::vector<Individual *> &old_individuals = p_subpop_data.kd_retained_individuals_;
+	std::vector<Individual *> &individuals = p_subpop_data.kd_individuals_;
+	int old_count = (int)old_individuals.size();
+	int count = p_subpop_data.individual_count_;
+	
+	if (!old_root || (count == 0) || ((int)individuals.size() != count) || periodic_x_ || periodic_y_ || periodic_z_)
+		return false;
+	
+	// Match the current individuals with the old ones.  Individuals that survive keep their order in the subpopulation, with new
+	// individuals added at the end, so one forward scan normally suffices; we give up if the scan gets too long.  If an individual
+	// that died was freed and its memory reused for a new individual, the new individual will look like a survivor that moved; that
+	// is harmless, since every current individual still gets exactly one node, and movement is handled by the repair.
+	SLiM_kdRepairState state;
+	int64_t scan_limit = 4 * ((int64_t)count + old_count), scanned = 0;
+	int old_index = 0;
+	
+	state.new_index_.resize(old_count, -1);
+	
+	for (int index = 0; index < count; ++index)
+	{
+		Individual *individual = individuals[index];
+		int scan_index = old_index;
+		
+		while ((scan_index < old_count) && (old_individuals[scan_index] != individual))
+			scan_index++;
+		
+		scanned += (scan_index - old_index) + 1;
+		
+		if (scanned > scan_limit)
+			return false;
+		
+		if (scan_index < old_count)
+		{
+			state.new_index_[scan_index] = index;
+			old_index = scan_index + 1;
+		}
+		else
+		{
+			state.rerouted_.push_back(index);
+		}
+	}
+	
+	if ((int)state.rerouted_.size() > count / 4)
+		return false;
+	
+	// Decide which old nodes are kept, gathering up the individuals in subtrees that will be rebuilt
+	SLiM_kdNode *old_nodes = p_subpop_data.kd_retained_nodes_;
+	double lo[SLIM_MAX_DIMENSIONALITY], hi[SLIM_MAX_DIMENSIONALITY];
+	
+	for (int dim = 0; dim < SLIM_MAX_DIMENSIONALITY; ++dim)
+	{
+		lo[dim] = -std::numeric_limits<double>::infinity();
+		hi[dim] = std::numeric_limits<double>::infinity();
+	}
+	
+	state.old_nodes_ = old_nodes;
+	state.positions_ = p_subpop_data.positions_;
+	state.kept_.resize(old_count);
+	state.split_.resize(old_count);
+	
+	ClassifyRetainedKDSubtree(state, old_root, 0, lo, hi);
+	
+	// Route the new individuals, and those that have moved out of their subtrees, down the tree by the new splits until they reach
+	// an empty branch or a subtree to be rebuilt; the individuals in each bin are then grouped together with a counting sort
+	for (slim_popsize_t index : state.rerouted_)
+	{
+		double *position = state.positions_ + index * SLIM_MAX_DIMENSIONALITY;
+		SLiM_kdNode *node = old_root;
+		int phase = 0;
+		
+		while (true)
+		{
+			uint32_t slot = (uint32_t)(node - old_nodes);
+			
+			if (!state.kept_[slot])
+			{
+				place_in_retained_kd_bin(state, 3 * slot + 2, index);
+				break;
+			}
+			
+			bool go_left = (position[phase] < state.split_[slot]);
+			SLiM_kdNode *child = (go_left ? node->left : node->right);
+			
+			if (!child)
+			{
+				place_in_retained_kd_bin(state, 3 * slot + (go_left ? 0 : 1), index);
+				break;
+			}
+			
+			node = child;
+			
+			if (++phase >= spatiality_)
+				phase = 0;
+		}
+	}
+	
+	size_t placement_count = state.placement_bins_.size();
+	
+	state.bin_starts_.resize(3 * (size_t)old_count + 1, 0);
+	
+	for (size_t placement = 0; placement < placement_count; ++placement)
+		state.bin_starts_[state.placement_bins_[placement] + 1]++;
+	
+	for (size_t bin = 0; bin < 3 * (size_t)old_count; ++bin)
+		state.bin_starts_[bin + 1] += state.bin_starts_[bin];
+	
+	{
+		std::vector<uint32_t> bin_cursors(state.bin_starts_.begin(), state.bin_starts_.end() - 1);
+		
+		state.bin_members_.resize(placement_count);
+		
+		for (size_t placement = 0; placement < placement_count; ++placement)
+			state.bin_members_[bin_cursors[state.placement_bins_[placement]]++] = state.placement_indices_[placement];
+	}
+	
+	// Lay out the new nodes in the old tree's order, so that each old subtree corresponds to a contiguous range of new nodes, and
+	// then link them up, rebuilding the ranges for subtrees that are not kept
+	SLiM_kdNode *nodes = (SLiM_kdNode *)calloc(count, sizeof(SLiM_kdNode));
+	
+	state.new_nodes_ = nodes;
+	state.cursor_ = 0;
+	state.subtree_start_.resize(old_count);
+	state.subtree_length_.resize(old_count);
+	state.root_position_.resize(old_count);
+	
+	LayOutRetainedKDSubtree(state, old_root);
+	
+	if (state.cursor_ != count)
+		EIDOS_TERMINATION << "ERROR (InteractionType::RepairKDTree): (internal error) the repaired k-d tree count " << state.cursor_ << " does not match the individual count " << count << "." << EidosTerminate();
+	
+	p_subpop_data.kd_nodes_ = nodes;
+	p_subpop_data.kd_node_count_ = count;
+	p_subpop_data.kd_root_ = RepairKDSubtree(state, old_root, 0);
+	
+#if DEBUG
+	int total_tree_count = 0;
+	
+	switch (spatiality_)
+	{
+		case 1: total_tree_count = CheckKDTree1_p0(p_subpop_data.kd_root_);	break;
+		case 2: total_tree_count = CheckKDTree2_p0(p_subpop_data.kd_root_);	break;
+		case 3: total_tree_count = CheckKDTree3_p0(p_subpop_data.kd_root_);	break;
+	}
+	
+	if (total_tree_count != p_subpop_data.kd_node_count_)
+		EIDOS_TERMINATION << "ERROR (InteractionType::RepairKDTree): (internal error) the k-d tree count " << total_tree_count << " does not match the allocated node count" << p_subpop_data.kd_node_count_ << "." << EidosTerminate();
+#endif
+	
+	return true;
+}
+
+#pragma mark -
+#pragma mark uniform grid
+#pragma mark -
+
+// The uniform grid is an alternative spatial index to the k-d tree, for interactions with a maximum distance that is small relative
+// to the spatial extent of the subpopulation; the neighbors of a point are then found by scanning just a few cells, each of which is
+// one contiguous block of points, rather than by descending through the tree.  It is also cheaper to build, with a counting sort.
+// Note that the grid and the k-d tree find the same neighbors, but in a different order; results that depend upon the order of
+// neighbors, such as draws from drawByStrength(), therefore depend upon which index is in use, but are reproducible either way.
+
+// the cell coordinate of a position along one dimension; positions beyond the edges of the grid are placed in the edge cells
+inline __attribute__((always_inline)) int grid_cell_coord(InteractionsData &p_subpop_data, int p_dim, double p_x)
+{
+	int coord = (int)((p_x - p_subpop_data.grid_origin_[p_dim]) * p_subpop_data.grid_cell_scale_[p_dim]);
+	
+	if (coord < 0) return 0;
+	if (coord >= p_subpop_data.grid_cell_counts_[p_dim]) return p_subpop_data.grid_cell_counts_[p_dim] - 1;
+	return coord;
+}
+
+// decide whether to use the grid for this subpopulation, and if so choose its dimensions; returns false if the k-d tree should be used
+bool InteractionType::ConfigureGrid(InteractionsData &p_subpop_data)
+{
+	int individual_count = p_subpop_data.individual_count_;
+	
+	if (!std::isfinite(max_distance_) || (max_distance_ <= 0.0) || (individual_count == 0))
+		return false;
+	
+	bool periodic[SLIM_MAX_DIMENSIONALITY] = {periodic_x_, periodic_y_, periodic_z_};
+	double bounds[SLIM_MAX_DIMENSIONALITY] = {p_subpop_data.bounds_x1_, p_subpop_data.bounds_y1_, p_subpop_data.bounds_z1_};
+	double extent[SLIM_MAX_DIMENSIONALITY];
+	double cells[SLIM_MAX_DIMENSIONALITY];
+	double total_cells = 1.0;
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		if (periodic[dim])
+		{
+			// periodic positions are known to be within [0, bound], and the grid must span exactly one period so it can wrap
+			p_subpop_data.grid_origin_[dim] = 0.0;
+			p_subpop_data.grid_period_[dim] = bounds[dim];
+			extent[dim] = bounds[dim];
+		}
+		else
+		{
+			// non-periodic positions may lie outside the spatial bounds, so the grid spans the positions actually present
+			double *position_data = p_subpop_data.positions_;
+			double min_coord = position_data[dim], max_coord = position_data[dim];
+			
+			for (int ind_index = 1; ind_index < individual_count; ++ind_index)
+			{
+				double coord = position_data[ind_index * SLIM_MAX_DIMENSIONALITY + dim];
+				
+				if (coord < min_coord) min_coord = coord;
+				if (coord > max_coord) max_coord = coord;
+			}
+			
+			p_subpop_data.grid_origin_[dim] = min_coord;
+			p_subpop_data.grid_period_[dim] = 0.0;
+			extent[dim] = max_coord - min_coord;
+		}
+		
+		// cells are made very slightly wider than the maximum distance, so that roundoff in assigning cells cannot lose a neighbor
+		cells[dim] = std::max(1.0, std::min((double)individual_count, floor((extent[dim] / max_distance_) * (1.0 - 1e-9))));
+		total_cells *= cells[dim];
+	}
+	
+	// use no more cells than individuals; a sparser grid would spend its time scanning empty cells
+	if (total_cells > individual_count)
+	{
+		double shrink = pow(total_cells / individual_count, 1.0 / spatiality_);
+		
+		total_cells = 1.0;
+		
+		for (int dim = 0; dim < spatiality_; ++dim)
+		{
+			cells[dim] = std::max(1.0, floor(cells[dim] / shrink));
+			total_cells *= cells[dim];
+		}
+	}
+	
+	// the cells searched around a point should be a small fraction of the grid, or the k-d tree will do better
+	int searched_cells = (spatiality_ == 1) ? 3 : ((spatiality_ == 2) ? 9 : 27);
+	
+	if (total_cells < searched_cells * SLIM_INTERACTION_GRID_MIN_CELLS_PER_SEARCHED)
+		return false;
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		if (periodic[dim] && (cells[dim] < 3))
+			return false;
+		
+		p_subpop_data.grid_cell_counts_[dim] = (int)cells[dim];
+		p_subpop_data.grid_cell_scale_[dim] = (extent[dim] > 0.0) ? cells[dim] / extent[dim] : 0.0;
+	}
+	
+	p_subpop_data.grid_total_cells_ = (int)total_cells;
+	
+	return true;
+}
+
+// build the grid, as configured by ConfigureGrid(), with a counting sort of the points by cell
+void InteractionType::BuildGrid(InteractionsData &p_subpop_data)
+{
+	int individual_count = p_subpop_data.individual_count_;
+	int total_cells = p_subpop_data.grid_total_cells_;
+	double *position_data = p_subpop_data.positions_;
+	uint32_t *cell_starts = (uint32_t *)calloc(total_cells + 1, sizeof(uint32_t));
+	uint32_t *point_cells = (uint32_t *)malloc(individual_count * sizeof(uint32_t));
+	slim_popsize_t *indices = (slim_popsize_t *)malloc(individual_count * sizeof(slim_popsize_t));
+	double *coords = (double *)malloc(SLIM_MAX_DIMENSIONALITY * individual_count * sizeof(double));
+	
+	// find the cell for each point, and count the points in each cell (offset by one, to make the prefix sum below simple)
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		double *position = position_data + ind_index * SLIM_MAX_DIMENSIONALITY;
+		uint32_t cell = 0;
+		
+		for (int dim = spatiality_ - 1; dim >= 0; --dim)
+			cell = cell * p_subpop_data.grid_cell_counts_[dim] + grid_cell_coord(p_subpop_data, dim, position[dim]);
+		
+		point_cells[ind_index] = cell;
+		cell_starts[cell + 1]++;
+	}
+	
+	for (int cell = 0; cell < total_cells; ++cell)
+		cell_starts[cell + 1] += cell_starts[cell];
+	
+	// place the points, in individual order within each cell; each cell's start is used as its insertion cursor, and ends up at its end
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		double *position = position_data + ind_index * SLIM_MAX_DIMENSIONALITY;
+		uint32_t point_index = cell_starts[point_cells[ind_index]]++;
+		
+		coords[point_index] = position[0];
+		coords[individual_count + point_index] = position[1];
+		coords[2 * individual_count + point_index] = position[2];
+		indices[point_index] = ind_index;
+	}
+	
+	memmove(cell_starts + 1, cell_starts, total_cells * sizeof(uint32_t));
+	cell_starts[0] = 0;
+	
+	free(point_cells);
+	
+	p_subpop_data.grid_cell_starts_ = cell_starts;
+	p_subpop_data.grid_indices_ = indices;
+	p_subpop_data.grid_coords_ = coords;
+}
+
+// find the points that must be searched for neighbors of a point: those in the point's cell and the cells adjacent to it.  The points
+// are returned as ranges of indices into the grid, [p_ranges[2*i], p_ranges[2*i+1]), with adjacent cells merged; returns the count
+int InteractionType::GridNeighborRanges(InteractionsData &p_subpop_data, double *p_point, uint32_t *p_ranges)
+{
+	int dim_cells[SLIM_MAX_DIMENSIONALITY][3];
+	int dim_cell_count[SLIM_MAX_DIMENSIONALITY] = {1, 1, 1};
+	
+	for (int dim = 0; dim < SLIM_MAX_DIMENSIONALITY; ++dim)
+		dim_cells[dim][0] = 0;
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		int cell_count = p_subpop_data.grid_cell_counts_[dim];
+		int coord = grid_cell_coord(p_subpop_data, dim, p_point[dim]);
+		int count = 0;
+		
+		if (p_subpop_data.grid_period_[dim] != 0.0)
+		{
+			// periodic dimensions wrap around; there are always at least three cells, so these are distinct
+			dim_cells[dim][count++] = (coord == 0) ? cell_count - 1 : coord - 1;
+			dim_cells[dim][count++] = coord;
+			dim_cells[dim][count++] = (coord == cell_count - 1) ? 0 : coord + 1;
+		}
+		else
+		{
+			if (coord > 0)
+				dim_cells[dim][count++] = coord - 1;
+			dim_cells[dim][count++] = coord;
+			if (coord < cell_count - 1)
+				dim_cells[dim][count++] = coord + 1;
+		}
+		
+		dim_cell_count[dim] = count;
+	}
+	
+	// cells that are consecutive along the x dimension hold consecutive runs of points, so their ranges are merged
+	uint32_t *cell_starts = p_subpop_data.grid_cell_starts_;
+	int ranges_found = 0;
+	int count_0 = p_subpop_data.grid_cell_counts_[0];
+	int count_01 = count_0 * ((spatiality_ >= 2) ? p_subpop_data.grid_cell_counts_[1] : 1);
+	
+	for (int i2 = 0; i2 < dim_cell_count[2]; ++i2)
+		for (int i1 = 0; i1 < dim_cell_count[1]; ++i1)
+		{
+			int row_base = count_0 * dim_cells[1][i1] + count_01 * dim_cells[2][i2];
+			int previous_cell = -2;
+			
+			for (int i0 = 0; i0 < dim_cell_count[0]; ++i0)
+			{
+				int cell = row_base + dim_cells[0][i0];
+				
+				if (cell == previous_cell + 1)
+				{
+					p_ranges[2 * ranges_found - 1] = cell_starts[cell + 1];
+				}
+				else
+				{
+					p_ranges[2 * ranges_found] = cell_starts[cell];
+					p_ranges[2 * ranges_found + 1] = cell_starts[cell + 1];
+					ranges_found++;
+				}
+				
+				previous_cell = cell;
+			}
+		}
+	
+	return ranges_found;
+}
+
+// make sure that a spatial index, either the uniform grid or the k-d tree, is present for the subpopulation
+void InteractionType::EnsureSpatialIndexPresent(InteractionsData &p_subpop_data)
+{
+	if (p_subpop_data.grid_indices_ || p_subpop_data.kd_nodes_)
+		return;
+	
+	if (p_subpop_data.evaluated_ && (spatiality_ > 0) && ConfigureGrid(p_subpop_data))
+		BuildGrid(p_subpop_data);
+	else
+		EnsureKDTreePresent(p_subpop_data);
+}
+
+// add the neighbors of receivers p_start_row to p_after_end_row - 1 to the sparse array, using the grid
+void InteractionType::BuildSA_Grid(InteractionsData &p_subpop_data, SparseArray *p_sparse_array, int p_start_row, int p_after_end_row, int p_start_exerter, int p_after_end_exerter)
+{
+	double *position_data = p_subpop_data.positions_;
+	slim_popsize_t *indices = p_subpop_data.grid_indices_;
+	double *coords = p_subpop_data.grid_coords_;
+	int individual_count = p_subpop_data.individual_count_;
+	double *period = p_subpop_data.grid_period_;
+	uint32_t neighbor_ranges[2 * 27];
+	std::vector<double> dist_sq;
+	
+	for (int row = p_start_row; row < p_after_end_row; row++)
+	{
+		double *nd = position_data + row * SLIM_MAX_DIMENSIONALITY;
+		int range_count = GridNeighborRanges(p_subpop_data, nd, neighbor_ranges);
+		
+		for (int range_index = 0; range_index < range_count; ++range_index)
+		{
+			uint32_t range_start = neighbor_ranges[2 * range_index];
+			uint32_t point_count = neighbor_ranges[2 * range_index + 1] - range_start;
+			
+			if (dist_sq.size() < point_count)
+				dist_sq.resize(point_count);
+			
+			grid_squared_distances(coords + range_start, individual_count, point_count, nd, period, spatiality_, dist_sq.data());
+			
+			for (uint32_t point_index = 0; point_index < point_count; ++point_index)
+			{
+				double d = dist_sq[point_index];
+				
+				if (d > max_distance_sq_)
+					continue;
+				
+				slim_popsize_t exerter_index = indices[range_start + point_index];
+				
+				if ((exerter_index == row) || (exerter_index < p_start_exerter) || (exerter_index >= p_after_end_exerter))
+					continue;
+				
+				p_sparse_array->AddEntryDistance(row, exerter_index, (sa_distance_t)sqrt(d));
+			}
+		}
+	}
+}
+
+// find neighbors of a point using the grid; the semantics are those of FindNeighbors(), except that the neighbors found are returned
+// in order of increasing distance (ties broken by individual index) when fewer than all of them are requested
+void InteractionType::FindNeighbors_Grid(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, slim_popsize_t p_focal_individual_index)
+{
+	slim_popsize_t *indices = p_subpop_data.grid_indices_;
+	double *coords = p_subpop_data.grid_coords_;
+	int individual_count = p_subpop_data.individual_count_;
+	double *period = p_subpop_data.grid_period_;
+	uint32_t neighbor_ranges[2 * 27];
+	double point[SLIM_MAX_DIMENSIONALITY];
+	
+	// wrap the point into the grid along periodic dimensions, since it may be an arbitrary point from nearestNeighborsOfPoint()
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		point[dim] = p_point[dim];
+		
+		if ((period[dim] != 0.0) && ((point[dim] < 0.0) || (point[dim] > period[dim])))
+			point[dim] -= floor(point[dim] / period[dim]) * period[dim];
+	}
+	
+	std::vector<std::pair<double, slim_popsize_t>> found;
+	std::vector<double> dist_sq;
+	int range_count = GridNeighborRanges(p_subpop_data, point, neighbor_ranges);
+	
+	for (int range_index = 0; range_index < range_count; ++range_index)
+	{
+		uint32_t range_start = neighbor_ranges[2 * range_index];
+		uint32_t point_count = neighbor_ranges[2 * range_index + 1] - range_start;
+		
+		if (dist_sq.size() < point_count)
+			dist_sq.resize(point_count);
+		
+		grid_squared_distances(coords + range_start, individual_count, point_count, point, period, spatiality_, dist_sq.data());
+		
+		for (uint32_t point_index = 0; point_index < point_count; ++point_index)
+		{
+			double d = dist_sq[point_index];
+			slim_popsize_t individual_index = indices[range_start + point_index];
+			
+			if ((d <= max_distance_sq_) && (individual_index != p_focal_individual_index))
+				found.emplace_back(d, individual_index);
+		}
+	}
+	
+	std::vector<Individual *> &individuals = p_subpop->parent_individuals_;
+	
+	if ((int)found.size() > p_count)
+	{
+		std::partial_sort(found.begin(), found.begin() + p_count, found.end());
+		found.resize(p_count);
+	}
+	else if (p_count < p_subpop_data.individual_count_ - 1)
+	{
+		std::sort(found.begin(), found.end());
+	}
+	
+	for (auto &found_pair : found)
+		p_result_vec.push_object_element_NORR(individuals[found_pair.second]);
+}
+
+
 #pragma mark -
 #pragma mark k-d tree consistency checking
 #pragma mark -
@@ -1752,6 +2796,59 @@ inline __attribute__((always_inline)) double dist_sq3(SLiM_kdNode *a, double *b)
 #endif
 }
 
+// add the neighbors of receivers p_start_row to p_after_end_row - 1 to the sparse array, which may be a chunk of the full sparse array
+void InteractionType::BuildSARows(InteractionsData &p_subpop_data, SparseArray *p_sparse_array, int p_start_row, int p_after_end_row, int p_start_exerter, int p_after_end_exerter)
+{
+	if (p_subpop_data.grid_indices_)
+	{
+		BuildSA_Grid(p_subpop_data, p_sparse_array, p_start_row, p_after_end_row, p_start_exerter, p_after_end_exerter);
+		return;
+	}
+	
+	double *position_data = p_subpop_data.positions_;
+	SLiM_kdNode *kd_root = p_subpop_data.kd_root_;
+	int row;
+	
+	if (exerter_sex_ == IndividualSex::kUnspecified)
+	{
+		// Without a specified exerter sex, we can add each exerter with no sex test
+		switch (spatiality_)
+		{
+			case 1:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_1(kd_root, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array);
+				break;
+			case 2:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_2(kd_root, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, 0);
+				break;
+			case 3:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_3(kd_root, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, 0);
+				break;
+		}
+	}
+	else
+	{
+		// With a specified exerter sex, we use a special version of BuildSA_X() that tests for that by range
+		switch (spatiality_)
+		{
+			case 1:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_SS_1(kd_root, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, p_start_exerter, p_after_end_exerter);
+				break;
+			case 2:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_SS_2(kd_root, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, p_start_exerter, p_after_end_exerter, 0);
+				break;
+			case 3:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_SS_3(kd_root, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, p_start_exerter, p_after_end_exerter, 0);
+				break;
+		}
+	}
+}
+
 // add neighbors to the sparse array in 1D
 void InteractionType::BuildSA_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array)
 {
@@ -2454,6 +3551,13 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 	{
 		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) neighbors cannot be found for non-spatial interactions." << EidosTerminate();
 	}
+	else if (p_subpop_data.grid_indices_)
+	{
+		if (p_count == 0)
+			return;
+		
+		FindNeighbors_Grid(p_subpop, p_subpop_data, p_point, p_count, p_result_vec, p_excluded_individual ? p_excluded_individual->index_ : -1);
+	}
 	else if (!p_subpop_data.kd_nodes_)
 	{
 		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) the k-d tree has not been constructed." << EidosTerminate();
@@ -2920,7 +4024,7 @@ EidosValue_SP InteractionType::ExecuteMethod_distanceToPoint(EidosGlobalStringID
 // a helper function for ExecuteMethod_drawByStrength() that does the draws using a vector of weights
 static void DrawByWeights(int draw_count, const double *weights, int n_weights, double weight_total, std::vector<int> &draw_indices)
 {
-	// Draw individuals; we do this using either the GSL or linear search, depending on the query size
+	// Draw individuals; we do this using either an alias table or linear search, depending on the query size
 	// This choice is somewhat problematic.  I empirically determined at what query size the GSL started
 	// to pay off despite the overhead of setup with gsl_ran_discrete_preproc().  However, I did that for
 	// a particular subpopulation size; and the crossover point might also depend upon the distribution
@@ -2934,17 +4038,13 @@ static void DrawByWeights(int draw_count, const double *weights, int n_weights,
 	{
 		if (draw_count > 50)		// the empirically determined crossover point in performance
 		{
-			// Use gsl_ran_discrete() to do the drawing
-			gsl_ran_discrete_t *gsl_lookup = gsl_ran_discrete_preproc(n_weights, weights);
+			// Use an alias table to do the drawing, with all of the draws made in one batch
+			EidosAliasTable lookup;
+			size_t draws_start = draw_indices.size();
 			
-			for (int64_t draw_index = 0; draw_index < draw_count; ++draw_index)
-			{
-				int hit_index = (int)gsl_ran_discrete(EIDOS_GSL_RNG, gsl_lookup);
-				
-				draw_indices.push_back(hit_index);
-			}
-			
-			gsl_ran_discrete_free(gsl_lookup);
+			lookup.Rebuild(n_weights, weights);
+			draw_indices.resize(draws_start + draw_count);
+			lookup.DrawMany(gEidos_RNG, draw_indices.data() + draws_start, draw_count);
 		}
 		else
 		{
@@ -3075,7 +4175,7 @@ EidosValue_SP InteractionType::ExecuteMethod_drawByStrength(EidosGlobalStringID
 		uint32_t row_nnz;
 		const uint32_t *row_columns;
 		const sa_strength_t *strengths;
-		std::vector<double> double_strengths;	// needed by DrawByWeights() for gsl_ran_discrete_preproc()
+		std::vector<double> double_strengths;	// needed by DrawByWeights() for EidosAliasTable::Rebuild()
 		
 		strengths = sa.StrengthsForRow(ind_index, &row_nnz, &row_columns);
 		
@@ -3121,17 +4221,19 @@ EidosValue_SP InteractionType::ExecuteMethod_evaluate(EidosGlobalStringID p_meth
 #pragma unused (p_method_id, p_arguments, p_interpreter)
 	EidosValue *subpops_value = p_arguments[0].get();
 	EidosValue *immediate_value = p_arguments[1].get();
+	EidosValue *incremental_value = p_arguments[2].get();
 	
 	if ((sim_.GenerationStage() == SLiMGenerationStage::kWFStage2GenerateOffspring) ||
 		(sim_.GenerationStage() == SLiMGenerationStage::kNonWFStage1GenerateOffspring))
 		EIDOS_TERMINATION << "ERROR (InteractionType::ExecuteMethod_evaluate): evaluate() may not be called during offspring generation." << EidosTerminate();
 	
 	bool immediate = immediate_value->LogicalAtIndex(0, nullptr);
+	bool incremental = incremental_value->LogicalAtIndex(0, nullptr);
 	
 	if (subpops_value->Type() == EidosValueType::kValueNULL)
 	{
 		for (std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : sim_.ThePopulation().subpops_)
-			EvaluateSubpopulation(subpop_pair.second, immediate);
+			EvaluateSubpopulation(subpop_pair.second, immediate, incremental);
 	}
 	else
 	{
@@ -3139,7 +4241,7 @@ EidosValue_SP InteractionType::ExecuteMethod_evaluate(EidosGlobalStringID p_meth
 		int requested_subpop_count = subpops_value->Count();
 		
 		for (int requested_subpop_index = 0; requested_subpop_index < requested_subpop_count; ++requested_subpop_index)
-			EvaluateSubpopulation((Subpopulation *)(subpops_value->ObjectElementAtIndex(requested_subpop_index, nullptr)), immediate);
+			EvaluateSubpopulation((Subpopulation *)(subpops_value->ObjectElementAtIndex(requested_subpop_index, nullptr)), immediate, incremental);
 	}
 	
 	return gStaticEidosValueVOID;
@@ -3472,7 +4574,7 @@ EidosValue_SP InteractionType::ExecuteMethod_nearestNeighbors(EidosGlobalStringI
 	double *position_data = subpop_data.positions_;
 	double *ind_position = position_data + ind_index * SLIM_MAX_DIMENSIONALITY;
 	
-	EnsureKDTreePresent(subpop_data);
+	EnsureSpatialIndexPresent(subpop_data);
 	
 	EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve((int)count);
 	
@@ -3526,7 +4628,7 @@ EidosValue_SP InteractionType::ExecuteMethod_nearestNeighborsOfPoint(EidosGlobal
 	// Find the neighbors
 	InteractionsData &subpop_data = subpop_data_iter->second;
 	
-	EnsureKDTreePresent(subpop_data);
+	EnsureSpatialIndexPresent(subpop_data);
 	
 	EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve((int)count);
 	
@@ -3955,7 +5057,7 @@ const std::vector<EidosMethodSignature_CSP> *InteractionType_Class::Methods(void
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_distance, kEidosValueMaskFloat))->AddObject("individuals1", gSLiM_Individual_Class)->AddObject_ON("individuals2", gSLiM_Individual_Class, gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_distanceToPoint, kEidosValueMaskFloat))->AddObject("individuals1", gSLiM_Individual_Class)->AddFloat("point"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_drawByStrength, kEidosValueMaskObject, gSLiM_Individual_Class))->AddObject_S("individual", gSLiM_Individual_Class)->AddInt_OS("count", gStaticEidosValue_Integer1));
-		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_evaluate, kEidosValueMaskVOID))->AddObject_ON("subpops", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddLogical_OS("immediate", gStaticEidosValue_LogicalF));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_evaluate, kEidosValueMaskVOID))->AddObject_ON("subpops", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddLogical_OS("immediate", gStaticEidosValue_LogicalF)->AddLogical_OS("incremental", gStaticEidosValue_LogicalF));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_interactingNeighborCount, kEidosValueMaskInt))->AddObject("individuals", gSLiM_Individual_Class));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_interactionDistance, kEidosValueMaskFloat))->AddObject_S("receiver", gSLiM_Individual_Class)->AddObject_ON("exerters", gSLiM_Individual_Class, gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_nearestInteractingNeighbors, kEidosValueMaskObject, gSLiM_Individual_Class))->AddObject_S("individual", gSLiM_Individual_Class)->AddInt_OS("count", gStaticEidosValue_Integer1));
@@ -3991,6 +5093,19 @@ _InteractionsData::_InteractionsData(_InteractionsData&& p_source)
 	dist_str_ = p_source.dist_str_;
 	kd_nodes_ = p_source.kd_nodes_;
 	kd_root_ = p_source.kd_root_;
+	kd_incremental_ = p_source.kd_incremental_;
+	kd_individuals_.swap(p_source.kd_individuals_);
+	kd_retained_nodes_ = p_source.kd_retained_nodes_;
+	kd_retained_root_ = p_source.kd_retained_root_;
+	kd_retained_individuals_.swap(p_source.kd_retained_individuals_);
+	std::copy(p_source.grid_cell_counts_, p_source.grid_cell_counts_ + SLIM_MAX_DIMENSIONALITY, grid_cell_counts_);
+	grid_total_cells_ = p_source.grid_total_cells_;
+	std::copy(p_source.grid_origin_, p_source.grid_origin_ + SLIM_MAX_DIMENSIONALITY, grid_origin_);
+	std::copy(p_source.grid_cell_scale_, p_source.grid_cell_scale_ + SLIM_MAX_DIMENSIONALITY, grid_cell_scale_);
+	std::copy(p_source.grid_period_, p_source.grid_period_ + SLIM_MAX_DIMENSIONALITY, grid_period_);
+	grid_cell_starts_ = p_source.grid_cell_starts_;
+	grid_indices_ = p_source.grid_indices_;
+	grid_coords_ = p_source.grid_coords_;
 	
 	p_source.evaluated_ = false;
 	p_source.evaluation_interaction_callbacks_.clear();
@@ -4001,6 +5116,15 @@ _InteractionsData::_InteractionsData(_InteractionsData&& p_source)
 	p_source.dist_str_ = nullptr;
 	p_source.kd_nodes_ = nullptr;
 	p_source.kd_root_ = nullptr;
+	p_source.kd_incremental_ = false;
+	p_source.kd_individuals_.clear();
+	p_source.kd_retained_nodes_ = nullptr;
+	p_source.kd_retained_root_ = nullptr;
+	p_source.kd_retained_individuals_.clear();
+	p_source.grid_total_cells_ = 0;
+	p_source.grid_cell_starts_ = nullptr;
+	p_source.grid_indices_ = nullptr;
+	p_source.grid_coords_ = nullptr;
 }
 
 _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
@@ -4013,6 +5137,14 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 			delete dist_str_;
 		if (kd_nodes_)
 			free(kd_nodes_);
+		if (kd_retained_nodes_)
+			free(kd_retained_nodes_);
+		if (grid_cell_starts_)
+			free(grid_cell_starts_);
+		if (grid_indices_)
+			free(grid_indices_);
+		if (grid_coords_)
+			free(grid_coords_);
 		
 		evaluated_ = p_source.evaluated_;
 		evaluation_interaction_callbacks_.swap(p_source.evaluation_interaction_callbacks_);
@@ -4023,6 +5155,19 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 		dist_str_ = p_source.dist_str_;
 		kd_nodes_ = p_source.kd_nodes_;
 		kd_root_ = p_source.kd_root_;
+		kd_incremental_ = p_source.kd_incremental_;
+		kd_individuals_.swap(p_source.kd_individuals_);
+		kd_retained_nodes_ = p_source.kd_retained_nodes_;
+		kd_retained_root_ = p_source.kd_retained_root_;
+		kd_retained_individuals_.swap(p_source.kd_retained_individuals_);
+		std::copy(p_source.grid_cell_counts_, p_source.grid_cell_counts_ + SLIM_MAX_DIMENSIONALITY, grid_cell_counts_);
+		grid_total_cells_ = p_source.grid_total_cells_;
+		std::copy(p_source.grid_origin_, p_source.grid_origin_ + SLIM_MAX_DIMENSIONALITY, grid_origin_);
+		std::copy(p_source.grid_cell_scale_, p_source.grid_cell_scale_ + SLIM_MAX_DIMENSIONALITY, grid_cell_scale_);
+		std::copy(p_source.grid_period_, p_source.grid_period_ + SLIM_MAX_DIMENSIONALITY, grid_period_);
+		grid_cell_starts_ = p_source.grid_cell_starts_;
+		grid_indices_ = p_source.grid_indices_;
+		grid_coords_ = p_source.grid_coords_;
 		
 		p_source.evaluated_ = false;
 		p_source.evaluation_interaction_callbacks_.clear();
@@ -4033,6 +5178,15 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 		p_source.dist_str_ = nullptr;
 		p_source.kd_nodes_ = nullptr;
 		p_source.kd_root_ = nullptr;
+		p_source.kd_incremental_ = false;
+		p_source.kd_individuals_.clear();
+		p_source.kd_retained_nodes_ = nullptr;
+		p_source.kd_retained_root_ = nullptr;
+		p_source.kd_retained_individuals_.clear();
+		p_source.grid_total_cells_ = 0;
+		p_source.grid_cell_starts_ = nullptr;
+		p_source.grid_indices_ = nullptr;
+		p_source.grid_coords_ = nullptr;
 	}
 	
 	return *this;
@@ -4068,6 +5222,32 @@ _InteractionsData::~_InteractionsData(void)
 	
 	kd_root_ = nullptr;
 	
+	if (kd_retained_nodes_)
+	{
+		free(kd_retained_nodes_);
+		kd_retained_nodes_ = nullptr;
+	}
+	
+	kd_retained_root_ = nullptr;
+	
+	if (grid_cell_starts_)
+	{
+		free(grid_cell_starts_);
+		grid_cell_starts_ = nullptr;
+	}
+	
+	if (grid_indices_)
+	{
+		free(grid_indices_);
+		grid_indices_ = nullptr;
+	}
+	
+	if (grid_coords_)
+	{
+		free(grid_coords_);
+		grid_coords_ = nullptr;
+	}
+	
 	// Unnecessary since it's about to be destroyed anyway
 	//evaluation_interaction_callbacks_.clear();
 }
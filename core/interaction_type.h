@@ -77,6 +77,40 @@ struct _SLiM_kdNode
 };
 typedef struct _SLiM_kdNode SLiM_kdNode;
 
+// A subtree of the k-d tree that has been split off to be built on a separate thread; see EnsureKDTreePresent()
+struct _SLiM_kdSubtree
+{
+	SLiM_kdNode *start_;					// the first node of the range of nodes that make up the subtree
+	int length_;							// the number of nodes in the subtree
+	int phase_;								// the phase (x, y, z) of the subtree's root
+	SLiM_kdNode **link_;					// where the subtree's root should be placed, once the subtree has been built
+};
+typedef struct _SLiM_kdSubtree SLiM_kdSubtree;
+
+// The working state for repairing a retained k-d tree with incremental evaluation; see RepairKDTree()
+struct _SLiM_kdRepairState;
+typedef struct _SLiM_kdRepairState SLiM_kdRepairState;
+
+// When a retained k-d tree is repaired, a subtree is rebuilt from scratch if more than this fraction of its nodes lie on one side of its
+// root.  A newly built subtree never has more than half of its nodes on one side, so this is the drift tolerated before rebalancing.
+#define SLIM_INTERACTION_KD_MAX_IMBALANCE		0.625
+
+// As an alternative to the k-d tree, a uniform grid of cells can be used as the spatial index when the maximum interaction distance
+// is small relative to the spatial extent of a subpopulation; see EnsureSpatialIndexPresent().  Each cell is wider than the maximum
+// interaction distance along every dimension, so all of the interacting neighbors of a point lie in the point's own cell or in the
+// cells adjacent to it.  The points are sorted by cell (and by individual index within each cell), and their coordinates are kept in
+// structure-of-arrays form, one contiguous block per dimension, so that the distances to all of the points in a run of cells can be
+// calculated with SIMD instructions; periodic dimensions wrap around at the edges of the grid.
+
+// The grid is used only if it has at least this many cells for each cell searched around a point (3 per dimension), and each
+// periodic dimension must have at least three cells, so that the cells adjacent to a given cell are all distinct.
+#define SLIM_INTERACTION_GRID_MIN_CELLS_PER_SEARCHED		8
+
+// Building k-d trees and sparse arrays on multiple threads (slim -threads) is done only for subpopulations of at least this size,
+// and the receivers (rows of the sparse array) are then processed in chunks of this size.  These values do not affect results.
+#define SLIM_INTERACTION_PARALLEL_MIN_SIZE		1000
+#define SLIM_INTERACTION_PARALLEL_CHUNK_SIZE	256
+
 struct _InteractionsData
 {
 	// This flag is true when the interaction has been evaluated.  What that means in practice is that allocated blocks below
@@ -103,6 +137,24 @@ struct _InteractionsData
 	SLiM_kdNode *kd_nodes_ = nullptr;		// individual_count_ entries, holding the nodes of the k-d tree
 	SLiM_kdNode *kd_root_ = nullptr;		// the root of the k-d tree
 	
+	// With incremental evaluation (evaluate(incremental=T)), the k-d tree is retained when the interaction is invalidated, and the
+	// next evaluation repairs it to fit the new positions instead of building a new tree from scratch; see RepairKDTree()
+	bool kd_incremental_ = false;							// true if the current evaluation is incremental
+	std::vector<Individual *> kd_individuals_;				// with incremental evaluation, the individuals evaluated, by index
+	SLiM_kdNode *kd_retained_nodes_ = nullptr;				// the k-d tree retained from a previous incremental evaluation, or nullptr
+	SLiM_kdNode *kd_retained_root_ = nullptr;				// the root of the retained k-d tree
+	std::vector<Individual *> kd_retained_individuals_;		// the individuals that the retained k-d tree's individual indices refer to
+	
+	// The uniform grid, used as the spatial index instead of the k-d tree when grid_indices_ is non-null; see EnsureSpatialIndexPresent()
+	int grid_cell_counts_[SLIM_MAX_DIMENSIONALITY];		// the number of cells along each dimension
+	int grid_total_cells_ = 0;							// the total number of cells in the grid
+	double grid_origin_[SLIM_MAX_DIMENSIONALITY];		// the coordinate of the lower edge of the grid along each dimension
+	double grid_cell_scale_[SLIM_MAX_DIMENSIONALITY];	// the number of cells per unit distance along each dimension
+	double grid_period_[SLIM_MAX_DIMENSIONALITY];		// the period of each dimension if it is periodic, or 0.0 if not
+	uint32_t *grid_cell_starts_ = nullptr;				// grid_total_cells_ + 1 entries, the offset of each cell's first point
+	slim_popsize_t *grid_indices_ = nullptr;			// individual_count_ entries, the individual index of each point, sorted by cell
+	double *grid_coords_ = nullptr;						// SLIM_MAX_DIMENSIONALITY blocks of individual_count_ entries, each point's coordinates
+	
 	_InteractionsData(const _InteractionsData&) = delete;					// no copying
 	_InteractionsData& operator=(const _InteractionsData&) = delete;		// no copying
 	_InteractionsData(_InteractionsData&&);									// move constructor, for std::map compatibility
@@ -169,7 +221,21 @@ private:
 	SLiM_kdNode *MakeKDTree3_p0(SLiM_kdNode *t, int len);
 	SLiM_kdNode *MakeKDTree3_p1(SLiM_kdNode *t, int len);
 	SLiM_kdNode *MakeKDTree3_p2(SLiM_kdNode *t, int len);
+	SLiM_kdNode *MakeKDSubtree(SLiM_kdNode *t, int len, int p_phase);
+	void SplitKDTree(SLiM_kdNode *t, int len, int p_phase, int p_depth, SLiM_kdNode **p_link, std::vector<SLiM_kdSubtree> &p_subtrees);
+	SLiM_kdNode *MakeKDTree_Parallel(SLiM_kdNode *t, int len);
 	void EnsureKDTreePresent(InteractionsData &p_subpop_data);
+	void RetireKDTree(InteractionsData &p_subpop_data);
+	void ClassifyRetainedKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node, int p_phase, double *p_lo, double *p_hi);
+	void GatherRetainedKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node, int p_rebuilt_slot, double *p_lo, double *p_hi);
+	void LayOutRetainedKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node);
+	SLiM_kdNode *RepairKDSubtree(SLiM_kdRepairState &p_state, SLiM_kdNode *p_old_node, int p_phase);
+	bool RepairKDTree(InteractionsData &p_subpop_data);
+	
+	bool ConfigureGrid(InteractionsData &p_subpop_data);
+	void BuildGrid(InteractionsData &p_subpop_data);
+	int GridNeighborRanges(InteractionsData &p_subpop_data, double *p_point, uint32_t *p_ranges);
+	void EnsureSpatialIndexPresent(InteractionsData &p_subpop_data);
 	
 	int CheckKDTree1_p0(SLiM_kdNode *t);
 	void CheckKDTree1_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
@@ -190,6 +256,8 @@ private:
 	void BuildSA_SS_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter);
 	void BuildSA_SS_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase);
 	void BuildSA_SS_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase);
+	void BuildSA_Grid(InteractionsData &p_subpop_data, SparseArray *p_sparse_array, int p_start_row, int p_after_end_row, int p_start_exerter, int p_after_end_exerter);
+	void BuildSARows(InteractionsData &p_subpop_data, SparseArray *p_sparse_array, int p_start_row, int p_after_end_row, int p_start_exerter, int p_after_end_exerter);
 	
 	void FindNeighbors1_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist);
 	void FindNeighbors1_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase);
@@ -200,6 +268,7 @@ private:
 	void FindNeighborsN_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist);
 	void FindNeighborsN_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
 	void FindNeighborsN_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
+	void FindNeighbors_Grid(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, slim_popsize_t p_focal_individual_index);
 	void FindNeighbors(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, Individual *p_excluded_individual);
 	
 public:
@@ -214,7 +283,7 @@ public:
 	InteractionType(SLiMSim &p_sim, slim_objectid_t p_interaction_type_id, std::string p_spatiality_string, bool p_reciprocal, double p_max_distance, IndividualSex p_receiver_sex, IndividualSex p_exerter_sex);
 	~InteractionType(void);
 	
-	void EvaluateSubpopulation(Subpopulation *p_subpop, bool p_immediate);
+	void EvaluateSubpopulation(Subpopulation *p_subpop, bool p_immediate, bool p_incremental);
 	bool AnyEvaluated(void);
 	void Invalidate(void);
 	
@@ -88,7 +88,7 @@ static void PrintUsageAndDie(bool p_print_header, bool p_print_full_usage)
 	
 	SLIM_OUTSTREAM << "usage: slim -v[ersion] | -u[sage] | -testEidos | -testSLiM |" << std::endl;
 	SLIM_OUTSTREAM << "   [-l[ong] [<l>]] [-s[eed] <seed>] [-t[ime]] [-m[em]] [-M[emhist]] [-x]" << std::endl;
-	SLIM_OUTSTREAM << "   [-d[efine] <def>] [<script file>]" << std::endl;
+	SLIM_OUTSTREAM << "   [-threads <n>] [-profile <file>] [-d[efine] <def>] [<script file>]" << std::endl;
 	
 	if (p_print_full_usage)
 	{
@@ -104,6 +104,8 @@ static void PrintUsageAndDie(bool p_print_header, bool p_print_full_usage)
 		SLIM_OUTSTREAM << "   -m[em]           : print SLiM's peak memory usage" << std::endl;
 		SLIM_OUTSTREAM << "   -M[emhist]       : print a histogram of SLiM's memory usage" << std::endl;
 		SLIM_OUTSTREAM << "   -x               : disable SLiM's runtime safety/consistency checks" << std::endl;
+		SLIM_OUTSTREAM << "   -threads <n>     : generate WF offspring using <n> threads, where possible" << std::endl;
+		SLIM_OUTSTREAM << "   -profile <file>  : write a profile report for the run, as JSON, to <file>" << std::endl;
 		SLIM_OUTSTREAM << "   -d[efine] <def>  : define an Eidos constant, such as \"mu=1e-7\"" << std::endl;
 		SLIM_OUTSTREAM << "   <script file>    : the input script file (stdin may be used instead)" << std::endl;
 	}
@@ -123,6 +125,7 @@ static void clean_up_leak_false_positives(void)
 	MutationRun::DeleteMutationRunFreeList();
 	FreeSymbolTablePool();
 	Eidos_FreeRNG(gEidos_RNG);
+	Eidos_FreeRNGStreams();
 }
 #endif
 
@@ -146,6 +149,9 @@ int main(int argc, char *argv[])
 	unsigned long int *override_seed_ptr = nullptr;			// by default, a seed is generated or supplied in the input file
 	const char *input_file = nullptr;
 	bool keep_time = false, keep_mem = false, keep_mem_hist = false, skip_checks = false, tree_seq_checks = false;
+#if (SLIMPROFILING == 1)
+	const char *profile_file = nullptr;
+#endif
 	std::vector<std::string> defined_constants;
 	
 	// command-line SLiM generally terminates rather than throwing
@@ -253,6 +259,41 @@ int main(int argc, char *argv[])
 			continue;
 		}
 		
+		// -threads <n>: use up to n threads for multithreaded offspring generation; results depend on the seed, not on n, if n > 1
+		if (strcmp(arg, "-threads") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie(false, true);
+			
+			long thread_count = strtol(argv[arg_index], NULL, 10);
+			
+			if ((thread_count < 1) || (thread_count > 1024))
+			{
+				SLIM_ERRSTREAM << "Thread count supplied to -threads must be in [1, 1024]." << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			
+			gEidosMaxThreads = (int)thread_count;
+			
+			continue;
+		}
+		
+		// -profile <file>: profile the run, as SLiMgui does, and write the report as JSON to the given file
+		if (strcmp(arg, "-profile") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie(false, true);
+			
+#if (SLIMPROFILING == 1)
+			profile_file = argv[arg_index];
+#else
+			SLIM_ERRSTREAM << "The -profile option is not available in this build of SLiM; profiling requires a Release build." << std::endl;
+			exit(EXIT_FAILURE);
+#endif
+			
+			continue;
+		}
+		
 		// -x: skip runtime checks for greater speed, or to avoid them if they are causing problems
 		if (strcmp(arg, "-x") == 0)
 		{
@@ -440,6 +481,28 @@ int main(int argc, char *argv[])
 		int mem_check_counter = 0, mem_check_mod = 10;
 #endif
 		
+#if (SLIMPROFILING == 1)
+		// PROFILING
+		std::ofstream profile_stream;
+		slim_generation_t profile_start_generation = sim->Generation();
+		std::clock_t profile_begin_cpu = std::clock();
+		std::chrono::steady_clock::time_point profile_begin_wall = std::chrono::steady_clock::now();
+		eidos_profile_t profile_elapsed_wall_clock = 0;
+		
+		if (profile_file)
+		{
+			profile_stream.open(profile_file);
+			
+			if (!profile_stream.is_open())
+				EIDOS_TERMINATION << std::endl << "ERROR (main): could not open profile output file: " << profile_file << "." << EidosTerminate();
+			
+			gEidosProfilingClientCount++;
+			sim->StartProfiling();
+		}
+		
+		SLIM_PROFILE_BLOCK_START();
+#endif
+		
 		// Run the simulation to its natural end
 		while (sim->RunOneGeneration())
 		{
@@ -472,6 +535,22 @@ int main(int argc, char *argv[])
 #endif
 		}
 		
+#if (SLIMPROFILING == 1)
+		// PROFILING
+		SLIM_PROFILE_BLOCK_END(profile_elapsed_wall_clock);
+		
+		if (profile_file)
+		{
+			double profile_cpu_time = static_cast<double>(std::clock() - profile_begin_cpu) / CLOCKS_PER_SEC;
+			double profile_wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - profile_begin_wall).count();
+			
+			sim->WriteProfileReport(profile_stream, profile_wall_time, profile_cpu_time, profile_elapsed_wall_clock, profile_start_generation);
+			profile_stream.close();
+			
+			gEidosProfilingClientCount--;
+		}
+#endif
+		
 		// clean up; but most of this is an unnecessary waste of time in the command-line context
 		Eidos_FlushFiles();
 		
@@ -143,18 +143,19 @@ private:
 	
 	int32_t nonneutral_change_validation_ = 0;					// compared to sim.nonneutral_change_counter_ to detect changes
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 	
 	bool recached_run_ = false;
 	
-#endif	// defined(SLIMGUI) && (SLIMPROFILING == 1)
+#endif	// (SLIMPROFILING == 1)
 	
 #endif	// SLIM_USE_NONNEUTRAL_CACHES
 	
 public:
 	
 	int64_t operation_id_ = 0;		// used to mark the MutationRun objects that have been handled by a global operation
+	slim_refcount_t tally_use_count_ = 0;	// used by Population::TallyMutationRunUses() to count the uses of this run among the genomes being tallied
 	
 	// Allocation and disposal of MutationRun objects should go through these funnels.  The point of this architecture
 	// is to re-use the instances completely.  We don't use EidosObjectPool here because it would construct/destruct the
@@ -323,11 +324,11 @@ public:
 		++mutation_count_;
 	}
 	
-	inline void emplace_back_bulk(const MutationIndex *p_mutation_indices, long p_copy_count)
+	inline void reserve(long p_capacity)
 	{
-		SLIM_MUTRUN_LOCK_CHECK();
-		
-		if (mutation_count_ + p_copy_count > mutation_capacity_)
+		// Grow the buffer, if necessary, to hold at least p_capacity mutations; the resulting capacity is the same as would result from
+		// adding mutations one at a time with emplace_back(), so reserving ahead of time saves reallocs without increasing memory usage
+		if (p_capacity > mutation_capacity_)
 		{
 			// See emplace_back for comments on our capacity policy
 			if (mutations_ == mutations_buffer_)
@@ -340,7 +341,7 @@ public:
 				// perhaps because it causes a true realloc rather than just a size increment of the existing malloc block.  Who knows.
 				mutation_capacity_ = SLIM_MUTRUN_BUFFER_SIZE * 2;
 				
-				while (mutation_count_ + p_copy_count > mutation_capacity_)
+				while (p_capacity > mutation_capacity_)
 				{
 					if (mutation_capacity_ < 32)
 						mutation_capacity_ <<= 1;		// double the number of pointers we can hold
@@ -361,11 +362,19 @@ public:
 					else
 						mutation_capacity_ += 16;
 				}
-				while (mutation_count_ + p_copy_count > mutation_capacity_);
+				while (p_capacity > mutation_capacity_);
 				
 				mutations_ = (MutationIndex *)realloc(mutations_, mutation_capacity_ * sizeof(MutationIndex));
 			}
 		}
+	}
+	
+	inline void emplace_back_bulk(const MutationIndex *p_mutation_indices, long p_copy_count)
+	{
+		SLIM_MUTRUN_LOCK_CHECK();
+		
+		if (mutation_count_ + p_copy_count > mutation_capacity_)
+			reserve(mutation_count_ + p_copy_count);
 		
 		// Now we are guaranteed to have enough memory, so copy the pointers in
 		// (unless malloc/realloc failed, which we're not going to worry about!)
@@ -632,9 +641,14 @@ public:
 	
 	void check_nonneutral_mutation_cache();
 	
-	inline __attribute__((always_inline)) void beginend_nonneutral_pointers(const MutationIndex **p_mutptr_iter, const MutationIndex **p_mutptr_max, int32_t p_nonneutral_change_counter, int32_t p_nonneutral_regime)
+	inline __attribute__((always_inline)) bool nonneutral_cache_is_valid(int32_t p_nonneutral_change_counter) const
+	{
+		return ((nonneutral_change_validation_ == p_nonneutral_change_counter) && (nonneutral_mutations_count_ != -1));
+	}
+	
+	inline __attribute__((always_inline)) void validate_nonneutral_cache(int32_t p_nonneutral_change_counter, int32_t p_nonneutral_regime)
 	{
-		if ((nonneutral_change_validation_ != p_nonneutral_change_counter) || (nonneutral_mutations_count_ == -1))
+		if (!nonneutral_cache_is_valid(p_nonneutral_change_counter))
 		{
 			// If the nonneutral change counter has changed since we last validated, or our cache is invalid for other
 			// reasons (most notably being a new mutation run that has not yet cached), validate it immediately
@@ -647,11 +661,16 @@ public:
 				case 3: cache_nonneutral_mutations_REGIME_3(); break;
 			}
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			recached_run_ = true;
 #endif
 		}
+	}
+	
+	inline __attribute__((always_inline)) void beginend_nonneutral_pointers(const MutationIndex **p_mutptr_iter, const MutationIndex **p_mutptr_max, int32_t p_nonneutral_change_counter, int32_t p_nonneutral_regime)
+	{
+		validate_nonneutral_cache(p_nonneutral_change_counter, p_nonneutral_regime);
 		
 #if DEBUG
 		check_nonneutral_mutation_cache();
@@ -662,7 +681,7 @@ public:
 		*p_mutptr_max = nonneutral_mutations_ + nonneutral_mutations_count_;
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	inline __attribute__((always_inline)) void tally_nonneutral_mutations(int64_t *p_mutation_count, int64_t *p_nonneutral_count, int64_t *p_recached_count)
 	{
@@ -677,7 +696,7 @@ public:
 			recached_run_ = false;
 		}
 	}
-#endif	// defined(SLIMGUI) && (SLIMPROFILING == 1)
+#endif	// (SLIMPROFILING == 1)
 	
 #endif	// SLIM_USE_NONNEUTRAL_CACHES
 	
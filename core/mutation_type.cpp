@@ -205,20 +205,21 @@ void MutationType::ParseDFEParameters(std::string &p_dfe_type_string, const Eido
 	}
 }
 
-double MutationType::DrawSelectionCoefficient(void) const
+double MutationType::DrawSelectionCoefficient(Eidos_RNG_State &p_rng) const
 {
 	switch (dfe_type_)
 	{
 		case DFEType::kFixed:			return dfe_parameters_[0];
-		case DFEType::kGamma:			return gsl_ran_gamma(EIDOS_GSL_RNG, dfe_parameters_[1], dfe_parameters_[0] / dfe_parameters_[1]);
-		case DFEType::kExponential:		return gsl_ran_exponential(EIDOS_GSL_RNG, dfe_parameters_[0]);
-		case DFEType::kNormal:			return gsl_ran_gaussian(EIDOS_GSL_RNG, dfe_parameters_[1]) + dfe_parameters_[0];
-		case DFEType::kWeibull:			return gsl_ran_weibull(EIDOS_GSL_RNG, dfe_parameters_[0], dfe_parameters_[1]);
+		case DFEType::kGamma:			return gsl_ran_gamma(p_rng.gsl_rng_, dfe_parameters_[1], dfe_parameters_[0] / dfe_parameters_[1]);
+		case DFEType::kExponential:		return gsl_ran_exponential(p_rng.gsl_rng_, dfe_parameters_[0]);
+		case DFEType::kNormal:			return gsl_ran_gaussian(p_rng.gsl_rng_, dfe_parameters_[1]) + dfe_parameters_[0];
+		case DFEType::kWeibull:			return gsl_ran_weibull(p_rng.gsl_rng_, dfe_parameters_[0], dfe_parameters_[1]);
 			
 		case DFEType::kScript:
 		{
 			// We have a script string that we need to execute, and it will return a float or integer to us.  This
 			// is basically a lambda call, so the code here is parallel to the executeLambda() code in many ways.
+			// Note that the script draws from gEidos_RNG, not p_rng, so this case must only be used on the main thread.
 			double sel_coeff;
 			
 			// Errors in lambdas should be reported for the lambda script, not for the calling script,
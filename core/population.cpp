@@ -28,6 +28,10 @@
 #include <unordered_map>
 #include <ctime>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "slim_sim.h"
 #include "slim_globals.h"
 #include "eidos_script.h"
@@ -50,6 +54,7 @@ Population::Population(SLiMSim &p_sim) : sim_(p_sim)
 
 Population::~Population(void)
 {
+	ClearNewMutationRunTable();
 	RemoveAllSubpopulationInfo();
 	
 #ifdef SLIMGUI
@@ -93,6 +98,7 @@ void Population::RemoveAllSubpopulationInfo(void)
 		delete subpopulation.second;
 	
 	subpops_.clear();
+	InvalidateMutationTallies();
 	
 	// Free all substitutions and clear out the substitution vector
 	for (auto substitution : substitutions_)
@@ -185,6 +191,7 @@ Subpopulation *Population::AddSubpopulation(slim_objectid_t p_subpop_id, slim_po
 #endif
 	
 	subpops_.insert(std::pair<const slim_objectid_t,Subpopulation*>(p_subpop_id, new_subpop));
+	InvalidateMutationTallies();
 	
 	return new_subpop;
 }
@@ -216,6 +223,7 @@ Subpopulation *Population::AddSubpopulationSplit(slim_objectid_t p_subpop_id, Su
 #endif
 	
 	subpops_.insert(std::pair<const slim_objectid_t,Subpopulation*>(p_subpop_id, new_subpop));
+	InvalidateMutationTallies();
 	
 	// then draw parents from the source population according to fitness, obeying the new subpop's sex ratio
 	Subpopulation &subpop = *new_subpop;
@@ -313,6 +321,7 @@ void Population::SetSize(Subpopulation &p_subpop, slim_popsize_t p_subpop_size)
 			
 			// remember the subpop for later disposal
 			removed_subpops_.emplace_back(&p_subpop);
+			InvalidateMutationTallies();
 		}
 	}
 	else
@@ -342,6 +351,7 @@ void Population::RemoveSubpopulation(Subpopulation &p_subpop)
 		
 		// remember the subpop for later disposal
 		removed_subpops_.emplace_back(&p_subpop);
+		InvalidateMutationTallies();
 	}
 }
 #endif  // SLIM_NONWF_ONLY
@@ -400,7 +410,7 @@ void Population::ExecuteScript(SLiMEidosBlock *p_script_block, slim_generation_t
 // apply mateChoice() callbacks to a mating event with a chosen first parent; the return is the second parent index, or -1 to force a redraw
 slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_index, Subpopulation *p_subpop, Subpopulation *p_source_subpop, std::vector<SLiMEidosBlock*> &p_mate_choice_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -579,7 +589,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 				
 				sim_.executing_block_type_ = old_executing_block_type;
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -605,7 +615,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 		
 		sim_.executing_block_type_ = old_executing_block_type;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -652,7 +662,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 			
 			sim_.executing_block_type_ = old_executing_block_type;
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -726,7 +736,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 		
 		sim_.executing_block_type_ = old_executing_block_type;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -736,7 +746,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 	
 	sim_.executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -749,7 +759,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 // apply modifyChild() callbacks to a generated child; a return of false means "do not use this child, generate a new one"
 bool Population::ApplyModifyChildCallbacks(Individual *p_child, Genome *p_child_genome1, Genome *p_child_genome2, IndividualSex p_child_sex, Individual *p_parent1, Genome *p_parent1Genome1, Genome *p_parent1Genome2, Individual *p_parent2, Genome *p_parent2Genome1, Genome *p_parent2Genome2, bool p_is_selfing, bool p_is_cloning, Subpopulation *p_target_subpop, Subpopulation *p_source_subpop, std::vector<SLiMEidosBlock*> &p_modify_child_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -843,7 +853,7 @@ bool Population::ApplyModifyChildCallbacks(Individual *p_child, Genome *p_child_
 					sim_.executing_block_type_ = old_executing_block_type;
 					sim_.focal_modification_child_ = nullptr;
 					
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 					// PROFILING
 					SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosModifyChildCallback)]);
 #endif
@@ -864,7 +874,7 @@ bool Population::ApplyModifyChildCallbacks(Individual *p_child, Genome *p_child_
 	sim_.executing_block_type_ = old_executing_block_type;
 	sim_.focal_modification_child_ = nullptr;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosModifyChildCallback)]);
 #endif
@@ -1714,6 +1724,11 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 			}
 		}
 	}
+	else if ((gEidosMaxThreads > 1) && CanEvolveSubpopulationInParallel())
+	{
+		// NO CALLBACKS, MULTITHREADED: offspring are generated in chunks, in parallel, with a separate RNG stream for each chunk
+		EvolveSubpopulation_Parallel(p_subpop, migrant_source_count, migration_rates, migration_sources, num_migrants, total_female_children, total_male_children);
+	}
 	else
 	{
 		// NO CALLBACKS PRESENT: offspring can be generated in a fixed (i.e. predetermined) order.  This is substantially faster, since it avoids
@@ -1943,224 +1958,828 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 		}
 	}
 }
-#endif	// SLIM_WF_ONLY
 
-// apply recombination() callbacks to a generated child; a return of true means breakpoints were changed
-bool Population::ApplyRecombinationCallbacks(slim_popsize_t p_parent_index, Genome *p_genome1, Genome *p_genome2, Subpopulation *p_source_subpop, std::vector<slim_position_t> &p_crossovers, std::vector<SLiMEidosBlock*> &p_recombination_callbacks)
+// Check whether the model allows offspring generation by EvolveSubpopulation_Parallel().  The chunked code path does not support
+// tree-sequence recording, nucleotide-based models, sex-chromosome models, the DSB recombination model, or type 's' DFEs (which
+// run Eidos script); callbacks are excluded by EvolveSubpopulation() before we are called.
+bool Population::CanEvolveSubpopulationInParallel(void)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
-	// PROFILING
-	SLIM_PROFILE_BLOCK_START();
+	if (sim_.RecordingTreeSequence() || sim_.IsNucleotideBased())
+		return false;
+	if (sim_.ModeledChromosomeType() != GenomeType::kAutosome)
+		return false;
+	if (sim_.TheChromosome().using_DSB_model_)
+		return false;
+	
+	for (auto &muttype_iter : sim_.MutationTypes())
+		if (muttype_iter.second->dfe_type_ == DFEType::kScript)
+			return false;
+	
+	return true;
+}
+
+// Draw the recipe for one gamete: the parental strands, crossover breakpoints, and new mutations.  This parallels the no-callback
+// paths of DoCrossoverMutation() and DoClonalMutation(), but it modifies no shared state, so chunks can be drawn concurrently.
+void Population::DrawGameteRecipe(Eidos_RNG_State &p_rng, SLiM_OffspringChunk &p_chunk, Chromosome &p_chromosome, Genome *p_child_genome, Genome *p_strand1, Genome *p_strand2, IndividualSex p_sex, bool p_clonal, slim_objectid_t p_subpop_id, slim_position_t p_mutrun_length)
+{
+	int num_mutations, num_breakpoints;
+	
+	if (p_clonal)
+	{
+		num_breakpoints = 0;
+		num_mutations = p_chromosome.DrawMutationCount(p_rng, p_sex);
+	}
+	else
+	{
+		// swap strands in half of cases to assure random assortment
+		if (Eidos_RandomBool(p_rng))
+			std::swap(p_strand1, p_strand2);
+		
+#ifdef USE_GSL_POISSON
+		num_mutations = p_chromosome.DrawMutationCount(p_rng, p_sex);
+		num_breakpoints = p_chromosome.DrawBreakpointCount(p_rng, p_sex);
+#else
+		p_chromosome.DrawMutationAndBreakpointCounts(p_rng, p_sex, &num_mutations, &num_breakpoints);
 #endif
+	}
 	
-	// note the focal child during the callback, so we can prevent illegal operations during the callback
-	SLiMEidosBlockType old_executing_block_type = sim_.executing_block_type_;
-	sim_.executing_block_type_ = SLiMEidosBlockType::SLiMEidosRecombinationCallback;
+	SLiM_GameteRecipe recipe;
 	
-	bool crossovers_changed = false;
-	EidosValue_SP local_crossovers_ptr;
+	recipe.child_genome_ = p_child_genome;
+	recipe.strand1_ = p_strand1;
+	recipe.strand2_ = p_strand2;
+	recipe.breakpoints_start_ = (int32_t)p_chunk.breakpoints_.size();
+	recipe.breakpoints_count_ = 0;
+	recipe.mutations_start_ = (int32_t)p_chunk.mutations_.size();
+	recipe.mutations_count_ = 0;
 	
-	for (SLiMEidosBlock *recombination_callback : p_recombination_callbacks)
+	// DrawCrossoverBreakpoints() and DrawSortedUniquedMutationPositions() append to the chunk's flat buffers, sorting only what they append
+	if (num_breakpoints)
+		recipe.breakpoints_count_ = (int32_t)p_chromosome.DrawCrossoverBreakpoints(p_rng, p_sex, num_breakpoints, p_chunk.breakpoints_);
+	
+	if (num_mutations)
 	{
-		if (recombination_callback->active_)
+		int32_t positions_start = (int32_t)p_chunk.positions_.size();
+		
+		num_mutations = p_chromosome.DrawSortedUniquedMutationPositions(p_rng, num_mutations, p_sex, p_chunk.positions_);
+		
+		const std::pair<slim_position_t, GenomicElement *> *positions = p_chunk.positions_.data() + positions_start;
+		
+		for (int k = 0; k < num_mutations; k++)
 		{
-			// The callback is active, so we need to execute it
-			EidosSymbolTable callback_symbols(EidosSymbolTableType::kContextConstantsTable, &sim_.SymbolTable());
-			EidosSymbolTable client_symbols(EidosSymbolTableType::kLocalVariablesTable, &callback_symbols);
-			EidosFunctionMap &function_map = sim_.FunctionMap();
-			EidosInterpreter interpreter(recombination_callback->compound_statement_node_, client_symbols, function_map, &sim_);
+			// this parallels Chromosome::DrawNewMutation(); the Mutation object itself is made later, on the main thread
+			MutationType *mutation_type_ptr = positions[k].second->genomic_element_type_ptr_->DrawMutationType(p_rng);
+			double selection_coeff = mutation_type_ptr->DrawSelectionCoefficient(p_rng);
 			
-			if (recombination_callback->contains_self_)
-				callback_symbols.InitializeConstantSymbolEntry(recombination_callback->SelfSymbolTableEntry());		// define "self"
+			p_chunk.mutations_.emplace_back(SLiM_PendingMutation{positions[k].first, mutation_type_ptr, selection_coeff, p_subpop_id, -1, false});
+		}
+		
+		recipe.mutations_count_ = num_mutations;
+	}
+	
+	// count the mutation runs that will need to be built, rather than shared with a parent: those containing a new mutation, or a
+	// breakpoint that does not fall at the start of the run; both lists are sorted, so we can merge them to count distinct runs
+	if (recipe.breakpoints_count_ || recipe.mutations_count_)
+	{
+		const slim_position_t *bp_iter = p_chunk.breakpoints_.data() + recipe.breakpoints_start_;
+		const slim_position_t *bp_end = bp_iter + recipe.breakpoints_count_;
+		const SLiM_PendingMutation *mut_iter = p_chunk.mutations_.data() + recipe.mutations_start_;
+		const SLiM_PendingMutation *mut_end = mut_iter + recipe.mutations_count_;
+		slim_mutrun_index_t last_run_index = -1;
+		
+		while (true)
+		{
+			slim_position_t position;
 			
-			// Set all of the callback's parameters; note we use InitializeConstantSymbolEntry() for speed.
-			// We can use that method because we know the lifetime of the symbol table is shorter than that of
-			// the value objects, and we know that the values we are setting here will not change (the objects
-			// referred to by the values may change, but the values themselves will not change).
-			if (recombination_callback->contains_individual_)
+			if ((bp_iter != bp_end) && ((mut_iter == mut_end) || (*bp_iter < mut_iter->position_)))
 			{
-				Individual *individual = p_source_subpop->parent_individuals_[p_parent_index];
-				callback_symbols.InitializeConstantSymbolEntry(gID_individual, individual->CachedEidosValue());
+				position = *(bp_iter++);
+				
+				if (position % p_mutrun_length == 0)
+					continue;		// a breakpoint between runs just switches strands
 			}
-			if (recombination_callback->contains_genome1_)
-				callback_symbols.InitializeConstantSymbolEntry(gID_genome1, p_genome1->CachedEidosValue());
-			if (recombination_callback->contains_genome2_)
-				callback_symbols.InitializeConstantSymbolEntry(gID_genome2, p_genome2->CachedEidosValue());
-			if (recombination_callback->contains_subpop_)
-				callback_symbols.InitializeConstantSymbolEntry(gID_subpop, p_source_subpop->SymbolTableEntry().second);
+			else if (mut_iter != mut_end)
+				position = (mut_iter++)->position_;
+			else
+				break;
 			
-			// All the variable entries for the crossovers and gene conversion start/end points
-			if (recombination_callback->contains_breakpoints_)
+			slim_mutrun_index_t run_index = (slim_mutrun_index_t)(position / p_mutrun_length);
+			
+			if (run_index != last_run_index)
 			{
-				if (!local_crossovers_ptr)
-					local_crossovers_ptr = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector(p_crossovers));
-				client_symbols.SetValueForSymbolNoCopy(gID_breakpoints, local_crossovers_ptr);
+				p_chunk.new_run_count_++;
+				last_run_index = run_index;
 			}
+		}
+	}
+	
+	p_chunk.gametes_.emplace_back(recipe);
+}
+
+// Draw the parents and gamete recipes for all of the children in one chunk, using the chunk's RNG stream
+void Population::DrawOffspringChunk(Eidos_RNG_State &p_rng, SLiM_OffspringChunk &p_chunk, const std::vector<SLiM_ChildPlan> &p_plan, Subpopulation &p_subpop, Chromosome &p_chromosome, bool p_prevent_incidental_selfing)
+{
+	bool sex_enabled = p_subpop.sex_enabled_;
+	slim_position_t mutrun_length = p_subpop.child_genomes_[0]->mutrun_length_;
+	
+	p_chunk.parents_.clear();
+	p_chunk.gametes_.clear();
+	p_chunk.breakpoints_.clear();
+	p_chunk.positions_.clear();
+	p_chunk.mutations_.clear();
+	p_chunk.new_run_count_ = 0;
+	
+	for (slim_popsize_t child_index = p_chunk.child_start_; child_index < p_chunk.child_end_; ++child_index)
+	{
+		const SLiM_ChildPlan &child_plan = p_plan[child_index];
+		Subpopulation &source_subpop = *child_plan.source_subpop_;
+		slim_objectid_t source_subpop_id = source_subpop.subpopulation_id_;
+		IndividualSex child_sex = child_plan.child_sex_;
+		Genome *child_genome_1 = p_subpop.child_genomes_[2 * child_index];
+		Genome *child_genome_2 = p_subpop.child_genomes_[2 * child_index + 1];
+		slim_popsize_t parent1, parent2;
+		
+		if (child_plan.mode_ == SLiMChildMode::kCloned)
+		{
+			if (sex_enabled)
+				parent1 = (child_sex == IndividualSex::kFemale) ? source_subpop.DrawFemaleParentUsingFitness(p_rng) : source_subpop.DrawMaleParentUsingFitness(p_rng);
+			else
+				parent1 = source_subpop.DrawParentUsingFitness(p_rng);
 			
-			try
+			parent2 = parent1;
+			
+			Genome *parent_genome_1 = source_subpop.parent_genomes_[2 * parent1];
+			Genome *parent_genome_2 = source_subpop.parent_genomes_[2 * parent1 + 1];
+			
+			DrawGameteRecipe(p_rng, p_chunk, p_chromosome, child_genome_1, parent_genome_1, parent_genome_2, child_sex, true, source_subpop_id, mutrun_length);
+			DrawGameteRecipe(p_rng, p_chunk, p_chromosome, child_genome_2, parent_genome_2, parent_genome_1, child_sex, true, source_subpop_id, mutrun_length);
+		}
+		else
+		{
+			IndividualSex parent1_sex, parent2_sex;
+			
+			if (sex_enabled)
 			{
-				// Interpret the script; the result from the interpretation must be a singleton logical, T if breakpoints have been changed, F otherwise
-				EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(recombination_callback->script_);
-				EidosValue *result = result_SP.get();
-				
-				if ((result->Type() != EidosValueType::kValueLogical) || (result->Count() != 1))
-					EIDOS_TERMINATION << "ERROR (Population::ApplyRecombinationCallbacks): recombination() callbacks must provide a logical singleton return value." << EidosTerminate(recombination_callback->identifier_token_);
-				
-				eidos_logical_t breakpoints_changed = result->LogicalAtIndex(0, nullptr);
-				
-				// If the callback says that breakpoints were changed, check for an actual change in value for the variables referenced by the callback
-				if (breakpoints_changed)
-				{
-					if (recombination_callback->contains_breakpoints_)
-					{
-						EidosValue_SP new_crossovers = client_symbols.GetValueOrRaiseForSymbol(gID_breakpoints);
-						
-						if (new_crossovers != local_crossovers_ptr)
-						{
-							if (new_crossovers->Type() != EidosValueType::kValueInt)
-								EIDOS_TERMINATION << "ERROR (Population::ApplyRecombinationCallbacks): recombination() callbacks must provide output values (breakpoints) of type integer." << EidosTerminate(recombination_callback->identifier_token_);
-							
-							new_crossovers.swap(local_crossovers_ptr);
-							crossovers_changed = true;
-						}
-					}
-				}
-				
-				// Output generated by the interpreter goes to our output stream
-				interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+				parent1 = source_subpop.DrawFemaleParentUsingFitness(p_rng);
+				parent1_sex = IndividualSex::kFemale;
 			}
-			catch (...)
+			else
 			{
-				// Emit final output even on a throw, so that stop() messages and such get printed
-				interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+				parent1 = source_subpop.DrawParentUsingFitness(p_rng);
+				parent1_sex = IndividualSex::kHermaphrodite;
+			}
+			
+			if (child_plan.mode_ == SLiMChildMode::kSelfed)
+			{
+				parent2 = parent1;
+				parent2_sex = parent1_sex;
+			}
+			else if (sex_enabled)
+			{
+				parent2 = source_subpop.DrawMaleParentUsingFitness(p_rng);
+				parent2_sex = IndividualSex::kMale;
+			}
+			else
+			{
+				do
+					parent2 = source_subpop.DrawParentUsingFitness(p_rng);	// note this does not prohibit selfing!
+				while (p_prevent_incidental_selfing && (parent2 == parent1));
 				
-				throw;
+				parent2_sex = IndividualSex::kHermaphrodite;
 			}
+			
+			DrawGameteRecipe(p_rng, p_chunk, p_chromosome, child_genome_1, source_subpop.parent_genomes_[2 * parent1], source_subpop.parent_genomes_[2 * parent1 + 1], parent1_sex, false, source_subpop_id, mutrun_length);
+			DrawGameteRecipe(p_rng, p_chunk, p_chromosome, child_genome_2, source_subpop.parent_genomes_[2 * parent2], source_subpop.parent_genomes_[2 * parent2 + 1], parent2_sex, false, source_subpop_id, mutrun_length);
 		}
+		
+		p_chunk.parents_.emplace_back(parent1);
+		p_chunk.parents_.emplace_back(parent2);
 	}
+}
+
+// Return the first mutation in [p_begin, p_end) at or after p_position; mutation runs are sorted by position.  This scans linearly,
+// as the merge loops below do; the runs are short enough that independent loads beat the dependent loads of a binary search.
+static inline const MutationIndex *MutationsBefore(const Mutation *p_mut_block_ptr, const MutationIndex *p_begin, const MutationIndex *p_end, slim_position_t p_position)
+{
+	while ((p_begin != p_end) && ((p_mut_block_ptr + *p_begin)->position_ < p_position))
+		p_begin++;
 	
-	// Read out the final values of breakpoint vectors that changed
-	bool breakpoints_changed = false;
+	return p_begin;
+}
+
+// Append to p_child_run the parental mutations it inherits from p_run_1 and p_run_2, switching between them at each of the breakpoints
+// in [p_breakpoints, p_breakpoints_end), which must all fall inside the run.  The segments of the two strands are found first, with a
+// cursor for each strand; the child run's capacity is then reserved once, and each segment is appended in one bulk copy.  The segments
+// are gathered in p_segments, supplied by the caller so that it can be reused without reallocation; this is called from worker threads
+// by BuildOffspringChunk(), so each chunk has its own buffer, and the main thread uses Population::crossover_segments_.
+static void CopyCrossoverSegments(const Mutation *p_mut_block_ptr, const MutationRun *p_run_1, const MutationRun *p_run_2, const slim_position_t *p_breakpoints, const slim_position_t *p_breakpoints_end, MutationRun *p_child_run, SLiM_CrossoverSegments &p_segments)
+{
+	const MutationIndex *cursor = p_run_1->begin_pointer_const(), *cursor_end = p_run_1->end_pointer_const();
+	const MutationIndex *other_cursor = p_run_2->begin_pointer_const(), *other_cursor_end = p_run_2->end_pointer_const();
+	long inherited_count = 0;
 	
-	if (crossovers_changed)
+	p_segments.clear();
+	
+	while (true)
 	{
-		int count = local_crossovers_ptr->Count();
-		
-		p_crossovers.resize(count);		// zero-fills only new entries at the margin, so is minimally wasteful
+		const MutationIndex *segment_end = (p_breakpoints == p_breakpoints_end) ? cursor_end : MutationsBefore(p_mut_block_ptr, cursor, cursor_end, *p_breakpoints);
 		
-		if (count == 1)
-			p_crossovers[0] = (slim_position_t)local_crossovers_ptr->IntAtIndex(0, nullptr);
-		else
+		if (segment_end != cursor)
 		{
-			const EidosValue_Int_vector *new_crossover_vector = local_crossovers_ptr->IntVector();
-			const int64_t *new_crossover_data = new_crossover_vector->data();
-			slim_position_t *p_crossovers_data = p_crossovers.data();
-			
-			for (int value_index = 0; value_index < count; ++value_index)
-				p_crossovers_data[value_index] = (slim_position_t)new_crossover_data[value_index];
+			p_segments.emplace_back(cursor, segment_end);
+			inherited_count += (segment_end - cursor);
 		}
 		
-		breakpoints_changed = true;
+		if (p_breakpoints == p_breakpoints_end)
+			break;
+		
+		// switch strands, skipping the mutations in the new strand that fall before the breakpoint
+		cursor = segment_end;
+		std::swap(cursor, other_cursor);
+		std::swap(cursor_end, other_cursor_end);
+		cursor = MutationsBefore(p_mut_block_ptr, cursor, cursor_end, *(p_breakpoints++));
 	}
 	
-	sim_.executing_block_type_ = old_executing_block_type;
-	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
-	// PROFILING
-	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosRecombinationCallback)]);
-#endif
+	p_child_run->reserve(p_child_run->size() + inherited_count);
 	
-	return breakpoints_changed;
+	for (auto &segment : p_segments)
+		p_child_run->emplace_back_bulk(segment.first, segment.second - segment.first);
 }
 
-// generate a child genome from parental genomes, with recombination, gene conversion, and mutation
-void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_child_genome, slim_popsize_t p_parent_index, IndividualSex p_child_sex, IndividualSex p_parent_sex, std::vector<SLiMEidosBlock*> *p_recombination_callbacks, std::vector<SLiMEidosBlock*> *p_mutation_callbacks)
+// Build the mutation runs for all of the gametes in one chunk, following their recipes.  Runs that are unaffected by breakpoints and
+// new mutations are shared with the parent; the rest are filled in using the chunk's new_runs_.  The resulting run pointers are put
+// in child_runs_ without being retained, since refcounts are not thread-safe; the main thread installs them in the child genomes.
+void Population::BuildOffspringChunk(SLiM_OffspringChunk &p_chunk, int p_mutrun_count, slim_position_t p_mutrun_length)
 {
-	slim_popsize_t parent_genome_1_index = p_parent_index * 2;
-	slim_popsize_t parent_genome_2_index = parent_genome_1_index + 1;
-	
-	// child genome p_child_genome_index in subpopulation p_subpop_id is assigned outcome of cross-overs at breakpoints in all_breakpoints
-	// between parent genomes p_parent1_genome_index and p_parent2_genome_index from subpopulation p_source_subpop and new mutations added
-	// 
-	// example: all_breakpoints = (r1, r2)
-	// 
-	// mutations (      x < r1) assigned from p1
-	// mutations (r1 <= x < r2) assigned from p2
-	// mutations (r2 <= x     ) assigned from p1
-	
-	// A lot of the checks here are only on when DEBUG is defined.  They should absolutely never be hit; if they are, it indicates a flaw
-	// in SLiM's internal logic, not user error.  This method gets called a whole lot; every test makes a speed difference.  So disabling
-	// these checks seems to make sense.  Of course, if you want the checks on, just define DEBUG.
-	
-#if DEBUG
-	if (p_child_sex == IndividualSex::kUnspecified)
-		EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Child sex cannot be IndividualSex::kUnspecified." << EidosTerminate();
-#endif
+	Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+	MutationRun **new_run_iter = p_chunk.new_runs_.data();
 	
-	bool use_only_strand_1 = false;		// if true, we are in a case where crossover cannot occur, and we are to use only parent strand 1
-	bool do_swap = true;				// if true, we are to swap the parental strands at the beginning, either 50% of the time (if use_only_strand_1 is false), or always (if use_only_strand_1 is true – in other words, we are directed to use only strand 2)
+	p_chunk.child_runs_.resize(p_chunk.gametes_.size() * p_mutrun_count);
 	
-	GenomeType child_genome_type = p_child_genome.Type();
-	Genome *parent_genome_1 = p_source_subpop->parent_genomes_[parent_genome_1_index];
-	GenomeType parent1_genome_type = parent_genome_1->Type();
-	Genome *parent_genome_2 = p_source_subpop->parent_genomes_[parent_genome_2_index];
-	GenomeType parent2_genome_type = parent_genome_2->Type();
+	MutationRun **child_runs = p_chunk.child_runs_.data();
 	
-	if (child_genome_type == GenomeType::kAutosome)
-	{
-		// If we're modeling autosomes, we can disregard p_child_sex entirely; we don't care whether we're modeling sexual or hermaphrodite individuals
-#if DEBUG
-		if (parent1_genome_type != GenomeType::kAutosome || parent2_genome_type != GenomeType::kAutosome)
-			EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Mismatch between parent and child genome types (case 1)." << EidosTerminate();
-#endif
-	}
-	else
+	for (SLiM_GameteRecipe &recipe : p_chunk.gametes_)
 	{
-		// SEX ONLY: If we're modeling sexual individuals, then there are various degenerate cases to be considered, since X and Y don't cross over, there are null chromosomes, etc.
-#if DEBUG
-		if (p_child_sex == IndividualSex::kHermaphrodite)
-			EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): A hermaphrodite child is requested but the child genome is not autosomal." << EidosTerminate();
-		if (parent1_genome_type == GenomeType::kAutosome || parent2_genome_type == GenomeType::kAutosome)
-			EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Mismatch between parent and child genome types (case 2)." << EidosTerminate();
-#endif
-		
-		if (child_genome_type == GenomeType::kXChromosome)
+		Genome *strand = recipe.strand1_;
+		Genome *other_strand = recipe.strand2_;
+		const slim_position_t *bp_iter = p_chunk.breakpoints_.data() + recipe.breakpoints_start_;
+		const slim_position_t *bp_end = bp_iter + recipe.breakpoints_count_;
+		SLiM_PendingMutation *mut_iter = p_chunk.mutations_.data() + recipe.mutations_start_;
+		SLiM_PendingMutation *mut_end = mut_iter + recipe.mutations_count_;
+		
+		for (int run_index = 0; run_index < p_mutrun_count; ++run_index)
 		{
-			if (p_child_sex == IndividualSex::kMale)
+			slim_position_t run_start = run_index * p_mutrun_length;
+			slim_position_t run_end = run_start + p_mutrun_length;
+			
+			// breakpoints at the start of the run (i.e., between runs) just switch strands
+			while ((bp_iter != bp_end) && (*bp_iter <= run_start))
 			{
-				// If our parent is male (XY or YX), then we have a mismatch, because we're supposed to be male and we're supposed to be getting an X chromosome, but the X must come from the female
-				if (parent1_genome_type == GenomeType::kYChromosome || parent2_genome_type == GenomeType::kYChromosome)
-					EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Mismatch between parent and child genome types (case 3)." << EidosTerminate();
-				
-				// else: we're doing inheritance from the female (XX) to get our X chromosome; we treat this just like the autosomal case
+				std::swap(strand, other_strand);
+				bp_iter++;
 			}
-			else if (p_child_sex == IndividualSex::kFemale)
+			
+			bool has_breakpoint = ((bp_iter != bp_end) && (*bp_iter < run_end));
+			bool has_mutation = ((mut_iter != mut_end) && (mut_iter->position_ < run_end));
+			
+			if (!has_breakpoint && !has_mutation)
 			{
-				if (parent1_genome_type == GenomeType::kYChromosome && parent2_genome_type == GenomeType::kXChromosome)
-				{
-					// we're doing inheritance from the male (YX) to get an X chromosome; we need to ensure that we take the X
-					use_only_strand_1 = true; do_swap = true;	// use strand 2
-				}
-				else if (parent1_genome_type == GenomeType::kXChromosome && parent2_genome_type == GenomeType::kYChromosome)
-				{
-					// we're doing inheritance from the male (XY) to get an X chromosome; we need to ensure that we take the X
-					use_only_strand_1 = true; do_swap = false;	// use strand 1
-				}
-				// else: we're doing inheritance from the female (XX) to get an X chromosome; we treat this just like the autosomal case
+				*(child_runs++) = strand->mutruns_[run_index].get();
+				continue;
 			}
-		}
-		else // (child_genome_type == GenomeType::kYChromosome), so p_child_sex == IndividualSex::kMale
-		{
-			if (p_child_sex == IndividualSex::kFemale)
-				EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): A female child is requested but the child genome is a Y chromosome." << EidosTerminate();
 			
-			if (parent1_genome_type == GenomeType::kYChromosome && parent2_genome_type == GenomeType::kXChromosome)
+			if (!has_mutation)
 			{
-				// we're doing inheritance from the male (YX) to get a Y chromosome; we need to ensure that we take the Y
-				use_only_strand_1 = true; do_swap = false;	// use strand 1
+				// only breakpoints fall inside the run, so the parental segments are copied in bulk, as in DoCrossoverMutation()
+				const slim_position_t *run_bp_end = bp_iter;
+				
+				while ((run_bp_end != bp_end) && (*run_bp_end < run_end))
+					run_bp_end++;
+				
+				MutationRun *child_run = *(new_run_iter++);
+				
+				CopyCrossoverSegments(mut_block_ptr, strand->mutruns_[run_index].get(), other_strand->mutruns_[run_index].get(), bp_iter, run_bp_end, child_run, p_chunk.segments_);
+				
+				// the strand in effect at the end of the run depends on the number of breakpoints inside it
+				if ((run_bp_end - bp_iter) % 2)
+					std::swap(strand, other_strand);
+				
+				bp_iter = run_bp_end;
+				*(child_runs++) = child_run;
+				continue;
 			}
-			else if (parent1_genome_type == GenomeType::kXChromosome && parent2_genome_type == GenomeType::kYChromosome)
-			{
+			
+			// the run needs to be built, segment by segment between breakpoints; the rules here follow DoCrossoverMutation(): a
+			// breakpoint falls to the left of its position, and parental mutations precede new mutations at the same position
+			MutationRun *child_run = *(new_run_iter++);
+			const MutationIndex *parent_iter = strand->mutruns_[run_index]->begin_pointer_const();
+			const MutationIndex *parent_iter_max = strand->mutruns_[run_index]->end_pointer_const();
+			
+			while (true)
+			{
+				slim_position_t segment_end = ((bp_iter != bp_end) && (*bp_iter < run_end)) ? *bp_iter : run_end;
+				
+				while (parent_iter != parent_iter_max)
+				{
+					MutationIndex current_mutation = *parent_iter;
+					slim_position_t current_mutation_pos = (mut_block_ptr + current_mutation)->position_;
+					
+					if (current_mutation_pos >= segment_end)
+						break;
+					
+					for ( ; (mut_iter != mut_end) && (mut_iter->position_ < current_mutation_pos); ++mut_iter)
+						if ((mut_iter->accepted_ = child_run->enforce_stack_policy_for_addition(mut_iter->position_, mut_iter->mutation_type_ptr_)))
+							child_run->emplace_back(mut_iter->mutation_index_);
+					
+					child_run->emplace_back(current_mutation);
+					parent_iter++;
+				}
+				
+				for ( ; (mut_iter != mut_end) && (mut_iter->position_ < segment_end); ++mut_iter)
+					if ((mut_iter->accepted_ = child_run->enforce_stack_policy_for_addition(mut_iter->position_, mut_iter->mutation_type_ptr_)))
+						child_run->emplace_back(mut_iter->mutation_index_);
+				
+				if (segment_end == run_end)
+					break;
+				
+				// we have reached a breakpoint inside the run, so switch strands and skip over the new strand's mutations before it
+				std::swap(strand, other_strand);
+				bp_iter++;
+				
+				parent_iter = strand->mutruns_[run_index]->begin_pointer_const();
+				parent_iter_max = strand->mutruns_[run_index]->end_pointer_const();
+				
+				while ((parent_iter != parent_iter_max) && ((mut_block_ptr + *parent_iter)->position_ < segment_end))
+					parent_iter++;
+			}
+			
+			*(child_runs++) = child_run;
+		}
+	}
+}
+
+// Generate offspring for p_subpop in parallel, in the no-callback case.  The work is split into chunks of SLIM_OFFSPRING_CHUNK_SIZE
+// children, and each chunk draws from its own RNG stream, seeded from a single draw from the main RNG; the results therefore depend
+// upon the seed but not upon the number of threads, or the order in which chunks are executed.  (They do differ from the results of
+// the single-threaded code path, which makes its draws in a different order.)  There are five phases: (1) the offspring plan for
+// migration, sex, selfing, and cloning is made on the main thread, exactly as in EvolveSubpopulation(); (2) each chunk draws its
+// parents and gamete recipes in parallel; (3) the main thread makes the new Mutation objects and does pedigree tracking, in order;
+// (4) each chunk builds its child mutation runs in parallel; and (5) the main thread installs those runs in the child genomes,
+// adding accepted mutations to the registry.  Work that touches shared state – the mutation block, the MutationRun pool, refcounts,
+// the mutation registry, and pedigree IDs – is thus confined to the main thread.
+void Population::EvolveSubpopulation_Parallel(Subpopulation &p_subpop, int p_migrant_source_count, double *p_migration_rates, Subpopulation **p_migration_sources, unsigned int *p_num_migrants, slim_popsize_t p_total_female_children, slim_popsize_t p_total_male_children)
+{
+	bool pedigrees_enabled = sim_.PedigreesEnabled();
+	bool prevent_incidental_selfing = sim_.PreventIncidentalSelfing();
+	bool sex_enabled = p_subpop.sex_enabled_;
+	slim_popsize_t total_children = p_subpop.child_subpop_size_;
+	int number_of_sexes = (sex_enabled ? 2 : 1);
+	Chromosome &chromosome = sim_.TheChromosome();
+	
+	if (total_children <= 0)
+		return;
+	
+	// (1) make the offspring plan; this consumes draws from the main RNG in the same way as the single-threaded code path
+	offspring_plan_.resize(total_children);
+	
+	slim_popsize_t child_count = 0;
+	
+	for (int sex_index = 0; sex_index < number_of_sexes; ++sex_index)
+	{
+		slim_popsize_t total_children_of_sex;
+		IndividualSex child_sex;
+		
+		if (sex_enabled)
+		{
+			total_children_of_sex = ((sex_index == 0) ? p_total_female_children : p_total_male_children);
+			child_sex = ((sex_index == 0) ? IndividualSex::kFemale : IndividualSex::kMale);
+		}
+		else
+		{
+			total_children_of_sex = total_children;
+			child_sex = IndividualSex::kHermaphrodite;
+		}
+		
+		if (p_migrant_source_count == 0)
+			p_num_migrants[0] = (unsigned int)total_children_of_sex;
+		else
+			gsl_ran_multinomial(EIDOS_GSL_RNG, p_migrant_source_count + 1, (unsigned int)total_children_of_sex, p_migration_rates, p_num_migrants);
+		
+		for (int pop_count = 0; pop_count < p_migrant_source_count + 1; ++pop_count)
+		{
+			slim_popsize_t migrants_to_generate = static_cast<slim_popsize_t>(p_num_migrants[pop_count]);
+			
+			if (migrants_to_generate > 0)
+			{
+				Subpopulation *source_subpop = p_migration_sources[pop_count];
+				double selfing_fraction = sex_enabled ? 0.0 : source_subpop->selfing_fraction_;
+				double cloning_fraction = (sex_index == 0) ? source_subpop->female_clone_fraction_ : source_subpop->male_clone_fraction_;
+				slim_popsize_t number_to_self = 0, number_to_clone = 0;
+				
+				if (selfing_fraction > 0)
+				{
+					if (cloning_fraction > 0)
+					{
+						double fractions[3] = {selfing_fraction, cloning_fraction, 1.0 - (selfing_fraction + cloning_fraction)};
+						unsigned int counts[3] = {0, 0, 0};
+						
+						gsl_ran_multinomial(EIDOS_GSL_RNG, 3, (unsigned int)migrants_to_generate, fractions, counts);
+						
+						number_to_self = static_cast<slim_popsize_t>(counts[0]);
+						number_to_clone = static_cast<slim_popsize_t>(counts[1]);
+					}
+					else
+						number_to_self = static_cast<slim_popsize_t>(gsl_ran_binomial(EIDOS_GSL_RNG, selfing_fraction, (unsigned int)migrants_to_generate));
+				}
+				else if (cloning_fraction > 0)
+					number_to_clone = static_cast<slim_popsize_t>(gsl_ran_binomial(EIDOS_GSL_RNG, cloning_fraction, (unsigned int)migrants_to_generate));
+				
+				// as in EvolveSubpopulation(), clones come first, then selfed offspring, then biparental offspring
+				for (slim_popsize_t migrant_count = 0; migrant_count < migrants_to_generate; ++migrant_count)
+				{
+					SLiM_ChildPlan &child_plan = offspring_plan_[child_count++];
+					
+					child_plan.source_subpop_ = source_subpop;
+					child_plan.child_sex_ = child_sex;
+					
+					if (migrant_count < number_to_clone)
+						child_plan.mode_ = SLiMChildMode::kCloned;
+					else if (migrant_count < number_to_clone + number_to_self)
+						child_plan.mode_ = SLiMChildMode::kSelfed;
+					else
+						child_plan.mode_ = SLiMChildMode::kBiparental;
+				}
+			}
+		}
+	}
+	
+	// set up the chunks, and the per-thread RNG streams; a single draw from the main RNG seeds the streams for all of the chunks
+	int chunk_count = (total_children + SLIM_OFFSPRING_CHUNK_SIZE - 1) / SLIM_OFFSPRING_CHUNK_SIZE;
+	int thread_count = std::min(gEidosMaxThreads, chunk_count);
+	uint64_t stream_base = Eidos_MT64_genrand64_int64();
+	
+#ifndef _OPENMP
+	thread_count = 1;
+#endif
+	
+	if ((int)offspring_chunks_.size() < chunk_count)
+		offspring_chunks_.resize(chunk_count);
+	
+	for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		SLiM_OffspringChunk &chunk = offspring_chunks_[chunk_index];
+		
+		chunk.child_start_ = chunk_index * SLIM_OFFSPRING_CHUNK_SIZE;
+		chunk.child_end_ = std::min(chunk.child_start_ + SLIM_OFFSPRING_CHUNK_SIZE, total_children);
+		chunk.exception_ = nullptr;
+	}
+	
+	Eidos_PrepareRNGStreams(thread_count);
+	
+	// (2) draw parents and gamete recipes for each chunk, in parallel; each chunk reseeds the current thread's stream with its own seed
+#pragma omp parallel num_threads(thread_count)
+	{
+#ifdef _OPENMP
+		Eidos_RNG_State &rng = Eidos_RNGStream(omp_get_thread_num());
+#else
+		Eidos_RNG_State &rng = Eidos_RNGStream(0);
+#endif
+		
+#pragma omp for schedule(dynamic, 1)
+		for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+		{
+			SLiM_OffspringChunk &chunk = offspring_chunks_[chunk_index];
+			
+			try {
+				Eidos_SeedRNGStream(rng, stream_base, chunk_index);
+				DrawOffspringChunk(rng, chunk, offspring_plan_, p_subpop, chromosome, prevent_incidental_selfing);
+			} catch (...) {
+				chunk.exception_ = std::current_exception();
+			}
+		}
+	}
+	
+	for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+		if (offspring_chunks_[chunk_index].exception_)
+			std::rethrow_exception(offspring_chunks_[chunk_index].exception_);
+	
+	// (3) on the main thread, in chunk order: make the new mutations, take empty runs from the pool, and track parentage
+	slim_generation_t generation = sim_.Generation();
+	
+	for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		SLiM_OffspringChunk &chunk = offspring_chunks_[chunk_index];
+		
+		for (SLiM_PendingMutation &pending : chunk.mutations_)
+		{
+			MutationIndex new_mut_index = SLiM_NewMutationFromBlock();
+			
+			new (gSLiM_Mutation_Block + new_mut_index) Mutation(pending.mutation_type_ptr_, pending.position_, pending.selection_coeff_, pending.subpop_id_, generation, -1);
+			pending.mutation_index_ = new_mut_index;
+			pending.accepted_ = false;
+		}
+		
+		chunk.new_runs_.resize(chunk.new_run_count_);
+		
+		for (int32_t run_index = 0; run_index < chunk.new_run_count_; ++run_index)
+			chunk.new_runs_[run_index] = MutationRun::NewMutationRun();
+		
+		for (slim_popsize_t child_index = chunk.child_start_; child_index < chunk.child_end_; ++child_index)
+		{
+			Individual *new_child = p_subpop.child_individuals_[child_index];
+			Subpopulation *source_subpop = offspring_plan_[child_index].source_subpop_;
+			
+			new_child->migrant_ = (source_subpop != &p_subpop);
+			
+			if (pedigrees_enabled)
+			{
+				slim_popsize_t parent_offset = 2 * (child_index - chunk.child_start_);
+				
+				new_child->TrackParentage(*source_subpop->parent_individuals_[chunk.parents_[parent_offset]], *source_subpop->parent_individuals_[chunk.parents_[parent_offset + 1]]);
+			}
+		}
+	}
+	
+	// (4) build the child mutation runs for each chunk, in parallel
+	int mutrun_count = p_subpop.child_genomes_[0]->mutrun_count_;
+	slim_position_t mutrun_length = p_subpop.child_genomes_[0]->mutrun_length_;
+	
+#pragma omp parallel for schedule(dynamic, 1) num_threads(thread_count)
+	for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+		BuildOffspringChunk(offspring_chunks_[chunk_index], mutrun_count, mutrun_length);
+	
+	// (5) on the main thread, in chunk order: install the runs in the child genomes (retaining them), and register the new mutations
+	bool unique_new_mutruns = sim_.UniqueNewMutationRuns();
+	
+	for (int chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		SLiM_OffspringChunk &chunk = offspring_chunks_[chunk_index];
+		MutationRun **child_runs = chunk.child_runs_.data();
+		
+		for (SLiM_GameteRecipe &recipe : chunk.gametes_)
+		{
+			Genome *child_genome = recipe.child_genome_;
+			
+			for (int run_index = 0; run_index < mutrun_count; ++run_index)
+				child_genome->mutruns_[run_index].reset(*(child_runs++));
+			
+			if (unique_new_mutruns)
+				UniqueNewMutationRuns(*child_genome);
+		}
+		
+		for (SLiM_PendingMutation &pending : chunk.mutations_)
+		{
+			Mutation *new_mut = gSLiM_Mutation_Block + pending.mutation_index_;
+			
+			if (pending.accepted_)
+				MutationRegistryAdd(new_mut);
+			else
+				new_mut->Release();		// rejected by the stacking policy
+		}
+		
+		chunk.new_runs_.clear();
+	}
+}
+#endif	// SLIM_WF_ONLY
+
+// apply recombination() callbacks to a generated child; a return of true means breakpoints were changed
+bool Population::ApplyRecombinationCallbacks(slim_popsize_t p_parent_index, Genome *p_genome1, Genome *p_genome2, Subpopulation *p_source_subpop, std::vector<slim_position_t> &p_crossovers, std::vector<SLiMEidosBlock*> &p_recombination_callbacks)
+{
+#if (SLIMPROFILING == 1)
+	// PROFILING
+	SLIM_PROFILE_BLOCK_START();
+#endif
+	
+	// note the focal child during the callback, so we can prevent illegal operations during the callback
+	SLiMEidosBlockType old_executing_block_type = sim_.executing_block_type_;
+	sim_.executing_block_type_ = SLiMEidosBlockType::SLiMEidosRecombinationCallback;
+	
+	bool crossovers_changed = false;
+	EidosValue_SP local_crossovers_ptr;
+	
+	for (SLiMEidosBlock *recombination_callback : p_recombination_callbacks)
+	{
+		if (recombination_callback->active_)
+		{
+			// The callback is active, so we need to execute it
+			EidosSymbolTable callback_symbols(EidosSymbolTableType::kContextConstantsTable, &sim_.SymbolTable());
+			EidosSymbolTable client_symbols(EidosSymbolTableType::kLocalVariablesTable, &callback_symbols);
+			EidosFunctionMap &function_map = sim_.FunctionMap();
+			EidosInterpreter interpreter(recombination_callback->compound_statement_node_, client_symbols, function_map, &sim_);
+			
+			if (recombination_callback->contains_self_)
+				callback_symbols.InitializeConstantSymbolEntry(recombination_callback->SelfSymbolTableEntry());		// define "self"
+			
+			// Set all of the callback's parameters; note we use InitializeConstantSymbolEntry() for speed.
+			// We can use that method because we know the lifetime of the symbol table is shorter than that of
+			// the value objects, and we know that the values we are setting here will not change (the objects
+			// referred to by the values may change, but the values themselves will not change).
+			if (recombination_callback->contains_individual_)
+			{
+				Individual *individual = p_source_subpop->parent_individuals_[p_parent_index];
+				callback_symbols.InitializeConstantSymbolEntry(gID_individual, individual->CachedEidosValue());
+			}
+			if (recombination_callback->contains_genome1_)
+				callback_symbols.InitializeConstantSymbolEntry(gID_genome1, p_genome1->CachedEidosValue());
+			if (recombination_callback->contains_genome2_)
+				callback_symbols.InitializeConstantSymbolEntry(gID_genome2, p_genome2->CachedEidosValue());
+			if (recombination_callback->contains_subpop_)
+				callback_symbols.InitializeConstantSymbolEntry(gID_subpop, p_source_subpop->SymbolTableEntry().second);
+			
+			// All the variable entries for the crossovers and gene conversion start/end points
+			if (recombination_callback->contains_breakpoints_)
+			{
+				if (!local_crossovers_ptr)
+					local_crossovers_ptr = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector(p_crossovers));
+				client_symbols.SetValueForSymbolNoCopy(gID_breakpoints, local_crossovers_ptr);
+			}
+			
+			try
+			{
+				// Interpret the script; the result from the interpretation must be a singleton logical, T if breakpoints have been changed, F otherwise
+				EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(recombination_callback->script_);
+				EidosValue *result = result_SP.get();
+				
+				if ((result->Type() != EidosValueType::kValueLogical) || (result->Count() != 1))
+					EIDOS_TERMINATION << "ERROR (Population::ApplyRecombinationCallbacks): recombination() callbacks must provide a logical singleton return value." << EidosTerminate(recombination_callback->identifier_token_);
+				
+				eidos_logical_t breakpoints_changed = result->LogicalAtIndex(0, nullptr);
+				
+				// If the callback says that breakpoints were changed, check for an actual change in value for the variables referenced by the callback
+				if (breakpoints_changed)
+				{
+					if (recombination_callback->contains_breakpoints_)
+					{
+						EidosValue_SP new_crossovers = client_symbols.GetValueOrRaiseForSymbol(gID_breakpoints);
+						
+						if (new_crossovers != local_crossovers_ptr)
+						{
+							if (new_crossovers->Type() != EidosValueType::kValueInt)
+								EIDOS_TERMINATION << "ERROR (Population::ApplyRecombinationCallbacks): recombination() callbacks must provide output values (breakpoints) of type integer." << EidosTerminate(recombination_callback->identifier_token_);
+							
+							new_crossovers.swap(local_crossovers_ptr);
+							crossovers_changed = true;
+						}
+					}
+				}
+				
+				// Output generated by the interpreter goes to our output stream
+				interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+			}
+			catch (...)
+			{
+				// Emit final output even on a throw, so that stop() messages and such get printed
+				interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+				
+				throw;
+			}
+		}
+	}
+	
+	// Read out the final values of breakpoint vectors that changed
+	bool breakpoints_changed = false;
+	
+	if (crossovers_changed)
+	{
+		int count = local_crossovers_ptr->Count();
+		
+		p_crossovers.resize(count);		// zero-fills only new entries at the margin, so is minimally wasteful
+		
+		if (count == 1)
+			p_crossovers[0] = (slim_position_t)local_crossovers_ptr->IntAtIndex(0, nullptr);
+		else
+		{
+			const EidosValue_Int_vector *new_crossover_vector = local_crossovers_ptr->IntVector();
+			const int64_t *new_crossover_data = new_crossover_vector->data();
+			slim_position_t *p_crossovers_data = p_crossovers.data();
+			
+			for (int value_index = 0; value_index < count; ++value_index)
+				p_crossovers_data[value_index] = (slim_position_t)new_crossover_data[value_index];
+		}
+		
+		breakpoints_changed = true;
+	}
+	
+	sim_.executing_block_type_ = old_executing_block_type;
+	
+#if (SLIMPROFILING == 1)
+	// PROFILING
+	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosRecombinationCallback)]);
+#endif
+	
+	return breakpoints_changed;
+}
+
+// Return the index just past the breakpoints in p_breakpoints, starting at p_break_index, that fall inside the run ending at p_run_end
+static inline int RunBreakpointsEnd(const std::vector<slim_position_t> &p_breakpoints, int p_break_index, slim_position_t p_run_end)
+{
+	int break_index_max = (int)p_breakpoints.size();
+	
+	while ((p_break_index < break_index_max) && (p_breakpoints[p_break_index] < p_run_end))
+		p_break_index++;
+	
+	return p_break_index;
+}
+
+// Count the new mutations in [p_begin, p_end) that fall before p_run_end; they are sorted by position
+static inline int32_t CountNewMutationsInRun(const Mutation *p_mut_block_ptr, const MutationIndex *p_begin, const MutationIndex *p_end, slim_position_t p_run_end)
+{
+	int32_t count = 0;
+	
+	while ((p_begin != p_end) && ((p_mut_block_ptr + *(p_begin++))->position_ < p_run_end))
+		count++;
+	
+	return count;
+}
+
+// generate a child genome from parental genomes, with recombination, gene conversion, and mutation
+void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_child_genome, slim_popsize_t p_parent_index, IndividualSex p_child_sex, IndividualSex p_parent_sex, std::vector<SLiMEidosBlock*> *p_recombination_callbacks, std::vector<SLiMEidosBlock*> *p_mutation_callbacks)
+{
+	slim_popsize_t parent_genome_1_index = p_parent_index * 2;
+	slim_popsize_t parent_genome_2_index = parent_genome_1_index + 1;
+	
+	// child genome p_child_genome_index in subpopulation p_subpop_id is assigned outcome of cross-overs at breakpoints in all_breakpoints
+	// between parent genomes p_parent1_genome_index and p_parent2_genome_index from subpopulation p_source_subpop and new mutations added
+	// 
+	// example: all_breakpoints = (r1, r2)
+	// 
+	// mutations (      x < r1) assigned from p1
+	// mutations (r1 <= x < r2) assigned from p2
+	// mutations (r2 <= x     ) assigned from p1
+	
+	// A lot of the checks here are only on when DEBUG is defined.  They should absolutely never be hit; if they are, it indicates a flaw
+	// in SLiM's internal logic, not user error.  This method gets called a whole lot; every test makes a speed difference.  So disabling
+	// these checks seems to make sense.  Of course, if you want the checks on, just define DEBUG.
+	
+#if DEBUG
+	if (p_child_sex == IndividualSex::kUnspecified)
+		EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Child sex cannot be IndividualSex::kUnspecified." << EidosTerminate();
+#endif
+	
+	bool use_only_strand_1 = false;		// if true, we are in a case where crossover cannot occur, and we are to use only parent strand 1
+	bool do_swap = true;				// if true, we are to swap the parental strands at the beginning, either 50% of the time (if use_only_strand_1 is false), or always (if use_only_strand_1 is true – in other words, we are directed to use only strand 2)
+	
+	GenomeType child_genome_type = p_child_genome.Type();
+	Genome *parent_genome_1 = p_source_subpop->parent_genomes_[parent_genome_1_index];
+	GenomeType parent1_genome_type = parent_genome_1->Type();
+	Genome *parent_genome_2 = p_source_subpop->parent_genomes_[parent_genome_2_index];
+	GenomeType parent2_genome_type = parent_genome_2->Type();
+	
+	if (child_genome_type == GenomeType::kAutosome)
+	{
+		// If we're modeling autosomes, we can disregard p_child_sex entirely; we don't care whether we're modeling sexual or hermaphrodite individuals
+#if DEBUG
+		if (parent1_genome_type != GenomeType::kAutosome || parent2_genome_type != GenomeType::kAutosome)
+			EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Mismatch between parent and child genome types (case 1)." << EidosTerminate();
+#endif
+	}
+	else
+	{
+		// SEX ONLY: If we're modeling sexual individuals, then there are various degenerate cases to be considered, since X and Y don't cross over, there are null chromosomes, etc.
+#if DEBUG
+		if (p_child_sex == IndividualSex::kHermaphrodite)
+			EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): A hermaphrodite child is requested but the child genome is not autosomal." << EidosTerminate();
+		if (parent1_genome_type == GenomeType::kAutosome || parent2_genome_type == GenomeType::kAutosome)
+			EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Mismatch between parent and child genome types (case 2)." << EidosTerminate();
+#endif
+		
+		if (child_genome_type == GenomeType::kXChromosome)
+		{
+			if (p_child_sex == IndividualSex::kMale)
+			{
+				// If our parent is male (XY or YX), then we have a mismatch, because we're supposed to be male and we're supposed to be getting an X chromosome, but the X must come from the female
+				if (parent1_genome_type == GenomeType::kYChromosome || parent2_genome_type == GenomeType::kYChromosome)
+					EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): Mismatch between parent and child genome types (case 3)." << EidosTerminate();
+				
+				// else: we're doing inheritance from the female (XX) to get our X chromosome; we treat this just like the autosomal case
+			}
+			else if (p_child_sex == IndividualSex::kFemale)
+			{
+				if (parent1_genome_type == GenomeType::kYChromosome && parent2_genome_type == GenomeType::kXChromosome)
+				{
+					// we're doing inheritance from the male (YX) to get an X chromosome; we need to ensure that we take the X
+					use_only_strand_1 = true; do_swap = true;	// use strand 2
+				}
+				else if (parent1_genome_type == GenomeType::kXChromosome && parent2_genome_type == GenomeType::kYChromosome)
+				{
+					// we're doing inheritance from the male (XY) to get an X chromosome; we need to ensure that we take the X
+					use_only_strand_1 = true; do_swap = false;	// use strand 1
+				}
+				// else: we're doing inheritance from the female (XX) to get an X chromosome; we treat this just like the autosomal case
+			}
+		}
+		else // (child_genome_type == GenomeType::kYChromosome), so p_child_sex == IndividualSex::kMale
+		{
+			if (p_child_sex == IndividualSex::kFemale)
+				EIDOS_TERMINATION << "ERROR (Population::DoCrossoverMutation): A female child is requested but the child genome is a Y chromosome." << EidosTerminate();
+			
+			if (parent1_genome_type == GenomeType::kYChromosome && parent2_genome_type == GenomeType::kXChromosome)
+			{
+				// we're doing inheritance from the male (YX) to get a Y chromosome; we need to ensure that we take the Y
+				use_only_strand_1 = true; do_swap = false;	// use strand 1
+			}
+			else if (parent1_genome_type == GenomeType::kXChromosome && parent2_genome_type == GenomeType::kYChromosome)
+			{
 				// we're doing inheritance from the male (XY) to get an X chromosome; we need to ensure that we take the Y
 				use_only_strand_1 = true; do_swap = true;	// use strand 2
 			}
@@ -2397,63 +3016,29 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 				// The break occurs to the left of the base position of the breakpoint; check whether that is between runs
 				if (breakpoint > break_mutrun_index * mutrun_length)
 				{
-					// The breakpoint occurs *inside* the run, so process the run by copying mutations and switching strands
+					// The breakpoint occurs *inside* the run, so the run is built from segments of the two parental runs, switching strands at
+					// each breakpoint inside the run; we reserve the child run's capacity once, and then copy each segment in bulk
 					int this_mutrun_index = first_uncompleted_mutrun;
-					const MutationIndex *parent1_iter		= parent_genome_1->mutruns_[this_mutrun_index]->begin_pointer_const();
-					const MutationIndex *parent2_iter		= parent_genome_2->mutruns_[this_mutrun_index]->begin_pointer_const();
-					const MutationIndex *parent1_iter_max	= parent_genome_1->mutruns_[this_mutrun_index]->end_pointer_const();
-					const MutationIndex *parent2_iter_max	= parent_genome_2->mutruns_[this_mutrun_index]->end_pointer_const();
-					const MutationIndex *parent_iter		= parent1_iter;
-					const MutationIndex *parent_iter_max	= parent1_iter_max;
+					int run_break_index_max = RunBreakpointsEnd(all_breakpoints, break_index, (this_mutrun_index + 1) * mutrun_length);
+					const slim_position_t *run_breakpoints = all_breakpoints.data() + break_index;
+					const slim_position_t *run_breakpoints_end = all_breakpoints.data() + run_break_index_max;
+					const MutationRun *parent1_run = parent_genome_1->mutruns_[this_mutrun_index].get();
+					const MutationRun *parent2_run = parent_genome_2->mutruns_[this_mutrun_index].get();
 					MutationRun *child_mutrun = p_child_genome.WillCreateRun(this_mutrun_index);
 					
-					while (true)
+					CopyCrossoverSegments(mut_block_ptr, parent1_run, parent2_run, run_breakpoints, run_breakpoints_end, child_mutrun, crossover_segments_);
+					
+					// an odd number of breakpoints inside the run leaves us on the other strand
+					if ((run_break_index_max - break_index) & 1)
 					{
-						// while there are still old mutations in the parent before the current breakpoint...
-						while (parent_iter != parent_iter_max)
-						{
-							MutationIndex current_mutation = *parent_iter;
-							
-							if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
-								break;
-							
-							// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
-							child_mutrun->emplace_back(current_mutation);
-							
-							parent_iter++;
-						}
-						
-						// we have reached the breakpoint, so swap parents; we want the "current strand" variables to change, so no std::swap()
-						parent1_iter = parent2_iter;	parent1_iter_max = parent2_iter_max;	parent_genome_1 = parent_genome_2;
-						parent2_iter = parent_iter;		parent2_iter_max = parent_iter_max;		parent_genome_2 = parent_genome;
-						parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = parent_genome_1;
-						
-						// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-						while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
-							parent_iter++;
-						
-						// we have now handled the current breakpoint, so move on to the next breakpoint; advance the enclosing for loop here
-						break_index++;
-						
-						// if we just handled the last breakpoint, which is guaranteed to be at or beyond lastPosition+1, then we are done
-						if (break_index == break_index_max)
-							break;
-						
-						// otherwise, figure out the new breakpoint, and continue looping on the current mutation run, which needs to be finished
-						breakpoint = all_breakpoints[break_index];
-						break_mutrun_index = (slim_mutrun_index_t)(breakpoint / mutrun_length);
-						
-						// if the next breakpoint is outside this mutation run, then finish the run and break out
-						if (break_mutrun_index > this_mutrun_index)
-						{
-							while (parent_iter != parent_iter_max)
-								child_mutrun->emplace_back(*(parent_iter++));
-							
-							break_index--;	// the outer loop will want to handle the current breakpoint again at the mutation-run level
-							break;
-						}
+						parent_genome_1 = parent_genome_2;
+						parent_genome_2 = parent_genome;
+						parent_genome = parent_genome_1;
 					}
 					
+					// the enclosing for loop will advance to the first breakpoint after this run
+					break_index = run_break_index_max - 1;
+					
 					// We have completed this run
 					++first_uncompleted_mutrun;
 				}
@@ -2571,6 +3156,9 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 				const MutationIndex *parent_iter_max	= parent_genome->mutruns_[this_mutrun_index]->end_pointer_const();
 				MutationRun *child_mutrun = p_child_genome.WillCreateRun(this_mutrun_index);
 				
+				// reserve the child run's capacity once, for the parental run and the new mutations in the run
+				child_mutrun->reserve((parent_iter_max - parent_iter) + CountNewMutationsInRun(mut_block_ptr, mutation_iter, mutation_iter_max, (this_mutrun_index + 1) * mutrun_length));
+				
 				// add any additional new mutations that occur before the end of the mutation run; there is at least one
 				do
 				{
@@ -2716,6 +3304,10 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 						// =====  this_mutrun_index has both breakpoint(s) and new mutation(s); this is the really nasty case
 						//
 						
+						// reserve the child run's capacity once, for a strand's worth of parental mutations and the new mutations in the run; counting
+						// exactly what the child inherits would cost a second pass over the parental mutations, so this is only an estimate
+						child_mutrun->reserve((parent_iter_max - parent_iter) + CountNewMutationsInRun(mut_block_ptr, mutation_iter, mutation_iter_max, (this_mutrun_index + 1) * mutrun_length));
+						
 						while (true)
 						{
 							// while there are still old mutations in the parent before the current breakpoint...
@@ -2836,56 +3428,35 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 					else
 					{
 						//
-						// =====  this_mutrun_index has only breakpoint(s), no new mutations
+						// =====  this_mutrun_index has only breakpoint(s), no new mutations; the segments between breakpoints are copied in bulk
 						//
 						
-						while (true)
+						int run_break_index_max = RunBreakpointsEnd(all_breakpoints, break_index, (this_mutrun_index + 1) * mutrun_length);
+						const slim_position_t *run_breakpoints = all_breakpoints.data() + break_index;
+						const slim_position_t *run_breakpoints_end = all_breakpoints.data() + run_break_index_max;
+						const MutationRun *parent1_run = parent_genome_1->mutruns_[this_mutrun_index].get();
+						const MutationRun *parent2_run = parent_genome_2->mutruns_[this_mutrun_index].get();
+						
+						CopyCrossoverSegments(mut_block_ptr, parent1_run, parent2_run, run_breakpoints, run_breakpoints_end, child_mutrun, crossover_segments_);
+						
+						// an odd number of breakpoints inside the run leaves us on the other strand
+						if ((run_break_index_max - break_index) & 1)
 						{
-							// while there are still old mutations in the parent before the current breakpoint...
-							while (parent_iter != parent_iter_max)
-							{
-								MutationIndex current_mutation = *parent_iter;
-								
-								if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
-									break;
-								
-								// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
-								child_mutrun->emplace_back(current_mutation);
-								
-								parent_iter++;
-							}
-							
-							// we have reached the breakpoint, so swap parents; we want the "current strand" variables to change, so no std::swap()
-							parent1_iter = parent2_iter;	parent1_iter_max = parent2_iter_max;	parent_genome_1 = parent_genome_2;
-							parent2_iter = parent_iter;		parent2_iter_max = parent_iter_max;		parent_genome_2 = parent_genome;
-							parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = parent_genome_1;
-							
-							// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-							while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
-								parent_iter++;
-							
-							// we have now handled the current breakpoint, so move on; if we just handled the last breakpoint, then we are done
-							if (++break_index == break_index_max)
-								break;
-							
-							// otherwise, figure out the new breakpoint, and continue looping on the current mutation run, which needs to be finished
-							breakpoint = all_breakpoints[break_index];
-							break_mutrun_index = (slim_mutrun_index_t)(breakpoint / mutrun_length);
-							
-							// if the next breakpoint is outside this mutation run, then finish the run and break out
-							if (break_mutrun_index > this_mutrun_index)
-							{
-								while (parent_iter != parent_iter_max)
-									child_mutrun->emplace_back(*(parent_iter++));
-								
-								break;	// the outer loop will want to handle this breakpoint again at the mutation-run level
-							}
+							parent_genome_1 = parent_genome_2;
+							parent_genome_2 = parent_genome;
+							parent_genome = parent_genome_1;
 						}
 						
 						// if we just handled the last breakpoint, which is guaranteed to be at or beyond lastPosition+1, then we are done
+						break_index = run_break_index_max;
+						
 						if (break_index == break_index_max)
 							break;
 						
+						// otherwise, the next breakpoint lies beyond this run; the outer loop will handle it at the mutation-run level
+						breakpoint = all_breakpoints[break_index];
+						break_mutrun_index = (slim_mutrun_index_t)(breakpoint / mutrun_length);
+						
 						// We have completed this run
 						++first_uncompleted_mutrun;
 					}
@@ -2896,6 +3467,9 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 					// =====  this_mutrun_index has only new mutation(s), no breakpoints
 					//
 					
+					// reserve the child run's capacity once, for the parental run and the new mutations in the run
+					child_mutrun->reserve((parent_iter_max - parent_iter) + CountNewMutationsInRun(mut_block_ptr, mutation_iter, mutation_iter_max, (this_mutrun_index + 1) * mutrun_length));
+					
 					// add any additional new mutations that occur before the end of the mutation run; there is at least one
 					do
 					{
@@ -2972,6 +3546,9 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 	
 	if (heteroduplex.size() > 0)
 		DoHeteroduplexRepair(heteroduplex, all_breakpoints, parent_genome_1, parent_genome_2, &p_child_genome);
+	
+	if (sim_.UniqueNewMutationRuns())
+		UniqueNewMutationRuns(p_child_genome);
 }
 
 void Population::DoHeteroduplexRepair(std::vector<slim_position_t> &p_heteroduplex, std::vector<slim_position_t> &p_breakpoints, Genome *p_parent_genome_1, Genome *p_parent_genome_2, Genome *p_child_genome)
@@ -3417,63 +3994,29 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 			// The break occurs to the left of the base position of the breakpoint; check whether that is between runs
 			if (breakpoint > break_mutrun_index * mutrun_length)
 			{
-				// The breakpoint occurs *inside* the run, so process the run by copying mutations and switching strands
+				// The breakpoint occurs *inside* the run, so the run is built from segments of the two parental runs, switching strands at
+				// each breakpoint inside the run; we reserve the child run's capacity once, and then copy each segment in bulk
 				int this_mutrun_index = first_uncompleted_mutrun;
-				const MutationIndex *parent1_iter		= p_parent_genome_1->mutruns_[this_mutrun_index]->begin_pointer_const();
-				const MutationIndex *parent2_iter		= p_parent_genome_2->mutruns_[this_mutrun_index]->begin_pointer_const();
-				const MutationIndex *parent1_iter_max	= p_parent_genome_1->mutruns_[this_mutrun_index]->end_pointer_const();
-				const MutationIndex *parent2_iter_max	= p_parent_genome_2->mutruns_[this_mutrun_index]->end_pointer_const();
-				const MutationIndex *parent_iter		= parent1_iter;
-				const MutationIndex *parent_iter_max	= parent1_iter_max;
+				int run_break_index_max = RunBreakpointsEnd(p_breakpoints, break_index, (this_mutrun_index + 1) * mutrun_length);
+				const slim_position_t *run_breakpoints = p_breakpoints.data() + break_index;
+				const slim_position_t *run_breakpoints_end = p_breakpoints.data() + run_break_index_max;
+				const MutationRun *parent1_run = p_parent_genome_1->mutruns_[this_mutrun_index].get();
+				const MutationRun *parent2_run = p_parent_genome_2->mutruns_[this_mutrun_index].get();
 				MutationRun *child_mutrun = p_child_genome.WillCreateRun(this_mutrun_index);
 				
-				while (true)
+				CopyCrossoverSegments(mut_block_ptr, parent1_run, parent2_run, run_breakpoints, run_breakpoints_end, child_mutrun, crossover_segments_);
+				
+				// an odd number of breakpoints inside the run leaves us on the other strand
+				if ((run_break_index_max - break_index) & 1)
 				{
-					// while there are still old mutations in the parent before the current breakpoint...
-					while (parent_iter != parent_iter_max)
-					{
-						MutationIndex current_mutation = *parent_iter;
-						
-						if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
-							break;
-						
-						// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
-						child_mutrun->emplace_back(current_mutation);
-						
-						parent_iter++;
-					}
-					
-					// we have reached the breakpoint, so swap parents; we want the "current strand" variables to change, so no std::swap()
-					parent1_iter = parent2_iter;	parent1_iter_max = parent2_iter_max;	p_parent_genome_1 = p_parent_genome_2;
-					parent2_iter = parent_iter;		parent2_iter_max = parent_iter_max;		p_parent_genome_2 = parent_genome;
-					parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = p_parent_genome_1;
-					
-					// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-					while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
-						parent_iter++;
-					
-					// we have now handled the current breakpoint, so move on to the next breakpoint; advance the enclosing for loop here
-					break_index++;
-					
-					// if we just handled the last breakpoint, which is guaranteed to be at or beyond lastPosition+1, then we are done
-					if (break_index == break_index_max)
-						break;
-					
-					// otherwise, figure out the new breakpoint, and continue looping on the current mutation run, which needs to be finished
-					breakpoint = p_breakpoints[break_index];
-					break_mutrun_index = (slim_mutrun_index_t)(breakpoint / mutrun_length);
-					
-					// if the next breakpoint is outside this mutation run, then finish the run and break out
-					if (break_mutrun_index > this_mutrun_index)
-					{
-						while (parent_iter != parent_iter_max)
-							child_mutrun->emplace_back(*(parent_iter++));
-						
-						break_index--;	// the outer loop will want to handle the current breakpoint again at the mutation-run level
-						break;
-					}
+					p_parent_genome_1 = p_parent_genome_2;
+					p_parent_genome_2 = parent_genome;
+					parent_genome = p_parent_genome_1;
 				}
 				
+				// the enclosing for loop will advance to the first breakpoint after this run
+				break_index = run_break_index_max - 1;
+				
 				// We have completed this run
 				++first_uncompleted_mutrun;
 			}
@@ -3639,6 +4182,10 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 					// =====  this_mutrun_index has both breakpoint(s) and new mutation(s); this is the really nasty case
 					//
 					
+					// reserve the child run's capacity once, for a strand's worth of parental mutations and the new mutations in the run; counting
+					// exactly what the child inherits would cost a second pass over the parental mutations, so this is only an estimate
+					child_mutrun->reserve((parent_iter_max - parent_iter) + CountNewMutationsInRun(mut_block_ptr, mutation_iter, mutation_iter_max, (this_mutrun_index + 1) * mutrun_length));
+					
 					while (true)
 					{
 						// while there are still old mutations in the parent before the current breakpoint...
@@ -3759,56 +4306,35 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 				else
 				{
 					//
-					// =====  this_mutrun_index has only breakpoint(s), no new mutations
+					// =====  this_mutrun_index has only breakpoint(s), no new mutations; the segments between breakpoints are copied in bulk
 					//
 					
-					while (true)
+					int run_break_index_max = RunBreakpointsEnd(p_breakpoints, break_index, (this_mutrun_index + 1) * mutrun_length);
+					const slim_position_t *run_breakpoints = p_breakpoints.data() + break_index;
+					const slim_position_t *run_breakpoints_end = p_breakpoints.data() + run_break_index_max;
+					const MutationRun *parent1_run = p_parent_genome_1->mutruns_[this_mutrun_index].get();
+					const MutationRun *parent2_run = p_parent_genome_2->mutruns_[this_mutrun_index].get();
+					
+					CopyCrossoverSegments(mut_block_ptr, parent1_run, parent2_run, run_breakpoints, run_breakpoints_end, child_mutrun, crossover_segments_);
+					
+					// an odd number of breakpoints inside the run leaves us on the other strand
+					if ((run_break_index_max - break_index) & 1)
 					{
-						// while there are still old mutations in the parent before the current breakpoint...
-						while (parent_iter != parent_iter_max)
-						{
-							MutationIndex current_mutation = *parent_iter;
-							
-							if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
-								break;
-							
-							// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
-							child_mutrun->emplace_back(current_mutation);
-							
-							parent_iter++;
-						}
-						
-						// we have reached the breakpoint, so swap parents; we want the "current strand" variables to change, so no std::swap()
-						parent1_iter = parent2_iter;	parent1_iter_max = parent2_iter_max;	p_parent_genome_1 = p_parent_genome_2;
-						parent2_iter = parent_iter;		parent2_iter_max = parent_iter_max;		p_parent_genome_2 = parent_genome;
-						parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = p_parent_genome_1;
-						
-						// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-						while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
-							parent_iter++;
-						
-						// we have now handled the current breakpoint, so move on; if we just handled the last breakpoint, then we are done
-						if (++break_index == break_index_max)
-							break;
-						
-						// otherwise, figure out the new breakpoint, and continue looping on the current mutation run, which needs to be finished
-						breakpoint = p_breakpoints[break_index];
-						break_mutrun_index = (slim_mutrun_index_t)(breakpoint / mutrun_length);
-						
-						// if the next breakpoint is outside this mutation run, then finish the run and break out
-						if (break_mutrun_index > this_mutrun_index)
-						{
-							while (parent_iter != parent_iter_max)
-								child_mutrun->emplace_back(*(parent_iter++));
-							
-							break;	// the outer loop will want to handle this breakpoint again at the mutation-run level
-						}
+						p_parent_genome_1 = p_parent_genome_2;
+						p_parent_genome_2 = parent_genome;
+						parent_genome = p_parent_genome_1;
 					}
 					
 					// if we just handled the last breakpoint, which is guaranteed to be at or beyond lastPosition+1, then we are done
+					break_index = run_break_index_max;
+					
 					if (break_index == break_index_max)
 						break;
 					
+					// otherwise, the next breakpoint lies beyond this run; the outer loop will handle it at the mutation-run level
+					breakpoint = p_breakpoints[break_index];
+					break_mutrun_index = (slim_mutrun_index_t)(breakpoint / mutrun_length);
+					
 					// We have completed this run
 					++first_uncompleted_mutrun;
 				}
@@ -3819,6 +4345,9 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 				// =====  this_mutrun_index has only new mutation(s), no breakpoints
 				//
 				
+				// reserve the child run's capacity once, for the parental run and the new mutations in the run
+				child_mutrun->reserve((parent_iter_max - parent_iter) + CountNewMutationsInRun(mut_block_ptr, mutation_iter, mutation_iter_max, (this_mutrun_index + 1) * mutrun_length));
+				
 				// add any additional new mutations that occur before the end of the mutation run; there is at least one
 				do
 				{
@@ -3891,6 +4420,9 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 		if (child_genome.mutruns_[i].get() == nullptr)
 			EIDOS_TERMINATION << "ERROR (Population::DoRecombinantMutation): (internal error) null mutation run left at end of recombination-mutation." << EidosTerminate();
 #endif
+	
+	if (sim_.UniqueNewMutationRuns())
+		UniqueNewMutationRuns(p_child_genome);
 }
 
 void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_child_genome, Genome &p_parent_genome, IndividualSex p_child_sex, std::vector<SLiMEidosBlock*> *p_mutation_callbacks)
@@ -4098,6 +4630,9 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 		}
 		
 		MutationRun::FreeMutationRun(&mutations_to_add);
+		
+		if (sim_.UniqueNewMutationRuns())
+			UniqueNewMutationRuns(p_child_genome);
 	}
 }
 
@@ -4693,6 +5228,45 @@ void Population::UniqueMutationRuns(void)
 		EIDOS_TERMINATION << "ERROR (Population::UniqueMutationRuns): (internal error) bookkeeping error in mutation run uniquing." << EidosTerminate();
 }
 
+// Unique the mutation runs just built for a child genome, as UniqueMutationRuns() would, but incrementally as each child is made.  Runs
+// referenced by anything other than p_genome were copied from a parent (or already uniqued), and are left alone; a newly built run is
+// replaced by an identical run in new_mutrun_table_ if there is one, and otherwise is added to the table so that later children can share
+// it.  Recombination within a run commonly rebuilds the same run over and over in low-diversity populations, so this can collapse a lot
+// of duplicates, saving memory and also the recomputation of nonneutral caches for each duplicate.  The table is cleared at the end of
+// each offspring generation stage (and before tallying), so it holds only runs built in the current stage.
+void Population::UniqueNewMutationRuns(Genome &p_genome)
+{
+	int32_t mutrun_count = p_genome.mutrun_count_;
+	
+	for (int mutrun_index = 0; mutrun_index < mutrun_count; ++mutrun_index)
+	{
+		MutationRun *mut_run = p_genome.mutruns_[mutrun_index].get();
+		
+		if (!mut_run || (mut_run->UseCount() != 1))
+			continue;
+		
+		int64_t hash = mut_run->Hash();
+		auto range = new_mutrun_table_.equal_range(hash);		// pair<Iter, Iter>
+		
+		for (auto hash_iter = range.first; hash_iter != range.second; ++hash_iter)
+		{
+			MutationRun *hash_run = hash_iter->second.get();
+			
+			if (mut_run->Identical(*hash_run))
+			{
+				// this releases mut_run, returning it to the pool
+				p_genome.mutruns_[mutrun_index].reset(hash_run);
+				goto is_identical;
+			}
+		}
+		
+		new_mutrun_table_.emplace(hash, p_genome.mutruns_[mutrun_index]);
+	
+	is_identical:
+		;
+	}
+}
+
 #ifndef __clang_analyzer__
 void Population::SplitMutationRuns(int32_t p_new_mutrun_count)
 {
@@ -4719,17 +5293,12 @@ void Population::SplitMutationRuns(int32_t p_new_mutrun_count)
 					slim_position_t new_mutrun_length = old_mutrun_length >> 1;
 					
 					genome.clear_to_nullptr();
-					if (genome.mutruns_ != genome.run_buffer_)
-						delete[] genome.mutruns_;
-					genome.mutruns_ = nullptr;
+					genome.FreeMutrunBuffer();
 					
 					genome.mutrun_count_ = new_mutrun_count;
 					genome.mutrun_length_ = new_mutrun_length;
 					
-					if (new_mutrun_count <= SLIM_GENOME_MUTRUN_BUFSIZE)
-						genome.mutruns_ = genome.run_buffer_;
-					else
-						genome.mutruns_ = new MutationRun_SP[new_mutrun_count];
+					genome.AllocateMutrunBuffer();
 					
 					// Install empty MutationRun objects; I think this is not necessary, since this is the
 					// child generation, which will not be accessed by anybody until crossover-mutation
@@ -4827,17 +5396,12 @@ void Population::SplitMutationRuns(int32_t p_new_mutrun_count)
 				
 				// now replace the runs in the genome with those in mutrun_buf
 				genome.clear_to_nullptr();
-				if (genome.mutruns_ != genome.run_buffer_)
-					delete[] genome.mutruns_;
-				genome.mutruns_ = nullptr;
+				genome.FreeMutrunBuffer();
 				
 				genome.mutrun_count_ = new_mutrun_count;
 				genome.mutrun_length_ = new_mutrun_length;
 				
-				if (new_mutrun_count <= SLIM_GENOME_MUTRUN_BUFSIZE)
-					genome.mutruns_ = genome.run_buffer_;
-				else
-					genome.mutruns_ = new MutationRun_SP[new_mutrun_count];
+				genome.AllocateMutrunBuffer();
 				
 				for (int run_index = 0; run_index < new_mutrun_count; ++run_index)
 					genome.mutruns_[run_index].reset(mutruns_buf[run_index]);
@@ -4903,17 +5467,12 @@ void Population::JoinMutationRuns(int32_t p_new_mutrun_count)
 					slim_position_t new_mutrun_length = old_mutrun_length << 1;
 					
 					genome.clear_to_nullptr();
-					if (genome.mutruns_ != genome.run_buffer_)
-						delete[] genome.mutruns_;
-					genome.mutruns_ = nullptr;
+					genome.FreeMutrunBuffer();
 					
 					genome.mutrun_count_ = new_mutrun_count;
 					genome.mutrun_length_ = new_mutrun_length;
 					
-					if (new_mutrun_count <= SLIM_GENOME_MUTRUN_BUFSIZE)
-						genome.mutruns_ = genome.run_buffer_;
-					else
-						genome.mutruns_ = new MutationRun_SP[new_mutrun_count];
+					genome.AllocateMutrunBuffer();
 					
 					// Install empty MutationRun objects; I think this is not necessary, since this is the
 					// child generation, which will not be accessed by anybody until crossover-mutation
@@ -5010,17 +5569,12 @@ void Population::JoinMutationRuns(int32_t p_new_mutrun_count)
 				
 				// now replace the runs in the genome with those in mutrun_buf
 				genome.clear_to_nullptr();
-				if (genome.mutruns_ != genome.run_buffer_)
-					delete[] genome.mutruns_;
-				genome.mutruns_ = nullptr;
+				genome.FreeMutrunBuffer();
 				
 				genome.mutrun_count_ = new_mutrun_count;
 				genome.mutrun_length_ = new_mutrun_length;
 				
-				if (new_mutrun_count <= SLIM_GENOME_MUTRUN_BUFSIZE)
-					genome.mutruns_ = genome.run_buffer_;
-				else
-					genome.mutruns_ = new MutationRun_SP[new_mutrun_count];
+				genome.AllocateMutrunBuffer();
 				
 				for (int run_index = 0; run_index < new_mutrun_count; ++run_index)
 					genome.mutruns_[run_index].reset(mutruns_buf[run_index]);
@@ -5052,6 +5606,9 @@ void Population::MaintainRegistry(void)
 	// remove any mutations that have been eliminated or have fixed
 	RemoveAllFixedMutations();
 	
+	// the memo of the tally above no longer matches the registry, but its refcounts are still correct for the remaining mutations
+	MemoizeTally(nullptr, cached_tally_genome_count_);
+	
 	// check that the mutation registry does not have any "zombies" – mutations that have been removed and should no longer be there
 	// also check for any mutations that are in the registry but do not have the state MutationState::kInRegistry
 #if DEBUG
@@ -5202,6 +5759,12 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 		}
 	}
 	
+	// Third, restore a memoized tally of the same thing if we have one; a forced recache discards the memo, since refcounts may be stale
+	if (p_force_recache)
+		InvalidateMutationTallies();
+	else if (RestoreMemoizedTally(p_subpops_to_tally))
+		return cached_tally_genome_count_;
+	
 	// Now do the actual tallying, since apparently it is necessary
 	if (p_subpops_to_tally)
 	{
@@ -5210,9 +5773,9 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 		// first zero out the refcounts in all registered Mutation objects
 		SLiM_ZeroRefcountBlock(mutation_registry_);
 		
-		// then increment the refcounts through all pointers to Mutation in all genomes
-		slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+		// then increment the refcounts through all pointers to Mutation in all genomes, by unique MutationRun
 		slim_refcount_t total_genome_count = 0;
+		int64_t operation_id = ++gSLiM_MutationRun_OperationID;
 		
 		for (Subpopulation *subpop : *p_subpops_to_tally)
 		{
@@ -5221,32 +5784,15 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 			slim_popsize_t subpop_genome_count = subpop->CurrentGenomeCount();
 			std::vector<Genome *> &subpop_genomes = subpop->CurrentGenomes();
 			
-			for (slim_popsize_t i = 0; i < subpop_genome_count; i++)							// child genomes
-			{
-				Genome &genome = *subpop_genomes[i];
-				
-				if (!genome.IsNull())
-				{
-					int mutrun_count = genome.mutrun_count_;
-					
-					for (int run_index = 0; run_index < mutrun_count; ++run_index)
-					{
-						MutationRun *mutrun = genome.mutruns_[run_index].get();
-						const MutationIndex *genome_iter = mutrun->begin_pointer_const();
-						const MutationIndex *genome_end_iter = mutrun->end_pointer_const();
-						
-						for (; genome_iter != genome_end_iter; ++genome_iter)
-							++(*(refcount_block_ptr + *genome_iter));
-					}
-					
-					total_genome_count++;	// count only non-null genomes to determine fixation
-				}
-			}
+			total_genome_count += TallyMutationRunUses(subpop_genomes.data(), subpop_genome_count, operation_id);	// count only non-null genomes to determine fixation
 		}
 		
+		TallyMutationsInTalliedRuns();
+		
 		// set up the cache info
 		last_tallied_subpops_ = *p_subpops_to_tally;
 		cached_tally_genome_count_ = total_genome_count;
+		MemoizeTally(p_subpops_to_tally, total_genome_count);
 		
 		return total_genome_count;
 	}
@@ -5256,6 +5802,9 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 		// mutation in each Genome; our first order of business is to figure out which case we are using.
 		bool can_tally_runs = true;
 		
+		// The references held by new_mutrun_table_ would throw off the MutationRun refcounts, so release them first
+		ClearNewMutationRunTable();
+		
 		// To tally using MutationRun, we should be at the point in the generation cycle where the registry is
 		// maintained, so that other Genome objects have been cleared.  Otherwise, the tallies might not add up.
 #ifdef SLIM_WF_ONLY
@@ -5326,6 +5875,7 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 			// set up the cache info
 			last_tallied_subpops_.clear();
 			cached_tally_genome_count_ = total_genome_count;
+			MemoizeTally(nullptr, total_genome_count);
 			
 			// set up the global genome counts
 			total_genome_count_ = total_genome_count;
@@ -5390,8 +5940,12 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 #endif
 			SLiM_ZeroRefcountBlock(mutation_registry_);
 			
-			// then increment the refcounts through all pointers to Mutation in all genomes
+			// then increment the refcounts through all pointers to Mutation in all genomes; except for SLiMgui's subset case,
+			// this is done by unique MutationRun, since the MutationRun refcounts cannot be used at this point
+#ifdef SLIMGUI
 			slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+#endif
+			int64_t operation_id = ++gSLiM_MutationRun_OperationID;
 			
 			for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : subpops_)
 			{
@@ -5442,55 +5996,16 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 				else
 #endif
 				{
-					for (slim_popsize_t i = 0; i < subpop_genome_count; i++)							// child genomes
-					{
-						Genome &genome = *subpop_genomes[i];
-						
-						if (!genome.IsNull())
-						{
-							int mutrun_count = genome.mutrun_count_;
-							
-							for (int run_index = 0; run_index < mutrun_count; ++run_index)
-							{
-								MutationRun *mutrun = genome.mutruns_[run_index].get();
-								const MutationIndex *genome_iter = mutrun->begin_pointer_const();
-								const MutationIndex *genome_end_iter = mutrun->end_pointer_const();
-								
-								// Do 16 reps
-								while (genome_iter + 16 <= genome_end_iter)
-								{
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-								}
-								
-								// Finish off
-								while (genome_iter != genome_end_iter)
-									(*(refcount_block_ptr + (*genome_iter++)))++;
-							}
-							
-							total_genome_count++;	// count only non-null genomes to determine fixation
-						}
-					}
+					total_genome_count += TallyMutationRunUses(subpop_genomes.data(), subpop_genome_count, operation_id);	// count only non-null genomes to determine fixation
 				}
 			}
 			
+			TallyMutationsInTalliedRuns();
+			
 			// set up the cache info
 			last_tallied_subpops_.clear();
 			cached_tally_genome_count_ = total_genome_count;
+			MemoizeTally(nullptr, total_genome_count);
 			
 			// set up the global genome counts
 			total_genome_count_ = total_genome_count;
@@ -5526,40 +6041,19 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 
 slim_refcount_t Population::TallyMutationReferences(std::vector<Genome*> *p_genomes_to_tally)
 {
-	// first zero out the refcounts in all registered Mutation objects
-	SLiM_ZeroRefcountBlock(mutation_registry_);
-	
-	// then increment the refcounts through all pointers to Mutation in all genomes
-	slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
-	slim_popsize_t genome_count = (slim_popsize_t)p_genomes_to_tally->size();
-	std::vector<Genome *> &genomes = *p_genomes_to_tally;
-	slim_refcount_t total_genome_count = 0;
-	
-	for (slim_popsize_t i = 0; i < genome_count; i++)							// child genomes
-	{
-		Genome &genome = *genomes[i];
-		
-		if (!genome.IsNull())
-		{
-			int mutrun_count = genome.mutrun_count_;
-			
-			for (int run_index = 0; run_index < mutrun_count; ++run_index)
-			{
-				MutationRun *mutrun = genome.mutruns_[run_index].get();
-				const MutationIndex *genome_iter = mutrun->begin_pointer_const();
-				const MutationIndex *genome_end_iter = mutrun->end_pointer_const();
-				
-				for (; genome_iter != genome_end_iter; ++genome_iter)
-					++(*(refcount_block_ptr + *genome_iter));
-			}
-			
-			total_genome_count++;	// count only non-null genomes to determine fixation
-		}
-	}
+	// first zero out the refcounts in all registered Mutation objects
+	SLiM_ZeroRefcountBlock(mutation_registry_);
+	
+	// then increment the refcounts through all pointers to Mutation in all genomes, by unique MutationRun
+	int64_t operation_id = ++gSLiM_MutationRun_OperationID;
+	slim_refcount_t total_genome_count = TallyMutationRunUses(p_genomes_to_tally->data(), (slim_popsize_t)p_genomes_to_tally->size(), operation_id);	// count only non-null genomes to determine fixation
 	
-	// set up the cache info; we have messed up any cached tallies
+	TallyMutationsInTalliedRuns();
+	
+	// set up the cache info; we have messed up any cached tallies, although memoized tallies remain valid
 	last_tallied_subpops_.clear();
 	cached_tally_genome_count_ = 0;
+	tally_memo_current_ = -1;
 	
 	// return the total genome count tallied (not counting null genomes)
 	return total_genome_count;
@@ -5611,6 +6105,194 @@ slim_refcount_t Population::TallyMutationReferences_FAST(void)
 	return total_genome_count;
 }
 
+void Population::MemoizeTally(std::vector<Subpopulation*> *p_subpops_tallied, slim_refcount_t p_genome_count)
+{
+	// Remember the tally just made, replacing any memo for the same subpops, which must be stale; a genome count of zero is not
+	// memoized, since it is used to indicate an invalid cache.
+	tally_memo_current_ = -1;
+	
+	if (p_genome_count == 0)
+		return;
+	
+	for (auto memo_iter = tally_memo_.begin(); memo_iter != tally_memo_.end(); ++memo_iter)
+	{
+		if (p_subpops_tallied ? (memo_iter->subpops_ == *p_subpops_tallied) : memo_iter->subpops_.empty())
+		{
+			tally_memo_.erase(memo_iter);
+			break;
+		}
+	}
+	
+	if (tally_memo_.size() >= SLIM_TALLY_MEMO_MAX)
+		tally_memo_.erase(tally_memo_.begin());
+	
+	int registry_size;
+	const MutationIndex *registry = MutationRegistry(&registry_size);
+	slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+	
+	tally_memo_.emplace_back();
+	
+	SLiM_TallyMemo &memo = tally_memo_.back();
+	
+	if (p_subpops_tallied)
+		memo.subpops_ = *p_subpops_tallied;
+	memo.genome_count_ = p_genome_count;
+	memo.registry_.assign(registry, registry + registry_size);
+	memo.refcounts_.resize(registry_size);
+	
+	for (int registry_index = 0; registry_index < registry_size; ++registry_index)
+		memo.refcounts_[registry_index] = refcount_block_ptr[registry[registry_index]];
+	
+	tally_memo_current_ = (int)tally_memo_.size() - 1;
+}
+
+bool Population::RestoreMemoizedTally(std::vector<Subpopulation*> *p_subpops_to_tally)
+{
+	// Look for a memo of the same subpops; memos are discarded whenever genomes change (see InvalidateMutationTallies()), but the
+	// registry can change without that (a new mutation with no references, or removal of lost mutations), so we check it too
+	for (int memo_index = 0; memo_index < (int)tally_memo_.size(); ++memo_index)
+	{
+		SLiM_TallyMemo &memo = tally_memo_[memo_index];
+		
+		if (p_subpops_to_tally ? (memo.subpops_ != *p_subpops_to_tally) : !memo.subpops_.empty())
+			continue;
+		
+		if (!TallyMemoMatchesRegistry(memo))
+		{
+			tally_memo_.erase(tally_memo_.begin() + memo_index);
+			tally_memo_current_ = -1;
+			return false;
+		}
+		
+		int registry_size;
+		const MutationIndex *registry = MutationRegistry(&registry_size);
+		slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+		const slim_refcount_t *memo_refcounts = memo.refcounts_.data();
+		
+		for (int registry_index = 0; registry_index < registry_size; ++registry_index)
+			refcount_block_ptr[registry[registry_index]] = memo_refcounts[registry_index];
+		
+		last_tallied_subpops_ = memo.subpops_;
+		cached_tally_genome_count_ = memo.genome_count_;
+		tally_memo_current_ = memo_index;
+		
+		if (!p_subpops_to_tally)
+			total_genome_count_ = memo.genome_count_;
+		
+		return true;
+	}
+	
+	return false;
+}
+
+bool Population::TallyMemoMatchesRegistry(const SLiM_TallyMemo &p_memo)
+{
+	int registry_size;
+	const MutationIndex *registry = MutationRegistry(&registry_size);
+	
+	if (p_memo.registry_.size() != (size_t)registry_size)
+		return false;
+	
+	return ((registry_size == 0) || (memcmp(p_memo.registry_.data(), registry, registry_size * sizeof(MutationIndex)) == 0));
+}
+
+SLiM_TallyMemo *Population::CurrentTallyMemo(slim_refcount_t p_genome_count)
+{
+	// Returns the memo for the tally currently in gSLiM_Mutation_Refcounts, if it is still exactly valid; new mutations can be added
+	// to the registry while a tally remains cached (their refcounts are zero), but the memo's cached results would then be stale
+	if (tally_memo_current_ < 0)
+		return nullptr;
+	
+	SLiM_TallyMemo &memo = tally_memo_[tally_memo_current_];
+	
+	if ((memo.genome_count_ != p_genome_count) || !TallyMemoMatchesRegistry(memo))
+		return nullptr;
+	
+	return &memo;
+}
+
+slim_refcount_t Population::TallyMutationRunUses(Genome * const *p_genomes, slim_popsize_t p_genome_count, int64_t p_operation_id)
+{
+	// Count the uses of each MutationRun within the given genomes, gathering each run into tally_mutruns_ the first time it is seen
+	// in the operation; TallyMutationsInTalliedRuns() then tallies each gathered run's mutations once, weighted by its use count.
+	// This is the same idea as TallyMutationReferences_FAST(), but it does not depend upon MutationRun refcounts matching genome
+	// counts, so it is correct for any set of genomes, at any point in the generation cycle.  Runs are heavily shared in most
+	// models, so this touches far fewer mutations than tallying each genome; when they are not, its overhead is small.  Several
+	// calls may share an operation id to gather runs across several sets of genomes, such as the genomes of several subpops.
+	slim_refcount_t total_genome_count = 0;
+	
+	for (slim_popsize_t i = 0; i < p_genome_count; i++)
+	{
+		Genome *genome = p_genomes[i];
+		int mutrun_count = genome->mutrun_count_;
+		
+		if (mutrun_count == 0)
+			continue;			// null genome
+		
+		MutationRun_SP *mutruns = genome->mutruns_;
+		
+		for (int run_index = 0; run_index < mutrun_count; ++run_index)
+		{
+			MutationRun *mutrun = mutruns[run_index].get();
+			
+			if (mutrun->operation_id_ != p_operation_id)
+			{
+				mutrun->operation_id_ = p_operation_id;
+				mutrun->tally_use_count_ = 1;
+				tally_mutruns_.emplace_back(mutrun);
+			}
+			else
+			{
+				mutrun->tally_use_count_++;
+			}
+		}
+		
+		total_genome_count++;
+	}
+	
+	return total_genome_count;
+}
+
+void Population::TallyMutationsInTalliedRuns(void)
+{
+	// Add the use count of each run gathered by TallyMutationRunUses() to the refcounts of its mutations
+	slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+	
+	for (MutationRun *mutrun : tally_mutruns_)
+	{
+		slim_refcount_t use_count = mutrun->tally_use_count_;
+		const MutationIndex *mutrun_iter = mutrun->begin_pointer_const();
+		const MutationIndex *mutrun_end_iter = mutrun->end_pointer_const();
+		
+		// Do 16 reps
+		while (mutrun_iter + 16 <= mutrun_end_iter)
+		{
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+		}
+		
+		// Finish off
+		while (mutrun_iter != mutrun_end_iter)
+			*(refcount_block_ptr + (*mutrun_iter++)) += use_count;
+	}
+	
+	tally_mutruns_.clear();
+}
+
 EidosValue_SP Population::Eidos_FrequenciesForTalliedMutations(EidosValue *mutations_value, int total_genome_count)
 {
 	slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
@@ -5687,6 +6369,13 @@ EidosValue_SP Population::Eidos_FrequenciesForTalliedMutations(EidosValue *mutat
 	else
 	{
 		// no mutation vector was given, so return all frequencies from the registry
+		// if the tally is memoized, the result is cached in the memo and shared by later calls; this is safe because Eidos
+		// copies values with a use count greater than one before modifying them
+		SLiM_TallyMemo *memo = CurrentTallyMemo(total_genome_count);
+		
+		if (memo && memo->frequencies_)
+			return memo->frequencies_;
+		
 		int registry_size;
 		const MutationIndex *registry = MutationRegistry(&registry_size);
 		
@@ -5695,6 +6384,9 @@ EidosValue_SP Population::Eidos_FrequenciesForTalliedMutations(EidosValue *mutat
 		
 		for (int registry_index = 0; registry_index < registry_size; registry_index++)
 		float_result->set_float_no_check(*(refcount_block_ptr + registry[registry_index]) * denominator, registry_index);
+		
+		if (memo)
+			memo->frequencies_ = result_SP;
 	}
 	
 	return result_SP;
@@ -5774,7 +6466,12 @@ EidosValue_SP Population::Eidos_CountsForTalliedMutations(EidosValue *mutations_
 	}
 	else
 	{
-		// no mutation vector was given, so return all frequencies from the registry
+		// no mutation vector was given, so return all frequencies from the registry; this is cached in the memo, as above
+		SLiM_TallyMemo *memo = CurrentTallyMemo(total_genome_count);
+		
+		if (memo && memo->counts_)
+			return memo->counts_;
+		
 		int registry_size;
 		const MutationIndex *registry = MutationRegistry(&registry_size);
 		
@@ -5783,6 +6480,9 @@ EidosValue_SP Population::Eidos_CountsForTalliedMutations(EidosValue *mutations_
 		
 		for (int registry_index = 0; registry_index < registry_size; registry_index++)
 		int_result->set_int_no_check(*(refcount_block_ptr + registry[registry_index]), registry_index);
+		
+		if (memo)
+			memo->counts_ = result_SP;
 	}
 	
 	return result_SP;
@@ -6404,7 +7104,30 @@ void Population::PrintAll(std::ostream &p_out, bool p_output_spatial_positions,
 	}
 }
 
+// Write p_column with one large write, followed by zero padding up to a multiple of 8 bytes, so that the next column is 8-byte aligned;
+// _InitializePopulationFromBinaryFile() relies on that alignment to use the columns in place, in a memory-mapped file
+template <typename T>
+static void WriteBinaryColumn(std::ostream &p_out, const std::vector<T> &p_column)
+{
+	static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	size_t byte_count = p_column.size() * sizeof(T);
+	
+	if (byte_count)
+		p_out.write(reinterpret_cast<const char *>(p_column.data()), byte_count);
+	if (byte_count % 8)
+		p_out.write(padding, 8 - (byte_count % 8));
+}
+
 // print all mutations and all genomes to a stream in binary, for maximum reading speed
+//
+// As of version 7, the binary format is columnar.  After the header (unchanged from version 6, apart from the version number) comes
+// a section of eight int64_t counts: subpopulations, mutations, unique mutation runs, mutations in all runs, genomes, mutation runs
+// per genome, mutation run length, and individuals.  Then come the columns, each padded to a multiple of 8 bytes: the subpopulation
+// ids, sizes, sex flags, and sex ratios; the mutation ids, mutation type ids, positions, selection coefficients, dominance coefficients,
+// origin subpopulation ids, origin generations, prevalences, and (for nucleotide-based models) nucleotides, with a mutation's index
+// in these columns being its polymorphism id; the offset of each unique run's mutations, and the mutations of all runs as polymorphism
+// ids; the genome types, and for each genome the index of the run at each run position (-1 for null genomes); and the individuals'
+// x, y, and z coordinates, pedigree ids, and ages, as requested.  A section end tag and the optional ancestral sequence follow.
 void Population::PrintAllBinary(std::ostream &p_out, bool p_output_spatial_positions, bool p_output_ages, bool p_output_ancestral_nucs, bool p_output_pedigree_ids) const
 {
 	// This function is written to be able to print the population whether child_generation_valid is true or false.
@@ -6424,6 +7147,7 @@ void Population::PrintAllBinary(std::ostream &p_out, bool p_output_spatial_posit
 	bool has_nucleotides = sim_.IsNucleotideBased();
 	
 	int32_t section_end_tag = 0xFFFF0000;
+	std::streampos file_start = p_out.tellp();
 	
 	// Header section
 	{
@@ -6433,11 +7157,12 @@ void Population::PrintAllBinary(std::ostream &p_out, bool p_output_spatial_posit
 		p_out.write(reinterpret_cast<char *>(&endianness_tag), sizeof endianness_tag);
 		
 		// Write a format version tag
-		int32_t version_tag = 6;													// version 2 started with SLiM 2.1
+		int32_t version_tag = 7;													// version 2 started with SLiM 2.1
 																					// version 3 started with SLiM 2.3
 																					// version 4 started with SLiM 3.0, only when individual age is output
 																					// version 5 started with SLiM 3.3, adding a "flags" field and nucleotide support
 																					// version 6 started with SLiM 3.5, adding optional pedigree ID output with a new flag
+																					// version 7 switched to a columnar format after the header, for memory-mapped reading
 		p_out.write(reinterpret_cast<char *>(&version_tag), sizeof version_tag);
 		
 		// Write the size of a double
@@ -6498,11 +7223,39 @@ void Population::PrintAllBinary(std::ostream &p_out, bool p_output_spatial_posit
 	// Write a tag indicating the section has ended
 	p_out.write(reinterpret_cast<char *>(&section_end_tag), sizeof section_end_tag);
 	
-	// Populations section
+	// Pad the header to a multiple of 8 bytes; from here on, every column starts 8-byte aligned relative to the start of the file
+	{
+		static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		std::streamoff header_length = p_out.tellp() - file_start;
+		
+		if (header_length % 8)
+			p_out.write(padding, 8 - (header_length % 8));
+	}
+	
+	// Gather the subpopulation, genome, and individual columns.  Subpopulations, genomes, and individuals are in the same order as
+	// in the text format.  Each mutation run shared by several genomes is written only once, and genomes refer to runs by index.
+	std::vector<slim_objectid_t> subpop_ids;
+	std::vector<slim_popsize_t> subpop_sizes;
+	std::vector<int32_t> subpop_sex_flags;
+	std::vector<double> subpop_sex_ratios;
+	std::vector<int32_t> genome_types;
+	std::vector<int32_t> genome_runs;
+	std::vector<double> spatial_x, spatial_y, spatial_z;
+	std::vector<slim_pedigreeid_t> pedigree_ids;
+	std::vector<slim_age_t> ages;
+	std::vector<const MutationRun *> runs;
+	std::vector<slim_refcount_t> run_use_counts;
+	int32_t genome_mutrun_count = sim_.TheChromosome().mutrun_count_;
+	slim_position_t genome_mutrun_length = sim_.TheChromosome().mutrun_length_;
+#if EIDOS_ROBIN_HOOD_HASHING
+	robin_hood::unordered_flat_map<const MutationRun *, int32_t> run_ids;
+#elif STD_UNORDERED_MAP_HASHING
+	std::unordered_map<const MutationRun *, int32_t> run_ids;
+#endif
+	
 	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : subpops_)
 	{
 		Subpopulation *subpop = subpop_pair.second;
-		slim_objectid_t subpop_id = subpop_pair.first;
 		slim_popsize_t subpop_size = subpop->CurrentSubpopSize();
 		double subpop_sex_ratio;
 		
@@ -6520,236 +7273,194 @@ void Population::PrintAllBinary(std::ostream &p_out, bool p_output_spatial_posit
 				subpop_sex_ratio = 1.0 - (subpop->parent_first_male_index_ / (double)subpop->parent_subpop_size_);
 		}
 		
-		// Write a tag indicating we are starting a new subpopulation
-		int32_t subpop_start_tag = 0xFFFF0001;
-		
-		p_out.write(reinterpret_cast<char *>(&subpop_start_tag), sizeof subpop_start_tag);
+		// if we are not sexual, the sex ratio will be garbage, but that is fine
+		subpop_ids.emplace_back(subpop_pair.first);
+		subpop_sizes.emplace_back(subpop_size);
+		subpop_sex_flags.emplace_back(subpop->sex_enabled_ ? 1 : 0);
+		subpop_sex_ratios.emplace_back(subpop_sex_ratio);
 		
-		// Write the subpop identifier
-		p_out.write(reinterpret_cast<char *>(&subpop_id), sizeof subpop_id);
-		
-		// Write the subpop size
-		p_out.write(reinterpret_cast<char *>(&subpop_size), sizeof subpop_size);
-		
-		// Write a flag indicating whether this population has sexual or hermaphroditic
-		int32_t sex_flag = (subpop->sex_enabled_ ? 1 : 0);
-		
-		p_out.write(reinterpret_cast<char *>(&sex_flag), sizeof sex_flag);
-		
-		// Write the sex ratio; if we are not sexual, this will be garbage, but that is fine, we want a constant-length record
-		p_out.write(reinterpret_cast<char *>(&subpop_sex_ratio), sizeof subpop_sex_ratio);
+		for (slim_popsize_t i = 0; i < 2 * subpop_size; i++)
+		{
+			Genome &genome = *(subpop->CurrentGenomes()[i]);
+			
+			genome_types.emplace_back((int32_t)genome.Type());
+			
+			if (genome.IsNull())
+			{
+				// null genomes refer to run -1 in every position
+				genome_runs.insert(genome_runs.end(), genome_mutrun_count, -1);
+				continue;
+			}
+			
+			if ((genome.mutrun_count_ != genome_mutrun_count) || (genome.mutrun_length_ != genome_mutrun_length))
+				EIDOS_TERMINATION << "ERROR (Population::PrintAllBinary): (internal error) genome mutation run configuration does not match the chromosome." << EidosTerminate();
+			
+			for (int run_index = 0; run_index < genome_mutrun_count; ++run_index)
+			{
+				const MutationRun *mutrun = genome.mutruns_[run_index].get();
+				auto found_run = run_ids.find(mutrun);
+				int32_t run_id;
+				
+				if (found_run == run_ids.end())
+				{
+					run_id = (int32_t)runs.size();
+					run_ids.emplace(mutrun, run_id);
+					runs.emplace_back(mutrun);
+					run_use_counts.emplace_back(0);
+				}
+				else
+				{
+					run_id = found_run->second;
+				}
+				
+				genome_runs.emplace_back(run_id);
+				run_use_counts[run_id]++;
+			}
+		}
 		
-		// now will come either a subpopulation start tag, or a section end tag
+		for (slim_popsize_t individual_index = 0; individual_index < subpop_size; individual_index++)
+		{
+			Individual &individual = *(subpop->CurrentIndividuals()[individual_index]);
+			
+			if (spatial_output_count >= 1)
+				spatial_x.emplace_back(individual.spatial_x_);
+			if (spatial_output_count >= 2)
+				spatial_y.emplace_back(individual.spatial_y_);
+			if (spatial_output_count >= 3)
+				spatial_z.emplace_back(individual.spatial_z_);
+			if (pedigree_output_count)
+				pedigree_ids.emplace_back(individual.PedigreeID());
+#ifdef SLIM_NONWF_ONLY
+			if (age_output_count)
+				ages.emplace_back(individual.age_);
+#endif  // SLIM_NONWF_ONLY
+		}
 	}
 	
-	// Write a tag indicating the section has ended
-	p_out.write(reinterpret_cast<char *>(&section_end_tag), sizeof section_end_tag);
-	
-	// Find all polymorphisms
-	PolymorphismMap polymorphisms;
+	// Find the polymorphisms, which are all the mutations in the runs, and sort them by mutation id as the text format does; the
+	// index of a polymorphism in the mutation columns is its polymorphism id, and runs refer to mutations by polymorphism id
 	Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+	std::vector<slim_polymorphismid_t> polymorphism_ids(gSLiM_Mutation_Block_LastUsedIndex + 1, -1);
+	std::vector<MutationIndex> polymorphisms;
 	
-	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : subpops_)			// go through all subpopulations
+	for (const MutationRun *mutrun : runs)
 	{
-		Subpopulation *subpop = subpop_pair.second;
-		slim_popsize_t subpop_size = subpop->CurrentSubpopSize();
-		
-		for (slim_popsize_t i = 0; i < 2 * subpop_size; i++)				// go through all children
+		for (const MutationIndex *mut_ptr = mutrun->begin_pointer_const(); mut_ptr != mutrun->end_pointer_const(); ++mut_ptr)
 		{
-			Genome &genome = *(subpop->CurrentGenomes()[i]);
-			int mutrun_count = genome.mutrun_count_;
-			
-			for (int run_index = 0; run_index < mutrun_count; ++run_index)
+			if (polymorphism_ids[*mut_ptr] == -1)
 			{
-				MutationRun *mutrun = genome.mutruns_[run_index].get();
-				int mut_count = mutrun->size();
-				const MutationIndex *mut_ptr = mutrun->begin_pointer_const();
-				
-				for (int mut_index = 0; mut_index < mut_count; ++mut_index)
-					AddMutationToPolymorphismMap(&polymorphisms, mut_block_ptr + mut_ptr[mut_index]);
+				polymorphism_ids[*mut_ptr] = 0;
+				polymorphisms.emplace_back(*mut_ptr);
 			}
 		}
 	}
 	
-	// Write out the size of the mutation map, so we can allocate a vector rather than utilizing std::map when reading
-	int32_t mutation_map_size = (int32_t)polymorphisms.size();
+	std::sort(polymorphisms.begin(), polymorphisms.end(), [mut_block_ptr](MutationIndex a, MutationIndex b) { return (mut_block_ptr + a)->mutation_id_ < (mut_block_ptr + b)->mutation_id_; });
 	
-	p_out.write(reinterpret_cast<char *>(&mutation_map_size), sizeof mutation_map_size);
+	for (size_t polymorphism_index = 0; polymorphism_index < polymorphisms.size(); ++polymorphism_index)
+		polymorphism_ids[polymorphisms[polymorphism_index]] = (slim_polymorphismid_t)polymorphism_index;
 	
-	// Mutations section
-	for (const PolymorphismPair &polymorphism_pair : polymorphisms)
+	// Gather the mutation run columns: the offset of each run's mutations in run_mutations, followed by the total, and the mutations
+	// of all runs, as polymorphism ids.  The prevalence of each mutation is the sum of the use counts of the runs containing it.
+	std::vector<int64_t> run_offsets;
+	std::vector<slim_polymorphismid_t> run_mutations;
+	std::vector<slim_refcount_t> prevalences(polymorphisms.size(), 0);
+	
+	run_offsets.reserve(runs.size() + 1);
+	
+	for (size_t run_id = 0; run_id < runs.size(); ++run_id)
 	{
-		const Polymorphism &polymorphism = polymorphism_pair.second;
-		const Mutation *mutation_ptr = polymorphism.mutation_ptr_;
-		const MutationType *mutation_type_ptr = mutation_ptr->mutation_type_ptr_;
-		
-		slim_polymorphismid_t polymorphism_id = polymorphism.polymorphism_id_;
-		int64_t mutation_id = mutation_ptr->mutation_id_;													// Added in version 2
-		slim_objectid_t mutation_type_id = mutation_type_ptr->mutation_type_id_;
-		slim_position_t position = mutation_ptr->position_;
-		slim_selcoeff_t selection_coeff = mutation_ptr->selection_coeff_;
-		slim_selcoeff_t dominance_coeff = mutation_type_ptr->dominance_coeff_;
-		slim_objectid_t subpop_index = mutation_ptr->subpop_index_;
-		slim_generation_t generation = mutation_ptr->origin_generation_;
-		slim_refcount_t prevalence = polymorphism.prevalence_;
-		int8_t nucleotide = mutation_ptr->nucleotide_;
-		
-		// Write a tag indicating we are starting a new mutation
-		int32_t mutation_start_tag = 0xFFFF0002;
-		
-		p_out.write(reinterpret_cast<char *>(&mutation_start_tag), sizeof mutation_start_tag);
-		
-		// Write the mutation data
-		p_out.write(reinterpret_cast<char *>(&polymorphism_id), sizeof polymorphism_id);
-		p_out.write(reinterpret_cast<char *>(&mutation_id), sizeof mutation_id);							// Added in version 2
-		p_out.write(reinterpret_cast<char *>(&mutation_type_id), sizeof mutation_type_id);
-		p_out.write(reinterpret_cast<char *>(&position), sizeof position);
-		p_out.write(reinterpret_cast<char *>(&selection_coeff), sizeof selection_coeff);
-		p_out.write(reinterpret_cast<char *>(&dominance_coeff), sizeof dominance_coeff);
-		p_out.write(reinterpret_cast<char *>(&subpop_index), sizeof subpop_index);
-		p_out.write(reinterpret_cast<char *>(&generation), sizeof generation);
-		p_out.write(reinterpret_cast<char *>(&prevalence), sizeof prevalence);
+		const MutationRun *mutrun = runs[run_id];
 		
-		if (has_nucleotides)
-			p_out.write(reinterpret_cast<char *>(&nucleotide), sizeof nucleotide);							// added in version 5
+		run_offsets.emplace_back((int64_t)run_mutations.size());
 		
-		// now will come either a mutation start tag, or a section end tag
+		for (const MutationIndex *mut_ptr = mutrun->begin_pointer_const(); mut_ptr != mutrun->end_pointer_const(); ++mut_ptr)
+		{
+			slim_polymorphismid_t polymorphism_id = polymorphism_ids[*mut_ptr];
+			
+			run_mutations.emplace_back(polymorphism_id);
+			prevalences[polymorphism_id] += run_use_counts[run_id];
+		}
 	}
 	
-	// Write a tag indicating the section has ended
-	p_out.write(reinterpret_cast<char *>(&section_end_tag), sizeof section_end_tag);
+	run_offsets.emplace_back((int64_t)run_mutations.size());
 	
-	// Genomes section
-	bool use_16_bit = (mutation_map_size <= UINT16_MAX - 1);	// 0xFFFF is reserved as the start of our various tags
+	// Gather the mutation columns
+	size_t polymorphism_count = polymorphisms.size();
+	std::vector<slim_mutationid_t> mutation_ids(polymorphism_count);
+	std::vector<slim_objectid_t> mutation_type_ids(polymorphism_count);
+	std::vector<slim_position_t> positions(polymorphism_count);
+	std::vector<slim_selcoeff_t> selection_coeffs(polymorphism_count);
+	std::vector<slim_selcoeff_t> dominance_coeffs(polymorphism_count);
+	std::vector<slim_objectid_t> subpop_indices(polymorphism_count);
+	std::vector<slim_generation_t> origin_generations(polymorphism_count);
+	std::vector<int8_t> nucleotides(has_nucleotides ? polymorphism_count : 0);
 	
-	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : subpops_)			// go through all subpopulations
+	for (size_t polymorphism_index = 0; polymorphism_index < polymorphism_count; ++polymorphism_index)
 	{
-		Subpopulation *subpop = subpop_pair.second;
-		slim_objectid_t subpop_id = subpop_pair.first;
-		slim_popsize_t subpop_size = subpop->CurrentSubpopSize();
+		const Mutation *mutation_ptr = mut_block_ptr + polymorphisms[polymorphism_index];
+		const MutationType *mutation_type_ptr = mutation_ptr->mutation_type_ptr_;
 		
-		for (slim_popsize_t i = 0; i < 2 * subpop_size; i++)							// go through all children
-		{
-			Genome &genome = *(subpop->CurrentGenomes()[i]);
-			
-			// Write out the genome header; start with the genome type to guarantee that the first 32 bits are != section_end_tag
-			int32_t genome_type = (int32_t)(genome.Type());
-			
-			p_out.write(reinterpret_cast<char *>(&genome_type), sizeof genome_type);
-			p_out.write(reinterpret_cast<char *>(&subpop_id), sizeof subpop_id);
-			p_out.write(reinterpret_cast<char *>(&i), sizeof i);
-			
-			// Output individual spatial position information before the mutation list.  Added in version 3.
-			if (spatial_output_count && ((i % 2) == 0))
-			{
-				int individual_index = i / 2;
-				Individual &individual = *(subpop->CurrentIndividuals()[individual_index]);
-				
-				if (spatial_output_count >= 1)
-					p_out.write(reinterpret_cast<char *>(&individual.spatial_x_), sizeof individual.spatial_x_);
-				if (spatial_output_count >= 2)
-					p_out.write(reinterpret_cast<char *>(&individual.spatial_y_), sizeof individual.spatial_y_);
-				if (spatial_output_count >= 3)
-					p_out.write(reinterpret_cast<char *>(&individual.spatial_z_), sizeof individual.spatial_z_);
-			}
-			
-			// Output individual pedigree ID information.  Added in version 5.
-			if (pedigree_output_count && ((i % 2) == 0))
-			{
-				int individual_index = i / 2;
-				Individual &individual = *(subpop->CurrentIndividuals()[individual_index]);
-				slim_pedigreeid_t pedigree_id = individual.PedigreeID();
-				
-				p_out.write(reinterpret_cast<char *>(&pedigree_id), sizeof pedigree_id);
-			}
-			
-#ifdef SLIM_NONWF_ONLY
-			// Output individual age information before the mutation list.  Added in version 4.
-			if (age_output_count && ((i % 2) == 0))
-			{
-				int individual_index = i / 2;
-				Individual &individual = *(subpop->CurrentIndividuals()[individual_index]);
-				
-				p_out.write(reinterpret_cast<char *>(&individual.age_), sizeof individual.age_);
-			}
-#endif  // SLIM_NONWF_ONLY
-			
-			// Write out the mutation list
-			if (genome.IsNull())
-			{
-				// null genomes get a 32-bit flag value written instead of a mutation count
-				int32_t null_genome_tag = 0xFFFF1000;
-				
-				p_out.write(reinterpret_cast<char *>(&null_genome_tag), sizeof null_genome_tag);
-			}
-			else
-			{
-				// write a 32-bit mutation count
-				{
-					int32_t total_mutations = genome.mutation_count();
-					
-					p_out.write(reinterpret_cast<char *>(&total_mutations), sizeof total_mutations);
-				}
-				
-				if (use_16_bit)
-				{
-					// Write out 16-bit mutation tags
-					int mutrun_count = genome.mutrun_count_;
-					
-					for (int run_index = 0; run_index < mutrun_count; ++run_index)
-					{
-						MutationRun *mutrun = genome.mutruns_[run_index].get();
-						int mut_count = mutrun->size();
-						const MutationIndex *mut_ptr = mutrun->begin_pointer_const();
-						
-						for (int mut_index = 0; mut_index < mut_count; ++mut_index)
-						{
-							slim_polymorphismid_t polymorphism_id = FindMutationInPolymorphismMap(polymorphisms, mut_block_ptr + mut_ptr[mut_index]);
-							
-							if (polymorphism_id == -1)
-								EIDOS_TERMINATION << "ERROR (Population::PrintAllBinary): (internal error) polymorphism not found." << EidosTerminate();
-							
-							if (polymorphism_id <= UINT16_MAX - 1)
-							{
-								uint16_t id_16 = (uint16_t)polymorphism_id;
-								
-								p_out.write(reinterpret_cast<char *>(&id_16), sizeof id_16);
-							}
-							else
-							{
-								EIDOS_TERMINATION << "ERROR (Population::PrintAllBinary): (internal error) mutation id out of 16-bit bounds." << EidosTerminate();
-							}
-						}
-					}
-				}
-				else
-				{
-					// Write out 32-bit mutation tags
-					int mutrun_count = genome.mutrun_count_;
-					
-					for (int run_index = 0; run_index < mutrun_count; ++run_index)
-					{
-						MutationRun *mutrun = genome.mutruns_[run_index].get();
-						int mut_count = mutrun->size();
-						const MutationIndex *mut_ptr = mutrun->begin_pointer_const();
-						
-						for (int mut_index = 0; mut_index < mut_count; ++mut_index)
-						{
-							slim_polymorphismid_t polymorphism_id = FindMutationInPolymorphismMap(polymorphisms, mut_block_ptr + mut_ptr[mut_index]);
-							
-							if (polymorphism_id == -1)
-								EIDOS_TERMINATION << "ERROR (Population::PrintAllBinary): (internal error) polymorphism not found." << EidosTerminate();
-							
-							p_out.write(reinterpret_cast<char *>(&polymorphism_id), sizeof polymorphism_id);
-						}
-					}
-				}
-				
-				// now will come either a genome type (32 bits: 0, 1, or 2), or a section end tag
-			}
-		}
+		mutation_ids[polymorphism_index] = mutation_ptr->mutation_id_;
+		mutation_type_ids[polymorphism_index] = mutation_type_ptr->mutation_type_id_;
+		positions[polymorphism_index] = mutation_ptr->position_;
+		selection_coeffs[polymorphism_index] = mutation_ptr->selection_coeff_;
+		dominance_coeffs[polymorphism_index] = mutation_type_ptr->dominance_coeff_;
+		subpop_indices[polymorphism_index] = mutation_ptr->subpop_index_;
+		origin_generations[polymorphism_index] = mutation_ptr->origin_generation_;
+		
+		if (has_nucleotides)
+			nucleotides[polymorphism_index] = mutation_ptr->nucleotide_;
 	}
 	
+	// Counts section: the number of entries in each group of columns, and the mutation run configuration of the genomes
+	{
+		int64_t counts[8];
+		
+		counts[0] = (int64_t)subpop_ids.size();
+		counts[1] = (int64_t)polymorphism_count;
+		counts[2] = (int64_t)runs.size();
+		counts[3] = (int64_t)run_mutations.size();
+		counts[4] = (int64_t)genome_types.size();
+		counts[5] = (int64_t)genome_mutrun_count;
+		counts[6] = (int64_t)genome_mutrun_length;
+		counts[7] = (int64_t)(genome_types.size() / 2);
+		
+		p_out.write(reinterpret_cast<char *>(counts), sizeof counts);
+	}
+	
+	// Subpopulations section
+	WriteBinaryColumn(p_out, subpop_ids);
+	WriteBinaryColumn(p_out, subpop_sizes);
+	WriteBinaryColumn(p_out, subpop_sex_flags);
+	WriteBinaryColumn(p_out, subpop_sex_ratios);
+	
+	// Mutations section
+	WriteBinaryColumn(p_out, mutation_ids);
+	WriteBinaryColumn(p_out, mutation_type_ids);
+	WriteBinaryColumn(p_out, positions);
+	WriteBinaryColumn(p_out, selection_coeffs);
+	WriteBinaryColumn(p_out, dominance_coeffs);
+	WriteBinaryColumn(p_out, subpop_indices);
+	WriteBinaryColumn(p_out, origin_generations);
+	WriteBinaryColumn(p_out, prevalences);
+	WriteBinaryColumn(p_out, nucleotides);							// empty unless has_nucleotides
+	
+	// Mutation runs section
+	WriteBinaryColumn(p_out, run_offsets);
+	WriteBinaryColumn(p_out, run_mutations);
+	
+	// Genomes section
+	WriteBinaryColumn(p_out, genome_types);
+	WriteBinaryColumn(p_out, genome_runs);
+	
+	// Individuals section; each column is empty unless the corresponding information was requested
+	WriteBinaryColumn(p_out, spatial_x);
+	WriteBinaryColumn(p_out, spatial_y);
+	WriteBinaryColumn(p_out, spatial_z);
+	WriteBinaryColumn(p_out, pedigree_ids);
+	WriteBinaryColumn(p_out, ages);
+	
 	// Write a tag indicating the section has ended
 	p_out.write(reinterpret_cast<char *>(&section_end_tag), sizeof section_end_tag);
 	
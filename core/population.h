@@ -32,12 +32,14 @@
 #include <map>
 #include <string>
 #include <unordered_map>
+#include <exception>
 
 #include "slim_globals.h"
 #include "substitution.h"
 #include "chromosome.h"
 #include "slim_eidos_block.h"
 #include "mutation_run.h"
+#include "eidos_rng.h"
 
 
 class SLiMSim;
@@ -62,6 +64,74 @@ typedef struct {
 } SubpopSizeHistory;
 #endif
 
+// The segments of parental mutation runs inherited by a child mutation run, gathered by CopyCrossoverSegments() in population.cpp
+typedef std::vector<std::pair<const MutationIndex *, const MutationIndex *>> SLiM_CrossoverSegments;
+
+
+#ifdef SLIM_WF_ONLY
+// These types are used by Population::EvolveSubpopulation_Parallel() to generate offspring in fixed-size chunks, each of which
+// draws from its own RNG stream.  A chunk first records "recipes" for its gametes – parental strands, crossover breakpoints, and
+// new mutations – without touching any shared state; the Mutation objects and the child mutation runs are made from those later.
+#define SLIM_OFFSPRING_CHUNK_SIZE	256
+
+enum class SLiMChildMode : uint8_t {
+	kBiparental = 0,
+	kSelfed,
+	kCloned
+};
+
+typedef struct {
+	Subpopulation *source_subpop_;			// the subpopulation the parents are drawn from
+	IndividualSex child_sex_;
+	SLiMChildMode mode_;
+} SLiM_ChildPlan;
+
+typedef struct {
+	slim_position_t position_;
+	MutationType *mutation_type_ptr_;
+	double selection_coeff_;
+	slim_objectid_t subpop_id_;				// the origin subpopulation of the mutation
+	MutationIndex mutation_index_;			// set once the mutation has been made in the mutation block
+	bool accepted_;							// set if the mutation passed the stacking policy in its child genome
+} SLiM_PendingMutation;
+
+typedef struct {
+	Genome *child_genome_;
+	Genome *strand1_, *strand2_;			// the parental strands, after the initial strand swap; strand1_ is copied first
+	int32_t breakpoints_start_, breakpoints_count_;		// a range in the chunk's breakpoints_ buffer, sorted and uniqued
+	int32_t mutations_start_, mutations_count_;			// a range in the chunk's mutations_ buffer, sorted by position
+} SLiM_GameteRecipe;
+
+typedef struct {
+	slim_popsize_t child_start_, child_end_;			// the range of child indices generated by this chunk
+	std::vector<slim_popsize_t> parents_;				// two parent indices per child
+	std::vector<SLiM_GameteRecipe> gametes_;			// two gametes per child
+	std::vector<slim_position_t> breakpoints_;
+	std::vector<std::pair<slim_position_t, GenomicElement *>> positions_;	// the drawn mutation positions, from which mutations_ is made
+	std::vector<SLiM_PendingMutation> mutations_;
+	int32_t new_run_count_;								// the number of mutation runs that need to be built for this chunk
+	std::vector<MutationRun *> new_runs_;				// empty runs taken from the MutationRun pool, to be filled by the chunk
+	std::vector<MutationRun *> child_runs_;				// the finished runs for each gamete, mutrun_count_ per gamete; NOT retained
+	SLiM_CrossoverSegments segments_;					// a scratch buffer for CopyCrossoverSegments(), private to the chunk's thread
+	
+	std::exception_ptr exception_;						// an exception raised while drawing, to be rethrown on the main thread
+} SLiM_OffspringChunk;
+#endif	// SLIM_WF_ONLY
+
+
+// This struct holds a memoized tally made by Population::TallyMutationReferences(), so that scripts that ask for the frequencies of
+// mutations in several different sets of subpopulations within one generation don't redo each tally every time they ask.
+#define SLIM_TALLY_MEMO_MAX	8
+
+typedef struct {
+	std::vector<Subpopulation*> subpops_;			// NOT OWNED POINTERS: the subpops tallied; empty for the whole population
+	slim_refcount_t genome_count_;					// the total genome count returned by the tally
+	std::vector<MutationIndex> registry_;			// the mutation registry when the tally was made; the memo is valid only for the same registry
+	std::vector<slim_refcount_t> refcounts_;		// the tallied refcount for each mutation in registry_
+	EidosValue_SP frequencies_;						// cached results for mutationFrequencies() and mutationCounts() over the whole registry, or nullptr
+	EidosValue_SP counts_;
+} SLiM_TallyMemo;
+
 
 class Population
 {
@@ -89,12 +159,25 @@ public:
 	// Cache info for TallyMutationReferences(); see that function
 	std::vector<Subpopulation*> last_tallied_subpops_;		// NOT OWNED POINTERS
 	slim_refcount_t cached_tally_genome_count_ = 0;
+	std::vector<MutationRun *> tally_mutruns_;				// NOT OWNED POINTERS: the runs gathered by TallyMutationRunUses(), pending TallyMutationsInTalliedRuns()
+	std::vector<SLiM_TallyMemo> tally_memo_;				// recent tallies, oldest first; cleared by InvalidateMutationTallies()
+	int tally_memo_current_ = -1;							// the index of the memo matching the current refcounts in gSLiM_Mutation_Refcounts, or -1
 	
 	std::vector<Substitution*> substitutions_;				// OWNED POINTERS: Substitution objects for all fixed mutations
 	std::unordered_multimap<slim_position_t, Substitution*> treeseq_substitutions_map_;	// TREE SEQUENCE RECORDING; keeps all fixed mutations, hashed by position
+	
+	// Mutation runs built by DoCrossoverMutation() etc., hashed by MutationRun::Hash(), when initializeSLiMOptions(uniqueMutationRuns=T) is set;
+	// see UniqueNewMutationRuns().  The table retains its runs, so it must be cleared before MutationRun refcounts are used as genome counts.
+	std::unordered_multimap<int64_t, MutationRun_SP> new_mutrun_table_;
+	
+	SLiM_CrossoverSegments crossover_segments_;				// a scratch buffer for CopyCrossoverSegments() on the main thread, kept to avoid reallocation
 
 #ifdef SLIM_WF_ONLY
 	bool child_generation_valid_ = false;					// this keeps track of whether children have been generated by EvolveSubpopulation() yet, or whether the parents are still in charge
+	
+	// buffers used by EvolveSubpopulation_Parallel(), kept across generations to avoid reallocation
+	std::vector<SLiM_ChildPlan> offspring_plan_;
+	std::vector<SLiM_OffspringChunk> offspring_chunks_;
 #endif
 	
 	std::vector<Subpopulation*> removed_subpops_;			// OWNED POINTERS: Subpops which are set to size 0 (and thus removed) are kept here until the end of the generation
@@ -191,6 +274,10 @@ public:
 	// Scan through all mutation runs in the simulation and unique them
 	void UniqueMutationRuns(void);
 	
+	// Unique the runs just built for a child genome against those built earlier in the same stage, using new_mutrun_table_
+	void UniqueNewMutationRuns(Genome &p_genome);
+	inline void ClearNewMutationRunTable(void) { if (!new_mutrun_table_.empty()) new_mutrun_table_.clear(); }
+	
 	// Scan through all genomes and either split or join their mutation runs, to double or halve the number of runs per genome
 	void SplitMutationRuns(int32_t p_new_mutrun_count);
 	void JoinMutationRuns(int32_t p_new_mutrun_count);
@@ -203,6 +290,26 @@ public:
 	slim_refcount_t TallyMutationReferences(std::vector<Genome*> *p_genomes_to_tally);
 	slim_refcount_t TallyMutationReferences_FAST(void);
 	
+	// memoize tallies, and restore a memoized tally into gSLiM_Mutation_Refcounts if one is available for the given subpops
+	void MemoizeTally(std::vector<Subpopulation*> *p_subpops_tallied, slim_refcount_t p_genome_count);
+	bool RestoreMemoizedTally(std::vector<Subpopulation*> *p_subpops_to_tally);
+	bool TallyMemoMatchesRegistry(const SLiM_TallyMemo &p_memo);
+	SLiM_TallyMemo *CurrentTallyMemo(slim_refcount_t p_genome_count);
+	
+	// invalidate cached and memoized tallies; this must be called whenever genomes, their mutations, or the set of subpops change
+	inline void InvalidateMutationTallies(void)
+	{
+		cached_tally_genome_count_ = 0;
+		tally_memo_current_ = -1;
+		
+		if (!tally_memo_.empty())
+			tally_memo_.clear();
+	}
+	
+	// tally mutation references within an arbitrary set of genomes by unique MutationRun, weighted by the uses of each run within the set
+	slim_refcount_t TallyMutationRunUses(Genome * const *p_genomes, slim_popsize_t p_genome_count, int64_t p_operation_id);
+	void TallyMutationsInTalliedRuns(void);
+	
 	// Eidos back-end code that counts up tallied mutations, working with TallyMutationReferences()
 	EidosValue_SP Eidos_FrequenciesForTalliedMutations(EidosValue *mutations_value, int total_genome_count);
 	EidosValue_SP Eidos_CountsForTalliedMutations(EidosValue *mutations_value, int total_genome_count);
@@ -234,6 +341,13 @@ public:
 	// generate children for subpopulation p_subpop_id, drawing from all source populations, handling crossover and mutation
 	void EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice_callbacks_present, bool p_modify_child_callbacks_present, bool p_recombination_callbacks_present, bool p_mutation_callbacks_present);
 	
+	// multithreaded offspring generation (slim -threads); used by EvolveSubpopulation() when no callbacks are present and the model allows it
+	bool CanEvolveSubpopulationInParallel(void);
+	void EvolveSubpopulation_Parallel(Subpopulation &p_subpop, int p_migrant_source_count, double *p_migration_rates, Subpopulation **p_migration_sources, unsigned int *p_num_migrants, slim_popsize_t p_total_female_children, slim_popsize_t p_total_male_children);
+	static void DrawGameteRecipe(Eidos_RNG_State &p_rng, SLiM_OffspringChunk &p_chunk, Chromosome &p_chromosome, Genome *p_child_genome, Genome *p_strand1, Genome *p_strand2, IndividualSex p_sex, bool p_clonal, slim_objectid_t p_subpop_id, slim_position_t p_mutrun_length);
+	static void DrawOffspringChunk(Eidos_RNG_State &p_rng, SLiM_OffspringChunk &p_chunk, const std::vector<SLiM_ChildPlan> &p_plan, Subpopulation &p_subpop, Chromosome &p_chromosome, bool p_prevent_incidental_selfing);
+	static void BuildOffspringChunk(SLiM_OffspringChunk &p_chunk, int p_mutrun_count, slim_position_t p_mutrun_length);
+	
 	// step forward a generation: make the children become the parents
 	void SwapGenerations(void);
 	
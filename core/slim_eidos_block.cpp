@@ -878,6 +878,7 @@ SLiMEidosBlock::SLiMEidosBlock(slim_objectid_t p_id, const std::string &p_script
 
 SLiMEidosBlock::~SLiMEidosBlock(void)
 {
+	delete bytecode_;
 	delete script_;
 }
 
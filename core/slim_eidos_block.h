@@ -34,6 +34,7 @@
 #include "eidos_functions.h"
 #include "eidos_type_table.h"
 #include "eidos_type_interpreter.h"
+#include "eidos_bytecode.h"
 
 
 enum class SLiMEidosBlockType {
@@ -183,6 +184,9 @@ public:
 	double cached_opt_C_ = 0.0;
 	double cached_opt_D_ = 0.0;
 	
+	// The block compiled to bytecode, for callbacks whose execution sites support that and which EidosBytecode can handle; see SLiMSim::OptimizeScriptBlock()
+	EidosBytecode *bytecode_ = nullptr;							// OWNED
+	
 	
 	SLiMEidosBlock(const SLiMEidosBlock&) = delete;					// no copying
 	SLiMEidosBlock& operator=(const SLiMEidosBlock&) = delete;		// no copying
@@ -41,11 +41,15 @@
 #include <utility>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <unordered_set>
 #include <unordered_map>
+#include <functional>
 #include <float.h>
 #include <ctime>
+#include <chrono>
 
 #include "eidos_globals.h"
 #if EIDOS_ROBIN_HOOD_HASHING
@@ -424,6 +428,7 @@ slim_generation_t SLiMSim::InitializePopulationFromFile(const std::string &p_fil
 			
 			// reset our tree-seq auto-simplification interval so we don't simplify immediately
 			simplify_elapsed_ = 0;
+			simplify_last_post_bytes_ = TreeSequenceBytesInUse();
 			
 			// reset our last coalescence state; we don't know whether we're coalesced now or not
 			last_coalescence_state_ = false;
@@ -661,7 +666,7 @@ slim_generation_t SLiMSim::_InitializePopulationFromTextFile(const char *p_file,
 		}
 	}
 	
-	population_.cached_tally_genome_count_ = 0;
+	population_.InvalidateMutationTallies();
 	
 	// If there is an Individuals section (added in SLiM 2.0), we now need to parse it since it might contain spatial positions
 	if (has_individual_pedigree_IDs)
@@ -931,42 +936,115 @@ slim_generation_t SLiMSim::_InitializePopulationFromTextFile(const char *p_file,
 	return file_generation;
 }
 
+// A binary population file mapped into memory for the duration of a load; the mapping is private and copy-on-write, so the buffer can
+// be handed out as char * without any risk of modifying the file.  The mapping is released on destruction, including when the load
+// raises an error.  If the file cannot be mapped, it is read into an allocated buffer instead.
+class SLiMMappedFile
+{
+private:
+	char *buf_ = nullptr;
+	std::size_t size_ = 0;
+	bool mapped_ = false;
+	std::unique_ptr<char[]> read_buf_;
+	
+public:
+	SLiMMappedFile(const SLiMMappedFile&) = delete;					// no copying
+	SLiMMappedFile& operator=(const SLiMMappedFile&) = delete;		// no copying
+	SLiMMappedFile(void) = delete;									// no default constructor
+	
+	explicit SLiMMappedFile(const char *p_file)
+	{
+		int fd = open(p_file, O_RDONLY);
+		struct stat file_info;
+		
+		if ((fd == -1) || (fstat(fd, &file_info) != 0) || (file_info.st_size <= 0))
+		{
+			if (fd != -1)
+				close(fd);
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): could not open initialization file." << EidosTerminate();
+		}
+		
+		size_ = (std::size_t)file_info.st_size;
+		
+		void *mapping = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		
+		if (mapping != MAP_FAILED)
+		{
+			buf_ = static_cast<char *>(mapping);
+			mapped_ = true;
+			
+			// the whole file will be read, so ask for it to be paged in ahead of us
+			madvise(mapping, size_, MADV_WILLNEED);
+		}
+		else
+		{
+			read_buf_.reset(new char[size_]);
+			buf_ = read_buf_.get();
+			
+			std::size_t read_size = 0;
+			
+			while (read_size < size_)
+			{
+				ssize_t chunk_size = read(fd, buf_ + read_size, size_ - read_size);
+				
+				if (chunk_size <= 0)
+				{
+					close(fd);
+					EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): could not read initialization file." << EidosTerminate();
+				}
+				
+				read_size += (std::size_t)chunk_size;
+			}
+		}
+		
+		close(fd);
+	}
+	
+	~SLiMMappedFile(void)
+	{
+		if (mapped_)
+			munmap(buf_, size_);
+	}
+	
+	inline char *Buffer(void) const { return buf_; }
+	inline std::size_t Size(void) const { return size_; }
+};
+
+// Return a column of p_count elements of type T at *p_ptr in a version 7 binary population file, and advance *p_ptr past the column
+// and its padding.  Columns are padded to a multiple of 8 bytes by Population::PrintAllBinary(), so the column can be used in place.
+template <typename T>
+static const T *BinaryColumn(char **p_ptr, char *p_buf_end, int64_t p_count)
+{
+	char *p = *p_ptr;
+	
+	if ((p_count < 0) || ((uint64_t)p_count > (uint64_t)(p_buf_end - p) / sizeof(T)))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): unexpected EOF while reading columns." << EidosTerminate();
+	
+	std::size_t byte_count = (std::size_t)p_count * sizeof(T);
+	std::size_t padded_byte_count = (byte_count + 7) & ~(std::size_t)7;
+	
+	if (padded_byte_count > (std::size_t)(p_buf_end - p))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): unexpected EOF while reading columns." << EidosTerminate();
+	
+	*p_ptr = p + padded_byte_count;
+	return reinterpret_cast<const T *>(p);
+}
+
 #ifndef __clang_analyzer__
 slim_generation_t SLiMSim::_InitializePopulationFromBinaryFile(const char *p_file, EidosInterpreter *p_interpreter)
 {
-	std::size_t file_size = 0;
 	slim_generation_t file_generation;
 	int32_t spatial_output_count;
 	int age_output_count = 0;
 	int pedigree_output_count = 0;
 	bool has_nucleotides = false;
 	
-	// Read file into buf
-	std::ifstream infile(p_file, std::ios::in | std::ios::binary);
-	
-	if (!infile.is_open() || infile.eof())
-		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): could not open initialization file." << EidosTerminate();
-	
-	// Determine the file length
-	infile.seekg(0, std::ios_base::end);
-	file_size = infile.tellg();
-	
-	// Read in the entire file; we assume we have enough memory, for now
-	std::unique_ptr<char[]> raii_buf(new char[file_size]);
-	char *buf = raii_buf.get();
-	
-	if (!buf)
-		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): could not allocate input buffer." << EidosTerminate();
-	
-	char *buf_end = buf + file_size;
+	// Map the file into memory; we work only with the mapped buffer from here on
+	SLiMMappedFile mapped_file(p_file);
+	char *buf = mapped_file.Buffer();
+	char *buf_end = buf + mapped_file.Size();
 	char *p = buf;
 	
-	infile.seekg(0, std::ios_base::beg);
-	infile.read(buf, file_size);
-	
-	// Close the file; we will work only with our buffer from here on
-	infile.close();
-	
 	int32_t section_end_tag;
 	int32_t file_version;
 	
@@ -993,7 +1071,7 @@ slim_generation_t SLiMSim::_InitializePopulationFromBinaryFile(const char *p_fil
 			version_tag = 3;
 		}
 		
-		if ((version_tag != 1) && (version_tag != 2) && (version_tag != 3) && (version_tag != 5) && (version_tag != 6))
+		if ((version_tag != 1) && (version_tag != 2) && (version_tag != 3) && (version_tag != 5) && (version_tag != 6) && (version_tag != 7))
 			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): unrecognized version." << EidosTerminate();
 		
 		file_version = version_tag;
@@ -1140,6 +1218,18 @@ slim_generation_t SLiMSim::_InitializePopulationFromBinaryFile(const char *p_fil
 	// As of SLiM 3, we set the generation up here, before making any individuals, because we need it to be correct for the tree-seq recording code.
 	SetGeneration(file_generation);
 	
+	// Version 7 and later files are columnar after the header
+	if (file_version >= 7)
+	{
+		_InitializePopulationFromColumnarBinaryFile(p, buf, buf_end, p_interpreter, spatial_output_count, age_output_count, pedigree_output_count, has_nucleotides);
+		
+		// Re-tally mutation references so we have accurate frequency counts for our new mutations
+		population_.UniqueMutationRuns();
+		population_.TallyMutationReferences(nullptr, true);
+		
+		return file_generation;
+	}
+	
 	// Populations section
 	while (true)
 	{
@@ -1326,7 +1416,7 @@ slim_generation_t SLiMSim::_InitializePopulationFromBinaryFile(const char *p_fil
 		}
 	}
 	
-	population_.cached_tally_genome_count_ = 0;
+	population_.InvalidateMutationTallies();
 	
 	if (p + sizeof(section_end_tag) > buf_end)
 		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): unexpected EOF after mutations." << EidosTerminate();
@@ -1627,12 +1717,356 @@ slim_generation_t SLiMSim::_InitializePopulationFromBinaryFile(const char *p_fil
 	
 	return file_generation;
 }
+
+void SLiMSim::_InitializePopulationFromColumnarBinaryFile(char *p, char *buf, char *buf_end, EidosInterpreter *p_interpreter, int32_t p_spatial_output_count, int p_age_output_count, int p_pedigree_output_count, bool p_has_nucleotides)
+{
+	// The header has been read already, leaving p just past it; see Population::PrintAllBinary() for the layout of the rest of the
+	// file.  The header is padded so that the columns are 8-byte aligned relative to the start of the file, so we skip the padding.
+	p = buf + (((p - buf) + 7) & ~(std::ptrdiff_t)7);
+	
+	int32_t section_end_tag;
+	const int64_t *counts = BinaryColumn<int64_t>(&p, buf_end, 8);
+	int64_t subpop_count = counts[0];
+	int64_t mutation_count = counts[1];
+	int64_t run_count = counts[2];
+	int64_t run_mutation_count = counts[3];
+	int64_t genome_count = counts[4];
+	int64_t genome_mutrun_count = counts[5];
+	int64_t genome_mutrun_length = counts[6];
+	int64_t individual_count = counts[7];
+	
+	if ((subpop_count < 0) || (mutation_count < 0) || (mutation_count > INT32_MAX) || (run_count < 0) || (run_count >= INT32_MAX) || (run_mutation_count < 0) || (genome_mutrun_count < 1) || (genome_mutrun_count > INT32_MAX) || (genome_mutrun_length < 1) || (individual_count < 0) || (genome_count != individual_count * 2))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): malformed section counts." << EidosTerminate();
+	
+	// Subpopulations section
+	const slim_objectid_t *subpop_ids = BinaryColumn<slim_objectid_t>(&p, buf_end, subpop_count);
+	const slim_popsize_t *subpop_sizes = BinaryColumn<slim_popsize_t>(&p, buf_end, subpop_count);
+	const int32_t *subpop_sex_flags = BinaryColumn<int32_t>(&p, buf_end, subpop_count);
+	const double *subpop_sex_ratios = BinaryColumn<double>(&p, buf_end, subpop_count);
+	std::vector<Subpopulation *> subpops;
+	int64_t total_subpop_size = 0;
+	
+	for (int64_t subpop_index = 0; subpop_index < subpop_count; ++subpop_index)
+	{
+		if (subpop_sex_flags[subpop_index] != population_.sim_.sex_enabled_)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): sex vs. hermaphroditism mismatch between file and simulation." << EidosTerminate();
+		
+		// Create the population population
+		Subpopulation *new_subpop = population_.AddSubpopulation(subpop_ids[subpop_index], subpop_sizes[subpop_index], subpop_sex_ratios[subpop_index]);
+		
+		// define a new Eidos variable to refer to the new subpopulation
+		EidosSymbolTableEntry &symbol_entry = new_subpop->SymbolTableEntry();
+		
+		if (p_interpreter && p_interpreter->SymbolTable().ContainsSymbol(symbol_entry.first))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): new subpopulation symbol " << EidosStringRegistry::StringForGlobalStringID(symbol_entry.first) << " was already defined prior to its definition here." << EidosTerminate();
+		
+		simulation_constants_->InitializeConstantSymbolEntry(symbol_entry);
+		
+		subpops.emplace_back(new_subpop);
+		total_subpop_size += subpop_sizes[subpop_index];
+	}
+	
+	if (total_subpop_size != individual_count)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): individual count does not match the subpopulation sizes." << EidosTerminate();
+	
+	// Mutations section
+	const slim_mutationid_t *mutation_ids = BinaryColumn<slim_mutationid_t>(&p, buf_end, mutation_count);
+	const slim_objectid_t *mutation_type_ids = BinaryColumn<slim_objectid_t>(&p, buf_end, mutation_count);
+	const slim_position_t *positions = BinaryColumn<slim_position_t>(&p, buf_end, mutation_count);
+	const slim_selcoeff_t *selection_coeffs = BinaryColumn<slim_selcoeff_t>(&p, buf_end, mutation_count);
+	const slim_selcoeff_t *dominance_coeffs = BinaryColumn<slim_selcoeff_t>(&p, buf_end, mutation_count);
+	const slim_objectid_t *subpop_indices = BinaryColumn<slim_objectid_t>(&p, buf_end, mutation_count);
+	const slim_generation_t *origin_generations = BinaryColumn<slim_generation_t>(&p, buf_end, mutation_count);
+	BinaryColumn<slim_refcount_t>(&p, buf_end, mutation_count);				// prevalences; we don't use the frequency when reading the pop data back in
+	const int8_t *nucleotides = BinaryColumn<int8_t>(&p, buf_end, p_has_nucleotides ? mutation_count : 0);
+	std::vector<MutationIndex> mutations(mutation_count);
+	MutationType *mutation_type_ptr = nullptr;
+	slim_position_t last_position = chromosome_->last_position_;
+	
+	for (int64_t polymorphism_id = 0; polymorphism_id < mutation_count; ++polymorphism_id)
+	{
+		slim_objectid_t mutation_type_id = mutation_type_ids[polymorphism_id];
+		slim_position_t position = positions[polymorphism_id];
+		slim_selcoeff_t selection_coeff = selection_coeffs[polymorphism_id];
+		slim_selcoeff_t dominance_coeff = dominance_coeffs[polymorphism_id];
+		int8_t nucleotide = (p_has_nucleotides ? nucleotides[polymorphism_id] : -1);
+		
+		// look up the mutation type from its index; consecutive mutations often share a mutation type
+		if (!mutation_type_ptr || (mutation_type_ptr->mutation_type_id_ != mutation_type_id))
+		{
+			mutation_type_ptr = MutationTypeWithID(mutation_type_id);
+			
+			if (!mutation_type_ptr)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation type m" << mutation_type_id << " has not been defined." << EidosTerminate();
+		}
+		
+		if (mutation_type_ptr->dominance_coeff_ != dominance_coeff)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation type m" << mutation_type_id << " has dominance coefficient " << mutation_type_ptr->dominance_coeff_ << " that does not match the population file dominance coefficient of " << dominance_coeff << "." << EidosTerminate();
+		
+		if ((nucleotide == -1) && mutation_type_ptr->nucleotide_based_)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation type m"<< mutation_type_id << " is nucleotide-based, but a nucleotide value for a mutation of this type was not supplied." << EidosTerminate();
+		if ((nucleotide != -1) && !mutation_type_ptr->nucleotide_based_)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation type m"<< mutation_type_id << " is not nucleotide-based, but a nucleotide value for a mutation of this type was supplied." << EidosTerminate();
+		if ((position < 0) || (position > last_position))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation position " << position << " is outside the chromosome." << EidosTerminate();
+		
+		// construct the new mutation; NOTE THAT THE STACKING POLICY IS NOT CHECKED HERE, AS THIS IS NOT CONSIDERED THE ADDITION OF A MUTATION!
+		MutationIndex new_mut_index = SLiM_NewMutationFromBlock();
+		
+		Mutation *new_mut = new (gSLiM_Mutation_Block + new_mut_index) Mutation(mutation_ids[polymorphism_id], mutation_type_ptr, position, selection_coeff, subpop_indices[polymorphism_id], origin_generations[polymorphism_id], nucleotide);
+		
+		// add it to our local map, so we can find it when making genomes, and to the population's mutation registry
+		mutations[polymorphism_id] = new_mut_index;
+		population_.MutationRegistryAdd(new_mut);
+		
+#ifdef SLIM_KEEP_MUTTYPE_REGISTRIES
+		if (population_.keeping_muttype_registries_)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): (internal error) separate muttype registries set up during pop load." << EidosTerminate();
+#endif
+		
+		// all mutations seen here will be added to the simulation somewhere, so check and set pure_neutral_ and all_pure_neutral_DFE_
+		if (selection_coeff != 0.0)
+		{
+			pure_neutral_ = false;
+			mutation_type_ptr->all_pure_neutral_DFE_ = false;
+		}
+	}
+	
+	population_.InvalidateMutationTallies();
+	
+	// Mutation runs section; the offsets must be in order and the mutations must refer to defined polymorphisms
+	const int64_t *run_offsets = BinaryColumn<int64_t>(&p, buf_end, run_count + 1);
+	const slim_polymorphismid_t *run_mutations = BinaryColumn<slim_polymorphismid_t>(&p, buf_end, run_mutation_count);
+	
+	if ((run_offsets[0] != 0) || (run_offsets[run_count] != run_mutation_count))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): malformed mutation run offsets." << EidosTerminate();
+	
+	for (int64_t run_id = 0; run_id < run_count; ++run_id)
+		if (run_offsets[run_id] > run_offsets[run_id + 1])
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): malformed mutation run offsets." << EidosTerminate();
+	
+	// Genomes section
+	const int32_t *genome_types = BinaryColumn<int32_t>(&p, buf_end, genome_count);
+	const int32_t *genome_runs = BinaryColumn<int32_t>(&p, buf_end, genome_count * genome_mutrun_count);
+	
+	// Individuals section
+	const double *spatial_x = BinaryColumn<double>(&p, buf_end, (p_spatial_output_count >= 1) ? individual_count : 0);
+	const double *spatial_y = BinaryColumn<double>(&p, buf_end, (p_spatial_output_count >= 2) ? individual_count : 0);
+	const double *spatial_z = BinaryColumn<double>(&p, buf_end, (p_spatial_output_count >= 3) ? individual_count : 0);
+	const slim_pedigreeid_t *pedigree_ids = BinaryColumn<slim_pedigreeid_t>(&p, buf_end, p_pedigree_output_count ? individual_count : 0);
+	const slim_age_t *ages = BinaryColumn<slim_age_t>(&p, buf_end, p_age_output_count ? individual_count : 0);
+	
+	if (p + sizeof(section_end_tag) > buf_end)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): unexpected EOF after genomes." << EidosTerminate();
+	
+	section_end_tag = *(int32_t *)p;
+	p += sizeof(section_end_tag);
+	
+	if (section_end_tag != (int32_t)0xFFFF0000)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): missing section end after genomes." << EidosTerminate();
+	
+	// Set up the individuals and genomes.  When the simulation uses the same mutation run configuration as the file, each unique run
+	// is built once, with a bulk copy, the first time a genome refers to it, and is then shared by every genome that refers to it.
+	// Otherwise, each genome's mutations are gathered from its runs, in position order, and distributed into the simulation's runs.
+	if (p_pedigree_output_count)
+		gSLiM_next_pedigree_id = 0;
+	
+	// Translate the run contents to mutation block indices once; every reference to a run then copies from this in bulk
+	std::vector<MutationIndex> run_mutation_indices(run_mutation_count);
+	
+	for (int64_t run_mutation_index = 0; run_mutation_index < run_mutation_count; ++run_mutation_index)
+	{
+		slim_polymorphismid_t polymorphism_id = run_mutations[run_mutation_index];
+		
+		if ((polymorphism_id < 0) || (polymorphism_id >= mutation_count))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation " << polymorphism_id << " has not been defined." << EidosTerminate();
+		
+		run_mutation_indices[run_mutation_index] = mutations[polymorphism_id];
+	}
+	
+	std::vector<MutationRun *> built_runs(run_count, nullptr);
+	std::vector<int32_t> run_position_indices(run_count, -1);
+	int64_t file_individual_index = 0;
+	
+	for (Subpopulation *subpop : subpops)
+	{
+		slim_popsize_t subpop_size = subpop->parent_subpop_size_;
+		
+		for (slim_popsize_t individual_index = 0; individual_index < subpop_size; ++individual_index, ++file_individual_index)
+		{
+			Individual &individual = *subpop->parent_individuals_[individual_index];
+			
+			if (p_spatial_output_count >= 1)
+				individual.spatial_x_ = spatial_x[file_individual_index];
+			if (p_spatial_output_count >= 2)
+				individual.spatial_y_ = spatial_y[file_individual_index];
+			if (p_spatial_output_count >= 3)
+				individual.spatial_z_ = spatial_z[file_individual_index];
+			
+			if (p_pedigree_output_count && PedigreesEnabled())
+			{
+				slim_pedigreeid_t pedigree_id = pedigree_ids[file_individual_index];
+				
+				individual.SetPedigreeID(pedigree_id);
+				individual.genome1_->SetGenomeID(pedigree_id * 2);
+				individual.genome2_->SetGenomeID(pedigree_id * 2 + 1);
+				gSLiM_next_pedigree_id = std::max(gSLiM_next_pedigree_id, pedigree_id + 1);
+			}
+			
+#ifdef SLIM_NONWF_ONLY
+			if (p_age_output_count)
+				individual.age_ = ages[file_individual_index];
+#else
+			(void)ages;
+#endif  // SLIM_NONWF_ONLY
+			
+			for (int genome_offset = 0; genome_offset < 2; ++genome_offset)
+			{
+				Genome &genome = *subpop->parent_genomes_[individual_index * 2 + genome_offset];
+				int64_t file_genome_index = file_individual_index * 2 + genome_offset;
+				const int32_t *run_ids = genome_runs + file_genome_index * genome_mutrun_count;
+				
+				// Error-check the genome type and the null genome state
+				if (genome_types[file_genome_index] != (int32_t)genome.Type())
+					EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): genome type does not match the instantiated genome." << EidosTerminate();
+				
+				if (run_ids[0] == -1)
+				{
+					if (!genome.IsNull())
+						EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): genome is specified as null, but the instantiated genome is non-null." << EidosTerminate();
+					continue;
+				}
+				
+				if (genome.IsNull())
+					EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): genome is specified as non-null, but the instantiated genome is null." << EidosTerminate();
+				
+				for (int64_t run_index = 0; run_index < genome_mutrun_count; ++run_index)
+				{
+					int32_t run_id = run_ids[run_index];
+					
+					if ((run_id < 0) || (run_id >= run_count))
+						EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation run " << run_id << " has not been defined." << EidosTerminate();
+					
+					// The first time a run is used, check that its mutations fall within the span of the position it is used at; an
+					// empty run may be used anywhere, but a non-empty run is only valid at that one position
+					if (run_position_indices[run_id] == -1)
+					{
+						slim_position_t run_start_position = run_index * genome_mutrun_length;
+						slim_position_t run_end_position = run_start_position + genome_mutrun_length;
+						
+						for (int64_t run_mutation_index = run_offsets[run_id]; run_mutation_index < run_offsets[run_id + 1]; ++run_mutation_index)
+						{
+							slim_position_t position = positions[run_mutations[run_mutation_index]];
+							
+							if ((position < run_start_position) || (position >= run_end_position))
+								EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation " << run_mutations[run_mutation_index] << " is outside the span of mutation run " << run_id << "." << EidosTerminate();
+						}
+						
+						run_position_indices[run_id] = (int32_t)run_index;
+					}
+					else if ((run_position_indices[run_id] != run_index) && (run_offsets[run_id] != run_offsets[run_id + 1]))
+					{
+						EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): mutation run " << run_id << " is used at more than one run position." << EidosTerminate();
+					}
+				}
+				
+				if ((genome.mutrun_count_ == genome_mutrun_count) && (genome.mutrun_length_ == genome_mutrun_length))
+				{
+					// Each unique run is built once, the first time a genome refers to it, and is then shared
+					for (int32_t run_index = 0; run_index < genome.mutrun_count_; ++run_index)
+					{
+						int32_t run_id = run_ids[run_index];
+						MutationRun *mutrun = built_runs[run_id];
+						
+						if (!mutrun)
+						{
+							mutrun = MutationRun::NewMutationRun();		// take from shared pool of used objects
+							
+							if (run_offsets[run_id] != run_offsets[run_id + 1])
+								mutrun->emplace_back_bulk(run_mutation_indices.data() + run_offsets[run_id], (long)(run_offsets[run_id + 1] - run_offsets[run_id]));
+							
+							built_runs[run_id] = mutrun;
+						}
+						
+						genome.mutruns_[run_index].reset(mutrun);
+					}
+				}
+				else
+				{
+					// Each of the file's runs is appended in bulk to the genome's run that contains it; a file run that straddles a
+					// boundary between the genome's runs is split at the boundary
+					slim_position_t mutrun_length = genome.mutrun_length_;
+					slim_mutrun_index_t current_mutrun_index = -1;
+					
+					for (int64_t run_index = 0; run_index < genome_mutrun_count; ++run_index)
+					{
+						int32_t run_id = run_ids[run_index];
+						int64_t run_mutation_index = run_offsets[run_id];
+						int64_t run_mutation_end = run_offsets[run_id + 1];
+						
+						while (run_mutation_index < run_mutation_end)
+						{
+							slim_mutrun_index_t mutrun_index = (slim_mutrun_index_t)(positions[run_mutations[run_mutation_index]] / mutrun_length);
+							int64_t segment_end = run_mutation_end;
+							
+							if (positions[run_mutations[run_mutation_end - 1]] / mutrun_length != mutrun_index)
+							{
+								segment_end = run_mutation_index + 1;
+								
+								while (positions[run_mutations[segment_end]] / mutrun_length == mutrun_index)
+									segment_end++;
+							}
+							
+							if (mutrun_index != current_mutrun_index)
+							{
+								current_mutrun_index = mutrun_index;
+								genome.WillModifyRun(current_mutrun_index);
+							}
+							
+							genome.mutruns_[current_mutrun_index]->emplace_back_bulk(run_mutation_indices.data() + run_mutation_index, (long)(segment_end - run_mutation_index));
+							run_mutation_index = segment_end;
+						}
+					}
+				}
+			}
+		}
+	}
+	
+	// Ancestral sequence section, for nucleotide-based models
+	if (p_has_nucleotides)
+	{
+		if (p + sizeof(int64_t) > buf_end)
+		{
+			// The ancestral sequence can be suppressed at save time; as with earlier versions, that is not an error
+		}
+		else
+		{
+			chromosome_->AncestralSequence()->ReadCompressedNucleotides(&p, buf_end);
+			
+			if (p + sizeof(section_end_tag) > buf_end)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): unexpected EOF after ancestral sequence." << EidosTerminate();
+			else
+			{
+				section_end_tag = *(int32_t *)p;
+				p += sizeof(section_end_tag);
+				(void)p;	// dead store above is deliberate
+				
+				if (section_end_tag != (int32_t)0xFFFF0000)
+					EIDOS_TERMINATION << "ERROR (SLiMSim::_InitializePopulationFromBinaryFile): missing section end after ancestral sequence." << EidosTerminate();
+			}
+		}
+	}
+}
 #else
 // the static analyzer has a lot of trouble understanding this method
 slim_generation_t SLiMSim::_InitializePopulationFromBinaryFile(const char *p_file, EidosInterpreter *p_interpreter)
 {
 	return 0;
 }
+
+void SLiMSim::_InitializePopulationFromColumnarBinaryFile(char *p, char *buf, char *buf_end, EidosInterpreter *p_interpreter, int32_t p_spatial_output_count, int p_age_output_count, int p_pedigree_output_count, bool p_has_nucleotides)
+{
+}
 #endif
 
 void SLiMSim::ValidateScriptBlockCaches(void)
@@ -2070,6 +2504,16 @@ void SLiMSim::OptimizeScriptBlock(SLiMEidosBlock *p_script_block)
 //				std::cout << "NOT OPTIMIZED:" << std::endl << "   " << base_node->token_->token_string_ << std::endl;
 		}
 	}
+	
+	// Callbacks that are not special-cased above, and are not constant, may still be simple enough to compile to bytecode; see
+	// EidosBytecode.  This is done only for the callback types whose execution sites know how to use the bytecode.
+	if (!p_script_block->has_cached_optimization_ && !p_script_block->bytecode_ && !p_script_block->compound_statement_node_->cached_return_value_)
+	{
+		SLiMEidosBlockType block_type = p_script_block->type_;
+		
+		if ((block_type == SLiMEidosBlockType::SLiMEidosFitnessCallback) || (block_type == SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback) || (block_type == SLiMEidosBlockType::SLiMEidosInteractionCallback))
+			p_script_block->bytecode_ = EidosBytecode::Compile(p_script_block->compound_statement_node_);
+	}
 }
 
 void SLiMSim::AddScriptBlock(SLiMEidosBlock *p_script_block, EidosInterpreter *p_interpreter, const EidosToken *p_error_token)
@@ -2297,14 +2741,14 @@ void SLiMSim::RunInitializeCallbacks(void)
 	{
 		if (script_block->active_)
 		{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_START();
 #endif
 			
 			population_.ExecuteScript(script_block, generation_, *chromosome_);
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosInitializeCallback)]);
 #endif
@@ -2943,7 +3387,7 @@ void SLiMSim::MaintainMutationRunExperiments(double p_last_gen_runtime)
 	}
 }
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 #if SLIM_USE_NONNEUTRAL_CACHES
 void SLiMSim::CollectSLiMguiMutationProfileInfo(void)
@@ -3072,14 +3516,14 @@ bool SLiMSim::_RunOneGeneration(void)
 	{
 		// The zero generation is handled here by shared code, since it is the same for WF and nonWF models
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
 		
 		RunInitializeCallbacks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[0]);
 #endif
@@ -3088,7 +3532,7 @@ bool SLiMSim::_RunOneGeneration(void)
 		gEidosErrorContext.currentScript = nullptr;
 		gEidosErrorContext.executingRuntimeScript = false;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		if (gEidosProfilingClientCount)
 			CollectSLiMguiMemoryUsageProfileInfo();
@@ -3130,7 +3574,7 @@ bool SLiMSim::_RunOneGeneration(void)
 //
 bool SLiMSim::_RunOneGenerationWF(void)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 #if SLIM_USE_NONNEUTRAL_CACHES
 	if (gEidosProfilingClientCount)
@@ -3147,7 +3591,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 1: Execute early() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3165,14 +3609,14 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, *chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventEarly)]);
 #endif
@@ -3184,7 +3628,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[1]);
 #endif
@@ -3202,7 +3646,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 2: Generate offspring: evolve all subpopulations
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3335,11 +3779,12 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// moved up to SLiMGenerationStage::kWFStage2GenerateOffspring, 9 January 2018, so that the
 		// population is in a standard state for CheckIndividualIntegrity() at the end of this stage
 		population_.ClearParentalGenomes();
+		population_.ClearNewMutationRunTable();
 		
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[2]);
 #endif
@@ -3357,7 +3802,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 3: Remove fixed mutations and associated tasks
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3383,7 +3828,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// Deregister any interaction() callbacks that have been scheduled for deregistration, since it is now safe to do so
 		DeregisterScheduledInteractionBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[3]);
 #endif
@@ -3401,7 +3846,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 4: Swap generations
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3410,7 +3855,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		
 		population_.SwapGenerations();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[4]);
 #endif
@@ -3428,7 +3873,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 5: Execute late() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3446,14 +3891,14 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, *chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventLate)]);
 #endif
@@ -3465,7 +3910,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[5]);
 #endif
@@ -3483,7 +3928,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 6: Calculate fitness values for the new parental generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3499,7 +3944,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		if (x_experiments_enabled_)
 			MaintainMutationRunExperiments((std::clock() - x_clock0) / (double)CLOCKS_PER_SEC);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[6]);
 #endif
@@ -3531,19 +3976,22 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// TREE SEQUENCE RECORDING
 		if (recording_tree_)
 		{
+			// append this generation's buffered nodes to the node table, so that it is complete between generations
+			FlushBufferedNodes();
+
 #if DEBUG
 			// check the integrity of the tree sequence in every generation in Debug mode only
 			CheckTreeSeqIntegrity();
 #endif
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_START();
 #endif
 			
 			CheckAutoSimplification();
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END(profile_stage_totals_[7]);
 #endif
@@ -3569,7 +4017,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		gEidosErrorContext.currentScript = nullptr;
 		gEidosErrorContext.executingRuntimeScript = false;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		if (gEidosProfilingClientCount)
 			CollectSLiMguiMemoryUsageProfileInfo();
@@ -3598,7 +4046,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 //
 bool SLiMSim::_RunOneGenerationNonWF(void)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 #if SLIM_USE_NONNEUTRAL_CACHES
 	if (gEidosProfilingClientCount)
@@ -3638,7 +4086,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		}
 #endif
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3723,18 +4171,21 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		for (std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
 			subpop_pair.second->MergeReproductionOffspring();
 		
+		// runs built during reproduction no longer need to be uniqued against each other
+		population_.ClearNewMutationRunTable();
+		
 		// clear the "migrant" property on all individuals
 		for (std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
 			for (Individual *individual : subpop_pair.second->parent_individuals_)
 				individual->migrant_ = false;
 		
 		// cached mutation counts/frequencies are no longer accurate; mark the cache as invalid
-		population_.cached_tally_genome_count_ = 0;
+		population_.InvalidateMutationTallies();
 		
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[1]);
 #endif
@@ -3752,7 +4203,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 2: Execute early() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3770,14 +4221,14 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, *chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventEarly)]);
 #endif
@@ -3789,7 +4240,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[2]);
 #endif
@@ -3807,7 +4258,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 3: Calculate fitness values for the new generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3826,7 +4277,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		// Deregister any interaction() callbacks that have been scheduled for deregistration, since it is now safe to do so
 		DeregisterScheduledInteractionBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[3]);
 #endif
@@ -3838,7 +4289,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 4: Viability/survival selection
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3848,7 +4299,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		for (std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
 			subpop_pair.second->ViabilitySelection();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[4]);
 #endif
@@ -3866,7 +4317,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 5: Remove fixed mutations and associated tasks
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3885,7 +4336,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		if (generation_ % 100 == 0)
 			population_.UniqueMutationRuns();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[5]);
 #endif
@@ -3903,7 +4354,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 6: Execute late() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3921,14 +4372,14 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, *chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventLate)]);
 #endif
@@ -3944,7 +4395,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		if (x_experiments_enabled_)
 			MaintainMutationRunExperiments((std::clock() - x_clock0) / (double)CLOCKS_PER_SEC);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[6]);
 #endif
@@ -3982,19 +4433,22 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		// TREE SEQUENCE RECORDING
 		if (recording_tree_)
 		{
+			// append this generation's buffered nodes to the node table, so that it is complete between generations
+			FlushBufferedNodes();
+
 #if DEBUG
 			// check the integrity of the tree sequence in every generation in Debug mode only
 			CheckTreeSeqIntegrity();
 #endif
 									
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_START();
 #endif
 			
 			CheckAutoSimplification();
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END(profile_stage_totals_[7]);
 #endif
@@ -4024,7 +4478,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		gEidosErrorContext.currentScript = nullptr;
 		gEidosErrorContext.executingRuntimeScript = false;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		if (gEidosProfilingClientCount)
 			CollectSLiMguiMemoryUsageProfileInfo();
@@ -4416,7 +4870,7 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 {
 	// Gather genomes
 	std::vector<Genome *> all_genomes_in_use, all_genomes_not_in_use;
-	size_t genome_pool_usage = 0, individual_pool_usage = 0;
+	size_t genome_pool_usage = 0, mutrun_buffer_pool_usage = 0, individual_pool_usage = 0;
 	
 	for (auto iter : population_.subpops_)
 	{
@@ -4430,6 +4884,9 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 		all_genomes_in_use.insert(all_genomes_in_use.end(), subpop.nonWF_offspring_genomes_.begin(), subpop.nonWF_offspring_genomes_.end());
 		
 		genome_pool_usage += subpop.genome_pool_->MemoryUsageForAllNodes();
+		for (EidosObjectPool *pool : subpop.mutrun_buffer_pools_)
+			if (pool)
+				mutrun_buffer_pool_usage += pool->MemoryUsageForAllNodes();
 		individual_pool_usage += subpop.individual_pool_->MemoryUsageForAllNodes();
 	}
 	
@@ -4461,6 +4918,9 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 		p_usage->genomeUnusedPoolBuffers = 0;
 		for (Genome *genome : all_genomes_not_in_use)
 			p_usage->genomeUnusedPoolBuffers += genome->MemoryUsageForMutrunBuffers();
+		
+		// external mutrun buffers come from slabs in each subpop; space in those slabs not used by any genome is unused pool space
+		p_usage->genomeUnusedPoolSpace += mutrun_buffer_pool_usage - (p_usage->genomeExternalBuffers + p_usage->genomeUnusedPoolBuffers);
 	}
 	
 	// GenomicElement
@@ -4579,7 +5039,7 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 		
 		p_usage->slimsimObjects = (sizeof(SLiMSim) - sizeof(Chromosome)) * p_usage->slimsimObjects_count;	// Chromosome is handled separately above
 		
-		p_usage->slimsimTreeSeqTables = recording_tree_ ? MemoryUsageForTables(tables_) : 0;
+		p_usage->slimsimTreeSeqTables = recording_tree_ ? MemoryUsageForTables(tables_) + buffered_edges_.capacity() * sizeof(ts_buffered_edge) + buffered_nodes_.flags.capacity() * sizeof(tsk_flags_t) + buffered_nodes_.time.capacity() * sizeof(double) + buffered_nodes_.population.capacity() * sizeof(tsk_id_t) + buffered_nodes_.metadata.capacity() * sizeof(GenomeMetadataRec) : 0;
 	}
 	
 	// Subpopulation
@@ -4637,9 +5097,9 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 	/*
 	 Subpopulation:
 	 
-	gsl_ran_discrete_t *lookup_parent_ = nullptr;			// OWNED POINTER: lookup table for drawing a parent based upon fitness
-	gsl_ran_discrete_t *lookup_female_parent_ = nullptr;	// OWNED POINTER: lookup table for drawing a female parent based upon fitness, SEX ONLY
-	gsl_ran_discrete_t *lookup_male_parent_ = nullptr;		// OWNED POINTER: lookup table for drawing a male parent based upon fitness, SEX ONLY
+	EidosAliasTable lookup_parent_;					// lookup table for drawing a parent based upon fitness; not built in pure neutral models
+	EidosAliasTable lookup_female_parent_;			// lookup table for drawing a female parent based upon fitness, SEX ONLY
+	EidosAliasTable lookup_male_parent_;			// lookup table for drawing a male parent based upon fitness, SEX ONLY
 
 	 */
 	
@@ -4717,7 +5177,7 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 	p_usage->totalMemoryUsage = total_usage;
 }
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 void SLiMSim::CollectSLiMguiMemoryUsageProfileInfo(void)
 {
@@ -4787,24 +5247,339 @@ void SLiMSim::CollectSLiMguiMemoryUsageProfileInfo(void)
 	profile_total_memory_usage_.totalMemoryUsage += profile_last_memory_usage_.totalMemoryUsage;
 	
 	total_memory_tallies_++;
+	
+	// slim -profile also keeps a history of usage over time; when the history fills up, every other sample is
+	// discarded and the sampling interval is doubled, so a long run costs no more than a short one
+	if (profile_memory_history_enabled_ && (generation_ % profile_memory_history_stride_ == 0))
+	{
+		profile_memory_history_.emplace_back(generation_, profile_last_memory_usage_);
+		
+		if (profile_memory_history_.size() >= SLIM_PROFILE_MEMORY_HISTORY_MAX)
+		{
+			size_t kept_count = 0;
+			
+			for (size_t history_index = 0; history_index < profile_memory_history_.size(); history_index += 2)
+				profile_memory_history_[kept_count++] = profile_memory_history_[history_index];
+			
+			profile_memory_history_.resize(kept_count);
+			profile_memory_history_stride_ *= 2;
+		}
+	}
 }
-#endif
-
-
-//
-// TREE SEQUENCE RECORDING
-//
-#pragma mark -
-#pragma mark Tree sequence recording
-#pragma mark -
 
-void SLiMSim::handle_error(std::string msg, int err)
+void SLiMSim::StartProfiling(void)
 {
-	std::cout << "Error:" << msg << ": " << tsk_strerror(err) << std::endl;
-	EIDOS_TERMINATION << msg << ": " << tsk_strerror(err) << EidosTerminate();
-}
-
-void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> p_individual_map, bool p_keep_unmapped)
+	// This parallels QtSLiMWindow::startProfiling(); the caller is responsible for incrementing gEidosProfilingClientCount
+	Eidos_PrepareForProfiling();
+	
+	// zero out profile counts for generation stages and callback types
+	for (int i = 0; i < 8; ++i)
+		profile_stage_totals_[i] = 0;
+	for (int i = 0; i < 11; ++i)
+		profile_callback_totals_[i] = 0;
+	
+	// zero out profile counts for script blocks and user-defined functions; dynamic scripts will be zeroed on construction
+	for (SLiMEidosBlock *script_block : AllScriptBlocks())
+		if (script_block->type_ != SLiMEidosBlockType::SLiMEidosUserDefinedFunction)
+			script_block->root_node_->ZeroProfileTotals();
+	
+	for (auto functionPairIter : simulation_functions_)
+	{
+		const EidosFunctionSignature *signature = functionPairIter.second.get();
+		
+		if (signature->body_script_ && signature->user_defined_)
+			signature->body_script_->AST()->ZeroProfileTotals();
+	}
+	
+#if SLIM_USE_NONNEUTRAL_CACHES
+	// zero out mutation run metrics
+	profile_mutcount_history_.clear();
+	profile_nonneutral_regime_history_.clear();
+	profile_mutation_total_usage_ = 0;
+	profile_nonneutral_mutation_total_ = 0;
+	profile_mutrun_total_usage_ = 0;
+	profile_unique_mutrun_total_ = 0;
+	profile_mutrun_nonneutral_recache_total_ = 0;
+	profile_max_mutation_index_ = 0;
+#endif
+	
+	// zero out memory usage metrics, and start keeping a history of them
+	EIDOS_BZERO(&profile_last_memory_usage_, sizeof(SLiM_MemoryUsage));
+	EIDOS_BZERO(&profile_total_memory_usage_, sizeof(SLiM_MemoryUsage));
+	total_memory_tallies_ = 0;
+	
+	profile_memory_history_enabled_ = true;
+	profile_memory_history_stride_ = 1;
+	profile_memory_history_.clear();
+}
+
+static nlohmann::json SLiM_MemoryUsageJSON(const SLiM_MemoryUsage &p_usage, int64_t p_tallies)
+{
+	// If p_tallies is greater than 1, p_usage holds totals across that many generations, and averages are reported
+	nlohmann::json j;
+	auto field = [&j, p_tallies](const char *p_key, int64_t p_value) { if (p_tallies > 1) j[p_key] = p_value / (double)p_tallies; else j[p_key] = p_value; };
+	
+	field("chromosomeObjects_count", p_usage.chromosomeObjects_count);
+	field("chromosomeObjects", p_usage.chromosomeObjects);
+	field("chromosomeMutationRateMaps", p_usage.chromosomeMutationRateMaps);
+	field("chromosomeRecombinationRateMaps", p_usage.chromosomeRecombinationRateMaps);
+	field("chromosomeAncestralSequence", p_usage.chromosomeAncestralSequence);
+	
+	field("genomeObjects_count", p_usage.genomeObjects_count);
+	field("genomeObjects", p_usage.genomeObjects);
+	field("genomeExternalBuffers", p_usage.genomeExternalBuffers);
+	field("genomeUnusedPoolSpace", p_usage.genomeUnusedPoolSpace);
+	field("genomeUnusedPoolBuffers", p_usage.genomeUnusedPoolBuffers);
+	
+	field("genomicElementObjects_count", p_usage.genomicElementObjects_count);
+	field("genomicElementObjects", p_usage.genomicElementObjects);
+	
+	field("genomicElementTypeObjects_count", p_usage.genomicElementTypeObjects_count);
+	field("genomicElementTypeObjects", p_usage.genomicElementTypeObjects);
+	
+	field("individualObjects_count", p_usage.individualObjects_count);
+	field("individualObjects", p_usage.individualObjects);
+	field("individualUnusedPoolSpace", p_usage.individualUnusedPoolSpace);
+	
+	field("interactionTypeObjects_count", p_usage.interactionTypeObjects_count);
+	field("interactionTypeObjects", p_usage.interactionTypeObjects);
+	field("interactionTypeKDTrees", p_usage.interactionTypeKDTrees);
+	field("interactionTypePositionCaches", p_usage.interactionTypePositionCaches);
+	field("interactionTypeSparseArrays", p_usage.interactionTypeSparseArrays);
+	
+	field("mutationObjects_count", p_usage.mutationObjects_count);
+	field("mutationObjects", p_usage.mutationObjects);
+	field("mutationRefcountBuffer", p_usage.mutationRefcountBuffer);
+	field("mutationUnusedPoolSpace", p_usage.mutationUnusedPoolSpace);
+	
+	field("mutationRunObjects_count", p_usage.mutationRunObjects_count);
+	field("mutationRunObjects", p_usage.mutationRunObjects);
+	field("mutationRunExternalBuffers", p_usage.mutationRunExternalBuffers);
+	field("mutationRunNonneutralCaches", p_usage.mutationRunNonneutralCaches);
+	field("mutationRunUnusedPoolSpace", p_usage.mutationRunUnusedPoolSpace);
+	field("mutationRunUnusedPoolBuffers", p_usage.mutationRunUnusedPoolBuffers);
+	
+	field("mutationTypeObjects_count", p_usage.mutationTypeObjects_count);
+	field("mutationTypeObjects", p_usage.mutationTypeObjects);
+	
+	field("slimsimObjects_count", p_usage.slimsimObjects_count);
+	field("slimsimObjects", p_usage.slimsimObjects);
+	field("slimsimTreeSeqTables", p_usage.slimsimTreeSeqTables);
+	
+	field("subpopulationObjects_count", p_usage.subpopulationObjects_count);
+	field("subpopulationObjects", p_usage.subpopulationObjects);
+	field("subpopulationFitnessCaches", p_usage.subpopulationFitnessCaches);
+	field("subpopulationParentTables", p_usage.subpopulationParentTables);
+	field("subpopulationSpatialMaps", p_usage.subpopulationSpatialMaps);
+	field("subpopulationSpatialMapsDisplay", p_usage.subpopulationSpatialMapsDisplay);
+	
+	field("substitutionObjects_count", p_usage.substitutionObjects_count);
+	field("substitutionObjects", p_usage.substitutionObjects);
+	
+	field("eidosASTNodePool", p_usage.eidosASTNodePool);
+	field("eidosSymbolTablePool", p_usage.eidosSymbolTablePool);
+	field("eidosValuePool", p_usage.eidosValuePool);
+	
+	field("totalMemoryUsage", p_usage.totalMemoryUsage);
+	
+	return j;
+}
+
+void SLiMSim::WriteProfileReport(std::ostream &p_out, double p_wall_time, double p_cpu_time, eidos_profile_t p_elapsed_wall_clock, slim_generation_t p_start_generation)
+{
+	// This writes the same information as QtSLiMWindow::displayProfileResults(), but as JSON, for slim -profile.
+	// All times are in seconds; the times for stages, callbacks, and script blocks are corrected for profiling overhead.
+	bool isWF = (model_type_ == SLiMModelType::kModelTypeWF);
+	nlohmann::json j;
+	
+	j["version"] = SLIM_VERSION_STRING;
+	j["model_type"] = (isWF ? "WF" : "nonWF");
+	j["start_generation"] = p_start_generation;
+	j["end_generation"] = generation_;
+	j["wall_time"] = p_wall_time;
+	j["wall_time_in_slim_corrected"] = Eidos_ElapsedProfileTime(p_elapsed_wall_clock);
+	j["cpu_time"] = p_cpu_time;
+	j["profile_overhead_ticks"] = gEidos_ProfileOverheadTicks;
+	j["profile_overhead_seconds"] = gEidos_ProfileOverheadSeconds;
+	j["profile_lag_ticks"] = gEidos_ProfileLagTicks;
+	j["profile_lag_seconds"] = gEidos_ProfileLagSeconds;
+	
+	// Generation stage breakdown; stage 0 is initialize(), and the stages then follow the WF or nonWF generation cycle
+	{
+		static const char *wf_stage_names[8] = {"initialize() callback execution", "early() event execution", "offspring generation", "bookkeeping (fixed mutation removal, etc.)", "generation swap", "late() event execution", "fitness calculation", "tree sequence auto-simplification"};
+		static const char *nonwf_stage_names[8] = {"initialize() callback execution", "offspring generation", "early() event execution", "fitness calculation", "viability/survival selection", "bookkeeping (fixed mutation removal, etc.)", "late() event execution", "tree sequence auto-simplification"};
+		nlohmann::json stages = nlohmann::json::array();
+		
+		for (int stage = 0; stage < 8; ++stage)
+			stages.push_back({{"stage", stage}, {"name", (isWF ? wf_stage_names : nonwf_stage_names)[stage]}, {"time", Eidos_ElapsedProfileTime(profile_stage_totals_[stage])}});
+		
+		j["generation_stages"] = stages;
+	}
+	
+	// Callback type breakdown; these follow SLiMEidosBlockType, except that SLiMEidosUserDefinedFunction is not profiled here
+	{
+		nlohmann::json callbacks = nlohmann::json::array();
+		
+		for (int type = 0; type < 11; ++type)
+		{
+			std::ostringstream type_string;
+			
+			type_string << (SLiMEidosBlockType)type;
+			callbacks.push_back({{"type", type_string.str()}, {"time", Eidos_ElapsedProfileTime(profile_callback_totals_[type])}});
+		}
+		
+		j["callback_types"] = callbacks;
+	}
+	
+	// Script block profiles; this converts the profile counts in the tree into self counts, so it can only be done once
+	{
+		nlohmann::json blocks = nlohmann::json::array();
+		
+		for (SLiMEidosBlock *script_block : AllScriptBlocks())
+		{
+			if (script_block->type_ == SLiMEidosBlockType::SLiMEidosUserDefinedFunction)
+				continue;
+			
+			const EidosASTNode *profile_root = script_block->root_node_;
+			std::ostringstream type_string;
+			nlohmann::json block;
+			
+			profile_root->ConvertProfileTotalsToSelfCounts();
+			type_string << script_block->type_;
+			
+			if (script_block->block_id_ == -1)
+				block["id"] = nullptr;
+			else
+				block["id"] = std::string("s") + std::to_string(script_block->block_id_);
+			block["type"] = type_string.str();
+			block["start_generation"] = script_block->start_generation_;
+			if (script_block->end_generation_ == SLIM_MAX_GENERATION + 1)
+				block["end_generation"] = nullptr;
+			else
+				block["end_generation"] = script_block->end_generation_;
+			block["time"] = Eidos_ElapsedProfileTime(profile_root->TotalOfSelfCounts());
+			block["source"] = profile_root->token_->token_string_;
+			
+			blocks.push_back(block);
+		}
+		
+		j["script_blocks"] = blocks;
+	}
+	
+	// User-defined function profiles
+	{
+		nlohmann::json functions = nlohmann::json::array();
+		
+		for (auto functionPairIter : simulation_functions_)
+		{
+			const EidosFunctionSignature *signature = functionPairIter.second.get();
+			
+			if (signature->body_script_ && signature->user_defined_)
+			{
+				const EidosASTNode *profile_root = signature->body_script_->AST();
+				
+				profile_root->ConvertProfileTotalsToSelfCounts();
+				functions.push_back({{"signature", signature->SignatureString()}, {"time", Eidos_ElapsedProfileTime(profile_root->TotalOfSelfCounts())}});
+			}
+		}
+		
+		j["user_defined_functions"] = functions;
+	}
+	
+#if SLIM_USE_NONNEUTRAL_CACHES
+	// MutationRun metrics, including the per-generation history of the mutation run experiments
+	{
+		nlohmann::json mutruns;
+		
+		mutruns["mutrun_count_history"] = profile_mutcount_history_;
+		mutruns["nonneutral_regime_history"] = profile_nonneutral_regime_history_;
+		mutruns["mutation_total_usage"] = profile_mutation_total_usage_;
+		mutruns["nonneutral_mutation_total"] = profile_nonneutral_mutation_total_;
+		mutruns["max_mutation_index"] = profile_max_mutation_index_;
+		mutruns["mutrun_total_usage"] = profile_mutrun_total_usage_;
+		mutruns["unique_mutrun_total"] = profile_unique_mutrun_total_;
+		mutruns["mutrun_nonneutral_recache_total"] = profile_mutrun_nonneutral_recache_total_;
+		
+		j["mutation_runs"] = mutruns;
+	}
+#endif
+	
+	// Memory usage metrics: average, final, and sampled over time (in bytes, except for the _count fields)
+	{
+		nlohmann::json memory;
+		nlohmann::json history = nlohmann::json::array();
+		
+		memory["average"] = SLiM_MemoryUsageJSON(profile_total_memory_usage_, std::max(total_memory_tallies_, (int64_t)1));
+		memory["final"] = SLiM_MemoryUsageJSON(profile_last_memory_usage_, 1);
+		memory["history_stride"] = profile_memory_history_stride_;
+		
+		for (auto &history_entry : profile_memory_history_)
+		{
+			nlohmann::json sample = SLiM_MemoryUsageJSON(history_entry.second, 1);
+			
+			sample["generation"] = history_entry.first;
+			history.push_back(sample);
+		}
+		
+		memory["history"] = history;
+		j["memory_usage"] = memory;
+	}
+	
+	// Tree-sequence auto-simplification: the scheduling mode, and the most recent simplifications with the interval chosen after each
+	if (recording_tree_)
+	{
+		nlohmann::json simplification;
+		nlohmann::json history = nlohmann::json::array();
+		
+		if (simplification_interval_ != -1)
+		{
+			simplification["mode"] = "interval";
+			simplification["interval"] = simplification_interval_;
+		}
+		else if (simplification_memory_limit_ > 0.0)
+		{
+			simplification["mode"] = "memory_limit";
+			simplification["memory_limit"] = simplification_memory_limit_;
+			simplification["cost_tolerance"] = SLIM_SIMPLIFY_COST_TOLERANCE;
+		}
+		else if (std::isinf(simplification_ratio_))
+		{
+			simplification["mode"] = "none";
+		}
+		else
+		{
+			simplification["mode"] = "ratio";
+			simplification["ratio"] = simplification_ratio_;
+		}
+		
+		simplification["count"] = simplify_count_;
+		
+		for (const ts_simplify_record &record : simplify_history_)
+			history.push_back({{"generation", record.generation}, {"interval", record.interval}, {"growth_bytes_per_generation", record.growth}, {"pre_bytes", record.pre_bytes}, {"post_bytes", record.post_bytes}, {"time", record.seconds}, {"next_interval", record.next_interval}, {"memory_bound", record.memory_bound}, {"memory_forced", record.memory_forced}});
+		
+		simplification["history"] = history;
+		j["tree_sequence_simplification"] = simplification;
+	}
+	
+	p_out << j.dump(1, '\t') << std::endl;
+}
+#endif
+
+
+//
+// TREE SEQUENCE RECORDING
+//
+#pragma mark -
+#pragma mark Tree sequence recording
+#pragma mark -
+
+void SLiMSim::handle_error(std::string msg, int err)
+{
+	std::cout << "Error:" << msg << ": " << tsk_strerror(err) << std::endl;
+	EIDOS_TERMINATION << msg << ": " << tsk_strerror(err) << EidosTerminate();
+}
+
+void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> p_individual_map, bool p_keep_unmapped)
 {
 	// Modifies the tables in place so that individual number individual_map[k] becomes the k-th individual in the new tables.
 	// Discard unmapped individuals unless p_keep_unmapped is true, in which case put them at the end.
@@ -4865,52 +5640,363 @@ void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vect
 	}
 }
 
-struct edge_plus_time {
-	double time;
-	tsk_id_t parent, child;
-	double left, right;
-};
+void SLiMSim::FlushBufferedNodes(void)
+{
+	// RecordNewGenome() records nodes into buffered_nodes_ rather than into tables_.nodes, saving tskit's per-row bounds check, possible
+	// realloc, and metadata copy; here we append them to the node table with one call.  The node table is made to grow by at least
+	// its current capacity whenever it has to expand, rather than by tskit's default of 1024 rows, so that appends are amortized O(1).
+	size_t node_count = buffered_nodes_.time.size();
+	
+	if (node_count == 0)
+		return;
+	
+	tsk_node_table_t &nodes = tables_.nodes;
+	std::vector<tsk_size_t> metadata_offset(node_count + 1);
+	
+	for (size_t node_index = 0; node_index <= node_count; ++node_index)
+		metadata_offset[node_index] = (tsk_size_t)(node_index * sizeof(GenomeMetadataRec));
+	
+	int ret = tsk_node_table_set_max_rows_increment(&nodes, std::max(nodes.max_rows, (tsk_size_t)1024));
+	if (ret != 0) handle_error("tsk_node_table_set_max_rows_increment", ret);
+	
+	ret = tsk_node_table_set_max_metadata_length_increment(&nodes, std::max(nodes.max_metadata_length, (tsk_size_t)1024));
+	if (ret != 0) handle_error("tsk_node_table_set_max_metadata_length_increment", ret);
+	
+	ret = tsk_node_table_append_columns(&nodes, (tsk_size_t)node_count, buffered_nodes_.flags.data(), buffered_nodes_.time.data(), buffered_nodes_.population.data(), NULL, (const char *)buffered_nodes_.metadata.data(), metadata_offset.data());
+	if (ret != 0) handle_error("tsk_node_table_append_columns", ret);
+	
+	// the rewind position kept by RecordTablePosition() counted buffered nodes, which are now in the node table
+	table_position_.nodes += (tsk_size_t)buffered_nodes_position_;
+	buffered_nodes_position_ = 0;
+	
+	buffered_nodes_.flags.clear();
+	buffered_nodes_.time.clear();
+	buffered_nodes_.population.clear();
+	buffered_nodes_.metadata.clear();
+}
 
-static int
-slim_sort_edges(tsk_table_sorter_t *sorter, tsk_size_t start)
+void SLiMSim::MergeBufferedEdges(void)
 {
-	if (sorter->tables->edges.metadata_length != 0)
-		throw std::invalid_argument("the sorter does not currently handle edge metadata");
-	if (start != 0)
-		throw std::invalid_argument("the sorter requires start==0");
-	
-	std::vector<edge_plus_time> temp;
-	temp.reserve(static_cast<std::size_t>(sorter->tables->edges.num_rows));
-	
-	auto edges = &sorter->tables->edges;
-	auto nodes = &sorter->tables->nodes;
-	
-	for (tsk_size_t i = 0; i < sorter->tables->edges.num_rows; ++i)
-		temp.push_back(edge_plus_time{ nodes->time[edges->parent[i]], edges->parent[i], edges->child[i], edges->left[i], edges->right[i] });
-	
-	std::sort(begin(temp), end(temp),
-		[](const edge_plus_time &lhs, const edge_plus_time &rhs) {
-			if (lhs.time == rhs.time) {
-				if (lhs.parent == rhs.parent) {
-					if (lhs.child == rhs.child) {
-						return lhs.left < rhs.left;
-					}
-					return lhs.child < rhs.child;
-				}
-				return lhs.parent < rhs.parent;
-			}
-			return lhs.time < rhs.time;
+	// RecordNewGenome() records edges into buffered_edges_ rather than into tables_.edges, so that the edge table stays in the order
+	// that simplification requires: by parent time, with each parent's edges contiguous and sorted by child and then left.  The edge
+	// table starts out in that order (empty, loaded from a valid tree sequence, or produced by simplification), and here we merge the
+	// buffered edges into it in order, instead of sorting the whole table.  The buffered edges are already sorted by child and then
+	// left for each parent, because each new genome's node and edges are recorded together, so we just group them by parent with a
+	// stable counting pass.  A parent that already has edges in the table gets its new edges right after its old ones; its new
+	// children were added after the last simplification, so they have higher node ids than its old children.
+	FlushBufferedNodes();
+	
+	if (buffered_edges_.size() == 0)
+		return;
+	
+	tsk_edge_table_t &edges = tables_.edges;
+	const double *node_time = tables_.nodes.time;
+	size_t node_count = (size_t)tables_.nodes.num_rows;
+	size_t old_edge_count = (size_t)edges.num_rows;
+	size_t total_edge_count = old_edge_count + buffered_edges_.size();
+	
+	// Group the buffered edges by parent; after this, the edges of parent p are at [group_end[p - 1], group_end[p]) in grouped_edges
+	std::vector<size_t> group_end(node_count + 1, 0);
+	std::vector<ts_buffered_edge> grouped_edges(buffered_edges_.size());
+	
+	for (const ts_buffered_edge &edge : buffered_edges_)
+		group_end[edge.parent + 1]++;
+	
+	for (size_t node_index = 1; node_index <= node_count; ++node_index)
+		group_end[node_index] += group_end[node_index - 1];
+	
+	for (const ts_buffered_edge &edge : buffered_edges_)
+		grouped_edges[group_end[edge.parent]++] = edge;
+	
+	// Find the parents with buffered edges, in order of time; ties are broken by node id, which is arbitrary but deterministic
+	std::vector<tsk_id_t> new_parents;
+	
+	for (size_t node_index = 0; node_index < node_count; ++node_index)
+		if (group_end[node_index] != (node_index ? group_end[node_index - 1] : 0))
+			new_parents.emplace_back((tsk_id_t)node_index);
+	
+	std::sort(new_parents.begin(), new_parents.end(), [node_time](tsk_id_t a, tsk_id_t b) { return (node_time[a] < node_time[b]) || ((node_time[a] == node_time[b]) && (a < b)); });
+	
+	// Merge the old edges and the grouped buffered edges into new columns
+	std::vector<double> left(total_edge_count), right(total_edge_count);
+	std::vector<tsk_id_t> parent(total_edge_count), child(total_edge_count);
+	std::vector<bool> parent_merged(node_count, false);
+	size_t out_index = 0, old_index = 0, new_parent_index = 0;
+	
+	auto merge_new_edges = [&](tsk_id_t p_parent) {
+		for (size_t edge_index = (p_parent ? group_end[p_parent - 1] : 0); edge_index < group_end[p_parent]; ++edge_index, ++out_index)
+		{
+			const ts_buffered_edge &edge = grouped_edges[edge_index];
+			
+			left[out_index] = edge.left;
+			right[out_index] = edge.right;
+			parent[out_index] = edge.parent;
+			child[out_index] = edge.child;
+		}
+		parent_merged[p_parent] = true;
+	};
+	
+	while (old_index < old_edge_count)
+	{
+		tsk_id_t old_parent = edges.parent[old_index];
+		double old_time = node_time[old_parent];
+		
+		// buffered edges for parents younger than this parent come first
+		for ( ; (new_parent_index < new_parents.size()) && (node_time[new_parents[new_parent_index]] < old_time); ++new_parent_index)
+			if (!parent_merged[new_parents[new_parent_index]])
+				merge_new_edges(new_parents[new_parent_index]);
+		
+		// then this parent's old edges, followed by its buffered edges if it has any
+		do
+		{
+			left[out_index] = edges.left[old_index];
+			right[out_index] = edges.right[old_index];
+			parent[out_index] = old_parent;
+			child[out_index] = edges.child[old_index];
+			out_index++;
+			old_index++;
+		}
+		while ((old_index < old_edge_count) && (edges.parent[old_index] == old_parent));
+		
+		if (!parent_merged[old_parent] && (group_end[old_parent] != (old_parent ? group_end[old_parent - 1] : 0)))
+			merge_new_edges(old_parent);
+	}
+	
+	for ( ; new_parent_index < new_parents.size(); ++new_parent_index)
+		if (!parent_merged[new_parents[new_parent_index]])
+			merge_new_edges(new_parents[new_parent_index]);
+	
+	if (out_index != total_edge_count)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::MergeBufferedEdges): (internal error) edge count mismatch after merge." << EidosTerminate();
+	
+	int ret = tsk_edge_table_set_columns(&edges, (tsk_size_t)total_edge_count, left.data(), right.data(), parent.data(), child.data(), NULL, NULL);
+	if (ret != 0) handle_error("tsk_edge_table_set_columns", ret);
+	
+	buffered_edges_.clear();
+	buffered_edges_position_ = 0;
+}
+
+// Sort p_data by p_less, which must be a strict total order, so that the result does not depend upon the number of threads used.  With
+// more than one thread, one chunk per thread is sorted with std::sort(), and then adjacent runs are merged pairwise, in parallel, until
+// a single sorted run remains; each round doubles the run length, so the merging takes log2(thread count) passes over the data.
+template <typename T, typename C>
+static void slim_parallel_sort(std::vector<T> &p_data, C p_less)
+{
+	size_t count = p_data.size();
+	int thread_count = ((gEidosMaxThreads > 1) && (count >= SLIM_TREESEQ_PARALLEL_SORT_MIN_SIZE)) ? gEidosMaxThreads : 1;
+
+#ifndef _OPENMP
+	thread_count = 1;
+#endif
+	
+	if (thread_count == 1)
+	{
+		std::sort(p_data.begin(), p_data.end(), p_less);
+		return;
+	}
+	
+	size_t run_length = (count + thread_count - 1) / thread_count;
+	int run_count = (int)((count + run_length - 1) / run_length);
+
+#pragma omp parallel for schedule(static, 1) num_threads(thread_count)
+	for (int run_index = 0; run_index < run_count; ++run_index)
+		std::sort(p_data.begin() + run_index * run_length, p_data.begin() + std::min(count, (run_index + 1) * run_length), p_less);
+	
+	std::vector<T> buffer(count);
+	std::vector<T> *source = &p_data, *dest = &buffer;
+	
+	for ( ; run_length < count; run_length *= 2)
+	{
+		int pair_count = (int)((count + 2 * run_length - 1) / (2 * run_length));
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(std::min(thread_count, pair_count))
+		for (int pair_index = 0; pair_index < pair_count; ++pair_index)
+		{
+			size_t pair_start = pair_index * 2 * run_length;
+			size_t pair_middle = std::min(count, pair_start + run_length);
+			size_t pair_end = std::min(count, pair_middle + run_length);
+			
+			std::merge(source->begin() + pair_start, source->begin() + pair_middle, source->begin() + pair_middle, source->begin() + pair_end, dest->begin() + pair_start, p_less);
+		}
+		
+		std::swap(source, dest);
+	}
+	
+	if (source != &p_data)
+		p_data.swap(buffer);
+}
+
+void SLiMSim::SortTreeSequenceTables(tsk_table_collection_t *p_tables, tsk_size_t p_edge_start)
+{
+	// This replaces tsk_table_collection_sort() for our tables: it sorts the edges from p_edge_start onward, and all of the sites and
+	// mutations, into the same order that tskit's sorter produces, but with slim_parallel_sort() in place of qsort().  The sort keys
+	// are gathered into compact arrays for sorting, and the table columns are then rebuilt in sorted order.  Sites and mutations are
+	// sorted at every simplification and output, whereas the edges need sorting only for a full sort; MergeBufferedEdges() keeps our
+	// edge table sorted otherwise.
+	int ret;
+
+#if DEBUG
+	// tsk_table_collection_sort() checks the integrity of the tables in DEBUG builds, so we do too
+	ret = tsk_table_collection_check_integrity(p_tables, 0);
+	if (ret < 0) handle_error("tsk_table_collection_check_integrity", ret);
+#endif
+	
+	if (p_tables->migrations.num_rows != 0)
+		handle_error("SortTreeSequenceTables", TSK_ERR_SORT_MIGRATIONS_NOT_SUPPORTED);
+	if (p_edge_start > p_tables->edges.num_rows)
+		handle_error("SortTreeSequenceTables", TSK_ERR_EDGE_OUT_OF_BOUNDS);
+	
+	// the indexes will be invalidated, so drop them
+	ret = tsk_table_collection_drop_index(p_tables, 0);
+	if (ret != 0) handle_error("tsk_table_collection_drop_index", ret);
+	
+	// sort the edges by parent time, then parent, then child, then left; right is a final tiebreaker that makes the order total
+	tsk_edge_table_t &edges = p_tables->edges;
+	size_t edge_count = (size_t)(edges.num_rows - p_edge_start);
+	
+	if (edge_count > 1)
+	{
+		struct edge_plus_time {
+			double time;
+			tsk_id_t parent, child;
+			double left, right;
+		};
+		
+		if (edges.metadata_length != 0)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::SortTreeSequenceTables): (internal error) edge metadata is not supported." << EidosTerminate();
+		
+		const double *node_time = p_tables->nodes.time;
+		std::vector<edge_plus_time> sorted_edges(edge_count);
+		
+		for (size_t edge_index = 0; edge_index < edge_count; ++edge_index)
+		{
+			size_t row = p_edge_start + edge_index;
+			
+			sorted_edges[edge_index] = edge_plus_time{node_time[edges.parent[row]], edges.parent[row], edges.child[row], edges.left[row], edges.right[row]};
+		}
+		
+		slim_parallel_sort(sorted_edges, [](const edge_plus_time &lhs, const edge_plus_time &rhs) {
+			if (lhs.time != rhs.time) return lhs.time < rhs.time;
+			if (lhs.parent != rhs.parent) return lhs.parent < rhs.parent;
+			if (lhs.child != rhs.child) return lhs.child < rhs.child;
+			if (lhs.left != rhs.left) return lhs.left < rhs.left;
+			return lhs.right < rhs.right;
 		});
+		
+		for (size_t edge_index = 0; edge_index < edge_count; ++edge_index)
+		{
+			size_t row = p_edge_start + edge_index;
+			const edge_plus_time &edge = sorted_edges[edge_index];
+			
+			edges.left[row] = edge.left;
+			edges.right[row] = edge.right;
+			edges.parent[row] = edge.parent;
+			edges.child[row] = edge.child;
+		}
+	}
+	
+	// sort the sites by position, then by id, which keeps redundant sites at the same position in order for deduplication
+	tsk_site_table_t &sites = p_tables->sites;
+	size_t site_count = (size_t)sites.num_rows;
+	std::vector<tsk_id_t> site_id_map(site_count);
 	
-	for (std::size_t i = 0; i < temp.size(); ++i)
+	if (site_count > 0)
 	{
-		edges->left[i] = temp[i].left;
-		edges->right[i] = temp[i].right;
-		edges->parent[i] = temp[i].parent;
-		edges->child[i] = temp[i].child;
+		struct site_key {
+			double position;
+			tsk_id_t id;
+		};
+		
+		std::vector<site_key> sorted_sites(site_count);
+		
+		for (size_t site_index = 0; site_index < site_count; ++site_index)
+			sorted_sites[site_index] = site_key{sites.position[site_index], (tsk_id_t)site_index};
+		
+		slim_parallel_sort(sorted_sites, [](const site_key &lhs, const site_key &rhs) { return (lhs.position < rhs.position) || ((lhs.position == rhs.position) && (lhs.id < rhs.id)); });
+		
+		std::vector<double> position(site_count);
+		std::vector<char> ancestral_state, metadata;
+		std::vector<tsk_size_t> ancestral_state_offset(site_count + 1), metadata_offset(site_count + 1);
+		
+		// tskit rejects NULL column pointers, even for empty columns (our ancestral states are empty), so we always reserve some capacity
+		ancestral_state.reserve(sites.ancestral_state_length + 1);
+		metadata.reserve(sites.metadata_length + 1);
+		
+		for (size_t site_index = 0; site_index < site_count; ++site_index)
+		{
+			tsk_id_t old_id = sorted_sites[site_index].id;
+			
+			site_id_map[old_id] = (tsk_id_t)site_index;
+			position[site_index] = sorted_sites[site_index].position;
+			ancestral_state_offset[site_index] = (tsk_size_t)ancestral_state.size();
+			ancestral_state.insert(ancestral_state.end(), sites.ancestral_state + sites.ancestral_state_offset[old_id], sites.ancestral_state + sites.ancestral_state_offset[old_id + 1]);
+			metadata_offset[site_index] = (tsk_size_t)metadata.size();
+			metadata.insert(metadata.end(), sites.metadata + sites.metadata_offset[old_id], sites.metadata + sites.metadata_offset[old_id + 1]);
+		}
+		
+		ancestral_state_offset[site_count] = (tsk_size_t)ancestral_state.size();
+		metadata_offset[site_count] = (tsk_size_t)metadata.size();
+		
+		ret = tsk_site_table_set_columns(&sites, (tsk_size_t)site_count, position.data(), ancestral_state.data(), ancestral_state_offset.data(), metadata.data(), metadata_offset.data());
+		if (ret != 0) handle_error("tsk_site_table_set_columns", ret);
 	}
 	
-	return 0;
+	// sort the mutations by their new site, then by decreasing time when known, then by id, which keeps mutations in order within a site
+	tsk_mutation_table_t &mutations = p_tables->mutations;
+	size_t mutation_count = (size_t)mutations.num_rows;
+	
+	if (mutation_count > 0)
+	{
+		struct mutation_key {
+			tsk_id_t site;
+			tsk_id_t id;
+			double time;
+		};
+		
+		std::vector<mutation_key> sorted_mutations(mutation_count);
+		std::vector<tsk_id_t> mutation_id_map(mutation_count);
+		
+		for (size_t mutation_index = 0; mutation_index < mutation_count; ++mutation_index)
+			sorted_mutations[mutation_index] = mutation_key{site_id_map[mutations.site[mutation_index]], (tsk_id_t)mutation_index, mutations.time[mutation_index]};
+		
+		slim_parallel_sort(sorted_mutations, [](const mutation_key &lhs, const mutation_key &rhs) {
+			if (lhs.site != rhs.site) return lhs.site < rhs.site;
+			if (!tsk_is_unknown_time(lhs.time) && !tsk_is_unknown_time(rhs.time) && (lhs.time != rhs.time)) return lhs.time > rhs.time;
+			return lhs.id < rhs.id;
+		});
+		
+		for (size_t mutation_index = 0; mutation_index < mutation_count; ++mutation_index)
+			mutation_id_map[sorted_mutations[mutation_index].id] = (tsk_id_t)mutation_index;
+		
+		std::vector<tsk_id_t> site(mutation_count), node(mutation_count), parent(mutation_count);
+		std::vector<double> time(mutation_count);
+		std::vector<char> derived_state, metadata;
+		std::vector<tsk_size_t> derived_state_offset(mutation_count + 1), metadata_offset(mutation_count + 1);
+		
+		derived_state.reserve(mutations.derived_state_length + 1);
+		metadata.reserve(mutations.metadata_length + 1);
+		
+		for (size_t mutation_index = 0; mutation_index < mutation_count; ++mutation_index)
+		{
+			tsk_id_t old_id = sorted_mutations[mutation_index].id;
+			tsk_id_t old_parent = mutations.parent[old_id];
+			
+			site[mutation_index] = sorted_mutations[mutation_index].site;
+			node[mutation_index] = mutations.node[old_id];
+			parent[mutation_index] = (old_parent == TSK_NULL) ? TSK_NULL : mutation_id_map[old_parent];
+			time[mutation_index] = mutations.time[old_id];
+			derived_state_offset[mutation_index] = (tsk_size_t)derived_state.size();
+			derived_state.insert(derived_state.end(), mutations.derived_state + mutations.derived_state_offset[old_id], mutations.derived_state + mutations.derived_state_offset[old_id + 1]);
+			metadata_offset[mutation_index] = (tsk_size_t)metadata.size();
+			metadata.insert(metadata.end(), mutations.metadata + mutations.metadata_offset[old_id], mutations.metadata + mutations.metadata_offset[old_id + 1]);
+		}
+		
+		derived_state_offset[mutation_count] = (tsk_size_t)derived_state.size();
+		metadata_offset[mutation_count] = (tsk_size_t)metadata.size();
+		
+		ret = tsk_mutation_table_set_columns(&mutations, (tsk_size_t)mutation_count, site.data(), node.data(), parent.data(), time.data(), derived_state.data(), derived_state_offset.data(), metadata.data(), metadata_offset.data());
+		if (ret != 0) handle_error("tsk_mutation_table_set_columns", ret);
+	}
 }
 
 void SLiMSim::SimplifyTreeSequence(void)
@@ -4920,6 +6006,8 @@ void SLiMSim::SimplifyTreeSequence(void)
 		EIDOS_TERMINATION << "ERROR (SLiMSim::SimplifyTreeSequence): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
 #endif
 	
+	FlushBufferedNodes();
+	
 	if (tables_.nodes.num_rows == 0)
 		return;
 	
@@ -4980,40 +6068,14 @@ void SLiMSim::SimplifyTreeSequence(void)
 	// the tables need to have a population table to be able to sort it
 	WritePopulationTable(&tables_);
 	
-	// sort the table collection
-    int flags = TSK_NO_CHECK_INTEGRITY;
-#if DEBUG
-    flags = 0;
-#endif
-	
-#if 0
-	// sort the tables using tsk_table_collection_sort() to get the default behavior
-	int ret = tsk_table_collection_sort(&tables_, /* edge_start */ NULL, /* flags */ flags);
-	if (ret < 0) handle_error("tsk_table_collection_sort", ret);
-#else
-	// sort the tables using our own custom edge sorter, for additional speed through inlining of the comparison function
-	// see https://github.com/tskit-dev/tskit/pull/627, https://github.com/tskit-dev/tskit/pull/711
-	// FIXME for additional speed we could perhaps be smart about only sorting the portions of the edge table
-	// that need it, but the tricky thing is that all the old stuff has to be at the bottom of the table, not the top...
-	tsk_table_sorter_t sorter;
-	int ret = tsk_table_sorter_init(&sorter, &tables_, /* flags */ flags);
-	if (ret != 0) handle_error("tsk_table_sorter_init", ret);
-	
-	sorter.sort_edges = slim_sort_edges;
-	
-	try {
-		ret = tsk_table_sorter_run(&sorter, NULL);
-	} catch (std::exception &e) {
-		EIDOS_TERMINATION << "ERROR (SLiMSim::SimplifyTreeSequence): (internal error) exception raised during tsk_table_sorter_run(): " << e.what() << "." << EidosTerminate();
-	}
-	if (ret != 0) handle_error("tsk_table_sorter_run", ret);
+	// merge the edges recorded since the last simplification into the edge table, which leaves it sorted
+	MergeBufferedEdges();
 	
-	tsk_table_sorter_free(&sorter);
-	if (ret != 0) handle_error("tsk_table_sorter_free", ret);
-#endif
+	// sort the sites and mutations; the edges are already sorted, so the sort starts at the end of the edge table
+	SortTreeSequenceTables(&tables_, tables_.edges.num_rows);
 	
 	// remove redundant sites we added
-	ret = tsk_table_collection_deduplicate_sites(&tables_, 0);
+	int ret = tsk_table_collection_deduplicate_sites(&tables_, 0);
 	if (ret < 0) handle_error("tsk_table_collection_deduplicate_sites", ret);
 	
 	// simplify
@@ -5027,8 +6089,9 @@ void SLiMSim::SimplifyTreeSequence(void)
 	// reset current position, used to rewind individuals that are rejected by modifyChild()
 	RecordTablePosition();
 	
-	// and reset our elapsed time since last simplification, for auto-simplification
+	// and reset our elapsed time since last simplification, and our baseline for table growth, for auto-simplification
 	simplify_elapsed_ = 0;
+	simplify_last_post_bytes_ = TreeSequenceBytesInUse();
 	
 	// as a side effect of simplification, update a "model has coalesced" flag that the user can consult, if requested
 	if (running_coalescence_checks_)
@@ -5145,6 +6208,8 @@ void SLiMSim::RecordTablePosition(void)
 {
 	// keep the current table position for rewinding if a proposed child is rejected
 	tsk_table_collection_record_num_rows(&tables_, &table_position_);
+	buffered_edges_position_ = buffered_edges_.size();
+	buffered_nodes_position_ = buffered_nodes_.time.size();
 }
 
 void SLiMSim::AllocateTreeSequenceTables(void)
@@ -5160,6 +6225,12 @@ void SLiMSim::AllocateTreeSequenceTables(void)
 	int ret = tsk_table_collection_init(&tables_, TSK_NO_EDGE_METADATA);
 	if (ret != 0) handle_error("AllocateTreeSequenceTables()", ret);
 	
+	buffered_edges_.clear();
+	buffered_nodes_.flags.clear();
+	buffered_nodes_.time.clear();
+	buffered_nodes_.population.clear();
+	buffered_nodes_.metadata.clear();
+	
 	tables_.sequence_length = (double)chromosome_->last_position_ + 1;
 	
 	RecordTablePosition();
@@ -5198,6 +6269,11 @@ void SLiMSim::RetractNewIndividual()
 	//current_new_individual_ = nullptr;
 	
     tsk_table_collection_truncate(&tables_, &table_position_);
+	buffered_edges_.resize(buffered_edges_position_);
+	buffered_nodes_.flags.resize(buffered_nodes_position_);
+	buffered_nodes_.time.resize(buffered_nodes_position_);
+	buffered_nodes_.population.resize(buffered_nodes_position_);
+	buffered_nodes_.metadata.resize(buffered_nodes_position_);
 }
 
 void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, 
@@ -5215,18 +6291,16 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 	// The breakpoints vector may be nullptr (indicating no recombination), but if it exists it will be sorted in ascending order.
 
 	// add genome node; we mark all nodes with TSK_NODE_IS_SAMPLE here because we have full genealogical information on all of them
-	// (until simplify, which clears TSK_NODE_IS_SAMPLE from nodes that are not kept in the sample).
+	// (until simplify, which clears TSK_NODE_IS_SAMPLE from nodes that are not kept in the sample).  The node is buffered until the
+	// end of the generation, see FlushBufferedNodes(); its id is the row it will occupy in the node table.
 	double time = (double) -1 * (tree_seq_generation_ + tree_seq_generation_offset_);	// see Population::AddSubpopulationSplit() regarding tree_seq_generation_offset_
-	uint32_t flags = TSK_NODE_IS_SAMPLE;
-	GenomeMetadataRec metadata_rec;
-	
-	MetadataForGenome(p_new_genome, &metadata_rec);
+	tsk_id_t offspringTSKID = (tsk_id_t)(tables_.nodes.num_rows + buffered_nodes_.time.size());
 	
-	const char *metadata = (char *)&metadata_rec;
-	size_t metadata_length = sizeof(GenomeMetadataRec)/sizeof(char);
-	tsk_id_t offspringTSKID = tsk_node_table_add_row(&tables_.nodes, flags, time, (tsk_id_t)p_new_genome->subpop_->subpopulation_id_,
-                                        TSK_NULL, metadata, (tsk_size_t)metadata_length);
-	if (offspringTSKID < 0) handle_error("tsk_node_table_add_row", offspringTSKID);
+	buffered_nodes_.flags.emplace_back(TSK_NODE_IS_SAMPLE);
+	buffered_nodes_.time.emplace_back(time);
+	buffered_nodes_.population.emplace_back((tsk_id_t)p_new_genome->subpop_->subpopulation_id_);
+	buffered_nodes_.metadata.emplace_back();
+	MetadataForGenome(p_new_genome, &buffered_nodes_.metadata.back());
 	
 	p_new_genome->tsk_node_id_ = offspringTSKID;
 	
@@ -5244,7 +6318,7 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 	if (breakpoint_count && (p_breakpoints->back() > chromosome_->last_position_))
 		breakpoint_count--;
 	
-	// add an edge for each interval between breakpoints
+	// add an edge for each interval between breakpoints; these are buffered until simplification, see MergeBufferedEdges()
 	double left = 0.0;
 	double right;
 	bool polarity = true;
@@ -5254,8 +6328,7 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 		right = (*p_breakpoints)[i];
 
 		tsk_id_t parent = (tsk_id_t) (polarity ? genome1TSKID : genome2TSKID);
-		int ret = tsk_edge_table_add_row(&tables_.edges, left, right, parent, offspringTSKID, NULL, 0);
-		if (ret < 0) handle_error("tsk_edge_table_add_row", ret);
+		buffered_edges_.emplace_back(ts_buffered_edge{left, right, parent, offspringTSKID});
 		
 		polarity = !polarity;
 		left = right;
@@ -5263,8 +6336,7 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 	
 	right = (double)chromosome_->last_position_+1;
 	tsk_id_t parent = (tsk_id_t) (polarity ? genome1TSKID : genome2TSKID);
-	int ret = tsk_edge_table_add_row(&tables_.edges, left, right, parent, offspringTSKID, NULL, 0);
-	if (ret < 0) handle_error("tsk_edge_table_add_row", ret);
+	buffered_edges_.emplace_back(ts_buffered_edge{left, right, parent, offspringTSKID});
 }
 
 void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_position, const std::vector<Mutation *> &p_derived_mutations)
@@ -5351,6 +6423,120 @@ void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_po
 	if (ret < 0) handle_error("tsk_mutation_table_add_row", ret);
 }
 
+double SLiMSim::TreeSequenceBytesInUse(void)
+{
+	// This counts the bytes used by the rows of our tables, including the buffered edges, rather than the bytes allocated for them as
+	// MemoryUsageForTables() does; tskit never shrinks its columns, so this is the measure of how much the tables have grown, and of
+	// how much simplification has freed for reuse.  The peak allocation over a run follows the peak of this value.
+	tsk_table_collection_t &t = tables_;
+	size_t usage = 0;
+	
+	usage += t.individuals.num_rows * (sizeof(uint32_t) + 2 * sizeof(tsk_size_t)) + t.individuals.location_length * sizeof(double) + t.individuals.metadata_length;
+	usage += t.nodes.num_rows * (sizeof(uint32_t) + sizeof(double) + 2 * sizeof(tsk_id_t) + sizeof(tsk_size_t)) + t.nodes.metadata_length;
+	usage += buffered_nodes_.time.size() * (sizeof(tsk_flags_t) + sizeof(double) + sizeof(tsk_id_t) + sizeof(GenomeMetadataRec));
+	usage += t.edges.num_rows * (2 * sizeof(double) + 2 * sizeof(tsk_id_t)) + buffered_edges_.size() * sizeof(ts_buffered_edge);
+	usage += t.sites.num_rows * (sizeof(double) + 2 * sizeof(tsk_size_t)) + t.sites.ancestral_state_length + t.sites.metadata_length;
+	usage += t.mutations.num_rows * (3 * sizeof(tsk_id_t) + sizeof(double) + 2 * sizeof(tsk_size_t)) + t.mutations.derived_state_length + t.mutations.metadata_length;
+	
+	return (double)usage;
+}
+
+ts_simplify_record &SLiMSim::TimedSimplifyTreeSequence(bool p_memory_forced)
+{
+	// Do an automatic simplification, recording its wall time and its effect on the tables in simplify_history_; the caller fills
+	// in the interval it then chooses for the next automatic simplification
+	ts_simplify_record record;
+	
+	record.generation = generation_;
+	record.interval = simplify_elapsed_;
+	record.pre_bytes = TreeSequenceBytesInUse();
+	record.growth = (record.pre_bytes - simplify_last_post_bytes_) / std::max(simplify_elapsed_, (int64_t)1);
+	record.memory_bound = false;
+	record.memory_forced = p_memory_forced;
+	
+	std::chrono::steady_clock::time_point begin_wall = std::chrono::steady_clock::now();
+	
+	SimplifyTreeSequence();
+	
+	record.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_wall).count();
+	record.post_bytes = simplify_last_post_bytes_;
+	record.next_interval = simplify_interval_;
+	
+	if (simplify_history_.size() >= SLIM_SIMPLIFY_HISTORY_MAX)
+		simplify_history_.erase(simplify_history_.begin());
+	
+	simplify_history_.emplace_back(record);
+	simplify_count_++;
+	
+	return simplify_history_.back();
+}
+
+void SLiMSim::ChooseSimplificationInterval(ts_simplify_record &p_record)
+{
+	// The cost-driven scheduler, used when initializeTreeSeq() is given a simplificationMemoryLimit.  We model the wall time of a
+	// simplification as a + b * S, where S is the table bytes in use before simplifying, fitted by least squares to the most recent
+	// simplifications, and the tables as growing by g bytes per generation from their post-simplification size S0.  Simplifying every
+	// T generations then costs (a + b * (S0 + g * T)) / T per generation: b * g, the cost of simplifying the new rows, which does not
+	// depend upon T, plus (a + b * S0) / T, the cost of reprocessing what survived the last simplification, which longer intervals
+	// amortize away.  We choose the T at which that second part falls to SLIM_SIMPLIFY_COST_TOLERANCE of the first, since longer
+	// intervals save little beyond that while their tables keep growing, unless the memory limit requires a shorter interval.
+	size_t history_size = simplify_history_.size();
+	size_t fit_count = std::min(history_size, (size_t)SLIM_SIMPLIFY_FIT_COUNT);
+	double sum_bytes = 0.0, sum_seconds = 0.0, sum_growth = 0.0;
+	
+	for (size_t record_index = history_size - fit_count; record_index < history_size; ++record_index)
+	{
+		const ts_simplify_record &record = simplify_history_[record_index];
+		
+		sum_bytes += record.pre_bytes;
+		sum_seconds += record.seconds;
+		sum_growth += record.growth;
+	}
+	
+	double mean_bytes = sum_bytes / fit_count, mean_seconds = sum_seconds / fit_count;
+	double growth = sum_growth / fit_count;
+	double fixed_seconds = 0.0, seconds_per_byte = 0.0, sxx = 0.0, sxy = 0.0;
+	
+	for (size_t record_index = history_size - fit_count; record_index < history_size; ++record_index)
+	{
+		const ts_simplify_record &record = simplify_history_[record_index];
+		
+		sxx += (record.pre_bytes - mean_bytes) * (record.pre_bytes - mean_bytes);
+		sxy += (record.pre_bytes - mean_bytes) * (record.seconds - mean_seconds);
+	}
+	
+	if (sxx > 0.0)
+	{
+		seconds_per_byte = sxy / sxx;
+		fixed_seconds = mean_seconds - seconds_per_byte * mean_bytes;
+	}
+	
+	// with too few points for a fit, or a fit that makes no physical sense, we assume that the cost is simply proportional to size
+	if ((seconds_per_byte <= 0.0) || (fixed_seconds < 0.0))
+	{
+		seconds_per_byte = (sum_bytes > 0.0) ? (sum_seconds / sum_bytes) : 0.0;
+		fixed_seconds = 0.0;
+	}
+	
+	double post_bytes = p_record.post_bytes;
+	double cost_interval = SLIM_SIMPLIFY_MAX_INTERVAL, memory_interval = SLIM_SIMPLIFY_MAX_INTERVAL;
+	
+	if ((growth > 0.0) && (seconds_per_byte > 0.0))
+		cost_interval = (fixed_seconds + seconds_per_byte * post_bytes) / (SLIM_SIMPLIFY_COST_TOLERANCE * seconds_per_byte * growth);
+	if (growth > 0.0)
+		memory_interval = (simplification_memory_limit_ - post_bytes) / growth;
+	
+	simplify_interval_ = std::min(cost_interval, memory_interval);
+	
+	if (simplify_interval_ < 1.0)
+		simplify_interval_ = 1.0;
+	if (simplify_interval_ > SLIM_SIMPLIFY_MAX_INTERVAL)
+		simplify_interval_ = SLIM_SIMPLIFY_MAX_INTERVAL;
+	
+	p_record.next_interval = simplify_interval_;
+	p_record.memory_bound = (memory_interval < cost_interval) && (memory_interval < SLIM_SIMPLIFY_MAX_INTERVAL);
+}
+
 void SLiMSim::CheckAutoSimplification(void)
 {
 #if DEBUG
@@ -5363,7 +6549,9 @@ void SLiMSim::CheckAutoSimplification(void)
 	// time we simplify, we ask whether we simplified too early, too late, or just the right time by comparing
 	// the pre:post ratio of the tree recording table sizes to the desired pre:post ratio, simplification_ratio_,
 	// as set up in initializeTreeSeq().  Note that a simplification_ratio_ value of INF means "never simplify
-	// automatically"; we check for that up front.
+	// automatically"; we check for that up front.  If a simplificationMemoryLimit was given, the cost-driven scheduler in
+	// ChooseSimplificationInterval() picks the intervals instead.  Every automatic simplification is timed and recorded in
+	// simplify_history_, so that slim -profile can report the choices made.
 	++simplify_elapsed_;
 	
 	if (simplification_interval_ != -1)
@@ -5372,7 +6560,24 @@ void SLiMSim::CheckAutoSimplification(void)
 		// means the simplification ratio is being used, as implemented below; any other value is a target interval.
 		if ((simplify_elapsed_ >= 1) && (simplify_elapsed_ >= simplification_interval_))
 		{
-			SimplifyTreeSequence();
+			ts_simplify_record &record = TimedSimplifyTreeSequence(false);
+			
+			record.next_interval = (double)simplification_interval_;
+		}
+	}
+	else if (simplification_memory_limit_ > 0.0)
+	{
+		// The cost-driven scheduler chooses each interval after simplifying, in ChooseSimplificationInterval().  We also simplify early
+		// if, judging from their growth since the last simplification, the tables would pass the memory limit in the next generation.
+		double table_bytes = TreeSequenceBytesInUse();
+		double growth = (table_bytes - simplify_last_post_bytes_) / simplify_elapsed_;
+		bool interval_elapsed = (simplify_elapsed_ >= simplify_interval_);
+		
+		if (interval_elapsed || (table_bytes + growth > simplification_memory_limit_))
+		{
+			ts_simplify_record &record = TimedSimplifyTreeSequence(!interval_elapsed);
+			
+			ChooseSimplificationInterval(record);
 		}
 	}
 	else if (!std::isinf(simplification_ratio_))
@@ -5383,11 +6588,11 @@ void SLiMSim::CheckAutoSimplification(void)
 			// but that seems like overkill; adding together the number of rows in all the tables should be a
 			// reasonable proxy, and this whole thing is just a heuristic that needs to be tailored anyway.
 			uint64_t old_table_size = (uint64_t)tables_.nodes.num_rows;
-            old_table_size += (uint64_t)tables_.edges.num_rows;
+            old_table_size += (uint64_t)tables_.edges.num_rows + (uint64_t)buffered_edges_.size();
             old_table_size += (uint64_t)tables_.sites.num_rows;
             old_table_size += (uint64_t)tables_.mutations.num_rows;
 			
-			SimplifyTreeSequence();
+			ts_simplify_record &record = TimedSimplifyTreeSequence(false);
 			
 			uint64_t new_table_size = (uint64_t)tables_.nodes.num_rows;
             new_table_size += (uint64_t)tables_.edges.num_rows;
@@ -5410,8 +6615,8 @@ void SLiMSim::CheckAutoSimplification(void)
 				simplify_interval_ *= 1.2;
 				
 				// Impose a maximum interval of 1000, so we don't get caught flat-footed if model demography changes
-				if (simplify_interval_ > 1000.0)
-					simplify_interval_ = 1000.0;
+				if (simplify_interval_ > SLIM_SIMPLIFY_MAX_INTERVAL)
+					simplify_interval_ = SLIM_SIMPLIFY_MAX_INTERVAL;
 			}
 			else if (ratio > simplification_ratio_)
 			{
@@ -5424,6 +6629,8 @@ void SLiMSim::CheckAutoSimplification(void)
 			}
 			
 			//std::cout << simplify_interval_ << std::endl;
+			
+			record.next_interval = simplify_interval_;
 		}
 	}
 }
@@ -6110,6 +7317,10 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
 	if (p_tables == nullptr)
 		p_tables = &tables_;
 	
+	// the nodes of the individuals may still be buffered, if they were generated in this generation
+	if (p_tables == &tables_)
+		FlushBufferedNodes();
+	
 	// construct the map of currently remembered individuals first; these are not really just those
 	// that are "remembered", but all individuals that are currently in the tables
 	// BCH 16 Nov. 2019: Making this into an unordered_map for faster lookup; this can end up
@@ -6888,6 +8099,415 @@ void SLiMSim::ReadTreeSequenceMetadata(tsk_table_collection_t *p_tables, slim_ge
 #endif
 }
 
+// A column of a kastore file to be written by slim_write_kastore(); its values are taken from array, or, for a column that is
+// transformed on output, are produced by fill, which is called for consecutive chunks so that the full column is never built
+struct slim_kastore_column {
+	std::string key;
+	int type;
+	size_t length;
+	const void *array;
+	std::function<void(size_t p_start, size_t p_count, void *p_buffer)> fill;
+};
+
+#define SLIM_KASTORE_FILL_CHUNK_SIZE	65536
+
+static size_t slim_kastore_type_size(int p_type)
+{
+	switch (p_type)
+	{
+		case KAS_INT8: case KAS_UINT8:										return 1;
+		case KAS_INT16: case KAS_UINT16:									return 2;
+		case KAS_INT32: case KAS_UINT32: case KAS_FLOAT32:					return 4;
+		case KAS_INT64: case KAS_UINT64: case KAS_FLOAT64:					return 8;
+		default:															return 0;
+	}
+}
+
+// Writes p_columns to p_path in kastore format, returning false on failure (in which case the file is removed).  kastore_puts()
+// copies each array into the store until kastore_close() writes the file, so dumping a table collection through kastore holds a
+// second copy of all of its columns; this writes the same layout (header, item descriptors sorted by key, keys, and then arrays
+// aligned to 8 bytes) straight from the columns given.
+static bool slim_write_kastore(const std::string &p_path, std::vector<slim_kastore_column> &p_columns)
+{
+	std::sort(p_columns.begin(), p_columns.end(), [](const slim_kastore_column &l, const slim_kastore_column &r) { return l.key < r.key; });
+	
+	// lay out the file
+	size_t item_count = p_columns.size();
+	std::vector<uint64_t> key_start(item_count), array_start(item_count);
+	uint64_t offset = KAS_HEADER_SIZE + item_count * KAS_ITEM_DESCRIPTOR_SIZE;
+	
+	for (size_t item_index = 0; item_index < item_count; ++item_index)
+	{
+		key_start[item_index] = offset;
+		offset += p_columns[item_index].key.size();
+	}
+	
+	uint64_t keys_end = offset;
+	
+	for (size_t item_index = 0; item_index < item_count; ++item_index)
+	{
+		offset = (offset + KAS_ARRAY_ALIGN - 1) / KAS_ARRAY_ALIGN * KAS_ARRAY_ALIGN;
+		array_start[item_index] = offset;
+		offset += p_columns[item_index].length * slim_kastore_type_size(p_columns[item_index].type);
+	}
+	
+	FILE *file = fopen(p_path.c_str(), "wb");
+	
+	if (!file)
+		return false;
+	
+	bool success = true;
+	
+	// header
+	{
+		char header[KAS_HEADER_SIZE];
+		uint16_t version_major = KAS_FILE_VERSION_MAJOR, version_minor = KAS_FILE_VERSION_MINOR;
+		uint32_t num_items = (uint32_t)item_count;
+		uint64_t file_size = offset;
+		
+		memset(header, 0, sizeof(header));
+		memcpy(header, KAS_MAGIC, 8);
+		memcpy(header + 8, &version_major, 2);
+		memcpy(header + 10, &version_minor, 2);
+		memcpy(header + 12, &num_items, 4);
+		memcpy(header + 16, &file_size, 8);
+		success = success && (fwrite(header, sizeof(header), 1, file) == 1);
+	}
+	
+	// item descriptors
+	for (size_t item_index = 0; success && (item_index < item_count); ++item_index)
+	{
+		char descriptor[KAS_ITEM_DESCRIPTOR_SIZE];
+		uint8_t type = (uint8_t)p_columns[item_index].type;
+		uint64_t key_len = p_columns[item_index].key.size(), array_len = p_columns[item_index].length;
+		
+		memset(descriptor, 0, sizeof(descriptor));
+		memcpy(descriptor, &type, 1);
+		memcpy(descriptor + 8, &key_start[item_index], 8);
+		memcpy(descriptor + 16, &key_len, 8);
+		memcpy(descriptor + 24, &array_start[item_index], 8);
+		memcpy(descriptor + 32, &array_len, 8);
+		success = (fwrite(descriptor, sizeof(descriptor), 1, file) == 1);
+	}
+	
+	// keys
+	for (size_t item_index = 0; success && (item_index < item_count); ++item_index)
+		success = (fwrite(p_columns[item_index].key.data(), p_columns[item_index].key.size(), 1, file) == 1);
+	
+	// arrays
+	std::vector<char> chunk;
+	
+	offset = keys_end;
+	
+	for (size_t item_index = 0; success && (item_index < item_count); ++item_index)
+	{
+		slim_kastore_column &column = p_columns[item_index];
+		size_t element_size = slim_kastore_type_size(column.type);
+		size_t padding = (size_t)(array_start[item_index] - offset);
+		
+		if (padding)
+		{
+			const char pad[KAS_ARRAY_ALIGN] = {0};
+			
+			success = (fwrite(pad, padding, 1, file) == 1);
+		}
+		
+		if (success && column.length)
+		{
+			if (!column.fill)
+			{
+				success = (fwrite(column.array, element_size, column.length, file) == column.length);
+			}
+			else
+			{
+				chunk.resize(SLIM_KASTORE_FILL_CHUNK_SIZE * element_size);
+				
+				for (size_t start = 0; success && (start < column.length); start += SLIM_KASTORE_FILL_CHUNK_SIZE)
+				{
+					size_t count = std::min((size_t)SLIM_KASTORE_FILL_CHUNK_SIZE, column.length - start);
+					
+					column.fill(start, count, chunk.data());
+					success = (fwrite(chunk.data(), element_size, count, file) == count);
+				}
+			}
+		}
+		
+		offset = array_start[item_index] + column.length * element_size;
+	}
+	
+	if (fclose(file) != 0)
+		success = false;
+	
+	if (!success)
+		remove(p_path.c_str());
+	
+	return success;
+}
+
+void SLiMSim::_WriteTreeSequenceBinary(const std::string &p_path, bool p_include_model, EidosDictionaryRetained *p_metadata_dict)
+{
+	// This writes the same file as copying tables_, modifying the copy for output as WriteTreeSequence() does for text output, and
+	// dumping it with tsk_table_collection_dump(), but it makes no copy of tables_; its large columns are written to the file as
+	// they are.  What output changes is supplied alongside: small tables (individuals, provenance, metadata) are built in overlay
+	// tables, node and mutation times are rebased and node individuals remapped chunk by chunk as they are written, and mutation
+	// parents are computed in place and then restored.  tables_ must already be simplified or sorted, with buffered rows flushed.
+	int ret = 0;
+	tsk_table_collection_t overlay_tables;
+	
+	ret = tsk_table_collection_init(&overlay_tables, 0);
+	if (ret != 0) handle_error("tsk_table_collection_init", ret);
+	
+	// Add in the mutation.parent information; valid tree sequences need parents, but we don't keep them while running.  The index
+	// built for this is also written to the file; it is dropped again afterwards, as our tables are not kept indexed while running
+	std::vector<tsk_id_t> saved_mutation_parent(tables_.mutations.parent, tables_.mutations.parent + tables_.mutations.num_rows);
+	
+	ret = tsk_table_collection_build_index(&tables_, 0);
+	if (ret < 0) handle_error("tsk_table_collection_build_index", ret);
+	ret = tsk_table_collection_compute_mutation_parents(&tables_, 0);
+	if (ret < 0) handle_error("tsk_table_collection_compute_mutation_parents", ret);
+	
+	// Build the output individual table: currently alive individuals first, in SLiM's order, with their current information, and
+	// then the other (remembered) individuals in their existing order; see AddCurrentGenerationToIndividuals() and
+	// ReorderIndividualTable(), which do this on a copy of the tables.  The remembered individuals are exactly the rows of
+	// tables_.individuals, and are referenced by their nodes (see the invariants asserted in AddIndividualsToTable()), so we
+	// record the remapping of individual ids, and the individuals of the nodes of alive individuals, instead of touching the nodes.
+	tsk_individual_table_t &live_individuals = tables_.individuals;
+	tsk_individual_table_t &output_individuals = overlay_tables.individuals;
+	std::vector<tsk_id_t> individual_map(live_individuals.num_rows, TSK_NULL);
+	std::vector<std::pair<tsk_id_t, tsk_id_t>> alive_node_individuals;
+	
+	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
+	{
+		for (Individual *individual : subpop_pair.second->parent_individuals_)
+		{
+			tsk_id_t node1 = individual->genome1_->tsk_node_id_;
+			tsk_id_t node2 = individual->genome2_->tsk_node_id_;
+			tsk_id_t live_individual = tables_.nodes.individual[node1];
+			tsk_flags_t flags = SLIM_TSK_INDIVIDUAL_ALIVE;
+			double location[3] = {individual->spatial_x_, individual->spatial_y_, individual->spatial_z_};
+			IndividualMetadataRec metadata_rec;
+			
+			MetadataForIndividual(individual, &metadata_rec);
+			
+			if (live_individual >= 0)
+				flags |= live_individuals.flags[live_individual];
+			
+			tsk_id_t output_individual = tsk_individual_table_add_row(&output_individuals, flags, location, 3, (char *)&metadata_rec, (tsk_size_t)sizeof(IndividualMetadataRec));
+			if (output_individual < 0) handle_error("tsk_individual_table_add_row", output_individual);
+			
+			if (live_individual >= 0)
+				individual_map[live_individual] = output_individual;
+			
+			alive_node_individuals.emplace_back(node1, output_individual);
+			alive_node_individuals.emplace_back(node2, output_individual);
+		}
+	}
+	
+	for (tsk_size_t live_individual = 0; live_individual < live_individuals.num_rows; ++live_individual)
+	{
+		if (individual_map[live_individual] != TSK_NULL)
+			continue;
+		
+		tsk_size_t location_start = live_individuals.location_offset[live_individual];
+		tsk_size_t metadata_start = live_individuals.metadata_offset[live_individual];
+		
+		tsk_id_t output_individual = tsk_individual_table_add_row(&output_individuals, live_individuals.flags[live_individual],
+			live_individuals.location + location_start, live_individuals.location_offset[live_individual + 1] - location_start,
+			live_individuals.metadata + metadata_start, live_individuals.metadata_offset[live_individual + 1] - metadata_start);
+		if (output_individual < 0) handle_error("tsk_individual_table_add_row", output_individual);
+		
+		individual_map[live_individual] = output_individual;
+	}
+	
+	std::sort(alive_node_individuals.begin(), alive_node_individuals.end());
+	
+	// Provenance, with a row added to record the current state, and the top-level metadata and the metadata schemas
+	ret = tsk_provenance_table_copy(&tables_.provenances, &overlay_tables.provenances, TSK_NO_INIT);
+	if (ret != 0) handle_error("tsk_provenance_table_copy", ret);
+	
+	WriteProvenanceTable(&overlay_tables, /* p_use_newlines */ true, p_include_model);
+	WriteTreeSequenceMetadata(&overlay_tables, p_metadata_dict);
+	
+	// derived state data must be in ASCII (or unicode) on disk, according to tskit policy; this is built as an overlay column
+	std::string ascii_derived_state;
+	std::vector<tsk_size_t> ascii_derived_state_offset;
+	
+	{
+		tsk_mutation_table_t &mutations = tables_.mutations;
+		
+		ascii_derived_state_offset.reserve(mutations.num_rows + 1);
+		ascii_derived_state_offset.emplace_back(0);
+		
+		for (size_t j = 0; j < mutations.num_rows; j++)
+		{
+			slim_mutationid_t *int_derived_state = (slim_mutationid_t *)(mutations.derived_state + mutations.derived_state_offset[j]);
+			size_t cur_derived_state_length = (mutations.derived_state_offset[j+1] - mutations.derived_state_offset[j])/sizeof(slim_mutationid_t);
+			
+			for (size_t i = 0; i < cur_derived_state_length; i++)
+			{
+				if (i != 0) ascii_derived_state.append(",");
+				ascii_derived_state.append(std::to_string(int_derived_state[i]));
+			}
+			ascii_derived_state_offset.emplace_back((tsk_size_t)ascii_derived_state.size());
+		}
+	}
+	
+	// Rebase the times in the nodes to be in tskit-land as they are written; see WriteTreeSequence()
+	double time_adjustment = tree_seq_generation_;
+	const double *node_time = tables_.nodes.time;
+	const double *mutation_time = tables_.mutations.time;
+	const tsk_id_t *node_individual = tables_.nodes.individual;
+	
+	auto fill_node_time = [node_time, time_adjustment](size_t p_start, size_t p_count, void *p_buffer) {
+		for (size_t index = 0; index < p_count; ++index)
+			((double *)p_buffer)[index] = node_time[p_start + index] + time_adjustment;
+	};
+	auto fill_mutation_time = [mutation_time, time_adjustment](size_t p_start, size_t p_count, void *p_buffer) {
+		for (size_t index = 0; index < p_count; ++index)
+			((double *)p_buffer)[index] = mutation_time[p_start + index] + time_adjustment;
+	};
+	auto fill_node_individual = [node_individual, &individual_map, &alive_node_individuals](size_t p_start, size_t p_count, void *p_buffer) {
+		tsk_id_t *buffer = (tsk_id_t *)p_buffer;
+		
+		for (size_t index = 0; index < p_count; ++index)
+		{
+			tsk_id_t live_individual = node_individual[p_start + index];
+			
+			buffer[index] = (live_individual >= 0) ? individual_map[live_individual] : TSK_NULL;
+		}
+		
+		// alive individuals that are not remembered have no individual in tables_ yet
+		auto alive_iter = std::lower_bound(alive_node_individuals.begin(), alive_node_individuals.end(), std::pair<tsk_id_t, tsk_id_t>((tsk_id_t)p_start, TSK_NULL));
+		
+		for ( ; (alive_iter != alive_node_individuals.end()) && ((size_t)alive_iter->first < p_start + p_count); ++alive_iter)
+			buffer[alive_iter->first - p_start] = alive_iter->second;
+	};
+	
+	// The file's columns; this follows tsk_table_collection_dump() for tskit file format 12.3, taking each column from tables_ or
+	// from the overlay tables.  In nucleotide-based models the ancestral sequence is added as well.
+	char format_name[TSK_FILE_FORMAT_NAME_LENGTH];
+	uint32_t format_version[2] = {TSK_FILE_FORMAT_VERSION_MAJOR, TSK_FILE_FORMAT_VERSION_MINOR};
+	char uuid[TSK_UUID_SIZE + 1];
+	
+	memcpy(format_name, TSK_FILE_FORMAT_NAME, sizeof(format_name));
+	ret = tsk_generate_uuid(uuid, 0);
+	if (ret != 0) handle_error("tsk_generate_uuid", ret);
+	
+	tsk_node_table_t &nodes = tables_.nodes;
+	tsk_edge_table_t &edges = tables_.edges;
+	tsk_site_table_t &sites = tables_.sites;
+	tsk_migration_table_t &migrations = tables_.migrations;
+	tsk_mutation_table_t &mutations = tables_.mutations;
+	tsk_population_table_t &populations = tables_.populations;
+	tsk_individual_table_t &individuals = overlay_tables.individuals;
+	tsk_provenance_table_t &provenances = overlay_tables.provenances;
+	std::vector<slim_kastore_column> columns = {
+		{"format/name", KAS_INT8, sizeof(format_name), format_name, nullptr},
+		{"format/version", KAS_UINT32, 2, format_version, nullptr},
+		{"sequence_length", KAS_FLOAT64, 1, &tables_.sequence_length, nullptr},
+		{"uuid", KAS_INT8, TSK_UUID_SIZE, uuid, nullptr},
+		{"metadata", KAS_INT8, overlay_tables.metadata_length, overlay_tables.metadata, nullptr},
+		{"metadata_schema", KAS_INT8, overlay_tables.metadata_schema_length, overlay_tables.metadata_schema, nullptr},
+		
+		{"nodes/time", KAS_FLOAT64, nodes.num_rows, nullptr, fill_node_time},
+		{"nodes/flags", KAS_UINT32, nodes.num_rows, nodes.flags, nullptr},
+		{"nodes/population", KAS_INT32, nodes.num_rows, nodes.population, nullptr},
+		{"nodes/individual", KAS_INT32, nodes.num_rows, nullptr, fill_node_individual},
+		{"nodes/metadata", KAS_UINT8, nodes.metadata_length, nodes.metadata, nullptr},
+		{"nodes/metadata_offset", KAS_UINT32, nodes.num_rows + 1, nodes.metadata_offset, nullptr},
+		{"nodes/metadata_schema", KAS_UINT8, overlay_tables.nodes.metadata_schema_length, overlay_tables.nodes.metadata_schema, nullptr},
+		
+		{"edges/left", KAS_FLOAT64, edges.num_rows, edges.left, nullptr},
+		{"edges/right", KAS_FLOAT64, edges.num_rows, edges.right, nullptr},
+		{"edges/parent", KAS_INT32, edges.num_rows, edges.parent, nullptr},
+		{"edges/child", KAS_INT32, edges.num_rows, edges.child, nullptr},
+		{"edges/metadata_schema", KAS_UINT8, overlay_tables.edges.metadata_schema_length, overlay_tables.edges.metadata_schema, nullptr},
+		
+		{"sites/position", KAS_FLOAT64, sites.num_rows, sites.position, nullptr},
+		{"sites/ancestral_state", KAS_UINT8, sites.ancestral_state_length, sites.ancestral_state, nullptr},
+		{"sites/ancestral_state_offset", KAS_UINT32, sites.num_rows + 1, sites.ancestral_state_offset, nullptr},
+		{"sites/metadata", KAS_UINT8, sites.metadata_length, sites.metadata, nullptr},
+		{"sites/metadata_offset", KAS_UINT32, sites.num_rows + 1, sites.metadata_offset, nullptr},
+		{"sites/metadata_schema", KAS_UINT8, overlay_tables.sites.metadata_schema_length, overlay_tables.sites.metadata_schema, nullptr},
+		
+		{"migrations/left", KAS_FLOAT64, migrations.num_rows, migrations.left, nullptr},
+		{"migrations/right", KAS_FLOAT64, migrations.num_rows, migrations.right, nullptr},
+		{"migrations/node", KAS_INT32, migrations.num_rows, migrations.node, nullptr},
+		{"migrations/source", KAS_INT32, migrations.num_rows, migrations.source, nullptr},
+		{"migrations/dest", KAS_INT32, migrations.num_rows, migrations.dest, nullptr},
+		{"migrations/time", KAS_FLOAT64, migrations.num_rows, migrations.time, nullptr},
+		{"migrations/metadata", KAS_UINT8, migrations.metadata_length, migrations.metadata, nullptr},
+		{"migrations/metadata_offset", KAS_UINT32, migrations.num_rows + 1, migrations.metadata_offset, nullptr},
+		{"migrations/metadata_schema", KAS_UINT8, migrations.metadata_schema_length, migrations.metadata_schema, nullptr},
+		
+		{"mutations/site", KAS_INT32, mutations.num_rows, mutations.site, nullptr},
+		{"mutations/node", KAS_INT32, mutations.num_rows, mutations.node, nullptr},
+		{"mutations/parent", KAS_INT32, mutations.num_rows, mutations.parent, nullptr},
+		{"mutations/time", KAS_FLOAT64, mutations.num_rows, nullptr, fill_mutation_time},
+		{"mutations/derived_state", KAS_UINT8, ascii_derived_state.size(), ascii_derived_state.data(), nullptr},
+		{"mutations/derived_state_offset", KAS_UINT32, mutations.num_rows + 1, ascii_derived_state_offset.data(), nullptr},
+		{"mutations/metadata", KAS_UINT8, mutations.metadata_length, mutations.metadata, nullptr},
+		{"mutations/metadata_offset", KAS_UINT32, mutations.num_rows + 1, mutations.metadata_offset, nullptr},
+		{"mutations/metadata_schema", KAS_UINT8, overlay_tables.mutations.metadata_schema_length, overlay_tables.mutations.metadata_schema, nullptr},
+		
+		{"individuals/flags", KAS_UINT32, individuals.num_rows, individuals.flags, nullptr},
+		{"individuals/location", KAS_FLOAT64, individuals.location_length, individuals.location, nullptr},
+		{"individuals/location_offset", KAS_UINT32, individuals.num_rows + 1, individuals.location_offset, nullptr},
+		{"individuals/metadata", KAS_UINT8, individuals.metadata_length, individuals.metadata, nullptr},
+		{"individuals/metadata_offset", KAS_UINT32, individuals.num_rows + 1, individuals.metadata_offset, nullptr},
+		{"individuals/metadata_schema", KAS_UINT8, individuals.metadata_schema_length, individuals.metadata_schema, nullptr},
+		
+		{"populations/metadata", KAS_UINT8, populations.metadata_length, populations.metadata, nullptr},
+		{"populations/metadata_offset", KAS_UINT32, populations.num_rows + 1, populations.metadata_offset, nullptr},
+		{"populations/metadata_schema", KAS_UINT8, overlay_tables.populations.metadata_schema_length, overlay_tables.populations.metadata_schema, nullptr},
+		
+		{"provenances/timestamp", KAS_UINT8, provenances.timestamp_length, provenances.timestamp, nullptr},
+		{"provenances/timestamp_offset", KAS_UINT32, provenances.num_rows + 1, provenances.timestamp_offset, nullptr},
+		{"provenances/record", KAS_UINT8, provenances.record_length, provenances.record, nullptr},
+		{"provenances/record_offset", KAS_UINT32, provenances.num_rows + 1, provenances.record_offset, nullptr},
+		
+		{"indexes/edge_insertion_order", KAS_INT32, tables_.indexes.num_edges, tables_.indexes.edge_insertion_order, nullptr},
+		{"indexes/edge_removal_order", KAS_INT32, tables_.indexes.num_edges, tables_.indexes.edge_removal_order, nullptr}
+	};
+	
+	// our edge table has no metadata columns (TSK_NO_METADATA), but a copy of it would, so we write empty ones for the same file
+	if (edges.options & TSK_NO_METADATA)
+	{
+		auto fill_zero = [](size_t __attribute__((__unused__)) p_start, size_t p_count, void *p_buffer) { memset(p_buffer, 0, p_count * sizeof(tsk_size_t)); };
+		
+		columns.push_back({"edges/metadata", KAS_UINT8, 0, nullptr, nullptr});
+		columns.push_back({"edges/metadata_offset", KAS_UINT32, edges.num_rows + 1, nullptr, fill_zero});
+	}
+	else
+	{
+		columns.push_back({"edges/metadata", KAS_UINT8, edges.metadata_length, edges.metadata, nullptr});
+		columns.push_back({"edges/metadata_offset", KAS_UINT32, edges.num_rows + 1, edges.metadata_offset, nullptr});
+	}
+	
+	std::string reference_sequence;
+	
+	if (nucleotide_based_)
+	{
+		reference_sequence.resize(chromosome_->AncestralSequence()->size());
+		chromosome_->AncestralSequence()->WriteNucleotidesToBuffer(&reference_sequence[0]);
+		
+		columns.push_back({"reference_sequence/data", KAS_INT8, reference_sequence.size(), reference_sequence.data(), nullptr});
+	}
+	
+	bool success = slim_write_kastore(p_path, columns);
+	
+	// Put tables_ back the way it was
+	ret = tsk_table_collection_drop_index(&tables_, 0);
+	if (ret != 0) handle_error("tsk_table_collection_drop_index", ret);
+	
+	std::copy(saved_mutation_parent.begin(), saved_mutation_parent.end(), tables_.mutations.parent);
+	
+	tsk_table_collection_free(&overlay_tables);
+	
+	if (!success)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_WriteTreeSequenceBinary): treeSeqOutput() could not write to " << p_path << "." << EidosTerminate();
+}
+
 void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binary, bool p_simplify, bool p_include_model, EidosDictionaryRetained *p_metadata_dict)
 {
 #if DEBUG
@@ -6904,7 +8524,8 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
 	std::string path = Eidos_ResolvedPath(Eidos_StripTrailingSlash(p_recording_tree_path));
 	
 	// Add a population (i.e., subpopulation) table to the table collection; subpopulation information
-	// comes from the time of output.  This needs to happen before simplify/sort.
+	// comes from the time of output.  This needs to happen before simplify/sort, and after flushing buffered nodes.
+	FlushBufferedNodes();
 	WritePopulationTable(&tables_);
 	
 	// First we simplify, on the original table collection; we considered doing this on the copy,
@@ -6917,18 +8538,21 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
 	else
 	{
         // this is done by SimplifyTreeSequence() but we need to do in any case
-        int flags = TSK_NO_CHECK_INTEGRITY;
-#if DEBUG
-        flags = 0;
-#endif
-		ret = tsk_table_collection_sort(&tables_, /* edge_start */ NULL, /* flags */ flags);
-        if (ret < 0) handle_error("tsk_table_collection_sort", ret);
+		MergeBufferedEdges();
+		SortTreeSequenceTables(&tables_, tables_.edges.num_rows);
 		
         // Remove redundant sites we added
         ret = tsk_table_collection_deduplicate_sites(&tables_, 0);
         if (ret < 0) handle_error("tsk_table_collection_deduplicate_sites", ret);
     }
 	
+	// Binary output is written directly from tables_, with the changes made for output supplied alongside, without a copy
+	if (p_binary)
+	{
+		_WriteTreeSequenceBinary(path, p_include_model, p_metadata_dict);
+		return;
+	}
+	
 	// Copy the table collection so that modifications we do for writing don't affect the original tables
 	tsk_table_collection_t output_tables;
 	ret = tsk_table_collection_copy(&tables_, &output_tables, 0);
@@ -6978,42 +8602,12 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
 	
 	// Add a row to the Provenance table to record current state; text format does not allow newlines in the entry,
 	// so we don't prettyprint the JSON when going to text, as a quick fix that avoids quoting the newlines etc.
-    WriteProvenanceTable(&output_tables, /* p_use_newlines */ p_binary, p_include_model);
+    WriteProvenanceTable(&output_tables, /* p_use_newlines */ false, p_include_model);
 
     // Add top-level metadata and metadata schema
     WriteTreeSequenceMetadata(&output_tables, p_metadata_dict);
 	
 	// Write out the copied tables
-    if (p_binary)
-	{
-		// derived state data must be in ASCII (or unicode) on disk, according to tskit policy
-		DerivedStatesToAscii(&output_tables);
-		
-		tsk_table_collection_dump(&output_tables, path.c_str(), 0);
-		
-		// In nucleotide-based models, write out the ancestral sequence, re-opening the kastore to append
-		if (nucleotide_based_)
-		{
-			std::size_t buflen = chromosome_->AncestralSequence()->size();
-			char *buffer;	// kastore needs to provide us with a memory location to which to write the data
-			kastore_t store;
-			
-			buffer = (char *)malloc(buflen);
-			chromosome_->AncestralSequence()->WriteNucleotidesToBuffer(buffer);
-			
-			ret = kastore_open(&store, path.c_str(), "a", 0);
-			if (ret < 0) handle_error("kastore_open", ret);
-				
-			kastore_oputs_int8(&store, "reference_sequence/data", (int8_t *)buffer, buflen, 0);
-			if (ret < 0) handle_error("kastore_oputs_int8", ret);
-			
-			ret = kastore_close(&store);
-			if (ret < 0) handle_error("kastore_close", ret);
-			
-			// kastore owns buffer now, so we do not free it
-		}
-    }
-	else
 	{
         std::string error_string;
         bool success = Eidos_CreateDirectory(path, &error_string);
@@ -7091,6 +8685,15 @@ void SLiMSim::FreeTreeSequence(void)
 	// and also when we're wiping the slate clean with something like readFromPopulationFile().
 	tsk_table_collection_free(&tables_);
 	
+	std::vector<ts_buffered_edge>().swap(buffered_edges_);
+	buffered_edges_position_ = 0;
+	
+	std::vector<tsk_flags_t>().swap(buffered_nodes_.flags);
+	std::vector<double>().swap(buffered_nodes_.time);
+	std::vector<tsk_id_t>().swap(buffered_nodes_.population);
+	std::vector<GenomeMetadataRec>().swap(buffered_nodes_.metadata);
+	buffered_nodes_position_ = 0;
+	
 	remembered_genomes_.clear();
 }
 
@@ -7303,10 +8906,13 @@ void SLiMSim::CrosscheckTreeSeqIntegrity(void)
 		for (Genome *genome : genomes)
 			genome_walkers.emplace_back(genome);
 		
-		// make a copy of the full table collection, so that we can sort/clean/simplify without modifying anything
+		// make a copy of the full table collection, so that we can sort/clean/simplify without modifying anything; the buffered edges
+		// are merged into our own edge table first, which changes nothing but makes the copy complete
 		int ret;
 		tsk_table_collection_t *tables_copy;
 		
+		MergeBufferedEdges();
+		
 		tables_copy = (tsk_table_collection_t *)malloc(sizeof(tsk_table_collection_t));
 		ret = tsk_table_collection_copy(&tables_, tables_copy, 0);
 		if (ret != 0) handle_error("CrosscheckTreeSeqIntegrity tsk_table_collection_copy()", ret);
@@ -7326,12 +8932,7 @@ void SLiMSim::CrosscheckTreeSeqIntegrity(void)
 				for (Genome *genome : iter.second->parent_genomes_)
 					samples.push_back(genome->tsk_node_id_);
 			
-            int flags = TSK_NO_CHECK_INTEGRITY;
-#if DEBUG
-            flags = 0;
-#endif
-			ret = tsk_table_collection_sort(tables_copy, /* edge_start */ NULL, /* flags */ flags);
-			if (ret < 0) handle_error("tsk_table_collection_sort", ret);
+			SortTreeSequenceTables(tables_copy, 0);
 			
 			ret = tsk_table_collection_deduplicate_sites(tables_copy, 0);
 			if (ret < 0) handle_error("tsk_table_collection_deduplicate_sites", ret);
@@ -8436,6 +10037,7 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
 	// Simplification has just been done, in effect (assuming the tree sequence we loaded is simplified; we assume that
 	// here, but if that is not true, no harm done really except that it might be a while before we simplify again)
 	simplify_elapsed_ = 0;
+	simplify_last_post_bytes_ = TreeSequenceBytesInUse();
 	
 	// Reset our last coalescence state; we don't know whether we're coalesced now or not
 	last_coalescence_state_ = false;
@@ -62,6 +62,24 @@ class LogFile;
 struct ts_subpop_info;
 struct ts_mut_info;
 
+// An edge recorded since the last simplification; these are buffered outside the edge table, see SLiMSim::MergeBufferedEdges()
+struct ts_buffered_edge {
+	double left, right;
+	tsk_id_t parent, child;
+};
+
+// A record of one automatic simplification, used by the cost-driven simplification scheduler and reported by slim -profile; see SLiMSim::CheckAutoSimplification()
+struct ts_simplify_record {
+	slim_generation_t generation;	// the generation in which the simplification was done
+	int64_t interval;				// the number of generations since the previous simplification
+	double growth;					// the growth of the tables, in bytes per generation, since the previous simplification
+	double pre_bytes, post_bytes;	// the table bytes in use before and after simplification
+	double seconds;					// the wall time taken by SimplifyTreeSequence()
+	double next_interval;			// the interval chosen for the next automatic simplification
+	bool memory_bound;				// true if next_interval was shortened to stay below simplificationMemoryLimit
+	bool memory_forced;				// true if this simplification was done before its interval was up, to stay below simplificationMemoryLimit
+};
+
 extern EidosClass *gSLiM_SLiMSim_Class;
 
 enum class SLiMModelType
@@ -177,6 +195,14 @@ static_assert(sizeof(IndividualMetadataRec) == 24, "IndividualMetadataRec is not
 static_assert(sizeof(SubpopulationMetadataRec) == 88, "SubpopulationMetadataRec is not 88 bytes!");
 static_assert(sizeof(SubpopulationMigrationMetadataRec) == 12, "SubpopulationMigrationMetadataRec is not 12 bytes!");
 
+// Nodes recorded since the last flush, in columns; these are buffered outside the node table, see SLiMSim::FlushBufferedNodes()
+struct ts_buffered_nodes {
+	std::vector<tsk_flags_t> flags;
+	std::vector<double> time;
+	std::vector<tsk_id_t> population;
+	std::vector<GenomeMetadataRec> metadata;	// GenomeMetadataRec is packed, so this is also the metadata column, with fixed-length rows
+};
+
 // We check endianness on the platform we're building on; we assume little-endianness in our read/write code, I think.
 #if defined(__BYTE_ORDER__)
 #if (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
@@ -295,12 +321,15 @@ private:
 	// LogFile registry, for logging data out to a file
 	std::vector<LogFile *> log_file_registry_;										// OWNED POINTERS (under retain/release)
 	
-#ifdef SLIMGUI
+#if defined(SLIMGUI) || (SLIMPROFILING == 1)
 public:
+#endif
 	
+#ifdef SLIMGUI
 	bool simulation_valid_ = true;													// set to false if a terminating condition is encountered while running in SLiMgui
-
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif
+	
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	eidos_profile_t profile_stage_totals_[8];										// profiling clocks; index 0 is initialize(), the rest follow sequentially; [7] is TS simplification
 	eidos_profile_t profile_callback_totals_[11];									// profiling clocks; these follow SLiMEidosBlockType, except no SLiMEidosUserDefinedFunction
@@ -309,6 +338,11 @@ public:
 	SLiM_MemoryUsage profile_total_memory_usage_;
 	int64_t total_memory_tallies_;
 	
+#define SLIM_PROFILE_MEMORY_HISTORY_MAX	2048	// the most memory usage samples kept by slim -profile; about 1 MB
+	bool profile_memory_history_enabled_ = false;									// set by slim -profile; SLiMgui shows only the average and final usage
+	slim_generation_t profile_memory_history_stride_ = 1;							// the history samples every stride-th generation; doubles each time it is thinned
+	std::vector<std::pair<slim_generation_t, SLiM_MemoryUsage>> profile_memory_history_;	// memory usage by generation, thinned to stay below SLIM_PROFILE_MEMORY_HISTORY_MAX
+	
 #if SLIM_USE_NONNEUTRAL_CACHES
 	std::vector<int32_t> profile_mutcount_history_;									// a record of the mutation run count used in each generation
 	std::vector<int32_t> profile_nonneutral_regime_history_;						// a record of the nonneutral regime used in each generation
@@ -319,9 +353,9 @@ public:
 	int64_t profile_mutrun_nonneutral_recache_total_;								// of profile_unique_mutrun_total_, how many mutruns regenerated their nonneutral cache
 	int64_t profile_max_mutation_index_;											// the largest mutation index seen over the course of the profile
 #endif	// SLIM_USE_NONNEUTRAL_CACHES
-#endif	// (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif	// (SLIMPROFILING == 1)
 	
-#else
+#ifndef SLIMGUI
 private:
 #endif
 	
@@ -359,6 +393,7 @@ private:
 	slim_generation_t InitializePopulationFromFile(const std::string &p_file_string, EidosInterpreter *p_interpreter);	// initialize the population from the file
 	slim_generation_t _InitializePopulationFromTextFile(const char *p_file, EidosInterpreter *p_interpreter);			// initialize the population from a SLiM text file
 	slim_generation_t _InitializePopulationFromBinaryFile(const char *p_file, EidosInterpreter *p_interpreter);			// initialize the population from a SLiM binary file
+	void _InitializePopulationFromColumnarBinaryFile(char *p, char *buf, char *buf_end, EidosInterpreter *p_interpreter, int32_t p_spatial_output_count, int p_age_output_count, int p_pedigree_output_count, bool p_has_nucleotides);		// the sections of a version 7 binary file
 	
 	// initialization completeness check counts; used only when running initialize() callbacks
 	int num_interaction_types_;
@@ -394,6 +429,9 @@ private:
 	// preventing incidental selfing in hermaphroditic models
 	bool prevent_incidental_selfing_ = false;
 	
+	// sharing identical mutation runs as soon as they are built, rather than only every hundredth generation
+	bool unique_mutation_runs_ = false;
+	
 	// nucleotide-based models
 	bool nucleotide_based_ = false;
 	double max_nucleotide_mut_rate_;				// the highest rate for any genetic background in any genomic element type
@@ -439,6 +477,13 @@ private:
 	tsk_table_collection_t tables_;
 	tsk_bookmark_t table_position_;
 	
+	std::vector<ts_buffered_edge> buffered_edges_;	// edges recorded since the last simplification, in the order recorded
+	size_t buffered_edges_position_ = 0;			// the size of buffered_edges_ at the last RecordTablePosition()
+	ts_buffered_nodes buffered_nodes_;			// nodes recorded since the last flush, in the order recorded; their ids continue on from tables_.nodes
+	size_t buffered_nodes_position_ = 0;			// the number of buffered nodes at the last RecordTablePosition()
+
+#define SLIM_TREESEQ_PARALLEL_SORT_MIN_SIZE		10000	// the fewest table rows for which SortTreeSequenceTables() sorts on multiple threads
+
     std::vector<tsk_id_t> remembered_genomes_;
 	//Individual *current_new_individual_;
 	
@@ -451,7 +496,16 @@ private:
 	double simplification_ratio_;				// the pre:post table size ratio we target with our automatic simplification heuristic
 	int64_t simplification_interval_;			// the generation interval between simplifications; -1 if not used (in which case the ratio is used)
 	int64_t simplify_elapsed_ = 0;				// the number of generations elapsed since a simplification was done (automatic or otherwise)
-	double simplify_interval_;					// the current number of generations between automatic simplifications when using simplification_ratio_
+	double simplify_interval_;					// the current number of generations between automatic simplifications when using simplification_ratio_ or simplification_memory_limit_
+	double simplification_memory_limit_ = 0.0;	// if > 0, the cost-driven scheduler is used, keeping the table bytes in use below this; see ChooseSimplificationInterval()
+	double simplify_last_post_bytes_ = 0.0;		// the table bytes in use after the last simplification (automatic or otherwise), for measuring table growth
+	int64_t simplify_count_ = 0;				// the number of automatic simplifications done
+	std::vector<ts_simplify_record> simplify_history_;	// the most recent automatic simplifications, oldest first
+
+#define SLIM_SIMPLIFY_HISTORY_MAX		1024	// the most simplification records kept in simplify_history_
+#define SLIM_SIMPLIFY_FIT_COUNT			8		// the number of recent simplifications used to fit the cost model of the cost-driven scheduler
+#define SLIM_SIMPLIFY_COST_TOLERANCE	0.1		// the cost-driven scheduler stops lengthening its interval when that would save less than this fraction of the cost
+#define SLIM_SIMPLIFY_MAX_INTERVAL		1000.0	// the longest interval between automatic simplifications chosen by the ratio and cost-driven schedulers
 	
 	slim_generation_t tree_seq_generation_ = 0;	// the generation for the tree sequence code, incremented after offspring generation
 												// this is needed since addSubpop() in an early() event makes one gen, and then the offspring
@@ -542,12 +596,16 @@ public:
 	void EnterStasisForMutationRunExperiments(void);
 	void MaintainMutationRunExperiments(double p_last_gen_runtime);
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	void CollectSLiMguiMemoryUsageProfileInfo(void);
 #if SLIM_USE_NONNEUTRAL_CACHES
 	void CollectSLiMguiMutationProfileInfo(void);
 #endif
+	
+	// Command-line profiling with slim -profile; SLiMgui does its own bookkeeping and presents its own report
+	void StartProfiling(void);
+	void WriteProfileReport(std::ostream &p_out, double p_wall_time, double p_cpu_time, eidos_profile_t p_elapsed_wall_clock, slim_generation_t p_start_generation);
 #endif
 	
 	// Mutation stack policy checking
@@ -602,6 +660,7 @@ public:
 	inline __attribute__((always_inline)) bool PedigreesEnabled(void) const													{ return pedigrees_enabled_; }
 	inline __attribute__((always_inline)) bool PedigreesEnabledByUser(void) const											{ return pedigrees_enabled_by_user_; }
 	inline __attribute__((always_inline)) bool PreventIncidentalSelfing(void) const											{ return prevent_incidental_selfing_; }
+	inline __attribute__((always_inline)) bool UniqueNewMutationRuns(void) const												{ return unique_mutation_runs_; }
 	inline __attribute__((always_inline)) GenomeType ModeledChromosomeType(void) const										{ return modeled_chromosome_type_; }
 	inline __attribute__((always_inline)) double XDominanceCoefficient(void) const											{ return x_chromosome_dominance_coeff_; }
 	inline __attribute__((always_inline)) int SpatialDimensionality(void) const												{ return spatial_dimensionality_; }
@@ -648,9 +707,16 @@ public:
 	void WriteTreeSequenceMetadata(tsk_table_collection_t *p_tables, EidosDictionaryRetained *p_metadata_dict);
 	void ReadTreeSequenceMetadata(tsk_table_collection_t *p_tables, slim_generation_t *p_generation, SLiMModelType *p_model_type, int *p_file_version);
 	void WriteTreeSequence(std::string &p_recording_tree_path, bool p_binary, bool p_simplify, bool p_include_model, EidosDictionaryRetained *p_metadata_dict);
+	void _WriteTreeSequenceBinary(const std::string &p_path, bool p_include_model, EidosDictionaryRetained *p_metadata_dict);
     void ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> p_individual_map, bool p_keep_unmapped);
+	void FlushBufferedNodes(void);
+	void MergeBufferedEdges(void);
+	void SortTreeSequenceTables(tsk_table_collection_t *p_tables, tsk_size_t p_edge_start);
 	void SimplifyTreeSequence(void);
 	void CheckCoalescenceAfterSimplification(void);
+	double TreeSequenceBytesInUse(void);
+	ts_simplify_record &TimedSimplifyTreeSequence(bool p_memory_forced);
+	void ChooseSimplificationInterval(ts_simplify_record &p_record);
 	void CheckAutoSimplification(void);
     void TreeSequenceDataFromAscii(std::string NodeFileName, 
             std::string EdgeFileName, std::string SiteFileName, std::string MutationFileName, 
@@ -1129,7 +1129,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSex(const std::string &p
 	return gStaticEidosValueVOID;
 }
 
-//	*********************	(void)initializeSLiMOptions([logical$ keepPedigrees = F], [string$ dimensionality = ""], [string$ periodicity = ""], [integer$ mutationRuns = 0], [logical$ preventIncidentalSelfing = F], [logical$ nucleotideBased = F])
+//	*********************	(void)initializeSLiMOptions([logical$ keepPedigrees = F], [string$ dimensionality = ""], [string$ periodicity = ""], [integer$ mutationRuns = 0], [logical$ preventIncidentalSelfing = F], [logical$ nucleotideBased = F], [logical$ uniqueMutationRuns = F])
 //
 EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::string &p_function_name, const std::vector<EidosValue_SP> &p_arguments, EidosInterpreter &p_interpreter)
 {
@@ -1140,6 +1140,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::s
 	EidosValue *arg_mutationRuns_value = p_arguments[3].get();
 	EidosValue *arg_preventIncidentalSelfing_value = p_arguments[4].get();
 	EidosValue *arg_nucleotideBased_value = p_arguments[5].get();
+	EidosValue *arg_uniqueMutationRuns_value = p_arguments[6].get();
 	std::ostream &output_stream = p_interpreter.ExecutionOutputStream();
 	
 	if (num_options_declarations_ > 0)
@@ -1249,6 +1250,13 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::s
 		nucleotide_based_ = nucleotide_based;
 	}
 	
+	{
+		// [logical$ uniqueMutationRuns = F]
+		bool unique_mutruns = arg_uniqueMutationRuns_value->LogicalAtIndex(0, nullptr);
+		
+		unique_mutation_runs_ = unique_mutruns;
+	}
+	
 	if (SLiM_verbosity_level >= 1)
 	{
 		output_stream << "initializeSLiMOptions(";
@@ -1306,6 +1314,13 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::s
 			if (previous_params) output_stream << ", ";
 			output_stream << "nucleotideBased = " << (nucleotide_based_ ? "T" : "F");
 			previous_params = true;
+		}
+		
+		if (unique_mutation_runs_)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "uniqueMutationRuns = " << (unique_mutation_runs_ ? "T" : "F");
+			previous_params = true;
 			(void)previous_params;	// dead store above is deliberate
 		}
 		
@@ -1318,7 +1333,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::s
 }
 
 // TREE SEQUENCE RECORDING
-//	*********************	(void)initializeTreeSeq([logical$ recordMutations = T], [Nif$ simplificationRatio = NULL], [Ni$ simplificationInterval = NULL], [logical$ checkCoalescence = F], [logical$ runCrosschecks = F])
+//	*********************	(void)initializeTreeSeq([logical$ recordMutations = T], [Nif$ simplificationRatio = NULL], [Ni$ simplificationInterval = NULL], [logical$ checkCoalescence = F], [logical$ runCrosschecks = F], [Nif$ simplificationMemoryLimit = NULL])
 //
 EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::string &p_function_name, const std::vector<EidosValue_SP> &p_arguments, EidosInterpreter &p_interpreter)
 {
@@ -1328,6 +1343,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 	EidosValue *arg_simplificationInterval_value = p_arguments[2].get();
 	EidosValue *arg_checkCoalescence_value = p_arguments[3].get();
 	EidosValue *arg_runCrosschecks_value = p_arguments[4].get();
+	EidosValue *arg_simplificationMemoryLimit_value = p_arguments[5].get();
 	std::ostream &output_stream = p_interpreter.ExecutionOutputStream();
 	
 	if (num_treeseq_declarations_ > 0)
@@ -1342,7 +1358,32 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 	running_treeseq_crosschecks_ = arg_runCrosschecks_value->LogicalAtIndex(0, nullptr);
 	treeseq_crosschecks_interval_ = 1;		// this interval is presently not exposed in the Eidos API
 	
-	if ((arg_simplificationRatio_value->Type() == EidosValueType::kValueNULL) && (arg_simplificationInterval_value->Type() == EidosValueType::kValueNULL))
+	if (arg_simplificationMemoryLimit_value->Type() != EidosValueType::kValueNULL)
+	{
+		// The memory limit is non-NULL; use the cost-driven scheduler, with the interval (if non-NULL) as the initial interval
+		if (arg_simplificationRatio_value->Type() != EidosValueType::kValueNULL)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() does not allow both simplificationRatio and simplificationMemoryLimit to be specified." << EidosTerminate();
+		
+		simplification_memory_limit_ = arg_simplificationMemoryLimit_value->FloatAtIndex(0, nullptr);
+		simplification_ratio_ = 0.0;
+		simplification_interval_ = -1;
+		
+		if (std::isnan(simplification_memory_limit_) || std::isinf(simplification_memory_limit_) || (simplification_memory_limit_ <= 0))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires simplificationMemoryLimit to be finite and > 0." << EidosTerminate();
+		
+		if (arg_simplificationInterval_value->Type() != EidosValueType::kValueNULL)
+		{
+			simplify_interval_ = arg_simplificationInterval_value->IntAtIndex(0, nullptr);
+			
+			if (simplify_interval_ <= 0)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires simplificationInterval to be > 0." << EidosTerminate();
+		}
+		else
+		{
+			simplify_interval_ = 20;
+		}
+	}
+	else if ((arg_simplificationRatio_value->Type() == EidosValueType::kValueNULL) && (arg_simplificationInterval_value->Type() == EidosValueType::kValueNULL))
 	{
 		// Both ratio and interval are NULL; use the default behavior of a ratio of 10
 		simplification_ratio_ = 10.0;
@@ -1430,6 +1471,13 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 			if (previous_params) output_stream << ", ";
 			output_stream << "runCrosschecks = " << (running_treeseq_crosschecks_ ? "T" : "F");
 			previous_params = true;
+		}
+		
+		if (simplification_memory_limit_ > 0.0)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "simplificationMemoryLimit = " << simplification_memory_limit_;
+			previous_params = true;
 			(void)previous_params;	// dead store above is deliberate
 		}
 		
@@ -1516,9 +1564,9 @@ const std::vector<EidosFunctionSignature_CSP> *SLiMSim::ZeroGenerationFunctionSi
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSex, nullptr, kEidosValueMaskVOID, "SLiM"))
 										->AddString_S("chromosomeType")->AddNumeric_OS("xDominanceCoeff", gStaticEidosValue_Float1));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSLiMOptions, nullptr, kEidosValueMaskVOID, "SLiM"))
-									   ->AddLogical_OS("keepPedigrees", gStaticEidosValue_LogicalF)->AddString_OS("dimensionality", gStaticEidosValue_StringEmpty)->AddString_OS("periodicity", gStaticEidosValue_StringEmpty)->AddInt_OS("mutationRuns", gStaticEidosValue_Integer0)->AddLogical_OS("preventIncidentalSelfing", gStaticEidosValue_LogicalF)->AddLogical_OS("nucleotideBased", gStaticEidosValue_LogicalF));
+									   ->AddLogical_OS("keepPedigrees", gStaticEidosValue_LogicalF)->AddString_OS("dimensionality", gStaticEidosValue_StringEmpty)->AddString_OS("periodicity", gStaticEidosValue_StringEmpty)->AddInt_OS("mutationRuns", gStaticEidosValue_Integer0)->AddLogical_OS("preventIncidentalSelfing", gStaticEidosValue_LogicalF)->AddLogical_OS("nucleotideBased", gStaticEidosValue_LogicalF)->AddLogical_OS("uniqueMutationRuns", gStaticEidosValue_LogicalF));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeTreeSeq, nullptr, kEidosValueMaskVOID, "SLiM"))
-									   ->AddLogical_OS("recordMutations", gStaticEidosValue_LogicalT)->AddNumeric_OSN("simplificationRatio", gStaticEidosValueNULL)->AddInt_OSN("simplificationInterval", gStaticEidosValueNULL)->AddLogical_OS("checkCoalescence", gStaticEidosValue_LogicalF)->AddLogical_OS("runCrosschecks", gStaticEidosValue_LogicalF));
+									   ->AddLogical_OS("recordMutations", gStaticEidosValue_LogicalT)->AddNumeric_OSN("simplificationRatio", gStaticEidosValueNULL)->AddInt_OSN("simplificationInterval", gStaticEidosValueNULL)->AddLogical_OS("checkCoalescence", gStaticEidosValue_LogicalF)->AddLogical_OS("runCrosschecks", gStaticEidosValue_LogicalF)->AddNumeric_OSN("simplificationMemoryLimit", gStaticEidosValueNULL));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSLiMModelType, nullptr, kEidosValueMaskVOID, "SLiM"))
 									   ->AddString_S("modelType"));
 	}
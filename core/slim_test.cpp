@@ -337,6 +337,7 @@ int RunSLiMTests(void)
 	_RunTreeSeqTests(temp_path);
 	_RunNucleotideFunctionTests();
 	_RunNucleotideMethodTests();
+	_RunParallelTests(temp_path);
 	_RunSLiMTimingTests();
 	
 	_RunInteractionTypeTests();		// many tests, time-consuming, so do this last
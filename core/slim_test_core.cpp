@@ -234,10 +234,13 @@ void _RunInitTests(void)
 	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(mutationRuns=100); stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(preventIncidentalSelfing=F); stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(preventIncidentalSelfing=T); stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(uniqueMutationRuns=F); stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(uniqueMutationRuns=T); stop(); }", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(keepPedigrees=NULL); stop(); }", 1, 15, "cannot be type NULL", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality=NULL); stop(); }", 1, 15, "cannot be type NULL", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(mutationRuns=NULL); stop(); }", 1, 15, "cannot be type NULL", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(preventIncidentalSelfing=NULL); stop(); }", 1, 15, "cannot be type NULL", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(uniqueMutationRuns=NULL); stop(); }", 1, 15, "cannot be type NULL", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='foo'); stop(); }", 1, 15, "legal non-empty values", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='y'); stop(); }", 1, 15, "legal non-empty values", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='z'); stop(); }", 1, 15, "legal non-empty values", __LINE__);
@@ -253,6 +256,18 @@ void _RunInitTests(void)
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(); initializeSLiMOptions(); stop(); }", 1, 40, "may be called only once", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeMutationRate(0.0); initializeSLiMOptions(); stop(); }", 1, 44, "must be called before", __LINE__);
 	
+	// with uniqueMutationRuns=T, mutation runs get shared by children; check that tallies, which use run refcounts, still match direct counts
+	std::string unique_mutruns_setup("initialize() { initializeSLiMOptions(mutationRuns=10, uniqueMutationRuns=T); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-4); } ");
+	std::string unique_mutruns_check("function (void)check(void) { g = sim.subpopulations.genomes; if (!identical(sim.mutationCounts(NULL), c(integer(0), sapply(sim.mutations, 'sum(g.containsMutations(applyValue));')))) stop('tally mismatch'); } ");
+	
+	SLiMAssertScriptSuccess(unique_mutruns_setup + unique_mutruns_check + "1 { sim.addSubpop('p1', 50); } early() { check(); } late() { check(); } 100 { }", __LINE__);
+	SLiMAssertScriptSuccess(nonWF_prefix + unique_mutruns_setup + unique_mutruns_check + "1 { sim.addSubpop('p1', 50); } reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); if (individual.index == 0) check(); } early() { check(); p1.fitnessScaling = 50 / p1.individualCount; } late() { check(); } 100 { }", __LINE__);
+	SLiMAssertScriptSuccess(nonWF_prefix + unique_mutruns_setup + unique_mutruns_check + "1 { sim.addSubpop('p1', 50); } reproduction() { subpop.addCloned(individual); subpop.addRecombinant(genome1, genome2, c(10000, 50000), genome2, genome1, 70000); } early() { check(); p1.fitnessScaling = 50 / p1.individualCount; } 100 { check(); }", __LINE__);
+	
+	// with more than one mutation run, genomes keep their runs in buffers from a per-subpop slab; check resizing, removal, and migration between subpops
+	SLiMAssertScriptSuccess(unique_mutruns_setup + unique_mutruns_check + "1 { sim.addSubpop('p1', 50); sim.addSubpop('p2', 20); } early() { p1.setSubpopulationSize(rdunif(1, 20, 80)); } late() { check(); } 30 { p2.setSubpopulationSize(0); } 60 { sim.addSubpopSplit('p3', 30, p1); } 100 { }", __LINE__);
+	SLiMAssertScriptSuccess(nonWF_prefix + unique_mutruns_setup + unique_mutruns_check + "1 { sim.addSubpop('p1', 50); sim.addSubpop('p2', 50); } reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } early() { p1.fitnessScaling = 50 / p1.individualCount; p2.fitnessScaling = 50 / p2.individualCount; } late() { check(); p2.takeMigrants(p1.sampleIndividuals(5)); p1.takeMigrants(p2.sampleIndividuals(5)); check(); } 100 { }", __LINE__);
+	
 	// Test (object<InteractionType>$)initializeInteractionType(is$ id, string$ spatiality, [logical$ reciprocal = F], [numeric$ maxDistance = INF], [string$ sexSegregation = "**"])
 	SLiMAssertScriptRaise("initialize() { initializeInteractionType(-1, ''); stop(); }", 1, 15, "identifier value is out of range", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeInteractionType(0, ''); stop(); }", __LINE__);
@@ -406,6 +421,12 @@ void _RunSLiMSimTests(std::string temp_path)
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p7 = 17; sim.addSubpopSplit('p7', 10, p1); stop(); }", 1, 260, "already defined", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { sim.addSubpopSplit('p7', 10, p1); sim.addSubpopSplit(7, 10, p1); stop(); }", 1, 285, "already exists", __LINE__);
 	
+	// fitness-proportional parent draws in WF models use alias tables; check that only individuals with non-zero fitness become parents, with and without sex
+	std::string parent_draw_setup("initialize() { initializeSLiMOptions(keepPedigrees=T); initializeMutationRate(1e-7); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } ");
+	std::string parent_draw_check("late() { inds = p1.individuals; if (sim.generation > 1) if (!all(match(inds.pedigreeParentIDs, sim.getValue('parents')) >= 0)) stop('parent mismatch'); parents = inds[c(0, 1, 2, 99, 100, 101)]; inds.fitnessScaling = 0.0; parents.fitnessScaling = c(1.0, 0.5, 2.0, 1.0, 3.0, 0.25); sim.setValue('parents', parents.pedigreeID); } 50 { }");
+	SLiMAssertScriptSuccess(parent_draw_setup + "1 { sim.addSubpop('p1', 200); } " + parent_draw_check, __LINE__);
+	SLiMAssertScriptSuccess(parent_draw_setup + "initialize() { initializeSex('A'); } 1 { sim.addSubpop('p1', 200); } " + parent_draw_check, __LINE__);
+	
 	// Test sim - (void)deregisterScriptBlock(io<SLiMEidosBlock> scriptBlocks)
 	SLiMAssertScriptSuccess(gen1_setup_p1 + "1 { sim.deregisterScriptBlock(s1); } s1 2 { stop(); }", __LINE__);
 	SLiMAssertScriptSuccess(gen1_setup_p1 + "1 { sim.deregisterScriptBlock(1); } s1 2 { stop(); }", __LINE__);
@@ -433,6 +454,17 @@ void _RunSLiMSimTests(std::string temp_path)
 	SLiMAssertScriptSuccess(gen1_setup_p1p2p3 + "1 { sim.mutationCounts(object()); }", __LINE__);												// legal to specify an empty object vector
 	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "1 { sim.mutationCounts(1); }", 1, 301, "cannot be type integer", __LINE__);						// this is one API where integer identifiers can't be used
 	
+	// tallies over subsets of the population, or at points where mutation run refcounts can't be used, count each unique mutation run once; check them against direct counts
+	std::string tally_setup("initialize() { initializeSLiMOptions(mutationRuns=4); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-6); initializeSex('X'); } 1 { sim.addSubpop('p1', 30); sim.addSubpop('p2', 30); sim.addSubpop('p3', 30); p1.setMigrationRates(p2, 0.1); p3.setMigrationRates(p1, 0.1); } ");
+	std::string tally_check("function (i)direct(o<Genome> g) { g = g[!g.isNullGenome]; return c(integer(0), sapply(sim.mutations, 'sum(g.containsMutations(applyValue));')); } function (void)check(void) { if (!identical(sim.mutationCounts(p1), direct(p1.genomes))) stop('p1 mismatch'); if (!identical(sim.mutationCounts(c(p1, p3)), direct(c(p1.genomes, p3.genomes)))) stop('p1 p3 mismatch'); if (!identical(sim.mutationCounts(NULL), direct(sim.subpopulations.genomes))) stop('total mismatch'); g = p2.genomes[!p2.genomes.isNullGenome]; if (!identical(g.mutationCountsInGenomes(), direct(g))) stop('genome mismatch'); } ");
+	
+	SLiMAssertScriptSuccess(tally_setup + tally_check + "early() { check(); } late() { check(); } 50 { }", __LINE__);
+	
+	// repeated tallies are memoized within a generation; check that changes to genomes invalidate the memo, and that shared results are not modified
+	SLiMAssertScriptSuccess(tally_setup + tally_check + "late() { check(); g = p1.genomes[!p1.genomes.isNullGenome]; g[0:4].addNewMutation(m1, 0.0, 500); check(); g[0].removeMutations(g[0].mutations); check(); } 20 { }", __LINE__);
+	SLiMAssertScriptSuccess(nonWF_prefix + gen1_setup_highmut_p1 + "1 { sim.addSubpop('p2', 10); } reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } early() { p1.fitnessScaling = 10 / p1.individualCount; p2.fitnessScaling = 10 / p2.individualCount; } late() { g = p1.genomes; c = sim.mutationCounts(p1); p2.takeMigrants(p1.sampleIndividuals(3)); g = p1.genomes; if (!identical(sim.mutationCounts(p1), c(integer(0), sapply(sim.mutations, 'sum(g.containsMutations(applyValue));')))) stop('tally mismatch'); } 20 { }", __LINE__);
+	SLiMAssertScriptSuccess(tally_setup + "late() { f = sim.mutationFrequencies(NULL); x = sim.mutationFrequencies(NULL); x[0] = 5.0; if (!identical(f, sim.mutationFrequencies(NULL))) stop('modified'); c = sim.mutationCounts(p1); y = sim.mutationCounts(p1); y[0] = -1; if (!identical(c, sim.mutationCounts(p1))) stop('modified'); } 20 { }", __LINE__);
+	
 	// Test sim - (object<Mutation>)mutationsOfType(io<MutationType>$ mutType)
 	SLiMAssertScriptSuccess(gen1_setup_p1 + "10 { sim.mutationsOfType(m1); } ", __LINE__);
 	SLiMAssertScriptSuccess(gen1_setup_p1 + "10 { sim.mutationsOfType(1); } ", __LINE__);
@@ -489,6 +521,13 @@ void _RunSLiMSimTests(std::string temp_path)
 		SLiMAssertScriptRaise(gen1_setup + "1 { sim.readFromPopulationFile('" + temp_path + "/notAFile.foo'); }", 1, 220, "does not exist or is empty", __LINE__);
 		SLiMAssertScriptSuccess(gen1_setup_p1 + "1 { sim.readFromPopulationFile('" + temp_path + "/slimOutputFullTest.txt'); if (size(sim.subpopulations) != 3) stop(); }", __LINE__);			// legal; should wipe previous state
 		SLiMAssertScriptSuccess(gen1_setup_p1 + "1 { sim.readFromPopulationFile('" + temp_path + "/slimOutputFullTest.slimbinary'); if (size(sim.subpopulations) != 3) stop(); }", __LINE__);	// legal; should wipe previous state
+		
+		// binary round trips; the second script reads into a different mutation run layout, exercising the redistribution of mutations into runs
+		std::string genome_contents("sapply(p1.genomes, 'paste(applyValue.mutations.id);')");
+		
+		SLiMAssertScriptSuccess(gen1_setup_highmut_p1 + "5 late() { g = " + genome_contents + "; f = sim.mutationFrequencies(p1)[order(sim.mutations.id)]; sim.outputFull('" + temp_path + "/slimRoundTripTest.slimbinary', T); sim.outputFull('" + temp_path + "/slimRoundTripTest.txt'); sim.readFromPopulationFile('" + temp_path + "/slimRoundTripTest.slimbinary'); if (!identical(g, " + genome_contents + ")) stop(); if (!identical(f, sim.mutationFrequencies(p1)[order(sim.mutations.id)])) stop(); }", __LINE__);
+		SLiMAssertScriptSuccess("initialize() { initializeSLiMOptions(mutationRuns=7); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.readFromPopulationFile('" + temp_path + "/slimRoundTripTest.slimbinary'); sim.outputFull('" + temp_path + "/slimRoundTripTest2.txt'); a = readFile('" + temp_path + "/slimRoundTripTest.txt'); b = readFile('" + temp_path + "/slimRoundTripTest2.txt'); if (!identical(a[1:(size(a)-1)], b[1:(size(b)-1)])) stop(); }", __LINE__);
+		SLiMAssertScriptSuccess("initialize() { initializeSLiMModelType('nonWF'); initializeSLiMOptions(keepPedigrees=T, dimensionality='xyz'); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } 1 { sim.addSubpop('p1', 10); } early() { p1.fitnessScaling = 10 / p1.individualCount; } 5 late() { p1.individuals.x = runif(p1.individualCount); p1.individuals.z = runif(p1.individualCount); i = p1.individuals; v = c(i.x, i.y, i.z, i.age, i.pedigreeID); g = " + genome_contents + "; sim.outputFull('" + temp_path + "/slimRoundTripTest3.slimbinary', T, pedigreeIDs=T); sim.readFromPopulationFile('" + temp_path + "/slimRoundTripTest3.slimbinary'); i = p1.individuals; if (!identical(v, c(i.x, i.y, i.z, i.age, i.pedigreeID))) stop(); if (!identical(g, " + genome_contents + ")) stop(); }", __LINE__);
 	}
 	
 	// Test sim - (object<SLiMEidosBlock>)registerEarlyEvent(Nis$ id, string$ source, [integer$ start], [integer$ end])
@@ -1641,6 +1680,8 @@ void _RunIndividualTests(void)
 	SLiMAssertScriptRaise(gen1_setup_i1xyz + "1 { i = p1.individuals; i.setSpatialPosition(c(0.5, 0.6, 0.7, 0.8)); }", 1, 507, "position parameter to contain", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyz + "1 { i = p1.individuals; i.setSpatialPosition(1.0:30); if (identical(i.spatialPosition, 1.0:30)) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyz + "1 { i = p1.individuals; i.setSpatialPosition(1.0:30); if (identical(i.z, (1.0:10)*3)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz + "1 { i = p1.individuals; i.setSpatialPosition(runif(30)); s = sample(i, 25, replace=T); p = float(0); for (ind in s) p = c(p, ind.spatialPosition); if (identical(s.spatialPosition, p) & identical(i[integer(0)].spatialPosition, float(0))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i = p1.individuals; i.setSpatialPosition(runif(10)); s = sample(i, 25, replace=T); if (identical(s.spatialPosition, s.x)) stop(); }", __LINE__);
 	
 	// Some specific testing for setting of accelerated properties
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { i = p1.individuals; i.tag = (seqAlong(i) % 2 == 0); if (all(i.tag == (seqAlong(i) % 2 == 0))) stop(); }", __LINE__);
@@ -1791,6 +1832,15 @@ void _RunSLiMEidosBlockTests(void)
 	
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitness(m1) { mut; homozygous; individual; genome1; genome2; subpop; return relFitness; } 100 { stop(); }", __LINE__);
 	
+	// fitness() callbacks that are simple enough to be compiled to bytecode; their results should match the interpreter's, and errors should still be raised by it
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitness(NULL) { x = individual.index; if (x % 2 == 0) return 1.5; else return exp(-0.5 * (x - 3) ^ 2) + abs(-0.25); } 2 early() { x = 0:9; e = ifelse(x % 2 == 0, 1.5, exp(-0.5 * (x - 3) ^ 2) + 0.25); if (all(abs(p1.cachedFitness(NULL) - e) < 1e-12)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitness(NULL, p1) { i = individual.index; return (i < 5 & i != 2) ? 1.0 + dnorm(i * 0.5, 1.0) else sqrt(i) / log(10.0); } 2 early() { i = 0:9; e = ifelse(i < 5 & i != 2, 1.0 + dnorm(i * 0.5, 1.0), sqrt(i) / log(10.0)); if (all(abs(p1.cachedFitness(NULL) - e) < 1e-12)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitness(m1) { h = mut.mutationType.dominanceCoeff; if (homozygous) return relFitness; return relFitness * (h == 0.5 ? 1.0 else 0.0); } 100 { stop(); }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitness(NULL) { return individual.index; } 100 { ; }", 1, 293, "return value", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitness(NULL) { return 1.0 + (individual.index + 9223372036854775807) * 0.0; } 100 { ; }", 1, 340, "overflow", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitness(NULL) { return relFitness * undefinedSymbol; } 100 { ; }", 1, 329, "undefined identifier", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitness(m1) { h = mut.mutationType.dominanceCoeff; return relFitness * h * undefinedSymbol; } 10000 { ; }", 1, 368, "undefined identifier", __LINE__);
+	
 	// mateChoice() callbacks
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "mateChoice() { return weights; } 10 { stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "mateChoice() { stop(); } 10 { ; }", __LINE__);
@@ -1861,6 +1911,17 @@ void _RunSLiMEidosBlockTests(void)
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "recombination(p1) { return T; } 10 { stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "recombination(p1) { stop(); } 10 { ; }", __LINE__);
 	
+	// breakpoints arrive sorted and uniqued, whether a gamete draws a few breakpoints or many, with one map or sex-specific maps
+	std::string recombination_sorted_check("1 { sim.addSubpop('p1', 100); } recombination() { if (!identical(breakpoints, unique(sort(breakpoints)))) stop('unsorted breakpoints'); return F; } 10 { }");
+	SLiMAssertScriptSuccess("initialize() { initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(c(1e-5, 1e-4), c(49999, 99999)); } " + recombination_sorted_check, __LINE__);
+	SLiMAssertScriptSuccess("initialize() { initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(c(1e-4, 5e-4), c(49999, 99999)); } " + recombination_sorted_check, __LINE__);
+	SLiMAssertScriptSuccess("initialize() { initializeSex('A'); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(5e-5, 99999, sex='M'); initializeRecombinationRate(c(1e-4, 1e-6), c(49999, 99999), sex='F'); } " + recombination_sorted_check, __LINE__);
+	
+	// children inherit exactly the parental segments between breakpoints, with several breakpoints inside one mutation run, in WF and nonWF models
+	std::string crossed_function("function (o<Mutation>)crossed(o<Genome>$ a, o<Genome>$ b, i bp) { starts = c(0, bp); ends = c(bp, 100000); strands = c(a, b); m = NULL; for (i in seqAlong(ends)) { s = strands[i % 2].mutations; m = c(m, s[s.position >= starts[i] & s.position < ends[i]]); } return m; } ");
+	SLiMAssertScriptSuccess("initialize() { initializeSLiMOptions(mutationRuns=4); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-5); } " + crossed_function + "1 { sim.addSubpop('p1', 100); } 20 early() { sim.chromosome.setMutationRate(0.0); } 21 recombination() { breakpoints = c(1000, 2000, 30000, 30500, 60000, 99000); return T; } 21 modifyChild() { if (size(parent1Genome1.mutations) + size(parent1Genome2.mutations) == 0) stop('no mutations'); ids = sort(childGenome1.mutations.id); bp = c(1000, 2000, 30000, 30500, 60000, 99000); if (!identical(ids, sort(crossed(parent1Genome1, parent1Genome2, bp).id)) & !identical(ids, sort(crossed(parent1Genome2, parent1Genome1, bp).id))) stop('mismatch'); return T; } 22 { }", __LINE__);
+	SLiMAssertScriptSuccess("initialize() { initializeSLiMModelType('nonWF'); initializeSLiMOptions(mutationRuns=4); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-5); } " + crossed_function + "1 { sim.addSubpop('p1', 100); } 19 late() { sim.chromosome.setMutationRate(0.0); } reproduction() { other = p1.sampleIndividuals(1); if (sim.generation < 20) { subpop.addCrossed(individual, other); return; } bp = sort(unique(sample(0:99999, 8))); child = subpop.addRecombinant(individual.genome1, other.genome2, bp, NULL, NULL, NULL); if (!identical(sort(child.genome1.mutations.id), sort(crossed(individual.genome1, other.genome2, bp).id))) stop('mismatch'); } early() { p1.fitnessScaling = 100 / p1.individualCount; } 20 late() { if (size(sim.mutations) == 0) stop('no mutations'); }", __LINE__);
+	
 	SLiMAssertScriptSuccess(gen1_setup_p1p2p3 + "recombination(p4) { stop(); } 10 { ; }", __LINE__);
 	
 	SLiMAssertScriptSuccess(gen1_setup_p1p2p3 + "early() { s1.active = 0; } s1 recombination(p1) { stop(); } 10 { ; }", __LINE__);
@@ -1924,6 +1985,10 @@ void _RunSLiMEidosBlockTests(void)
 	
 	SLiMAssertScriptStop(gen1_setup_p1p2p3_i1 + "interaction(i1) { distance; strength; receiver; exerter; subpop; return 1.0; } 10 { stop(); }", __LINE__);
 	
+	// interaction() callbacks compiled to bytecode
+	SLiMAssertScriptStop(gen1_setup_p1p2p3_i1 + "interaction(i1) { return (receiver.index == exerter.index) ? 0.0 else strength * 2.0; } 10 { stop(); }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3_i1 + "interaction(i1) { return strength - 2.0; } 10 { ; }", 1, 409, "finite value >= 0.0", __LINE__);
+	
 	// reproduction() callbacks
 	static std::string gen1_setup_p1p2p3_nonWF(nonWF_prefix + gen1_setup_sex_p1 + "1 { sim.addSubpop('p2', 10); sim.addSubpop('p3', 10); } " + "late() { sim.subpopulations.individuals.fitnessScaling = 0.0; } ");
 	
@@ -939,6 +939,14 @@ void _RunGenomeTests(std::string temp_path)
 		SLiMAssertScriptStop(gen1_setup_sex_p1 + "10 late() { sample(p1.individuals, 0, T).genomes.outputVCF('" + temp_path + "/slimOutputVCFTest7.txt', F); stop(); }", __LINE__);
 		SLiMAssertScriptStop(gen1_setup_sex_p1 + "10 late() { sample(p1.individuals, 100, T).genomes.outputVCF('" + temp_path + "/slimOutputVCFTest8.txt', F); stop(); }", __LINE__);
 	}
+	
+	// Test that the genotype calls in VCF output match the genomes, with enough genomes for several row blocks in the genotype matrix, and mutations common enough for both sparse and dense blocks
+	if (Eidos_SlashTmpExists())
+	{
+		std::string vcf_calls_check("g = p1.genomes; for (line in readFile('" + temp_path + "/slimOutputVCFTest9.txt')) { if (substr(line, 0, 0) == '#') next; fields = strsplit(line, '\t'); mut = sim.mutations[sim.mutations.id == asInteger(substr(strsplit(fields[7], ';')[0], 4))]; calls = fields[9:(size(fields) - 1)]; if (!identical(substr(calls, 0, 0) == '1', g[seq(0, 599, by=2)].containsMutations(mut)) | !identical(substr(calls, 2, 2) == '1', g[seq(1, 599, by=2)].containsMutations(mut))) stop('mismatched call'); } ");
+		
+		SLiMAssertScriptStop(gen1_setup + "1 { sim.addSubpop('p1', 300); } 1 late() { g = p1.genomes; sample(g, 400).addNewMutation(m1, 0.0, 10); sample(g, 40).addNewMutation(m1, 0.0, 20); sample(g, 3).addNewMutation(m1, 0.0, 30); g[590:599].addNewMutation(m1, 0.0, 40); g.outputVCF('" + temp_path + "/slimOutputVCFTest9.txt'); " + vcf_calls_check + "stop(); }", __LINE__);
+	}
 }
 
 
@@ -56,6 +56,23 @@ void _RunInteractionTypeTests(void)
 	SLiMAssertScriptRaise(gen1_setup_i1x + "1 { c(i1,i1).tag; }", 1, 430, "before being set", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i1.tag = 17; } 2 { if (i1.tag == 17) stop(); }", __LINE__);
 	
+	// Test the uniform grid spatial index, used when the maximum distance is small relative to the spatial extent, against brute-force distances
+	std::string grid_check("1 { sim.addSubpop('p1', 2000); p1.individuals.setSpatialPosition(p1.pointUniform(2000)); i1.evaluate(); inds = p1.individuals; ok = T; for (ind in inds[0:19]) { d = i1.distance(ind, inds); expected = inds[(d <= i1.maxDistance) & (inds.index != ind.index)]; ok = ok & (i1.interactingNeighborCount(ind) == size(expected)); ok = ok & identical(sort(i1.nearestNeighbors(ind, 2000).index), sort(expected.index)); nn = i1.nearestNeighbors(ind, 3); ok = ok & (size(nn) == min(3, size(expected))); if (size(nn)) ok = ok & identical(d[nn.index], sort(d[expected.index])[seqLen(size(nn))]); } if (ok) stop(); }");
+	std::string grid_genetics(" initializeMutationRate(0); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99); initializeRecombinationRate(0); } ");
+	
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(1, 'x', maxDistance=0.005);" + grid_genetics + grid_check, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy'); initializeInteractionType(1, 'xy', maxDistance=0.03);" + grid_genetics + grid_check, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xyz'); initializeInteractionType(1, 'xyz', maxDistance=0.1);" + grid_genetics + grid_check, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy', periodicity='xy'); initializeInteractionType(1, 'xy', maxDistance=0.03);" + grid_genetics + grid_check, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xyz', periodicity='z'); initializeInteractionType(1, 'xz', maxDistance=0.05);" + grid_genetics + grid_check, __LINE__);
+	
+	// Test incremental evaluation, which repairs the k-d tree from the previous evaluation, against brute-force distances in a nonWF model with births, deaths, and movement
+	std::string incremental_check("reproduction() { if (runif(1) < 0.2) { o = subpop.addCloned(individual); o.setSpatialPosition(p1.pointReflected(individual.spatialPosition + rnorm(size(individual.spatialPosition), 0, 0.02))); } } 1 early() { sim.addSubpop('p1', 1000); p1.individuals.setSpatialPosition(p1.pointUniform(1000)); } early() { inds = p1.individuals; inds.setSpatialPosition(p1.pointReflected(inds.spatialPosition + rnorm(size(inds.spatialPosition), 0, 0.01))); p1.fitnessScaling = 1000 / size(inds); i1.evaluate(incremental=T); for (ind in sample(inds, 10)) { d = i1.distance(ind, inds); expected = inds[(d <= i1.maxDistance) & (inds.index != ind.index)]; if (i1.interactingNeighborCount(ind) != size(expected)) stop('count mismatch'); if (!identical(sort(i1.nearestNeighbors(ind, 2000).index), sort(expected.index))) stop('neighbor mismatch'); nn = i1.nearestNeighbors(ind, 3); if (size(nn)) if (!identical(sort(d[nn.index]), sort(d[expected.index])[seqLen(size(nn))])) stop('nearest mismatch'); } } 10 late() { }");
+	
+	SLiMAssertScriptSuccess("initialize() { initializeSLiMModelType('nonWF'); initializeSLiMOptions(dimensionality='x'); initializeInteractionType(1, 'x', maxDistance=0.2);" + grid_genetics + incremental_check, __LINE__);
+	SLiMAssertScriptSuccess("initialize() { initializeSLiMModelType('nonWF'); initializeSLiMOptions(dimensionality='xy'); initializeInteractionType(1, 'xy', maxDistance=0.3);" + grid_genetics + incremental_check, __LINE__);
+	SLiMAssertScriptSuccess("initialize() { initializeSLiMModelType('nonWF'); initializeSLiMOptions(dimensionality='xyz'); initializeInteractionType(1, 'xyz', maxDistance=0.4);" + grid_genetics + incremental_check, __LINE__);
+	
 	// Run tests in a variety of combinations
 	_RunInteractionTypeTests_Nonspatial(false, false, false, "**");
 	_RunInteractionTypeTests_Nonspatial(true, false, false, "**");
@@ -962,6 +979,13 @@ void _RunTreeSeqTests(std::string temp_path)
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=T, simplificationRatio=INF, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=F, simplificationRatio=0.0, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=T, simplificationRatio=0.0, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationMemoryLimit=1e8); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(checkCoalescence=T, runCrosschecks=T, simplificationMemoryLimit=1e3); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationInterval=5, simplificationMemoryLimit=50000); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(simplificationRatio=10.0, simplificationMemoryLimit=1e8); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "does not allow both", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(simplificationMemoryLimit=0); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "to be finite and > 0", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(simplificationMemoryLimit=INF); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "to be finite and > 0", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(simplificationInterval=0, simplificationMemoryLimit=1e8); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "simplificationInterval to be > 0", __LINE__);
 	
 	// treeSeqCoalesced()
 	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1: { sim.treeSeqCoalesced(); } 100 { stop(); }", 1, 290, "coalescence checking is enabled", __LINE__);
@@ -987,6 +1011,20 @@ void _RunTreeSeqTests(std::string temp_path)
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_2.trees', simplify=T, includeModel=F, _binary=F); stop(); }", __LINE__);
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_3.trees', simplify=F, includeModel=F, _binary=T); stop(); }", __LINE__);
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_4.trees', simplify=T, includeModel=F, _binary=T); stop(); }", __LINE__);
+		
+		// binary output is written straight from the recorded tables; it should read back, and leave the tables as they were for later output
+		SLiMAssertScriptStop("initialize() { initializeSLiMOptions(keepPedigrees=T); initializeTreeSeq(); } " + gen1_setup_p1 + "50 { sim.treeSeqRememberIndividuals(p1.individuals[0:4]); } 100 late() { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_5.trees', simplify=F); sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_6.trees'); ids = p1.individuals.pedigreeID; muts = sort(sim.mutations.id); sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_6.trees'); if (identical(p1.individuals.pedigreeID, ids) & identical(sort(sim.mutations.id), muts)) stop(); }", __LINE__);
+		SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/no_such_directory/SLiM_treeSeq_7.trees'); }", 1, 291, "could not write", __LINE__);
+		
+		// new edges are buffered and merged into the edge table at simplification and output; exercise the buffer with crosschecks on,
+		// through retracted children, parents that gain edges after their old ones were simplified, and output or input between simplifications
+		std::string treeseq_buffer_setup("initialize() { initializeSLiMOptions(keepPedigrees=T); initializeTreeSeq(simplificationInterval=5, runCrosschecks=T); } ");
+		std::string treeseq_readback("function (void)readback(s$ path) { ids = p1.individuals.pedigreeID; muts = sort(sim.mutations.id); sim.treeSeqOutput(path); sim.readFromPopulationFile(path); if (!identical(p1.individuals.pedigreeID, ids)) stop('pedigree mismatch'); if (!identical(sort(sim.mutations.id), muts)) stop('mutation mismatch'); } ");
+		
+		SLiMAssertScriptSuccess(treeseq_buffer_setup + gen1_setup_highmut_p1 + treeseq_readback + "modifyChild() { return (runif(1) < 0.7); } 20 late() { readback('" + temp_path + "/SLiM_treeSeq_8.trees'); }", __LINE__);
+		SLiMAssertScriptSuccess(nonWF_prefix + treeseq_buffer_setup + gen1_setup_highmut_p1 + treeseq_readback + "reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } early() { inds = p1.individuals; young = inds[inds.age < sim.generation - 1]; young.fitnessScaling = 10 / size(young); } 30 late() { if (sum(p1.individuals.age == 29) != 10) stop('founders lost'); readback('" + temp_path + "/SLiM_treeSeq_9.trees'); }", __LINE__);
+		SLiMAssertScriptSuccess(treeseq_buffer_setup + gen1_setup_highmut_p1 + treeseq_readback + "12 late() { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_10.trees', simplify=F); } 20 late() { readback('" + temp_path + "/SLiM_treeSeq_11.trees'); }", __LINE__);
+		SLiMAssertScriptSuccess(treeseq_buffer_setup + gen1_setup_highmut_p1 + treeseq_readback + "12 late() { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_12.trees'); } 14 late() { if (isNULL(sim.getValue('loaded'))) { sim.setValue('loaded', T); sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_12.trees'); } } 30 late() { readback('" + temp_path + "/SLiM_treeSeq_13.trees'); }", __LINE__);
 	}
 }
 
@@ -1590,3 +1628,89 @@ void _RunNucleotideMethodTests(void)
 
 
 
+
+#pragma mark multithreading tests
+void _RunParallelTests(std::string temp_path)
+{
+	// These tests exercise the multithreaded offspring generation path, EvolveSubpopulation_Parallel(), which is used only when
+	// gEidosMaxThreads > 1; when built without OpenMP, the same chunked code path runs on the main thread.
+	int saved_max_threads = gEidosMaxThreads;
+	
+	gEidosMaxThreads = 4;
+	
+	std::string parallel_genetics("initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeMutationType('m2', 0.5, 'g', -0.05, 0.5); initializeMutationType('m3', 0.5, 'e', 0.05); initializeGenomicElementType('g1', c(m1, m2, m3), c(0.8, 0.15, 0.05)); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-5); } ");
+	std::string parallel_setup("initialize() { initializeSLiMOptions(keepPedigrees=T); " + parallel_genetics);
+	std::string parallel_check("50 late() { muts = unique(sim.subpopulations.genomes.mutations); if ((size(muts) > 0) & all(match(muts, sim.mutations) >= 0) & all(sim.mutationFrequencies(NULL, muts) > 0) & all(sim.subpopulations.individuals.pedigreeParentIDs >= 0)) stop(); } ");
+	
+	SLiMAssertScriptStop(parallel_setup + "1 { sim.addSubpop('p1', 1000); } " + parallel_check, __LINE__);
+	SLiMAssertScriptStop(parallel_setup + "1 { sim.addSubpop('p1', 1000); p1.setSelfingRate(0.3); p1.setCloningRate(0.2); } " + parallel_check, __LINE__);
+	SLiMAssertScriptStop(parallel_setup + "1 { sim.addSubpop('p1', 700); sim.addSubpop('p2', 300); p1.setMigrationRates(p2, 0.2); p2.setMigrationRates(p1, 0.5); } " + parallel_check, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(keepPedigrees=T); initializeSex('A'); " + parallel_genetics + "1 { sim.addSubpop('p1', 1000, sexRatio=0.4); p1.setCloningRate(c(0.1, 0.3)); } " + parallel_check, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(keepPedigrees=T, mutationRuns=7); " + parallel_genetics + "1 { sim.addSubpop('p1', 1000); } " + parallel_check, __LINE__);
+	SLiMAssertScriptStop(parallel_setup + "1 { m1.mutationStackPolicy = 'f'; m2.mutationStackPolicy = 'l'; sim.addSubpop('p1', 1000); } " + parallel_check, __LINE__);
+	
+	// tree-sequence recording and callbacks fall back to the single-threaded code path
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(keepPedigrees=T); initializeTreeSeq(); " + parallel_genetics + "1 { sim.addSubpop('p1', 1000); } " + parallel_check, __LINE__);
+	SLiMAssertScriptStop(parallel_setup + "1 { sim.addSubpop('p1', 1000); } 20:30 modifyChild() { return T; } " + parallel_check, __LINE__);
+	
+	// results depend upon the seed, but not upon the number of threads
+	if (Eidos_SlashTmpExists())
+	{
+		// mutation and pedigree ids are not reset between runs, so we compare positions, selection coefficients, frequencies, and genomes
+		std::string parallel_summary("c(paste(sim.mutations.position), paste(sim.mutations.selectionCoeff), paste(sim.mutationFrequencies(NULL)), paste(p1.genomes.countOfMutationsOfType(m1)))");
+		std::string parallel_repro(parallel_setup + "1 { setSeed(12); sim.addSubpop('p1', 1000); p1.setSelfingRate(0.1); } 50 late() { writeFile('" + temp_path + "/SLiM_parallel_");
+		
+		gEidosMaxThreads = 4;
+		SLiMAssertScriptSuccess(parallel_repro + "1.txt', " + parallel_summary + "); }", __LINE__);
+		gEidosMaxThreads = 3;
+		SLiMAssertScriptSuccess(parallel_repro + "2.txt', " + parallel_summary + "); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup + "1 { if (identical(readFile('" + temp_path + "/SLiM_parallel_1.txt'), readFile('" + temp_path + "/SLiM_parallel_2.txt'))) stop(); }", __LINE__);
+		
+		// multithreaded fitness calculation, UpdateFitness_Parallel(), gives exactly the same results as the single-threaded code; the modifyChild()
+		// callback keeps offspring generation single-threaded, so the whole run should match, including with constant fitness() callbacks
+		std::string fitness_repro("initialize() { initializeSex('A'); " + parallel_genetics + "1 { setSeed(5); sim.addSubpop('p1', 2000); } modifyChild() { return T; } ");
+		std::string fitness_summary("c(paste(p1.cachedFitness(NULL)), paste(sim.mutations.position))");
+		
+		for (std::string fitness_callbacks : {"", "fitness(m3) { return 1.1; } fitness(NULL) { return 0.9; } ", "fitness(m2) { return 1.0; } fitness(m3) { return 1.0 / relFitness; } "})
+		{
+			gEidosMaxThreads = 1;
+			SLiMAssertScriptSuccess(fitness_repro + fitness_callbacks + "30 { writeFile('" + temp_path + "/SLiM_parallel_3.txt', " + fitness_summary + "); }", __LINE__);
+			gEidosMaxThreads = 4;
+			SLiMAssertScriptSuccess(fitness_repro + fitness_callbacks + "30 { writeFile('" + temp_path + "/SLiM_parallel_4.txt', " + fitness_summary + "); }", __LINE__);
+			SLiMAssertScriptStop(gen1_setup + "1 { if (identical(readFile('" + temp_path + "/SLiM_parallel_3.txt'), readFile('" + temp_path + "/SLiM_parallel_4.txt'))) stop(); }", __LINE__);
+		}
+		
+		// multithreaded k-d tree and sparse array building, for spatial interactions, also gives exactly the same results as the single-threaded code
+		std::string interaction_summary("c(paste(i1.totalOfNeighborStrengths(p1.individuals)), paste(i1.interactingNeighborCount(p1.individuals)), paste(i1.nearestNeighbors(p1.individuals[7], 5).index), paste(i1.strength(p1.individuals[17])))");
+		
+		for (std::string interaction_config : {"initializeSLiMOptions(dimensionality='x'); initializeSex('A'); initializeInteractionType(1, 'x', maxDistance=0.01);",
+			"initializeSLiMOptions(dimensionality='xy'); initializeSex('A'); initializeInteractionType(1, 'xy', maxDistance=0.05);",
+			"initializeSLiMOptions(dimensionality='xyz'); initializeSex('A'); initializeInteractionType(1, 'xyz', maxDistance=0.1);",
+			"initializeSLiMOptions(dimensionality='xy', periodicity='xy'); initializeSex('A'); initializeInteractionType(1, 'xy', maxDistance=0.05);",
+			"initializeSLiMOptions(dimensionality='xyz', periodicity='z'); initializeSex('A'); initializeInteractionType(1, 'xz', maxDistance=0.05, sexSegregation='FM');"})
+		{
+			std::string interaction_repro("initialize() { " + interaction_config + " i1.setInteractionFunction('n', 1.0, 0.02); initializeMutationRate(0); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99); initializeRecombinationRate(0); } 1 { setSeed(3); sim.addSubpop('p1', 2000); p1.individuals.setSpatialPosition(p1.pointUniform(2000)); i1.evaluate(); ");
+			
+			gEidosMaxThreads = 1;
+			SLiMAssertScriptSuccess(interaction_repro + "writeFile('" + temp_path + "/SLiM_parallel_5.txt', " + interaction_summary + "); }", __LINE__);
+			gEidosMaxThreads = 4;
+			SLiMAssertScriptSuccess(interaction_repro + "writeFile('" + temp_path + "/SLiM_parallel_6.txt', " + interaction_summary + "); }", __LINE__);
+			SLiMAssertScriptStop(gen1_setup + "1 { if (identical(readFile('" + temp_path + "/SLiM_parallel_5.txt'), readFile('" + temp_path + "/SLiM_parallel_6.txt'))) stop(); }", __LINE__);
+		}
+		
+		// multithreaded sorting of tree-sequence tables, SortTreeSequenceTables(), gives exactly the same tables as the single-threaded sort; the
+		// crosschecks sort full copies of the tables, edges included, whereas output sorts only the sites and mutations.  Mutation ids are not
+		// reset between runs, so we compare only the first five columns of the mutation table (id, site, node, parent, time), not derived states
+		std::string treeseq_repro("initialize() { initializeTreeSeq(simplificationRatio=INF, runCrosschecks=T); " + parallel_genetics + "1 { setSeed(7); sim.addSubpop('p1', 1000); } 10 late() { sim.treeSeqOutput('" + temp_path + "/SLiM_parallel_");
+		std::string treeseq_columns("sapply(readFile(path), \"fields = strsplit(applyValue, '\\t'); paste(fields[0:min(4, size(fields) - 1)]);\")");
+		std::string treeseq_compare("function (s)columns(s path) { return " + treeseq_columns + "; } 1 { for (table in c('EdgeTable', 'SiteTable', 'MutationTable')) if (!identical(columns('" + temp_path + "/SLiM_parallel_7/' + table + '.txt'), columns('" + temp_path + "/SLiM_parallel_8/' + table + '.txt'))) return; stop(); }");
+		
+		gEidosMaxThreads = 1;
+		SLiMAssertScriptSuccess(treeseq_repro + "7', simplify=F, _binary=F); }", __LINE__);
+		gEidosMaxThreads = 4;
+		SLiMAssertScriptSuccess(treeseq_repro + "8', simplify=F, _binary=F); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup + treeseq_compare, __LINE__);
+	}
+	
+	gEidosMaxThreads = saved_max_threads;
+}
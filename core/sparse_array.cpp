@@ -35,9 +35,11 @@ SparseArray::SparseArray(unsigned int p_nrows, unsigned int p_ncols)
 	
 	nrows_ = p_nrows;
 	ncols_ = p_ncols;
+	first_row_ = 0;
 	nrows_set_ = 0;
 	nnz_ = 0;
 	nnz_capacity_ = 1024;
+	chunk_count_ = 0;
 	
 	row_offsets_ = (uint32_t *)malloc((nrows_ + 1) * sizeof(uint32_t));
 	columns_ = (uint32_t *)malloc(nnz_capacity_ * sizeof(uint32_t));
@@ -68,15 +70,22 @@ SparseArray::~SparseArray(void)
 	
 	free(strengths_);
 	strengths_ = nullptr;
+	
+	for (SparseArray *chunk : chunks_)
+		delete chunk;
+	chunks_.clear();
+	chunk_count_ = 0;
 }
 
 void SparseArray::Reset(void)
 {
 	nrows_ = 0;
 	ncols_ = 0;
+	first_row_ = 0;
 	nrows_set_ = 0;
 	nnz_ = 0;
 	finished_ = false;
+	chunk_count_ = 0;
 }
 
 void SparseArray::Reset(unsigned int p_nrows, unsigned int p_ncols)
@@ -86,6 +95,7 @@ void SparseArray::Reset(unsigned int p_nrows, unsigned int p_ncols)
 	
 	nrows_ = p_nrows;
 	ncols_ = p_ncols;
+	first_row_ = 0;
 	nrows_set_ = 0;
 	nnz_ = 0;
 	
@@ -93,6 +103,7 @@ void SparseArray::Reset(unsigned int p_nrows, unsigned int p_ncols)
 	
 	row_offsets_[nrows_set_] = 0;
 	finished_ = false;
+	chunk_count_ = 0;
 }
 
 void SparseArray::_ResizeToFitNNZ(void)
@@ -112,6 +123,8 @@ void SparseArray::_ResizeToFitNNZ(void)
 // BCH 6/6/2020: Note this method is not called from anywhere
 void SparseArray::AddRowDistances(uint32_t p_row, const uint32_t *p_columns, const sa_distance_t *p_distances, uint32_t p_row_nnz)
 {
+	p_row -= first_row_;
+	
 	// ensure that we are building sequentially, visiting each row exactly once
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): adding row to sparse array that is finished." << EidosTerminate(nullptr);
@@ -136,6 +149,8 @@ void SparseArray::AddRowDistances(uint32_t p_row, const uint32_t *p_columns, con
 
 void SparseArray::AddRowInteractions(uint32_t p_row, const uint32_t *p_columns, const sa_distance_t *p_distances, const sa_strength_t *p_strengths, uint32_t p_row_nnz)
 {
+	p_row -= first_row_;
+	
 	// ensure that we are building sequentially, visiting each row exactly once
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): adding row to sparse array that is finished." << EidosTerminate(nullptr);
@@ -161,6 +176,8 @@ void SparseArray::AddRowInteractions(uint32_t p_row, const uint32_t *p_columns,
 
 void SparseArray::AddEntryInteraction(uint32_t p_row, uint32_t p_column, sa_distance_t p_distance, sa_strength_t p_strength)
 {
+	p_row -= first_row_;
+	
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryInteraction): adding entry to sparse array that is finished." << EidosTerminate(nullptr);
 	
@@ -202,6 +219,9 @@ void SparseArray::Finished(void)
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::Finished): finishing sparse array that is already finished." << EidosTerminate(nullptr);
 	
+	if (chunk_count_)
+		MergeChunks();
+	
 	uint32_t offset = row_offsets_[nrows_set_];
 	
 	while (nrows_set_ < nrows_)
@@ -210,6 +230,65 @@ void SparseArray::Finished(void)
 	finished_ = true;
 }
 
+SparseArray *SparseArray::ChunkForRows(uint32_t p_first_row, uint32_t p_after_last_row)
+{
+	if (finished_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::ChunkForRows): (internal error) adding chunk to sparse array that is finished." << EidosTerminate(nullptr);
+	if (nrows_set_ != 0)
+		EIDOS_TERMINATION << "ERROR (SparseArray::ChunkForRows): (internal error) adding chunk to sparse array with rows already built." << EidosTerminate(nullptr);
+	if ((p_first_row >= p_after_last_row) || (p_after_last_row > nrows_))
+		EIDOS_TERMINATION << "ERROR (SparseArray::ChunkForRows): (internal error) chunk row range out of bounds." << EidosTerminate(nullptr);
+	if (chunk_count_ && (p_first_row < chunks_[chunk_count_ - 1]->first_row_ + chunks_[chunk_count_ - 1]->nrows_))
+		EIDOS_TERMINATION << "ERROR (SparseArray::ChunkForRows): (internal error) adding chunk out of order." << EidosTerminate(nullptr);
+	
+	// reuse a chunk left over from a previous build if we can, to reuse its buffers
+	SparseArray *chunk;
+	
+	if (chunk_count_ < (int)chunks_.size())
+	{
+		chunk = chunks_[chunk_count_];
+		chunk->Reset(p_after_last_row - p_first_row, ncols_);
+	}
+	else
+	{
+		chunk = new SparseArray(p_after_last_row - p_first_row, ncols_);
+		chunks_.emplace_back(chunk);
+	}
+	
+	chunk->first_row_ = p_first_row;
+	chunk_count_++;
+	
+	return chunk;
+}
+
+void SparseArray::MergeChunks(void)
+{
+	// make room for all of the entries in all of the chunks at once
+	for (int chunk_index = 0; chunk_index < chunk_count_; ++chunk_index)
+		nnz_ += chunks_[chunk_index]->nnz_;
+	
+	ResizeToFitNNZ();
+	
+	// then copy each chunk's rows in, adding empty rows for any rows not covered by a chunk
+	for (int chunk_index = 0; chunk_index < chunk_count_; ++chunk_index)
+	{
+		SparseArray *chunk = chunks_[chunk_index];
+		uint32_t offset = row_offsets_[nrows_set_];
+		
+		while (nrows_set_ < chunk->first_row_)
+			row_offsets_[++nrows_set_] = offset;
+		
+		for (uint32_t chunk_row = 1; chunk_row <= chunk->nrows_set_; ++chunk_row)
+			row_offsets_[++nrows_set_] = offset + chunk->row_offsets_[chunk_row];
+		
+		memcpy(columns_ + offset, chunk->columns_, chunk->nnz_ * sizeof(uint32_t));
+		memcpy(distances_ + offset, chunk->distances_, chunk->nnz_ * sizeof(sa_distance_t));
+		memcpy(strengths_ + offset, chunk->strengths_, chunk->nnz_ * sizeof(sa_strength_t));
+	}
+	
+	chunk_count_ = 0;
+}
+
 sa_distance_t SparseArray::Distance(uint32_t p_row, uint32_t p_column) const
 {
 #if DEBUG
@@ -379,6 +458,9 @@ size_t SparseArray::MemoryUsage(void)
 	usage += sizeof(uint32_t) * (nrows_ + 1);
 	usage += (sizeof(uint32_t) + sizeof(sa_distance_t) + sizeof(sa_strength_t)) * (nnz_capacity_);
 	
+	for (SparseArray *chunk : chunks_)
+		usage += sizeof(SparseArray) + chunk->MemoryUsage();
+	
 	return usage;
 }
 
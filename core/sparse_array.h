@@ -56,12 +56,17 @@ private:
 	sa_strength_t *strengths_;		// a strength value for each non-empty entry
 	
 	uint32_t nrows_, ncols_;		// the number of rows and columns; determined at construction time
+	uint32_t first_row_;			// the row index of our first row; non-zero only for chunks, see ChunkForRows()
 	uint32_t nrows_set_;			// the number of rows that have been configured (at least partially, during building)
 	uint32_t nnz_;					// the number of non-zero entries in the sparse array (also at row_offsets[nrows_set])
 	uint32_t nnz_capacity_;			// the number of non-zero entries allocated for at present
 	
 	bool finished_;					// if true, Finished() has been called and the sparse array is ready to use
 	
+	std::vector<SparseArray *> chunks_;	// chunks for building rows in parallel; kept across resets, to reuse their buffers
+	int chunk_count_;					// the number of chunks in use for the current build
+	
+	void MergeChunks(void);
 	void _ResizeToFitNNZ(void);
 	inline __attribute__((always_inline)) void ResizeToFitNNZ(void) { if (nnz_ > nnz_capacity_) _ResizeToFitNNZ(); };
 	
@@ -87,6 +92,8 @@ public:
 	
 	inline void AddEntryDistance(uint32_t p_row, const uint32_t p_column, sa_distance_t p_distance)
 	{
+		p_row -= first_row_;
+		
 #if DEBUG
 		if (finished_)
 			EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryDistance): (internal error) adding entry to sparse array that is finished." << EidosTerminate(nullptr);
@@ -125,6 +132,12 @@ public:
 	}
 	void AddEntryInteraction(uint32_t p_row, const uint32_t p_column, sa_distance_t p_distance, sa_strength_t p_strength);
 	
+	// Building in parallel; a contiguous block of rows can instead be built into a chunk obtained from ChunkForRows(), using
+	// the same row indices as for the full sparse array.  Each chunk can be built on its own thread, following the rules
+	// above; chunks must be requested in row order, on the main thread, and none of their rows may be built directly.
+	// Finished() then merges the rows of all of the chunks into the sparse array, in order.
+	SparseArray *ChunkForRows(uint32_t p_first_row, uint32_t p_after_last_row);
+	
 	void Finished(void);
 	inline __attribute__((always_inline)) bool IsFinished() const { return finished_; };
 	
@@ -327,6 +327,7 @@ void Subpopulation::MakeMemoryPools(size_t p_individual_capacity)
 		//std::cout << "sizeof(Genome) == " << sizeof(Genome) << std::endl;
 		
 		genome_pool_ = new EidosObjectPool(sizeof(Genome), capacity);
+		mutrun_buffer_pool_capacity_ = capacity;
 	}
 	
 	{
@@ -379,6 +380,19 @@ Genome *Subpopulation::_NewSubpopGenome(int p_mutrun_count, slim_position_t p_mu
 	return new (genome_pool_->AllocateChunk()) Genome(this, p_mutrun_count, p_mutrun_length, p_genome_type, p_is_null);
 }
 
+void *Subpopulation::_NewMutrunBufferPool(int32_t p_mutrun_count)
+{
+	// This gets called when no pool yet exists for buffers of p_mutrun_count runs.  Usually there is only one such pool, but the
+	// mutation run experiments can change the number of runs, and genomes in the junkyards keep their old buffers until reused.
+	if ((size_t)p_mutrun_count >= mutrun_buffer_pools_.size())
+		mutrun_buffer_pools_.resize(p_mutrun_count + 1, nullptr);
+	
+	EidosObjectPool *pool = new EidosObjectPool(p_mutrun_count * sizeof(MutationRun_SP), mutrun_buffer_pool_capacity_);
+	
+	mutrun_buffer_pools_[p_mutrun_count] = pool;
+	return pool->AllocateChunk();
+}
+
 #ifdef SLIM_WF_ONLY
 void Subpopulation::WipeIndividualsAndGenomes(std::vector<Individual *> &p_individuals, std::vector<Genome *> &p_genomes, slim_popsize_t p_individual_count, slim_popsize_t p_first_male, bool p_no_clear)
 {
@@ -1049,7 +1063,7 @@ Subpopulation::Subpopulation(Population &p_population, slim_objectid_t p_subpopu
 		for (slim_popsize_t i = 0; i < parent_subpop_size_; i++)
 			*(fitness_buffer_ptr++) = 1.0;
 		
-		lookup_parent_ = gsl_ran_discrete_preproc(parent_subpop_size_, cached_parental_fitness_);
+		lookup_parent_.Rebuild(parent_subpop_size_, cached_parental_fitness_);
 	}
 #endif	// SLIM_WF_ONLY
 }
@@ -1113,8 +1127,8 @@ Subpopulation::Subpopulation(Population &p_population, slim_objectid_t p_subpopu
 			*(male_buffer_ptr++) = 1.0;
 		}
 		
-		lookup_female_parent_ = gsl_ran_discrete_preproc(parent_first_male_index_, cached_parental_fitness_);
-		lookup_male_parent_ = gsl_ran_discrete_preproc(num_males, cached_parental_fitness_ + parent_first_male_index_);
+		lookup_female_parent_.Rebuild(parent_first_male_index_, cached_parental_fitness_);
+		lookup_male_parent_.Rebuild(num_males, cached_parental_fitness_ + parent_first_male_index_);
 	}
 #endif	// SLIM_WF_ONLY
 	
@@ -1138,15 +1152,6 @@ Subpopulation::~Subpopulation(void)
 	//std::cout << "Subpopulation::~Subpopulation" << std::endl;
 	
 #ifdef SLIM_WF_ONLY
-	if (lookup_parent_)
-		gsl_ran_discrete_free(lookup_parent_);
-	
-	if (lookup_female_parent_)
-		gsl_ran_discrete_free(lookup_female_parent_);
-	
-	if (lookup_male_parent_)
-		gsl_ran_discrete_free(lookup_male_parent_);
-	
 	if (cached_parental_fitness_)
 		free(cached_parental_fitness_);
 	
@@ -1201,6 +1206,9 @@ Subpopulation::~Subpopulation(void)
 	delete genome_pool_;
 	delete individual_pool_;
 	
+	for (EidosObjectPool *pool : mutrun_buffer_pools_)
+		delete pool;
+	
 	for (const auto &map_pair : spatial_maps_)
 	{
 		SpatialMap *map_ptr = map_pair.second;
@@ -1411,6 +1419,43 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 	bool pure_neutral = (!fitness_callbacks_exist && !global_fitness_callbacks_exist && population_.sim_.pure_neutral_);
 	double subpop_fitness_scaling = fitness_scaling_;
 	
+	// Can we calculate fitness values on multiple threads (slim -threads)?  We can if every active fitness() callback is pure arithmetic
+	// that cannot raise: a constant float return value, or (for non-global callbacks) a cached optimization.  Anything else runs script,
+	// or could raise, and so must run on the main thread.  The parallel path is used only for the general case below; the others are cheap.
+	bool parallel_fitness = (gEidosMaxThreads > 1) && (parent_subpop_size_ >= SLIM_FITNESS_PARALLEL_MIN_SIZE);
+	
+#if (SLIMPROFILING == 1)
+	// PROFILING
+	// The callback profiling in ApplyFitnessCallbacks() and ApplyGlobalFitnessCallbacks() uses shared clocks and totals without
+	// locking, and would sum per-thread times as if they were elapsed time, so when profiling we calculate fitness on the main thread
+	if (gEidosProfilingClientCount)
+		parallel_fitness = false;
+#endif
+	
+	if (parallel_fitness)
+	{
+		for (std::vector<SLiMEidosBlock*> *callbacks : {&p_fitness_callbacks, &p_global_fitness_callbacks})
+		{
+			for (SLiMEidosBlock *fitness_callback : *callbacks)
+			{
+				if (fitness_callback->active_)
+				{
+					EidosValue *constant_value = fitness_callback->compound_statement_node_->cached_return_value_.get();
+					
+					if (constant_value)
+					{
+						if ((constant_value->Type() != EidosValueType::kValueFloat) || (constant_value->Count() != 1))
+							parallel_fitness = false;
+					}
+					else if (!fitness_callback->has_cached_optimization_ || (callbacks == &p_global_fitness_callbacks))
+					{
+						parallel_fitness = false;
+					}
+				}
+			}
+		}
+	}
+	
 #if (!defined(SLIMGUI) && defined(SLIM_WF_ONLY))
 	// Reset our override of individual cached fitness values; we make this decision afresh with each UpdateFitness() call.  See
 	// the header for further comments on this mechanism.
@@ -1471,6 +1516,10 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 				totalFemaleFitness += fitness;
 			}
 		}
+		else if (parallel_fitness)
+		{
+			totalFemaleFitness = UpdateFitness_Parallel(0, parent_first_male_index_, subpop_fitness_scaling, p_fitness_callbacks, single_fitness_callback ? single_callback_mut_type : nullptr, p_global_fitness_callbacks);
+		}
 		else
 		{
 			// general case for females
@@ -1550,6 +1599,10 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 				totalMaleFitness += fitness;
 			}
 		}
+		else if (parallel_fitness)
+		{
+			totalMaleFitness = UpdateFitness_Parallel(parent_first_male_index_, parent_subpop_size_, subpop_fitness_scaling, p_fitness_callbacks, single_fitness_callback ? single_callback_mut_type : nullptr, p_global_fitness_callbacks);
+		}
 		else
 		{
 			// general case for males
@@ -1636,6 +1689,10 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 				totalFitness += fitness;
 			}
 		}
+		else if (parallel_fitness)
+		{
+			totalFitness = UpdateFitness_Parallel(0, parent_subpop_size_, subpop_fitness_scaling, p_fitness_callbacks, single_fitness_callback ? single_callback_mut_type : nullptr, p_global_fitness_callbacks);
+		}
 		else
 		{
 			// general case for hermaphrodites
@@ -1677,6 +1734,80 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 #endif	// SLIM_WF_ONLY
 }
 
+// This is the general case of UpdateFitness(), for individuals p_first_index to p_last_index - 1, run on multiple threads.  It must produce
+// exactly the same results as the single-threaded loops in UpdateFitness(); UpdateFitness() uses it only when no active fitness() callback
+// could run script or raise, so nothing in the parallel region touches shared state other than the reads noted below.  Each individual's
+// fitness is written to its own cached_fitness_UNSAFE_ without locking, and the total is then summed in index order on the main thread,
+// so that it does not depend on the number of threads.
+double Subpopulation::UpdateFitness_Parallel(slim_popsize_t p_first_index, slim_popsize_t p_last_index, double p_subpop_fitness_scaling, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, MutationType *p_single_callback_mut_type, std::vector<SLiMEidosBlock*> &p_global_fitness_callbacks)
+{
+	bool fitness_callbacks_exist = (p_fitness_callbacks.size() > 0);
+	bool global_fitness_callbacks_exist = (p_global_fitness_callbacks.size() > 0);
+	
+#if SLIM_USE_NONNEUTRAL_CACHES
+	// The nonneutral caches of mutation runs are rebuilt lazily, and runs are shared between genomes, so we rebuild any invalid caches up
+	// front; each run is rebuilt on only one thread.  The fitness calculations below then just read from the caches.
+	SLiMSim &sim = population_.sim_;
+	int32_t nonneutral_change_counter = sim.nonneutral_change_counter_;
+	int32_t nonneutral_regime = sim.last_nonneutral_regime_;
+	
+	recache_runs_.clear();
+	
+	for (slim_popsize_t genome_index = p_first_index * 2; genome_index < p_last_index * 2; genome_index++)
+	{
+		Genome *genome = parent_genomes_[genome_index];
+		
+		for (int run_index = 0; run_index < genome->mutrun_count_; ++run_index)
+		{
+			MutationRun *mutrun = genome->mutruns_[run_index].get();
+			
+			if (mutrun && !mutrun->nonneutral_cache_is_valid(nonneutral_change_counter))
+				recache_runs_.emplace_back(mutrun);
+		}
+	}
+	
+	std::sort(recache_runs_.begin(), recache_runs_.end());
+	recache_runs_.erase(std::unique(recache_runs_.begin(), recache_runs_.end()), recache_runs_.end());
+	
+	int64_t recache_count = (int64_t)recache_runs_.size();
+	
+#pragma omp parallel for schedule(dynamic, 16) num_threads(gEidosMaxThreads)
+	for (int64_t recache_index = 0; recache_index < recache_count; ++recache_index)
+		recache_runs_[recache_index]->validate_nonneutral_cache(nonneutral_change_counter, nonneutral_regime);
+#endif
+	
+	// Now calculate fitness values; this reads genomes, mutations, and callbacks, and writes only to the individuals
+#pragma omp parallel for schedule(dynamic, SLIM_FITNESS_PARALLEL_CHUNK_SIZE) num_threads(gEidosMaxThreads)
+	for (slim_popsize_t individual_index = p_first_index; individual_index < p_last_index; individual_index++)
+	{
+		double fitness = p_subpop_fitness_scaling * parent_individuals_[individual_index]->fitness_scaling_;
+		
+		if (fitness > 0.0)
+		{
+			if (!fitness_callbacks_exist)
+				fitness *= FitnessOfParentWithGenomeIndices_NoCallbacks(individual_index);
+			else if (p_single_callback_mut_type)
+				fitness *= FitnessOfParentWithGenomeIndices_SingleCallback(individual_index, p_fitness_callbacks, p_single_callback_mut_type);
+			else
+				fitness *= FitnessOfParentWithGenomeIndices_Callbacks(individual_index, p_fitness_callbacks);
+			
+			// multiply in the effects of any global fitness callbacks (muttype==NULL)
+			if (global_fitness_callbacks_exist && (fitness > 0.0))
+				fitness *= ApplyGlobalFitnessCallbacks(p_global_fitness_callbacks, individual_index);
+		}
+		
+		parent_individuals_[individual_index]->cached_fitness_UNSAFE_ = fitness;
+	}
+	
+	// Deterministic reduction: sum in index order, exactly as the single-threaded loops do
+	double total_fitness = 0.0;
+	
+	for (slim_popsize_t individual_index = p_first_index; individual_index < p_last_index; individual_index++)
+		total_fitness += parent_individuals_[individual_index]->cached_fitness_UNSAFE_;
+	
+	return total_fitness;
+}
+
 #ifdef SLIM_WF_ONLY
 void Subpopulation::UpdateWFFitnessBuffers(bool p_pure_neutral)
 {
@@ -1753,47 +1884,32 @@ void Subpopulation::UpdateWFFitnessBuffers(bool p_pure_neutral)
 	// Remake our mate-choice lookup tables
 	if (sex_enabled_)
 	{
-		// throw out the old tables
-		if (lookup_female_parent_)
+		// in pure neutral models we don't build the tables, and draw parents uniformly; otherwise we rebuild them in place
+		if (p_pure_neutral)
 		{
-			gsl_ran_discrete_free(lookup_female_parent_);
-			lookup_female_parent_ = nullptr;
+			lookup_female_parent_.Clear();
+			lookup_male_parent_.Clear();
 		}
-		
-		if (lookup_male_parent_)
-		{
-			gsl_ran_discrete_free(lookup_male_parent_);
-			lookup_male_parent_ = nullptr;
-		}
-		
-		// in pure neutral models we don't set up the discrete preproc
-		if (!p_pure_neutral)
+		else
 		{
-			lookup_female_parent_ = gsl_ran_discrete_preproc(parent_first_male_index_, cached_parental_fitness_);
-			lookup_male_parent_ = gsl_ran_discrete_preproc(parent_subpop_size_ - parent_first_male_index_, cached_parental_fitness_ + parent_first_male_index_);
+			lookup_female_parent_.Rebuild(parent_first_male_index_, cached_parental_fitness_);
+			lookup_male_parent_.Rebuild(parent_subpop_size_ - parent_first_male_index_, cached_parental_fitness_ + parent_first_male_index_);
 		}
 	}
 	else
 	{
-		// throw out the old tables
-		if (lookup_parent_)
-		{
-			gsl_ran_discrete_free(lookup_parent_);
-			lookup_parent_ = nullptr;
-		}
-		
-		// in pure neutral models we don't set up the discrete preproc
-		if (!p_pure_neutral)
-		{
-			lookup_parent_ = gsl_ran_discrete_preproc(parent_subpop_size_, cached_parental_fitness_);
-		}
+		// in pure neutral models we don't build the table, and draw parents uniformly; otherwise we rebuild it in place
+		if (p_pure_neutral)
+			lookup_parent_.Clear();
+		else
+			lookup_parent_.Rebuild(parent_subpop_size_, cached_parental_fitness_);
 	}
 }
 #endif	// SLIM_WF_ONLY
 
 double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homozygous, double p_computed_fitness, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, Individual *p_individual, Genome *p_genome1, Genome *p_genome2)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -1816,8 +1932,8 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 				if (compound_statement_node->cached_return_value_)
 				{
 					// The script is a constant expression such as "{ return 1.1; }", so we can short-circuit it completely
-					EidosValue_SP result_SP = compound_statement_node->cached_return_value_;
-					EidosValue *result = result_SP.get();
+					// We do not retain the cached value, since this may be called on multiple threads; see UpdateFitness_Parallel()
+					EidosValue *result = compound_statement_node->cached_return_value_.get();
 					
 					if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
 						EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyFitnessCallbacks): fitness() callbacks must provide a float singleton return value." << EidosTerminate(fitness_callback->identifier_token_);
@@ -1896,17 +2012,28 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 						
 						try
 						{
-							// Interpret the script; the result from the interpretation must be a singleton double used as a new fitness value
-							EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(fitness_callback->script_);
-							EidosValue *result = result_SP.get();
-							
-							if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
-								EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyFitnessCallbacks): fitness() callbacks must provide a float singleton return value." << EidosTerminate(fitness_callback->identifier_token_);
-							
-							p_computed_fitness = result->FloatAtIndex(0, nullptr);
+							// Run the compiled callback if there is one; if it cannot handle this call, it falls back to the interpreter
+							EidosBytecode *bytecode = fitness_callback->bytecode_;
+							EidosBytecodeSlot bytecode_result;
 							
-							// Output generated by the interpreter goes to our output stream
-							interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+							if (bytecode && bytecode->ShouldExecute() && bytecode->Execute(client_symbols, fitness_callback->script_, &bytecode_result) && (bytecode_result.type_ == EidosValueType::kValueFloat))
+							{
+								p_computed_fitness = bytecode_result.float_;
+							}
+							else
+							{
+								// Interpret the script; the result from the interpretation must be a singleton double used as a new fitness value
+								EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(fitness_callback->script_);
+								EidosValue *result = result_SP.get();
+								
+								if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
+									EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyFitnessCallbacks): fitness() callbacks must provide a float singleton return value." << EidosTerminate(fitness_callback->identifier_token_);
+								
+								p_computed_fitness = result->FloatAtIndex(0, nullptr);
+								
+								// Output generated by the interpreter goes to our output stream
+								interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+							}
 						}
 						catch (...)
 						{
@@ -1922,7 +2049,7 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 		}
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessCallback)]);
 #endif
@@ -1933,7 +2060,7 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 // This calculates the effects of global fitness callbacks, i.e. those with muttype==NULL and which therefore do not reference any mutation
 double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks, slim_popsize_t p_individual_index)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -1955,8 +2082,8 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 			if (compound_statement_node->cached_return_value_)
 			{
 				// The script is a constant expression such as "{ return 1.1; }", so we can short-circuit it completely
-				EidosValue_SP result_SP = compound_statement_node->cached_return_value_;
-				EidosValue *result = result_SP.get();
+				// We do not retain the cached value, since this may be called on multiple threads; see UpdateFitness_Parallel()
+				EidosValue *result = compound_statement_node->cached_return_value_.get();
 				
 				if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
 					EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyGlobalFitnessCallbacks): fitness() callbacks must provide a float singleton return value." << EidosTerminate(fitness_callback->identifier_token_);
@@ -2020,17 +2147,28 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 					
 					try
 					{
-						// Interpret the script; the result from the interpretation must be a singleton double used as a new fitness value
-						EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(fitness_callback->script_);
-						EidosValue *result = result_SP.get();
+						// Run the compiled callback if there is one; if it cannot handle this call, it falls back to the interpreter
+						EidosBytecode *bytecode = fitness_callback->bytecode_;
+						EidosBytecodeSlot bytecode_result;
 						
-						if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
-							EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyGlobalFitnessCallbacks): fitness() callbacks must provide a float singleton return value." << EidosTerminate(fitness_callback->identifier_token_);
-						
-						computed_fitness *= result->FloatAtIndex(0, nullptr);
-						
-						// Output generated by the interpreter goes to our output stream
-						interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+						if (bytecode && bytecode->ShouldExecute() && bytecode->Execute(client_symbols, fitness_callback->script_, &bytecode_result) && (bytecode_result.type_ == EidosValueType::kValueFloat))
+						{
+							computed_fitness *= bytecode_result.float_;
+						}
+						else
+						{
+							// Interpret the script; the result from the interpretation must be a singleton double used as a new fitness value
+							EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(fitness_callback->script_);
+							EidosValue *result = result_SP.get();
+							
+							if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != 1))
+								EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyGlobalFitnessCallbacks): fitness() callbacks must provide a float singleton return value." << EidosTerminate(fitness_callback->identifier_token_);
+							
+							computed_fitness *= result->FloatAtIndex(0, nullptr);
+							
+							// Output generated by the interpreter goes to our output stream
+							interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+						}
 					}
 					catch (...)
 					{
@@ -2052,7 +2190,7 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 		}
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)]);
 #endif
@@ -3018,7 +3156,7 @@ void Subpopulation::SwapChildAndParentGenomes(void)
 #ifdef SLIM_NONWF_ONLY
 void Subpopulation::ApplyReproductionCallbacks(std::vector<SLiMEidosBlock*> &p_reproduction_callbacks, slim_popsize_t p_individual_index)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3091,7 +3229,7 @@ void Subpopulation::ApplyReproductionCallbacks(std::vector<SLiMEidosBlock*> &p_r
 		}
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosReproductionCallback)]);
 #endif
@@ -3313,14 +3451,9 @@ size_t Subpopulation::MemoryUsageForParentTables(void)
 {
 	size_t usage = 0;
 	
-	if (lookup_parent_)
-		usage += lookup_parent_->K * (sizeof(size_t) + sizeof(double));
-	
-	if (lookup_female_parent_)
-		usage += lookup_female_parent_->K * (sizeof(size_t) + sizeof(double));
-	
-	if (lookup_male_parent_)
-		usage += lookup_male_parent_->K * (sizeof(size_t) + sizeof(double));
+	usage += lookup_parent_.MemoryUsage();
+	usage += lookup_female_parent_.MemoryUsage();
+	usage += lookup_male_parent_.MemoryUsage();
 	
 	return usage;
 }
@@ -4774,8 +4907,10 @@ EidosValue_SP Subpopulation::ExecuteMethod_takeMigrants(EidosGlobalStringID p_me
 			}
 			else
 			{
-				// if the original genome points to an external buffer, ignore the internal buffer and just swap external buffers
-				std::swap(genome1->mutruns_, genome1_transmogrified->mutruns_);
+				// if the original genome points to an external buffer, it belongs to the source subpop's slab, so move the runs into our own
+				genome1_transmogrified->AllocateMutrunBuffer();
+				memcpy(genome1_transmogrified->mutruns_, genome1->mutruns_, genome1_transmogrified->mutrun_count_ * sizeof(MutationRun_SP));
+				source_subpop->DisposeMutrunBuffer(genome1->mutruns_, genome1_transmogrified->mutrun_count_);
 			}
 			genome1->mutruns_ = nullptr;
 			genome1_transmogrified->tag_value_ = genome1->tag_value_;
@@ -4793,8 +4928,10 @@ EidosValue_SP Subpopulation::ExecuteMethod_takeMigrants(EidosGlobalStringID p_me
 			}
 			else
 			{
-				// if the original genome points to an external buffer, ignore the internal buffer and just swap external buffers
-				std::swap(genome2->mutruns_, genome2_transmogrified->mutruns_);
+				// if the original genome points to an external buffer, it belongs to the source subpop's slab, so move the runs into our own
+				genome2_transmogrified->AllocateMutrunBuffer();
+				memcpy(genome2_transmogrified->mutruns_, genome2->mutruns_, genome2_transmogrified->mutrun_count_ * sizeof(MutationRun_SP));
+				source_subpop->DisposeMutrunBuffer(genome2->mutruns_, genome2_transmogrified->mutrun_count_);
 			}
 			genome2->mutruns_ = nullptr;
 			genome2_transmogrified->tag_value_ = genome2->tag_value_;
@@ -5021,6 +5158,9 @@ EidosValue_SP Subpopulation::ExecuteMethod_takeMigrants(EidosGlobalStringID p_me
 		
 		for (auto int_type : interactionTypes)
 			int_type.second->Invalidate();
+		
+		// Mutation tallies over subsets of subpops are no longer accurate
+		population_.InvalidateMutationTallies();
 	}
 	
 	// Finally, dispose of the old individuals and genomes, in their respective subpops; there should be no references to
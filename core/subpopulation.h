@@ -35,7 +35,10 @@
  of a memory pool, genome_pool_, that is specific to the subpopulation.  This helps with memory locality; it keeps all of the
  Genome objects used by a given subpop grouped closely together in memory.  (We do the same with Individual objects, with another
  pool, for the same reason).  So allocations of Genomes come out of that pool, and deallocations go back into the pool.  Do not
- use new or delete with Genome objects.  There is one more complication.  In WF models, separate "parent" and "child" generations
+ use new or delete with Genome objects.  Similarly, the MutationRun pointer buffers of genomes with more than one run come from
+ per-subpop pools, one for each run count, so that scans across a subpop's genomes touch buffers that are densely packed rather
+ than scattered across the heap; Genome::AllocateMutrunBuffer() and Genome::FreeMutrunBuffer() should be used to get and return
+ them.  There is one more complication.  In WF models, separate "parent" and "child" generations
  are kept by the subpop, and which one is active switches back and forth in each generation, governed by child_generation_valid_.
  In nonWF models, the child generation variables are all unused; we have a #ifdef scheme with SLIM_WF_ONLY and SLIM_NONWF_ONLY to
  test for correct isolation of WF and nonWF code (see slim_global.h).  In nonWF models, the parental generation is always active.
@@ -51,6 +54,7 @@
 
 #include "slim_globals.h"
 #include "eidos_rng.h"
+#include "eidos_alias_table.h"
 #include "genome.h"
 #include "chromosome.h"
 #include "eidos_value.h"
@@ -70,6 +74,11 @@ class Population;
 extern EidosClass *gSLiM_Subpopulation_Class;
 
 
+// Multithreaded fitness calculation (slim -threads) is used only for subpopulations at least this large, and hands out individuals to threads in chunks of this size
+#define SLIM_FITNESS_PARALLEL_MIN_SIZE		1000
+#define SLIM_FITNESS_PARALLEL_CHUNK_SIZE	64
+
+
 #pragma mark -
 #pragma mark _SpatialMap
 #pragma mark -
@@ -125,9 +134,9 @@ private:
 private:
 	
 #ifdef SLIM_WF_ONLY
-	gsl_ran_discrete_t *lookup_parent_ = nullptr;			// OWNED POINTER: lookup table for drawing a parent based upon fitness
-	gsl_ran_discrete_t *lookup_female_parent_ = nullptr;	// OWNED POINTER: lookup table for drawing a female parent based upon fitness, SEX ONLY
-	gsl_ran_discrete_t *lookup_male_parent_ = nullptr;		// OWNED POINTER: lookup table for drawing a male parent based upon fitness, SEX ONLY
+	EidosAliasTable lookup_parent_;					// lookup table for drawing a parent based upon fitness; not built in pure neutral models
+	EidosAliasTable lookup_female_parent_;			// lookup table for drawing a female parent based upon fitness, SEX ONLY
+	EidosAliasTable lookup_male_parent_;			// lookup table for drawing a male parent based upon fitness, SEX ONLY
 #endif	// SLIM_WF_ONLY
 	
 	EidosSymbolTableEntry self_symbol_;						// for fast setup of the symbol table
@@ -148,6 +157,8 @@ public:
 	
 	EidosObjectPool *genome_pool_ = nullptr;		// a pool out of which genomes are allocated, for locality of memory usage across genomes
 	EidosObjectPool *individual_pool_ = nullptr;	// a pool out of which individuals are allocated, for locality of memory usage across individuals
+	std::vector<EidosObjectPool *> mutrun_buffer_pools_;	// pools out of which genomes' mutrun pointer buffers are allocated, indexed by mutrun count
+	size_t mutrun_buffer_pool_capacity_ = 1024;		// the initial capacity for new pools in mutrun_buffer_pools_, in buffers
 	
 	std::vector<Genome *> genome_junkyard_nonnull;	// non-null genomes get put here when we're done with them, so we can reuse them without dealloc/realloc of their mutrun buffers
 	std::vector<Genome *> genome_junkyard_null;		// null genomes get put here when we're done with them, so we can reuse them without dealloc/realloc of their mutrun buffers
@@ -212,6 +223,8 @@ public:
 	slim_popsize_t cached_fitness_capacity_ = 0;	// the capacity of the malloced buffers cached_parental_fitness_ and cached_male_fitness_
 #endif	// SLIM_WF_ONLY
 	
+	std::vector<MutationRun *> recache_runs_;		// mutation runs whose nonneutral caches need rebuilding; used by UpdateFitness_Parallel()
+	
 #if (!defined(SLIMGUI) && defined(SLIM_WF_ONLY))
 	// Optimized fitness caching at the Individual level.  Individual has an ivar named cached_fitness_UNSAFE_ that keeps a cached fitness value for each individual.
 	// When a model is neutral or nearly neutral, every individual may have the same fitness value, and we may know that.  In such cases, we want to avoid setting
@@ -280,13 +293,19 @@ public:
 	~Subpopulation(void);																			// destructor
 	
 #ifdef SLIM_WF_ONLY
-	slim_popsize_t DrawParentUsingFitness(void) const;										// draw an individual from the subpopulation based upon fitness
-	slim_popsize_t DrawFemaleParentUsingFitness(void) const;								// draw a female from the subpopulation based upon fitness; SEX ONLY
-	slim_popsize_t DrawMaleParentUsingFitness(void) const;									// draw a male from the subpopulation based upon fitness; SEX ONLY
+	slim_popsize_t DrawParentUsingFitness(Eidos_RNG_State &p_rng) const;					// draw an individual from the subpopulation based upon fitness
+	inline slim_popsize_t DrawParentUsingFitness(void) const { return DrawParentUsingFitness(gEidos_RNG); }
+	slim_popsize_t DrawFemaleParentUsingFitness(Eidos_RNG_State &p_rng) const;			// draw a female from the subpopulation based upon fitness; SEX ONLY
+	inline slim_popsize_t DrawFemaleParentUsingFitness(void) const { return DrawFemaleParentUsingFitness(gEidos_RNG); }
+	slim_popsize_t DrawMaleParentUsingFitness(Eidos_RNG_State &p_rng) const;				// draw a male from the subpopulation based upon fitness; SEX ONLY
+	inline slim_popsize_t DrawMaleParentUsingFitness(void) const { return DrawMaleParentUsingFitness(gEidos_RNG); }
 #endif	// SLIM_WF_ONLY
-	slim_popsize_t DrawParentEqualProbability(void) const;									// draw an individual from the subpopulation with equal probabilities
-	slim_popsize_t DrawFemaleParentEqualProbability(void) const;							// draw a female from the subpopulation  with equal probabilities; SEX ONLY
-	slim_popsize_t DrawMaleParentEqualProbability(void) const;								// draw a male from the subpopulation  with equal probabilities; SEX ONLY
+	slim_popsize_t DrawParentEqualProbability(Eidos_RNG_State &p_rng) const;				// draw an individual from the subpopulation with equal probabilities
+	inline slim_popsize_t DrawParentEqualProbability(void) const { return DrawParentEqualProbability(gEidos_RNG); }
+	slim_popsize_t DrawFemaleParentEqualProbability(Eidos_RNG_State &p_rng) const;		// draw a female from the subpopulation  with equal probabilities; SEX ONLY
+	inline slim_popsize_t DrawFemaleParentEqualProbability(void) const { return DrawFemaleParentEqualProbability(gEidos_RNG); }
+	slim_popsize_t DrawMaleParentEqualProbability(Eidos_RNG_State &p_rng) const;			// draw a male from the subpopulation  with equal probabilities; SEX ONLY
+	inline slim_popsize_t DrawMaleParentEqualProbability(void) const { return DrawMaleParentEqualProbability(gEidos_RNG); }
 	
 	void MakeMemoryPools(size_t p_individual_capacity);
 	
@@ -321,16 +340,12 @@ public:
 				if (back->mutrun_count_ != p_mutrun_count)
 				{
 					// the number of mutruns has changed; need to reallocate
-					if (back->mutruns_ != back->run_buffer_)
-						delete[] back->mutruns_;
+					back->FreeMutrunBuffer();
 					
 					back->mutrun_count_ = p_mutrun_count;
 					back->mutrun_length_ = p_mutrun_length;
 					
-					if (p_mutrun_count <= SLIM_GENOME_MUTRUN_BUFSIZE)
-						back->mutruns_ = back->run_buffer_;
-					else
-						back->mutruns_ = new MutationRun_SP[p_mutrun_count];
+					back->AllocateMutrunBuffer();
 				}
 				return back;
 			}
@@ -339,6 +354,22 @@ public:
 		return _NewSubpopGenome(p_mutrun_count, p_mutrun_length, p_genome_type, p_is_null);
 	}
 	
+	// Mutrun pointer buffers for genomes with more than SLIM_GENOME_MUTRUN_BUFSIZE runs come from a slab kept by the subpopulation, so
+	// that the buffers for the parent and child generations sit densely together rather than scattered across the heap; see Genome
+	void *_NewMutrunBufferPool(int32_t p_mutrun_count);	// internal use only
+	inline __attribute__((always_inline)) MutationRun_SP *AllocateMutrunBuffer(int32_t p_mutrun_count)
+	{
+		void *buffer = (((size_t)p_mutrun_count < mutrun_buffer_pools_.size()) && mutrun_buffer_pools_[p_mutrun_count]) ? mutrun_buffer_pools_[p_mutrun_count]->AllocateChunk() : _NewMutrunBufferPool(p_mutrun_count);
+		
+		// the free list of the pool threads through its chunks, so the buffer must be cleared to nullptr
+		memset(buffer, 0, p_mutrun_count * sizeof(MutationRun_SP));
+		return (MutationRun_SP *)buffer;
+	}
+	inline __attribute__((always_inline)) void DisposeMutrunBuffer(MutationRun_SP *p_buffer, int32_t p_mutrun_count)
+	{
+		mutrun_buffer_pools_[p_mutrun_count]->DisposeChunk(p_buffer);
+	}
+	
 	// Frees a genome object (puts it in one of the junkyards), clearing it to nullptr to keep our bookkeeping straight
 	inline __attribute__((always_inline)) void FreeSubpopGenome(Genome *p_genome)
 	{
@@ -360,6 +391,7 @@ public:
 	
 	IndividualSex SexOfIndividual(slim_popsize_t p_individual_index);						// return the sex of the individual at the given index; uses child_generation_valid
 	void UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callbacks, std::vector<SLiMEidosBlock*> &p_global_fitness_callbacks);	// update fitness values based upon current mutations
+	double UpdateFitness_Parallel(slim_popsize_t p_first_index, slim_popsize_t p_last_index, double p_subpop_fitness_scaling, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, MutationType *p_single_callback_mut_type, std::vector<SLiMEidosBlock*> &p_global_fitness_callbacks);	// multithreaded general case of UpdateFitness(); returns the total fitness
 #ifdef SLIM_WF_ONLY
 	void UpdateWFFitnessBuffers(bool p_pure_neutral);																					// update the WF model fitness buffers after UpdateFitness()
 #endif	// SLIM_WF_ONLY
@@ -528,82 +560,82 @@ public:
 
 
 #ifdef SLIM_WF_ONLY
-inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawParentUsingFitness(void) const
+inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawParentUsingFitness(Eidos_RNG_State &p_rng) const
 {
 #if DEBUG
 	if (sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (Subpopulation::DrawParentUsingFitness): (internal error) called on a population for which sex is enabled." << EidosTerminate();
 #endif
 	
-	if (lookup_parent_)
-		return static_cast<slim_popsize_t>(gsl_ran_discrete(EIDOS_GSL_RNG, lookup_parent_));
+	if (lookup_parent_.IsBuilt())
+		return static_cast<slim_popsize_t>(lookup_parent_.Draw(p_rng));
 	else
-		return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, parent_subpop_size_));
+		return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(p_rng.gsl_rng_, parent_subpop_size_));
 }
 #endif	// SLIM_WF_ONLY
 
-inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawParentEqualProbability(void) const
+inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawParentEqualProbability(Eidos_RNG_State &p_rng) const
 {
 #if DEBUG
 	if (sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (Subpopulation::DrawParentEqualProbability): (internal error) called on a population for which sex is enabled." << EidosTerminate();
 #endif
 	
-	return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, parent_subpop_size_));
+	return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(p_rng.gsl_rng_, parent_subpop_size_));
 }
 
 #ifdef SLIM_WF_ONLY
 // SEX ONLY
-inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawFemaleParentUsingFitness(void) const
+inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawFemaleParentUsingFitness(Eidos_RNG_State &p_rng) const
 {
 #if DEBUG
 	if (!sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (Subpopulation::DrawFemaleParentUsingFitness): (internal error) called on a population for which sex is not enabled." << EidosTerminate();
 #endif
 	
-	if (lookup_female_parent_)
-		return static_cast<slim_popsize_t>(gsl_ran_discrete(EIDOS_GSL_RNG, lookup_female_parent_));
+	if (lookup_female_parent_.IsBuilt())
+		return static_cast<slim_popsize_t>(lookup_female_parent_.Draw(p_rng));
 	else
-		return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, parent_first_male_index_));
+		return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(p_rng.gsl_rng_, parent_first_male_index_));
 }
 #endif	// SLIM_WF_ONLY
 
 // SEX ONLY
-inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawFemaleParentEqualProbability(void) const
+inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawFemaleParentEqualProbability(Eidos_RNG_State &p_rng) const
 {
 #if DEBUG
 	if (!sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (Subpopulation::DrawFemaleParentEqualProbability): (internal error) called on a population for which sex is not enabled." << EidosTerminate();
 #endif
 	
-	return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, parent_first_male_index_));
+	return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(p_rng.gsl_rng_, parent_first_male_index_));
 }
 
 #ifdef SLIM_WF_ONLY
 // SEX ONLY
-inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawMaleParentUsingFitness(void) const
+inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawMaleParentUsingFitness(Eidos_RNG_State &p_rng) const
 {
 #if DEBUG
 	if (!sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (Subpopulation::DrawMaleParentUsingFitness): (internal error) called on a population for which sex is not enabled." << EidosTerminate();
 #endif
 	
-	if (lookup_male_parent_)
-		return static_cast<slim_popsize_t>(gsl_ran_discrete(EIDOS_GSL_RNG, lookup_male_parent_)) + parent_first_male_index_;
+	if (lookup_male_parent_.IsBuilt())
+		return static_cast<slim_popsize_t>(lookup_male_parent_.Draw(p_rng)) + parent_first_male_index_;
 	else
-		return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, parent_subpop_size_ - parent_first_male_index_) + parent_first_male_index_);
+		return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(p_rng.gsl_rng_, parent_subpop_size_ - parent_first_male_index_) + parent_first_male_index_);
 }
 #endif	// SLIM_WF_ONLY
 
 // SEX ONLY
-inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawMaleParentEqualProbability(void) const
+inline __attribute__((always_inline)) slim_popsize_t Subpopulation::DrawMaleParentEqualProbability(Eidos_RNG_State &p_rng) const
 {
 #if DEBUG
 	if (!sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (Subpopulation::DrawMaleParentEqualProbability): (internal error) called on a population for which sex is not enabled." << EidosTerminate();
 #endif
 	
-	return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(EIDOS_GSL_RNG, parent_subpop_size_ - parent_first_male_index_) + parent_first_male_index_);
+	return static_cast<slim_popsize_t>(Eidos_rng_uniform_int(p_rng.gsl_rng_, parent_subpop_size_ - parent_first_male_index_) + parent_first_male_index_);
 }
 
 inline IndividualSex Subpopulation::SexOfIndividual(slim_popsize_t p_individual_index)
@@ -68,8 +68,10 @@ else:unix: PRE_TARGETDEPS += $$OUT_PWD/../eidos_zlib/libeidos_zlib.a
 
 
 SOURCES += \
+    eidos_alias_table.cpp \
     eidos_ast_node.cpp \
     eidos_beep.cpp \
+    eidos_bytecode.cpp \
     eidos_call_signature.cpp \
     eidos_class_Dictionary.cpp \
     eidos_class_Image.cpp \
@@ -97,8 +99,10 @@ SOURCES += \
     lodepng.cpp
 
 HEADERS += \
+    eidos_alias_table.h \
     eidos_ast_node.h \
     eidos_beep.h \
+    eidos_bytecode.h \
     eidos_call_signature.h \
     eidos_class_Dictionary.h \
     eidos_class_Object.h \
@@ -0,0 +1,142 @@
+//
+//  eidos_alias_table.cpp
+//  Eidos
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "eidos_alias_table.h"
+#include "eidos_globals.h"
+
+
+void EidosAliasTable::Rebuild(size_t p_count, const double *p_weights)
+{
+	// This follows gsl_ran_discrete_preproc() in gsl/randist/discrete.c step by step, so that the tables it builds are identical;
+	// see the header comment.  The GSL's stacks are replaced by vectors used as stacks, which are kept across rebuilds.
+	if ((p_count < 1) || (p_count > UINT32_MAX))
+		EIDOS_TERMINATION << "ERROR (EidosAliasTable::Rebuild): (internal error) the number of weights must be in [1, " << UINT32_MAX << "]." << EidosTerminate(nullptr);
+	
+	double total = 0.0;
+	
+	for (size_t k = 0; k < p_count; ++k)
+	{
+		if (p_weights[k] < 0)
+			EIDOS_TERMINATION << "ERROR (EidosAliasTable::Rebuild): (internal error) weights must be non-negative." << EidosTerminate(nullptr);
+		
+		total += p_weights[k];
+	}
+	
+	count_ = p_count;
+	cutoffs_.resize(p_count);
+	aliases_.resize(p_count);
+	scaled_.resize(p_count);
+	smalls_.clear();
+	bigs_.clear();
+	
+	double *cutoffs = cutoffs_.data();
+	uint32_t *aliases = aliases_.data();
+	double *scaled = scaled_.data();
+	double mean = 1.0 / p_count;
+	
+	for (size_t k = 0; k < p_count; ++k)
+		scaled[k] = p_weights[k] / total;
+	
+	for (size_t k = 0; k < p_count; ++k)
+	{
+		if (scaled[k] < mean)
+			smalls_.emplace_back((uint32_t)k);
+		else
+			bigs_.emplace_back((uint32_t)k);
+	}
+	
+	// pair each small bin with a big bin, which donates enough probability to fill the small bin up to the mean
+	while (smalls_.size() > 0)
+	{
+		uint32_t s = smalls_.back();
+		
+		smalls_.pop_back();
+		
+		if (bigs_.size() == 0)
+		{
+			aliases[s] = s;
+			cutoffs[s] = 1.0;
+			continue;
+		}
+		
+		uint32_t b = bigs_.back();
+		
+		bigs_.pop_back();
+		
+		aliases[s] = b;
+		cutoffs[s] = p_count * scaled[s];
+		
+		double d = mean - scaled[s];
+		
+		scaled[s] += d;
+		scaled[b] -= d;
+		
+		if (scaled[b] < mean)
+		{
+			smalls_.emplace_back(b);
+		}
+		else if (scaled[b] > mean)
+		{
+			bigs_.emplace_back(b);
+		}
+		else
+		{
+			aliases[b] = b;
+			cutoffs[b] = 1.0;
+		}
+	}
+	
+	while (bigs_.size() > 0)
+	{
+		uint32_t b = bigs_.back();
+		
+		bigs_.pop_back();
+		
+		aliases[b] = b;
+		cutoffs[b] = 1.0;
+	}
+	
+	// fold the bin index into the cutoffs, as the GSL does with KNUTH_CONVENTION, so that the draw can compare against u directly
+	for (size_t k = 0; k < p_count; ++k)
+	{
+		cutoffs[k] += k;
+		cutoffs[k] /= p_count;
+	}
+}
+
+void EidosAliasTable::DrawMany(Eidos_RNG_State &p_rng, int32_t *p_indices, size_t p_draw_count) const
+{
+	gsl_rng *rng = p_rng.gsl_rng_;
+	const double *cutoffs = cutoffs_.data();
+	const uint32_t *aliases = aliases_.data();
+	size_t count = count_;
+	
+	for (size_t draw_index = 0; draw_index < p_draw_count; ++draw_index)
+	{
+		double u = Eidos_rng_uniform(rng);
+		size_t bin = (size_t)(u * count);
+		
+		p_indices[draw_index] = (int32_t)((u < cutoffs[bin]) ? (uint32_t)bin : aliases[bin]);
+	}
+}
+
+size_t EidosAliasTable::MemoryUsage(void) const
+{
+	return cutoffs_.capacity() * sizeof(double) + aliases_.capacity() * sizeof(uint32_t) + scaled_.capacity() * sizeof(double) + (smalls_.capacity() + bigs_.capacity()) * sizeof(uint32_t);
+}
@@ -0,0 +1,88 @@
+//
+//  eidos_alias_table.h
+//  Eidos
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+
+ The class EidosAliasTable draws indices in [0, K) with probabilities proportional to a vector of K non-negative weights, using
+ Walker's alias method.  It replaces gsl_ran_discrete_preproc() / gsl_ran_discrete() for tables that are rebuilt often, such as the
+ fitness-proportional parent tables that each subpopulation rebuilds every generation.  Unlike the GSL's tables, an EidosAliasTable
+ keeps its buffers (and its scratch buffers for construction) across rebuilds, so a rebuild with the same or a smaller number of
+ weights does no allocation; and the draw is inline, taking an explicit Eidos_RNG_State so that it can be used with RNG streams.
+
+ The table construction and the draw deliberately follow the GSL's algorithm exactly, including the order in which "small" and
+ "large" entries are paired; given the same weights and the same RNG state, Draw() returns the same index as gsl_ran_discrete(),
+ consuming the same single uniform deviate.  Switching between them therefore does not change the results of a simulation run.
+
+ */
+
+#ifndef __Eidos__eidos_alias_table__
+#define __Eidos__eidos_alias_table__
+
+
+#include "eidos_rng.h"
+
+#include <stdint.h>
+#include <vector>
+
+
+class EidosAliasTable
+{
+	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
+
+private:
+	size_t count_ = 0;						// K, the number of weights in the current table; 0 if the table has not been built
+	std::vector<double> cutoffs_;			// for each bin k, (k + F[k]) / K where F[k] is the probability of keeping k; compared directly with u
+	std::vector<uint32_t> aliases_;			// for each bin k, the index drawn when k is not kept
+	
+	// scratch buffers used only during construction; kept to avoid reallocation across rebuilds
+	std::vector<double> scaled_;
+	std::vector<uint32_t> smalls_, bigs_;
+
+public:
+	EidosAliasTable(const EidosAliasTable&) = delete;					// no copying
+	EidosAliasTable& operator=(const EidosAliasTable&) = delete;		// no copying
+	EidosAliasTable(void) { }
+	~EidosAliasTable(void) { }
+	
+	// Rebuild the table for p_count weights; weights must be non-negative and p_count must be in [1, UINT32_MAX]
+	void Rebuild(size_t p_count, const double *p_weights);
+	
+	// Mark the table as not built; its buffers are kept for reuse
+	inline __attribute__((always_inline)) void Clear(void) { count_ = 0; }
+	
+	inline __attribute__((always_inline)) bool IsBuilt(void) const { return (count_ != 0); }
+	inline __attribute__((always_inline)) size_t Count(void) const { return count_; }
+	
+	// Draw one index, using one uniform deviate from p_rng exactly as gsl_ran_discrete() does
+	inline __attribute__((always_inline)) uint32_t Draw(Eidos_RNG_State &p_rng) const
+	{
+		double u = Eidos_rng_uniform(p_rng.gsl_rng_);
+		size_t bin = (size_t)(u * count_);
+		
+		return (u < cutoffs_[bin]) ? (uint32_t)bin : aliases_[bin];
+	}
+	
+	// Draw p_draw_count indices into p_indices; this is equivalent to p_draw_count calls to Draw(), but keeps the table in registers
+	void DrawMany(Eidos_RNG_State &p_rng, int32_t *p_indices, size_t p_draw_count) const;
+	
+	// Returns the number of bytes used by the table's buffers, including its scratch buffers
+	size_t MemoryUsage(void) const;
+};
+
+
+#endif /* __Eidos__eidos_alias_table__ */
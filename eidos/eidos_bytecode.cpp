@@ -0,0 +1,879 @@
+//
+//  eidos_bytecode.cpp
+//  Eidos
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "eidos_bytecode.h"
+#include "eidos_ast_node.h"
+#include "eidos_symbol_table.h"
+#include "eidos_functions.h"
+#include "eidos_script.h"
+#include "eidos_token.h"
+#include "eidos_class_Object.h"
+
+#include "gsl_randist.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+
+//
+//	EidosBytecodeCompiler
+//
+#pragma mark -
+#pragma mark EidosBytecodeCompiler
+#pragma mark -
+
+// The compiler lowers one compound statement to bytecode.  Registers are never reused; callbacks are small, and the limit of
+// EIDOS_BYTECODE_MAX_REGISTERS just means that larger blocks are left to the interpreter.  Every local variable gets a fixed
+// register.  Since the interpreter would look a local up in the enclosing scopes if it has not been assigned yet, a read of
+// a local is compiled only where it has definitely been assigned on every path; otherwise the block is not compiled.
+class EidosBytecodeCompiler
+{
+public:
+	EidosBytecode *bytecode_;
+	std::vector<int> local_registers_;			// parallel to bytecode_->locals_
+	std::vector<bool> local_assigned_;			// parallel to bytecode_->locals_; true if definitely assigned at this point
+	int pin_count_ = 0;
+	
+	explicit EidosBytecodeCompiler(EidosBytecode *p_bytecode) : bytecode_(p_bytecode) { }
+	
+	int NewRegister(void);
+	int ConstantRegister(const EidosValue *p_value);
+	int SymbolIndex(EidosGlobalStringID p_symbol);
+	int LocalIndex(EidosGlobalStringID p_symbol);
+	size_t Emit(EidosBytecodeOp p_op, int p_dest, int p_operand1, int p_operand2, int p_operand3, uint32_t p_index, const EidosASTNode *p_node);
+	
+	bool CollectLocals(const EidosASTNode *p_node);
+	int CompileExpression(const EidosASTNode *p_node);
+	int CompileCall(const EidosASTNode *p_node);
+	bool CompileStatement(const EidosASTNode *p_node, bool *p_returns);
+};
+
+int EidosBytecodeCompiler::NewRegister(void)
+{
+	if (bytecode_->register_count_ >= EIDOS_BYTECODE_MAX_REGISTERS)
+		return -1;
+	
+	return bytecode_->register_count_++;
+}
+
+int EidosBytecodeCompiler::ConstantRegister(const EidosValue *p_value)
+{
+	if (!p_value || (p_value->Count() != 1) || (p_value->DimensionCount() != 1))
+		return -1;
+	
+	EidosBytecodeSlot slot;
+	
+	switch (p_value->Type())
+	{
+		case EidosValueType::kValueLogical:	slot.type_ = EidosValueType::kValueLogical;	slot.logical_ = p_value->LogicalAtIndex(0, nullptr);	break;
+		case EidosValueType::kValueInt:		slot.type_ = EidosValueType::kValueInt;		slot.int_ = p_value->IntAtIndex(0, nullptr);			break;
+		case EidosValueType::kValueFloat:	slot.type_ = EidosValueType::kValueFloat;	slot.float_ = p_value->FloatAtIndex(0, nullptr);		break;
+		default:							return -1;
+	}
+	
+	int reg = NewRegister();
+	
+	if (reg >= 0)
+		bytecode_->constants_.emplace_back(reg, slot);
+	
+	return reg;
+}
+
+int EidosBytecodeCompiler::SymbolIndex(EidosGlobalStringID p_symbol)
+{
+	std::vector<EidosGlobalStringID> &symbols = bytecode_->symbols_;
+	auto symbol_iter = std::find(symbols.begin(), symbols.end(), p_symbol);
+	
+	if (symbol_iter != symbols.end())
+		return (int)(symbol_iter - symbols.begin());
+	
+	symbols.emplace_back(p_symbol);
+	return (int)symbols.size() - 1;
+}
+
+int EidosBytecodeCompiler::LocalIndex(EidosGlobalStringID p_symbol)
+{
+	std::vector<EidosGlobalStringID> &locals = bytecode_->locals_;
+	auto local_iter = std::find(locals.begin(), locals.end(), p_symbol);
+	
+	return (local_iter == locals.end()) ? -1 : (int)(local_iter - locals.begin());
+}
+
+size_t EidosBytecodeCompiler::Emit(EidosBytecodeOp p_op, int p_dest, int p_operand1, int p_operand2, int p_operand3, uint32_t p_index, const EidosASTNode *p_node)
+{
+	bytecode_->instructions_.emplace_back(EidosBytecodeInstruction{p_op, (uint8_t)p_dest, (uint8_t)p_operand1, (uint8_t)p_operand2, (uint8_t)p_operand3, p_index, p_node});
+	
+	return bytecode_->instructions_.size() - 1;
+}
+
+bool EidosBytecodeCompiler::CollectLocals(const EidosASTNode *p_node)
+{
+	// Find every identifier assigned to in the block and give it a register; assignments to anything but a bare identifier are not compiled
+	if (p_node->token_->token_type_ == EidosTokenType::kTokenAssign)
+	{
+		if (p_node->children_.size() != 2)
+			return false;
+		
+		const EidosASTNode *lvalue_node = p_node->children_[0];
+		
+		if ((lvalue_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || lvalue_node->cached_literal_value_)
+			return false;
+		
+		if (LocalIndex(lvalue_node->cached_stringID_) == -1)
+		{
+			int reg = NewRegister();
+			
+			if (reg < 0)
+				return false;
+			
+			bytecode_->locals_.emplace_back(lvalue_node->cached_stringID_);
+			local_registers_.emplace_back(reg);
+			local_assigned_.emplace_back(false);
+		}
+	}
+	
+	for (const EidosASTNode *child : p_node->children_)
+		if (!CollectLocals(child))
+			return false;
+	
+	return true;
+}
+
+int EidosBytecodeCompiler::CompileExpression(const EidosASTNode *p_node)
+{
+	EidosTokenType token_type = p_node->token_->token_type_;
+	size_t child_count = p_node->children_.size();
+	
+	switch (token_type)
+	{
+		case EidosTokenType::kTokenNumber:
+			return ConstantRegister(p_node->cached_literal_value_.get());
+		
+		case EidosTokenType::kTokenIdentifier:
+		{
+			// built-in constants like T and PI are cached on the node; NULL is not compiled
+			if (p_node->cached_literal_value_)
+				return ConstantRegister(p_node->cached_literal_value_.get());
+			
+			int local_index = LocalIndex(p_node->cached_stringID_);
+			
+			if (local_index != -1)
+				return local_assigned_[local_index] ? local_registers_[local_index] : -1;
+			
+			int reg = NewRegister();
+			
+			if (reg >= 0)
+				Emit(EidosBytecodeOp::kLoadSymbol, reg, 0, 0, 0, SymbolIndex(p_node->cached_stringID_), p_node);
+			
+			return reg;
+		}
+		
+		case EidosTokenType::kTokenDot:
+		{
+			if ((child_count != 2) || (p_node->children_[1]->token_->token_type_ != EidosTokenType::kTokenIdentifier) || (pin_count_ >= EIDOS_BYTECODE_MAX_PINS))
+				return -1;
+			
+			int base_reg = CompileExpression(p_node->children_[0]);
+			int reg = NewRegister();
+			
+			if ((base_reg < 0) || (reg < 0))
+				return -1;
+			
+			Emit(EidosBytecodeOp::kGetProperty, reg, base_reg, pin_count_++, 0, SymbolIndex(p_node->children_[1]->cached_stringID_), p_node->children_[1]);
+			return reg;
+		}
+		
+		case EidosTokenType::kTokenLParen:
+			return CompileCall(p_node);
+		
+		case EidosTokenType::kTokenPlus:
+		case EidosTokenType::kTokenMinus:
+		case EidosTokenType::kTokenNot:
+		case EidosTokenType::kTokenMult:
+		case EidosTokenType::kTokenDiv:
+		case EidosTokenType::kTokenMod:
+		case EidosTokenType::kTokenExp:
+		case EidosTokenType::kTokenEq:
+		case EidosTokenType::kTokenNotEq:
+		case EidosTokenType::kTokenLt:
+		case EidosTokenType::kTokenLtEq:
+		case EidosTokenType::kTokenGt:
+		case EidosTokenType::kTokenGtEq:
+		{
+			EidosBytecodeOp op;
+			
+			if (child_count == 1)
+			{
+				if (token_type == EidosTokenType::kTokenPlus)		op = EidosBytecodeOp::kUnaryPlus;
+				else if (token_type == EidosTokenType::kTokenMinus)	op = EidosBytecodeOp::kUnaryMinus;
+				else if (token_type == EidosTokenType::kTokenNot)	op = EidosBytecodeOp::kNot;
+				else return -1;
+				
+				int operand_reg = CompileExpression(p_node->children_[0]);
+				int reg = NewRegister();
+				
+				if ((operand_reg < 0) || (reg < 0))
+					return -1;
+				
+				Emit(op, reg, operand_reg, 0, 0, 0, p_node);
+				return reg;
+			}
+			
+			if (child_count != 2)
+				return -1;
+			
+			switch (token_type)
+			{
+				case EidosTokenType::kTokenPlus:	op = EidosBytecodeOp::kAdd;				break;
+				case EidosTokenType::kTokenMinus:	op = EidosBytecodeOp::kSubtract;		break;
+				case EidosTokenType::kTokenMult:	op = EidosBytecodeOp::kMultiply;		break;
+				case EidosTokenType::kTokenDiv:		op = EidosBytecodeOp::kDivide;			break;
+				case EidosTokenType::kTokenMod:		op = EidosBytecodeOp::kModulo;			break;
+				case EidosTokenType::kTokenExp:		op = EidosBytecodeOp::kPower;			break;
+				case EidosTokenType::kTokenEq:		op = EidosBytecodeOp::kEqual;			break;
+				case EidosTokenType::kTokenNotEq:	op = EidosBytecodeOp::kNotEqual;		break;
+				case EidosTokenType::kTokenLt:		op = EidosBytecodeOp::kLess;			break;
+				case EidosTokenType::kTokenLtEq:	op = EidosBytecodeOp::kLessEqual;		break;
+				case EidosTokenType::kTokenGt:		op = EidosBytecodeOp::kGreater;			break;
+				case EidosTokenType::kTokenGtEq:	op = EidosBytecodeOp::kGreaterEqual;	break;
+				default:							return -1;
+			}
+			
+			int operand1_reg = CompileExpression(p_node->children_[0]);
+			int operand2_reg = (operand1_reg < 0) ? -1 : CompileExpression(p_node->children_[1]);
+			int reg = NewRegister();
+			
+			if ((operand1_reg < 0) || (operand2_reg < 0) || (reg < 0))
+				return -1;
+			
+			Emit(op, reg, operand1_reg, operand2_reg, 0, 0, p_node);
+			return reg;
+		}
+		
+		case EidosTokenType::kTokenAnd:
+		case EidosTokenType::kTokenOr:
+		{
+			// & and | take any number of operands; like the interpreter, we evaluate all of them, left to right
+			EidosBytecodeOp op = ((token_type == EidosTokenType::kTokenAnd) ? EidosBytecodeOp::kAnd : EidosBytecodeOp::kOr);
+			
+			if (child_count < 2)
+				return -1;
+			
+			int reg = CompileExpression(p_node->children_[0]);
+			
+			for (size_t child_index = 1; child_index < child_count; ++child_index)
+			{
+				int operand_reg = (reg < 0) ? -1 : CompileExpression(p_node->children_[child_index]);
+				int result_reg = NewRegister();
+				
+				if ((operand_reg < 0) || (result_reg < 0))
+					return -1;
+				
+				Emit(op, result_reg, reg, operand_reg, 0, 0, p_node);
+				reg = result_reg;
+			}
+			
+			return reg;
+		}
+		
+		case EidosTokenType::kTokenConditional:
+		{
+			if (child_count != 3)
+				return -1;
+			
+			int condition_reg = CompileExpression(p_node->children_[0]);
+			int reg = NewRegister();
+			
+			if ((condition_reg < 0) || (reg < 0))
+				return -1;
+			
+			size_t false_jump = Emit(EidosBytecodeOp::kJumpIfFalse, 0, condition_reg, 0, 0, 0, p_node);
+			int true_reg = CompileExpression(p_node->children_[1]);
+			
+			if (true_reg < 0)
+				return -1;
+			
+			Emit(EidosBytecodeOp::kMove, reg, true_reg, 0, 0, 0, p_node);
+			size_t end_jump = Emit(EidosBytecodeOp::kJump, 0, 0, 0, 0, 0, p_node);
+			
+			bytecode_->instructions_[false_jump].index_ = (uint32_t)bytecode_->instructions_.size();
+			
+			int false_reg = CompileExpression(p_node->children_[2]);
+			
+			if (false_reg < 0)
+				return -1;
+			
+			Emit(EidosBytecodeOp::kMove, reg, false_reg, 0, 0, 0, p_node);
+			bytecode_->instructions_[end_jump].index_ = (uint32_t)bytecode_->instructions_.size();
+			
+			return reg;
+		}
+		
+		default:
+			return -1;
+	}
+}
+
+int EidosBytecodeCompiler::CompileCall(const EidosASTNode *p_node)
+{
+	// Only a few pure math functions are compiled, and only with positional arguments; we identify them by their internal
+	// function pointer, so that a Context-defined function of the same name could never be mistaken for them
+	const std::vector<EidosASTNode *> &children = p_node->children_;
+	
+	if (children.size() < 2)
+		return -1;
+	
+	const EidosASTNode *call_name_node = children[0];
+	const EidosFunctionSignature *signature = call_name_node->cached_signature_.get();
+	
+	if ((call_name_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || !signature)
+		return -1;
+	
+	for (size_t child_index = 1; child_index < children.size(); ++child_index)
+		if (children[child_index]->token_->token_type_ == EidosTokenType::kTokenAssign)
+			return -1;
+	
+	EidosInternalFunctionPtr function = signature->internal_function_;
+	size_t arg_count = children.size() - 1;
+	EidosBytecodeOp op;
+	
+	if ((function == &Eidos_ExecuteFunction_abs) && (arg_count == 1))			op = EidosBytecodeOp::kAbs;
+	else if ((function == &Eidos_ExecuteFunction_exp) && (arg_count == 1))		op = EidosBytecodeOp::kExp;
+	else if ((function == &Eidos_ExecuteFunction_log) && (arg_count == 1))		op = EidosBytecodeOp::kLog;
+	else if ((function == &Eidos_ExecuteFunction_sqrt) && (arg_count == 1))	op = EidosBytecodeOp::kSqrt;
+	else if ((function == &Eidos_ExecuteFunction_dnorm) && (arg_count <= 3))	op = EidosBytecodeOp::kDnorm;
+	else return -1;
+	
+	int operand_regs[3];
+	
+	for (size_t arg_index = 0; arg_index < 3; ++arg_index)
+	{
+		if (arg_index < arg_count)
+			operand_regs[arg_index] = CompileExpression(children[arg_index + 1]);
+		else if (op == EidosBytecodeOp::kDnorm)
+			operand_regs[arg_index] = ConstantRegister((arg_index == 1) ? gStaticEidosValue_Float0.get() : gStaticEidosValue_Float1.get());
+		else
+			operand_regs[arg_index] = 0;
+		
+		if (operand_regs[arg_index] < 0)
+			return -1;
+	}
+	
+	int reg = NewRegister();
+	
+	if (reg >= 0)
+		Emit(op, reg, operand_regs[0], operand_regs[1], operand_regs[2], 0, call_name_node);
+	
+	return reg;
+}
+
+bool EidosBytecodeCompiler::CompileStatement(const EidosASTNode *p_node, bool *p_returns)
+{
+	EidosTokenType token_type = p_node->token_->token_type_;
+	size_t child_count = p_node->children_.size();
+	
+	*p_returns = false;
+	
+	switch (token_type)
+	{
+		case EidosTokenType::kTokenSemicolon:
+			return true;
+		
+		case EidosTokenType::kTokenLBrace:
+		{
+			for (const EidosASTNode *child : p_node->children_)
+			{
+				if (!CompileStatement(child, p_returns))
+					return false;
+				
+				// statements after a return are never executed, so they do not need to be compiled
+				if (*p_returns)
+					break;
+			}
+			return true;
+		}
+		
+		case EidosTokenType::kTokenAssign:
+		{
+			int value_reg = CompileExpression(p_node->children_[1]);
+			
+			if (value_reg < 0)
+				return false;
+			
+			int local_index = LocalIndex(p_node->children_[0]->cached_stringID_);
+			
+			Emit(EidosBytecodeOp::kMove, local_registers_[local_index], value_reg, 0, 0, 0, p_node);
+			local_assigned_[local_index] = true;
+			return true;
+		}
+		
+		case EidosTokenType::kTokenReturn:
+		{
+			// a return with no value makes the block return void, which the interpreter can deal with
+			if (child_count != 1)
+				return false;
+			
+			int value_reg = CompileExpression(p_node->children_[0]);
+			
+			if (value_reg < 0)
+				return false;
+			
+			Emit(EidosBytecodeOp::kReturn, 0, value_reg, 0, 0, 0, p_node);
+			*p_returns = true;
+			return true;
+		}
+		
+		case EidosTokenType::kTokenIf:
+		{
+			if ((child_count != 2) && (child_count != 3))
+				return false;
+			
+			int condition_reg = CompileExpression(p_node->children_[0]);
+			
+			if (condition_reg < 0)
+				return false;
+			
+			size_t false_jump = Emit(EidosBytecodeOp::kJumpIfFalse, 0, condition_reg, 0, 0, 0, p_node);
+			std::vector<bool> assigned_before = local_assigned_;
+			bool true_returns, false_returns = false;
+			
+			if (!CompileStatement(p_node->children_[1], &true_returns))
+				return false;
+			
+			std::vector<bool> assigned_true = std::move(local_assigned_);
+			
+			local_assigned_ = assigned_before;
+			
+			if (child_count == 3)
+			{
+				size_t end_jump = 0;
+				
+				if (!true_returns)
+					end_jump = Emit(EidosBytecodeOp::kJump, 0, 0, 0, 0, 0, p_node);
+				
+				bytecode_->instructions_[false_jump].index_ = (uint32_t)bytecode_->instructions_.size();
+				
+				if (!CompileStatement(p_node->children_[2], &false_returns))
+					return false;
+				
+				if (!true_returns)
+					bytecode_->instructions_[end_jump].index_ = (uint32_t)bytecode_->instructions_.size();
+			}
+			else
+			{
+				bytecode_->instructions_[false_jump].index_ = (uint32_t)bytecode_->instructions_.size();
+			}
+			
+			// a local is definitely assigned after the if if it is assigned on every branch that does not return
+			if (false_returns)
+				local_assigned_ = assigned_true;
+			else if (!true_returns)
+				for (size_t local_index = 0; local_index < local_assigned_.size(); ++local_index)
+					local_assigned_[local_index] = local_assigned_[local_index] && assigned_true[local_index];
+			
+			*p_returns = (true_returns && false_returns);
+			return true;
+		}
+		
+		default:
+			// loops, bare expressions, and everything else are left to the interpreter
+			return false;
+	}
+}
+
+
+//
+//	EidosBytecode
+//
+#pragma mark -
+#pragma mark EidosBytecode
+#pragma mark -
+
+EidosBytecode *EidosBytecode::Compile(const EidosASTNode *p_block_node)
+{
+	if (!p_block_node || (p_block_node->token_->token_type_ != EidosTokenType::kTokenLBrace))
+		return nullptr;
+	
+	EidosBytecode *bytecode = new EidosBytecode();
+	EidosBytecodeCompiler compiler(bytecode);
+	bool returns = false;
+	
+	// the block must compile completely, and must not be able to fall off its end, since it would then return void
+	if (!compiler.CollectLocals(p_block_node) || !compiler.CompileStatement(p_block_node, &returns) || !returns)
+	{
+		delete bytecode;
+		return nullptr;
+	}
+	
+	return bytecode;
+}
+
+// Convert a register to a condition the way EidosValue::LogicalAtIndex() does; returns false if that would raise
+static inline __attribute__((always_inline)) bool Eidos_BytecodeSlotToLogical(const EidosBytecodeSlot &p_slot, bool *p_logical)
+{
+	switch (p_slot.type_)
+	{
+		case EidosValueType::kValueLogical:	*p_logical = p_slot.logical_;		return true;
+		case EidosValueType::kValueInt:		*p_logical = (p_slot.int_ != 0);	return true;
+		case EidosValueType::kValueFloat:
+			if (std::isnan(p_slot.float_))
+				return false;
+			*p_logical = (p_slot.float_ != 0.0);
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool EidosBytecode::Execute(const EidosSymbolTable &p_symbols, EidosScript *p_script_for_block, EidosBytecodeSlot *p_result)
+{
+	execution_count_++;
+	
+	// A local variable defined outside the block would be a constant (which the interpreter would refuse to assign) or a
+	// global variable (which the interpreter would read before assignment), so in either case we leave it to the interpreter
+	for (EidosGlobalStringID local : locals_)
+		if (p_symbols.ContainsSymbol(local))
+			return Fallback();
+	
+	EidosBytecodeSlot registers[EIDOS_BYTECODE_MAX_REGISTERS];
+	EidosValue_SP pins[EIDOS_BYTECODE_MAX_PINS];		// keeps object values from property getters alive while in registers
+	
+	// Registers are typed void until set, so that operand type checks never read garbage; then constants are loaded
+	for (int reg = 0; reg < register_count_; ++reg)
+		registers[reg].type_ = EidosValueType::kValueVOID;
+	
+	for (const std::pair<int, EidosBytecodeSlot> &constant : constants_)
+		registers[constant.first] = constant.second;
+	
+	// Blocks constructed at runtime have their own script, and errors from property getters need to be reported against it;
+	// see EidosInterpreter::EvaluateInternalBlock().  A raise blows through the restore, which is what error reporting wants.
+	bool redirect_error_context = ((p_script_for_block != nullptr) && (p_script_for_block != gEidosErrorContext.currentScript));
+	EidosErrorContext error_context_save;
+	
+	if (redirect_error_context)
+	{
+		error_context_save = gEidosErrorContext;
+		gEidosErrorContext = EidosErrorContext{{-1, -1, -1, -1}, p_script_for_block, true};
+	}
+	
+	const EidosBytecodeInstruction *instructions = instructions_.data();
+	const EidosBytecodeInstruction *instruction = instructions;
+	bool completed = false;
+	
+	while (true)
+	{
+		EidosBytecodeSlot &dest = registers[instruction->dest_];
+		const EidosBytecodeSlot &operand1 = registers[instruction->operand1_];
+		const EidosBytecodeSlot &operand2 = registers[instruction->operand2_];
+		EidosValueType type1 = operand1.type_;
+		EidosValueType type2 = operand2.type_;
+		bool numeric1 = ((type1 == EidosValueType::kValueInt) || (type1 == EidosValueType::kValueFloat));
+		bool numeric2 = ((type2 == EidosValueType::kValueInt) || (type2 == EidosValueType::kValueFloat));
+		
+		switch (instruction->op_)
+		{
+			case EidosBytecodeOp::kLoadSymbol:
+			{
+				// this raises for an undefined symbol exactly as EidosInterpreter::Evaluate_Identifier() would
+				EidosValue_SP value_SP = p_symbols.GetValueOrRaiseForASTNode(instruction->node_);
+				EidosValue *value = value_SP.get();
+				
+				if ((value->Count() != 1) || (value->DimensionCount() != 1))
+					goto fallback;
+				
+				switch (value->Type())
+				{
+					case EidosValueType::kValueLogical:	dest.type_ = EidosValueType::kValueLogical;	dest.logical_ = value->LogicalAtIndex(0, nullptr);			break;
+					case EidosValueType::kValueInt:		dest.type_ = EidosValueType::kValueInt;		dest.int_ = value->IntAtIndex(0, nullptr);					break;
+					case EidosValueType::kValueFloat:	dest.type_ = EidosValueType::kValueFloat;	dest.float_ = value->FloatAtIndex(0, nullptr);				break;
+					case EidosValueType::kValueObject:	dest.type_ = EidosValueType::kValueObject;	dest.object_ = value->ObjectElementAtIndex(0, nullptr);	break;
+					default:							goto fallback;
+				}
+				break;
+			}
+			case EidosBytecodeOp::kMove:
+				dest = operand1;
+				break;
+			case EidosBytecodeOp::kGetProperty:
+			{
+				if (type1 != EidosValueType::kValueObject)
+					goto fallback;
+				
+				EidosObject *object = operand1.object_;
+				EidosGlobalStringID property_id = symbols_[instruction->index_];
+				
+				if (!object->Class()->SignatureForProperty(property_id))
+					goto fallback;
+				
+				EidosErrorPosition error_pos_save = PushErrorPositionFromToken(instruction->node_->token_);
+				EidosValue_SP value_SP = object->GetProperty(property_id);
+				
+				RestoreErrorPosition(error_pos_save);
+				
+				EidosValue *value = value_SP.get();
+				
+				if ((value->Count() != 1) || (value->DimensionCount() != 1))
+					goto fallback;
+				
+				switch (value->Type())
+				{
+					case EidosValueType::kValueLogical:	dest.type_ = EidosValueType::kValueLogical;	dest.logical_ = value->LogicalAtIndex(0, nullptr);	break;
+					case EidosValueType::kValueInt:		dest.type_ = EidosValueType::kValueInt;		dest.int_ = value->IntAtIndex(0, nullptr);			break;
+					case EidosValueType::kValueFloat:	dest.type_ = EidosValueType::kValueFloat;	dest.float_ = value->FloatAtIndex(0, nullptr);		break;
+					case EidosValueType::kValueObject:
+						dest.type_ = EidosValueType::kValueObject;
+						dest.object_ = value->ObjectElementAtIndex(0, nullptr);
+						pins[instruction->operand2_] = std::move(value_SP);
+						break;
+					default:							goto fallback;
+				}
+				break;
+			}
+			case EidosBytecodeOp::kUnaryPlus:
+				if (!numeric1)
+					goto fallback;
+				dest = operand1;
+				break;
+			case EidosBytecodeOp::kUnaryMinus:
+				if (type1 == EidosValueType::kValueInt)
+				{
+					int64_t result;
+					
+					if (Eidos_sub_overflow((int64_t)0, operand1.int_, &result))
+						goto fallback;
+					dest.type_ = EidosValueType::kValueInt;
+					dest.int_ = result;
+				}
+				else if (type1 == EidosValueType::kValueFloat)
+				{
+					dest.type_ = EidosValueType::kValueFloat;
+					dest.float_ = -operand1.float_;
+				}
+				else
+					goto fallback;
+				break;
+			case EidosBytecodeOp::kNot:
+			{
+				bool logical;
+				
+				if (!Eidos_BytecodeSlotToLogical(operand1, &logical))
+					goto fallback;
+				dest.type_ = EidosValueType::kValueLogical;
+				dest.logical_ = !logical;
+				break;
+			}
+			case EidosBytecodeOp::kAdd:
+			case EidosBytecodeOp::kSubtract:
+			case EidosBytecodeOp::kMultiply:
+			{
+				if (!numeric1 || !numeric2)
+					goto fallback;
+				
+				if ((type1 == EidosValueType::kValueInt) && (type2 == EidosValueType::kValueInt))
+				{
+					// integer arithmetic is overflow-checked, as in the interpreter
+					int64_t result;
+					bool overflow;
+					
+					if (instruction->op_ == EidosBytecodeOp::kAdd)				overflow = Eidos_add_overflow(operand1.int_, operand2.int_, &result);
+					else if (instruction->op_ == EidosBytecodeOp::kSubtract)	overflow = Eidos_sub_overflow(operand1.int_, operand2.int_, &result);
+					else														overflow = Eidos_mul_overflow(operand1.int_, operand2.int_, &result);
+					
+					if (overflow)
+						goto fallback;
+					dest.type_ = EidosValueType::kValueInt;
+					dest.int_ = result;
+				}
+				else
+				{
+					double x = ((type1 == EidosValueType::kValueInt) ? (double)operand1.int_ : operand1.float_);
+					double y = ((type2 == EidosValueType::kValueInt) ? (double)operand2.int_ : operand2.float_);
+					
+					dest.type_ = EidosValueType::kValueFloat;
+					
+					if (instruction->op_ == EidosBytecodeOp::kAdd)				dest.float_ = x + y;
+					else if (instruction->op_ == EidosBytecodeOp::kSubtract)	dest.float_ = x - y;
+					else														dest.float_ = x * y;
+				}
+				break;
+			}
+			case EidosBytecodeOp::kDivide:
+			case EidosBytecodeOp::kModulo:
+			case EidosBytecodeOp::kPower:
+			{
+				// these always produce float, even for integer operands
+				if (!numeric1 || !numeric2)
+					goto fallback;
+				
+				double x = ((type1 == EidosValueType::kValueInt) ? (double)operand1.int_ : operand1.float_);
+				double y = ((type2 == EidosValueType::kValueInt) ? (double)operand2.int_ : operand2.float_);
+				
+				dest.type_ = EidosValueType::kValueFloat;
+				
+				if (instruction->op_ == EidosBytecodeOp::kDivide)		dest.float_ = x / y;
+				else if (instruction->op_ == EidosBytecodeOp::kModulo)	dest.float_ = fmod(x, y);
+				else													dest.float_ = pow(x, y);
+				break;
+			}
+			case EidosBytecodeOp::kEqual:
+			case EidosBytecodeOp::kNotEqual:
+			case EidosBytecodeOp::kLess:
+			case EidosBytecodeOp::kLessEqual:
+			case EidosBytecodeOp::kGreater:
+			case EidosBytecodeOp::kGreaterEqual:
+			{
+				// comparisons promote to the higher of the two operand types; logical promotes to integer exactly
+				if ((type1 == EidosValueType::kValueObject) || (type2 == EidosValueType::kValueObject))
+					goto fallback;
+				
+				int comparison;
+				
+				if ((type1 == EidosValueType::kValueFloat) || (type2 == EidosValueType::kValueFloat))
+				{
+					double x = ((type1 == EidosValueType::kValueFloat) ? operand1.float_ : ((type1 == EidosValueType::kValueInt) ? (double)operand1.int_ : (double)operand1.logical_));
+					double y = ((type2 == EidosValueType::kValueFloat) ? operand2.float_ : ((type2 == EidosValueType::kValueInt) ? (double)operand2.int_ : (double)operand2.logical_));
+					
+					switch (instruction->op_)
+					{
+						case EidosBytecodeOp::kEqual:		comparison = (x == y);	break;
+						case EidosBytecodeOp::kNotEqual:	comparison = (x != y);	break;
+						case EidosBytecodeOp::kLess:		comparison = (x < y);	break;
+						case EidosBytecodeOp::kLessEqual:	comparison = (x <= y);	break;
+						case EidosBytecodeOp::kGreater:		comparison = (x > y);	break;
+						default:							comparison = (x >= y);	break;
+					}
+				}
+				else
+				{
+					int64_t x = ((type1 == EidosValueType::kValueInt) ? operand1.int_ : (int64_t)operand1.logical_);
+					int64_t y = ((type2 == EidosValueType::kValueInt) ? operand2.int_ : (int64_t)operand2.logical_);
+					
+					switch (instruction->op_)
+					{
+						case EidosBytecodeOp::kEqual:		comparison = (x == y);	break;
+						case EidosBytecodeOp::kNotEqual:	comparison = (x != y);	break;
+						case EidosBytecodeOp::kLess:		comparison = (x < y);	break;
+						case EidosBytecodeOp::kLessEqual:	comparison = (x <= y);	break;
+						case EidosBytecodeOp::kGreater:		comparison = (x > y);	break;
+						default:							comparison = (x >= y);	break;
+					}
+				}
+				
+				dest.type_ = EidosValueType::kValueLogical;
+				dest.logical_ = (eidos_logical_t)comparison;
+				break;
+			}
+			case EidosBytecodeOp::kAnd:
+			case EidosBytecodeOp::kOr:
+			{
+				bool logical1, logical2;
+				
+				if (!Eidos_BytecodeSlotToLogical(operand1, &logical1) || !Eidos_BytecodeSlotToLogical(operand2, &logical2))
+					goto fallback;
+				dest.type_ = EidosValueType::kValueLogical;
+				dest.logical_ = ((instruction->op_ == EidosBytecodeOp::kAnd) ? (logical1 && logical2) : (logical1 || logical2));
+				break;
+			}
+			case EidosBytecodeOp::kAbs:
+				if (type1 == EidosValueType::kValueInt)
+				{
+					if (operand1.int_ == INT64_MIN)
+						goto fallback;
+					dest.type_ = EidosValueType::kValueInt;
+					dest.int_ = llabs(operand1.int_);
+				}
+				else if (type1 == EidosValueType::kValueFloat)
+				{
+					dest.type_ = EidosValueType::kValueFloat;
+					dest.float_ = fabs(operand1.float_);
+				}
+				else
+					goto fallback;
+				break;
+			case EidosBytecodeOp::kExp:
+			case EidosBytecodeOp::kLog:
+			case EidosBytecodeOp::kSqrt:
+			{
+				if (!numeric1)
+					goto fallback;
+				
+				double x = ((type1 == EidosValueType::kValueInt) ? (double)operand1.int_ : operand1.float_);
+				
+				dest.type_ = EidosValueType::kValueFloat;
+				
+				if (instruction->op_ == EidosBytecodeOp::kExp)		dest.float_ = exp(x);
+				else if (instruction->op_ == EidosBytecodeOp::kLog)	dest.float_ = log(x);
+				else												dest.float_ = sqrt(x);
+				break;
+			}
+			case EidosBytecodeOp::kDnorm:
+			{
+				// x must be float, as declared by dnorm()'s signature; mean and sd may be integer
+				const EidosBytecodeSlot &operand3 = registers[instruction->operand3_];
+				EidosValueType type3 = operand3.type_;
+				
+				if ((type1 != EidosValueType::kValueFloat) || !numeric2 || ((type3 != EidosValueType::kValueInt) && (type3 != EidosValueType::kValueFloat)))
+					goto fallback;
+				
+				double mu = ((type2 == EidosValueType::kValueInt) ? (double)operand2.int_ : operand2.float_);
+				double sigma = ((type3 == EidosValueType::kValueInt) ? (double)operand3.int_ : operand3.float_);
+				
+				if (!(sigma > 0.0))
+					goto fallback;
+				
+				dest.type_ = EidosValueType::kValueFloat;
+				dest.float_ = gsl_ran_gaussian_pdf(operand1.float_ - mu, sigma);
+				break;
+			}
+			case EidosBytecodeOp::kJump:
+				instruction = instructions + instruction->index_;
+				continue;
+			case EidosBytecodeOp::kJumpIfFalse:
+			{
+				bool logical;
+				
+				if (!Eidos_BytecodeSlotToLogical(operand1, &logical))
+					goto fallback;
+				
+				if (!logical)
+				{
+					instruction = instructions + instruction->index_;
+					continue;
+				}
+				break;
+			}
+			case EidosBytecodeOp::kReturn:
+				*p_result = operand1;
+				completed = true;
+				goto done;
+		}
+		
+		instruction++;
+	}
+
+fallback:
+done:
+	if (redirect_error_context)
+		gEidosErrorContext = error_context_save;
+	
+	return (completed ? true : Fallback());
+}
+
@@ -0,0 +1,166 @@
+//
+//  eidos_bytecode.h
+//  Eidos
+//
+//  Copyright (c) 2021 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+
+ EidosBytecode is a compact, register-based form of a small compound statement, such as the body of a callback in a Context.
+ Callbacks are often executed millions of times, and most are simple arithmetic on a few singleton values; for them, walking
+ the AST with EidosInterpreter, which allocates an EidosValue for every intermediate result, costs far more than the work
+ itself.  EidosBytecode::Compile() lowers an optimized AST to a linear sequence of instructions over typed registers, each
+ of which holds a singleton logical, integer, float, or object value unboxed; executing that sequence allocates nothing
+ except what property getters allocate.
+
+ Only a subset of Eidos is compiled: numeric and logical literals; identifiers that are either read from the symbol table
+ or assigned as local variables within the block; property access through singleton objects; the arithmetic, comparison,
+ and logical operators; the ternary conditional; if/else; return; and a few pure math functions (abs(), exp(), log(),
+ sqrt(), and dnorm() with positional arguments).  Every path through the block must end in a return.  Compile() returns
+ nullptr for anything else, and the caller then uses EidosInterpreter as usual.
+
+ At runtime, a compiled block can still encounter values it does not handle: a symbol that is NULL or not a singleton, an
+ integer overflow, a type combination that the interpreter would reject, and so forth.  In all such cases Execute() returns
+ false and the caller falls back to EidosInterpreter, which produces the correct result or error.  This is safe because
+ compiled code has no side effects (it assigns only registers, never symbols), so abandoning it partway is invisible; the
+ interpreter simply starts over.  The fallback is also how errors are reported with the interpreter's usual messages.
+
+ */
+
+#ifndef __Eidos__eidos_bytecode__
+#define __Eidos__eidos_bytecode__
+
+
+#include <vector>
+#include <utility>
+
+#include "eidos_globals.h"
+#include "eidos_value.h"
+
+class EidosASTNode;
+class EidosScript;
+class EidosSymbolTable;
+
+
+// The maximum number of registers and pinned object values a compiled block may use; blocks needing more are not compiled
+#define EIDOS_BYTECODE_MAX_REGISTERS	256
+#define EIDOS_BYTECODE_MAX_PINS			16
+
+// After this many fallbacks, a compiled block that falls back on more than 1 in 8 executions is no longer executed
+#define EIDOS_BYTECODE_FALLBACK_GRACE	64
+
+
+enum class EidosBytecodeOp : uint8_t {
+	kLoadSymbol = 0,	// dest = the value of symbols_[index_] in the symbol table
+	kMove,				// dest = operand1
+	kGetProperty,		// dest = operand1.symbols_[index_]; the value is pinned in pin operand2 if it is an object
+	kUnaryPlus,			// dest = +operand1
+	kUnaryMinus,		// dest = -operand1
+	kNot,				// dest = !operand1
+	kAdd,				// dest = operand1 + operand2
+	kSubtract,			// dest = operand1 - operand2
+	kMultiply,			// dest = operand1 * operand2
+	kDivide,			// dest = operand1 / operand2
+	kModulo,			// dest = operand1 % operand2
+	kPower,				// dest = operand1 ^ operand2
+	kEqual,				// dest = operand1 == operand2
+	kNotEqual,			// dest = operand1 != operand2
+	kLess,				// dest = operand1 < operand2
+	kLessEqual,			// dest = operand1 <= operand2
+	kGreater,			// dest = operand1 > operand2
+	kGreaterEqual,		// dest = operand1 >= operand2
+	kAnd,				// dest = operand1 & operand2
+	kOr,				// dest = operand1 | operand2
+	kAbs,				// dest = abs(operand1)
+	kExp,				// dest = exp(operand1)
+	kLog,				// dest = log(operand1)
+	kSqrt,				// dest = sqrt(operand1)
+	kDnorm,				// dest = dnorm(operand1, operand2, operand3)
+	kJump,				// continue at instruction index_
+	kJumpIfFalse,		// continue at instruction index_ if operand1 is false
+	kReturn,			// return operand1
+};
+
+typedef struct {
+	EidosBytecodeOp op_;
+	uint8_t dest_;				// destination register
+	uint8_t operand1_;			// first operand register
+	uint8_t operand2_;			// second operand register (or pin index, for kGetProperty)
+	uint8_t operand3_;			// third operand register
+	uint32_t index_;			// symbol index or jump target
+	const EidosASTNode *node_;	// the node to blame for errors, for kLoadSymbol and kGetProperty
+} EidosBytecodeInstruction;
+
+// A typed register, holding an unboxed singleton value; type_ is kValueLogical, kValueInt, kValueFloat, or kValueObject
+typedef struct {
+	EidosValueType type_;
+	union {
+		eidos_logical_t logical_;
+		int64_t int_;
+		double float_;
+		EidosObject *object_;
+	};
+} EidosBytecodeSlot;
+
+
+class EidosBytecode
+{
+	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
+
+private:
+	std::vector<EidosBytecodeInstruction> instructions_;
+	std::vector<std::pair<int, EidosBytecodeSlot>> constants_;	// registers holding constants, with their values
+	std::vector<EidosGlobalStringID> symbols_;			// identifiers and property names referenced by instructions
+	std::vector<EidosGlobalStringID> locals_;			// local variables assigned by the block, which must not be defined outside it
+	int register_count_ = 0;
+	
+	int64_t execution_count_ = 0;						// the number of calls to Execute()
+	int64_t fallback_count_ = 0;						// the number of those calls that returned false
+	
+	friend class EidosBytecodeCompiler;
+	
+	EidosBytecode(void) { }
+	
+	inline __attribute__((always_inline)) bool Fallback(void) { fallback_count_++; return false; }
+
+public:
+	EidosBytecode(const EidosBytecode&) = delete;					// no copying
+	EidosBytecode& operator=(const EidosBytecode&) = delete;		// no copying
+	~EidosBytecode(void) { }
+	
+	// Compile a compound statement node from an optimized AST; returns nullptr if the block uses anything not supported.
+	// The returned object is owned by the caller, and must not outlive the AST, whose tokens it references.
+	static EidosBytecode *Compile(const EidosASTNode *p_block_node);
+	
+	// Execute with the given symbol table, which should be set up exactly as it would be for EidosInterpreter.  Returns
+	// true with the returned value in p_result, or false if the interpreter must be used instead; see the header comment.
+	// p_script_for_block should be the same script passed to EidosInterpreter::EvaluateInternalBlock(), for error tracking.
+	bool Execute(const EidosSymbolTable &p_symbols, EidosScript *p_script_for_block, EidosBytecodeSlot *p_result);
+	
+	// Returns false if Execute() should not be called, because it falls back too often to be worthwhile, or because
+	// profiling is active and the interpreter's per-node profile counts would otherwise be missing for this block
+	inline bool ShouldExecute(void) const
+	{
+#if (SLIMPROFILING == 1)
+		if (gEidosProfilingClientCount)
+			return false;
+#endif
+		return ((fallback_count_ < EIDOS_BYTECODE_FALLBACK_GRACE) || (fallback_count_ * 8 <= execution_count_));
+	}
+};
+
+
+#endif /* __Eidos__eidos_bytecode__ */
+
@@ -78,7 +78,7 @@ EidosSymbolTable *gEidosConstantsSymbolTable = nullptr;
 #pragma mark Profiling support
 #pragma mark -
 
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#if (SLIMPROFILING == 1)
 // PROFILING
 
 int gEidosProfilingClientCount = 0;
@@ -170,7 +170,7 @@ void Eidos_PrepareForProfiling(void)
 	//std::cout << "Profile lag internal to block: " << gEidos_ProfileLag_double << " ticks, " << gEidos_ProfileLagSeconds << " seconds" << std::endl;
 }
 
-#endif	// (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif	// (SLIMPROFILING == 1)
 
 
 #pragma mark -
@@ -501,6 +501,9 @@ int gEidosErrorLine = -1, gEidosErrorLineCharacter = -1;
 // Warnings
 bool gEidosSuppressWarnings = false;
 
+// Multithreading
+int gEidosMaxThreads = 1;
+
 
 // define string stream used for output when gEidosTerminateThrows == 1; otherwise, terminates call exit()
 bool gEidosTerminateThrows = true;
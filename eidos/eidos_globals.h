@@ -33,14 +33,14 @@
 #include <algorithm>
 #include <unordered_map>
 
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#if (SLIMPROFILING == 1)
 
 #if defined(__APPLE__) && defined(__MACH__)
-// On macOS we use mach_absolute_time() for profiling (only in SLiMgui when profiling is enabled)
+// On macOS we use mach_absolute_time() for profiling (only when SLIMPROFILING is enabled, for SLiMgui and slim -profile)
 #include <mach/mach_time.h>
 #define MACH_PROFILING
 #else
-// On other platforms we use std::chrono::steady_clock (only in QtSLiM when profiling is enabled)
+// On other platforms we use std::chrono::steady_clock (only when SLIMPROFILING is enabled, for QtSLiM and slim -profile)
 #include <chrono>
 #define CHRONO_PROFILING
 #endif
@@ -149,6 +149,10 @@ extern int gEidosErrorLine, gEidosErrorLineCharacter;	// set up by EidosTerminat
 // Warnings: consult this flag before emitting a warning
 extern bool gEidosSuppressWarnings;
 
+// Multithreading: the maximum number of threads the Context may use for work it has parallelized (set by slim -threads).
+// The default of 1 means that all work is done on the main thread, with results identical to those of a non-threaded build.
+extern int gEidosMaxThreads;
+
 
 // *******************************************************************************************************************
 //
@@ -206,7 +210,7 @@ void Eidos_CheckRSSAgainstMax(std::string p_message1, std::string p_message2);
 #pragma mark Profiling support
 #pragma mark -
 
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#if (SLIMPROFILING == 1)
 // PROFILING
 
 extern int gEidosProfilingClientCount;	// if non-zero, profiling is happening in some context
@@ -222,7 +226,7 @@ extern double gEidos_ProfileLagSeconds;			// the clocked length of an empty prof
 #if defined(MACH_PROFILING)
 
 // This is the fastest clock, is available across OS X versions, and gives us nanoseconds.  The only disadvantage to
-// it is that it is platform-specific, so we can only use this clock in SLiMgui and Eidos_GUI.  That is OK.  This
+// it is that it is platform-specific, so we can only use this clock on macOS.  That is OK.  This
 // returns uint64_t in CPU-specific time units; see https://developer.apple.com/library/content/qa/qa1398/_index.html
 typedef uint64_t eidos_profile_t;
 
@@ -302,7 +306,7 @@ void Eidos_PrepareForProfiling(void);
 		(slim__accumulator) += slim__corrected_ticks;																														\
 	}
 
-#endif	// (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif	// (SLIMPROFILING == 1)
 
 
 // *******************************************************************************************************************
@@ -24,7 +24,8 @@
 #include <sys/time.h>
 
 
-Eidos_RNG_State gEidos_RNG;
+thread_local Eidos_RNG_State gEidos_RNG;
+std::vector<Eidos_RNG_State> gEidos_RNG_Streams;
 
 
 unsigned long int Eidos_GenerateSeedFromPIDAndTime(void)
@@ -43,16 +44,16 @@ unsigned long int Eidos_GenerateSeedFromPIDAndTime(void)
 	return (unsigned long int)milliseconds;
 }
 
-void Eidos_InitializeRNG(void)
+void Eidos_InitializeRNG(Eidos_RNG_State &p_rng)
 {
 	// Allocate the RNG if needed
-	if (!gEidos_RNG.gsl_rng_)
-		gEidos_RNG.gsl_rng_ = gsl_rng_alloc(gsl_rng_taus2);	// the assumption of taus2 is hard-coded in eidos_rng.h
+	if (!p_rng.gsl_rng_)
+		p_rng.gsl_rng_ = gsl_rng_alloc(gsl_rng_taus2);	// the assumption of taus2 is hard-coded in eidos_rng.h
 	
-	if (!gEidos_RNG.mt_)
+	if (!p_rng.mt_)
 	{
-		gEidos_RNG.mt_ = (uint64_t *)malloc(Eidos_MT64_NN * sizeof(uint64_t));
-		gEidos_RNG.mti_ = Eidos_MT64_NN + 1;				// mti==NN+1 means mt[NN] is not initialized
+		p_rng.mt_ = (uint64_t *)malloc(Eidos_MT64_NN * sizeof(uint64_t));
+		p_rng.mti_ = Eidos_MT64_NN + 1;				// mti==NN+1 means mt[NN] is not initialized
 	}
 }
 
@@ -75,29 +76,47 @@ void Eidos_FreeRNG(Eidos_RNG_State &p_rng)
 	p_rng.random_bool_bit_counter_ = 0;
 }
 
-void Eidos_SetRNGSeed(unsigned long int p_seed)
+void Eidos_SetRNGSeed(Eidos_RNG_State &p_rng, unsigned long int p_seed)
 {
 	// BCH 12 Sept. 2016: it turns out that gsl_rng_taus2 produces exactly the same sequence for seeds 0 and 1.  This is obviously
 	// undesirable; people will often do a set of runs with sequential seeds starting at 0 and counting up, and they will get
 	// identical runs for 0 and 1.  There is no way to re-map the seed space to get rid of the problem altogether; all we can do
 	// is shift it to a place where it is unlikely to cause a problem.  So that's what we do.
 	if ((p_seed > 0) && (p_seed < 10000000000000000000UL))
-		gsl_rng_set(gEidos_RNG.gsl_rng_, p_seed + 1);	// map 1 -> 2, 2-> 3, 3-> 4, etc.
+		gsl_rng_set(p_rng.gsl_rng_, p_seed + 1);	// map 1 -> 2, 2-> 3, 3-> 4, etc.
 	else
-		gsl_rng_set(gEidos_RNG.gsl_rng_, p_seed);		// 0 stays 0
+		gsl_rng_set(p_rng.gsl_rng_, p_seed);		// 0 stays 0
 	
 	// BCH 13 May 2018: set the seed on the MT64 generator as well; we keep them synchronized in their seeding
-	Eidos_MT64_init_genrand64(p_seed);
+	Eidos_MT64_init_genrand64(p_rng, p_seed);
 	
 	// remember the seed as part of the RNG state
 	
 	// BCH 12 Sept. 2016: we want to return the user the same seed they requested, if they call getSeed(), so we save the requested
 	// seed, not the seed shifted by one that is actually passed to the GSL above.
-	gEidos_RNG.rng_last_seed_ = p_seed;
+	p_rng.rng_last_seed_ = p_seed;
 	
 	// These need to be zeroed out, too; they are part of our RNG state
-	gEidos_RNG.random_bool_bit_counter_ = 0;
-	gEidos_RNG.random_bool_bit_buffer_ = 0;
+	p_rng.random_bool_bit_counter_ = 0;
+	p_rng.random_bool_bit_buffer_ = 0;
+}
+
+void Eidos_PrepareRNGStreams(int p_count)
+{
+	// Streams are allocated here, on the main thread, and are then used by worker threads; they are seeded by their users
+	while ((int)gEidos_RNG_Streams.size() < p_count)
+	{
+		gEidos_RNG_Streams.emplace_back();
+		Eidos_InitializeRNG(gEidos_RNG_Streams.back());
+	}
+}
+
+void Eidos_FreeRNGStreams(void)
+{
+	for (Eidos_RNG_State &stream : gEidos_RNG_Streams)
+		Eidos_FreeRNG(stream);
+	
+	gEidos_RNG_Streams.clear();
 }
 
 #ifndef USE_GSL_POISSON
@@ -129,11 +148,11 @@ double Eidos_FastRandomPoisson_PRECALCULATE(double p_mu)
 // reproduced in eidos_rng.h.  See eidos_rng.h for further comments on this code; most of the code is there.
 
 /* initializes mt[NN] with a seed */
-void Eidos_MT64_init_genrand64(uint64_t seed)
+void Eidos_MT64_init_genrand64(Eidos_RNG_State &p_rng, uint64_t seed)
 {
-	gEidos_RNG.mt_[0] = seed;
-	for (gEidos_RNG.mti_ = 1; gEidos_RNG.mti_ < Eidos_MT64_NN; gEidos_RNG.mti_++) 
-		gEidos_RNG.mt_[gEidos_RNG.mti_] =  (6364136223846793005ULL * (gEidos_RNG.mt_[gEidos_RNG.mti_ - 1] ^ (gEidos_RNG.mt_[gEidos_RNG.mti_ - 1] >> 62)) + gEidos_RNG.mti_);
+	p_rng.mt_[0] = seed;
+	for (p_rng.mti_ = 1; p_rng.mti_ < Eidos_MT64_NN; p_rng.mti_++) 
+		p_rng.mt_[p_rng.mti_] =  (6364136223846793005ULL * (p_rng.mt_[p_rng.mti_ - 1] ^ (p_rng.mt_[p_rng.mti_ - 1] >> 62)) + p_rng.mti_);
 }
 
 /* initialize by an array with array-length */
@@ -143,7 +162,7 @@ void Eidos_MT64_init_by_array64(uint64_t init_key[],
 					 uint64_t key_length)
 {
 	uint64_t i, j, k;
-	Eidos_MT64_init_genrand64(19650218ULL);
+	Eidos_MT64_init_genrand64(gEidos_RNG, 19650218ULL);
 	i=1; j=0;
 	k = (Eidos_MT64_NN>key_length ? Eidos_MT64_NN : key_length);
 	for (; k; k--) {
@@ -164,7 +183,7 @@ void Eidos_MT64_init_by_array64(uint64_t init_key[],
 }
 
 /* BCH: fill the next Eidos_MT64_NN words; used internally by genrand64_int64() */
-void _Eidos_MT64_fill()
+void _Eidos_MT64_fill(Eidos_RNG_State &p_rng)
 {
 	/* generate NN words at one time */
 	/* if init_genrand64() has not been called, */
@@ -175,21 +194,21 @@ void _Eidos_MT64_fill()
 	
 	// In the original code, this would fall back to some default seed value, but we
 	// don't want to allow the RNG to be used without being seeded first.  BCH 5/13/2018
-	if (gEidos_RNG.mti_ == Eidos_MT64_NN+1) 
+	if (p_rng.mti_ == Eidos_MT64_NN+1) 
 		abort(); 
 	
 	for (i=0;i<Eidos_MT64_NN-Eidos_MT64_MM;i++) {
-		x = (gEidos_RNG.mt_[i]&Eidos_MT64_UM)|(gEidos_RNG.mt_[i+1]&Eidos_MT64_LM);
-		gEidos_RNG.mt_[i] = gEidos_RNG.mt_[i+Eidos_MT64_MM] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
+		x = (p_rng.mt_[i]&Eidos_MT64_UM)|(p_rng.mt_[i+1]&Eidos_MT64_LM);
+		p_rng.mt_[i] = p_rng.mt_[i+Eidos_MT64_MM] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
 	}
 	for (;i<Eidos_MT64_NN-1;i++) {
-		x = (gEidos_RNG.mt_[i]&Eidos_MT64_UM)|(gEidos_RNG.mt_[i+1]&Eidos_MT64_LM);
-		gEidos_RNG.mt_[i] = gEidos_RNG.mt_[i+(Eidos_MT64_MM-Eidos_MT64_NN)] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
+		x = (p_rng.mt_[i]&Eidos_MT64_UM)|(p_rng.mt_[i+1]&Eidos_MT64_LM);
+		p_rng.mt_[i] = p_rng.mt_[i+(Eidos_MT64_MM-Eidos_MT64_NN)] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
 	}
-	x = (gEidos_RNG.mt_[Eidos_MT64_NN-1]&Eidos_MT64_UM)|(gEidos_RNG.mt_[0]&Eidos_MT64_LM);
-	gEidos_RNG.mt_[Eidos_MT64_NN-1] = gEidos_RNG.mt_[Eidos_MT64_MM-1] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
+	x = (p_rng.mt_[Eidos_MT64_NN-1]&Eidos_MT64_UM)|(p_rng.mt_[0]&Eidos_MT64_LM);
+	p_rng.mt_[Eidos_MT64_NN-1] = p_rng.mt_[Eidos_MT64_MM-1] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
 	
-	gEidos_RNG.mti_ = 0;
+	p_rng.mti_ = 0;
 }
 
 
@@ -21,6 +21,11 @@
  
  Eidos uses a globally shared random number generator called gEidos_RNG.  This file defines that global and relevant helper functions.
  
+ For code that runs on multiple threads, this file also provides RNG streams: a set of independent RNG states, one per thread, which
+ are seeded deterministically from a base value drawn from gEidos_RNG plus a stream index (typically the index of a block of work, not
+ the index of a thread, so that results do not depend upon the number of threads used).  Most of the functions below that make draws
+ therefore come in two forms: one taking an explicit Eidos_RNG_State (the RNG "context"), and one using gEidos_RNG.
+ 
  */
 
 #ifndef __Eidos__eidos_rng__
@@ -34,11 +39,14 @@
 
 #include <stdint.h>
 #include <cmath>
+#include <vector>
 #include "eidos_globals.h"
 
 
 // This cruft belongs to the 64-bit Mersenne Twister code below; it is up here because we need it to define the global RNG
 // struct and state below.  See below for all the rest of the 64-bit MT code, including copyrights and credits and license.
+typedef struct Eidos_RNG_State_ Eidos_RNG_State;
+uint64_t Eidos_MT64_genrand64_int64(Eidos_RNG_State &p_rng);
 uint64_t Eidos_MT64_genrand64_int64(void);
 
 // OK, so.  This header defines the Eidos random number generator, which is now a bit of a weird hybrid.  We need to use
@@ -48,7 +56,7 @@ uint64_t Eidos_MT64_genrand64_int64(void);
 // generators synchronized, in the sense that we always seed them simultaneously with the same seed value.  As long as
 // the user makes the same draws with the same calls, the fact that there are two generators under the hood shouldn't
 // matter.  This struct defines all of the variables associated with both RNGs; this is the complete Eidos RNG state.
-typedef struct
+struct Eidos_RNG_State_
 {
 	unsigned long int rng_last_seed_ = 0;		// unsigned long int is the type used for seeds in the GSL
 	
@@ -62,14 +70,16 @@ typedef struct
 	// random coin-flip generator; based on the MT64 generator now
 	int random_bool_bit_counter_ = 0;
 	uint64_t random_bool_bit_buffer_ = 0;
-} Eidos_RNG_State;
+};
 
 
 // This is the globally shared random number generator.  Note that the globals for random bit generation below are also
 // considered to be part of the RNG state; if the Context plays games with swapping different RNGs in and out, those
 // globals need to get swapped as well.  Likewise for the last seed value; this is part of the RNG state in Eidos.
-// The 64-bit Mersenne Twister is also part of the overall global RNG state.
-extern Eidos_RNG_State gEidos_RNG;
+// The 64-bit Mersenne Twister is also part of the overall global RNG state.  The RNG is thread-local; it belongs to the
+// main thread, and is never allocated on worker threads, so code running in parallel must use an RNG stream (see below) that
+// is passed to the draw functions explicitly.  Implicit use of gEidos_RNG from a worker thread will therefore fail fast.
+extern thread_local Eidos_RNG_State gEidos_RNG;
 
 // Calls to the GSL should use this macro to avoid hard-coding the internals of Eidos_RNG_State
 #define EIDOS_GSL_RNG	(gEidos_RNG.gsl_rng_)
@@ -79,9 +89,47 @@ extern Eidos_RNG_State gEidos_RNG;
 unsigned long int Eidos_GenerateSeedFromPIDAndTime(void);
 
 // set up the random number generator with a given seed
-void Eidos_InitializeRNG(void);
+void Eidos_InitializeRNG(Eidos_RNG_State &p_rng);
 void Eidos_FreeRNG(Eidos_RNG_State &p_rng);
-void Eidos_SetRNGSeed(unsigned long int p_seed);
+void Eidos_SetRNGSeed(Eidos_RNG_State &p_rng, unsigned long int p_seed);
+
+inline void Eidos_InitializeRNG(void) { Eidos_InitializeRNG(gEidos_RNG); }
+inline void Eidos_SetRNGSeed(unsigned long int p_seed) { Eidos_SetRNGSeed(gEidos_RNG, p_seed); }
+
+// RNG streams.  Eidos_PrepareRNGStreams() makes sure that at least p_count streams are allocated; Eidos_RNGStream() then returns
+// the RNG state for one of them, normally indexed by the thread number.  The streams are owned by Eidos, and are freed by
+// Eidos_FreeRNGStreams().  Eidos_RNGStreamSeed() derives the seed for stream index p_stream_index from p_base_seed, which
+// should be drawn from gEidos_RNG (with Eidos_MT64_genrand64_int64()) on the main thread before the parallel work begins;
+// Eidos_SeedRNGStream() seeds an RNG state with that derived seed.  The derivation is a SplitMix64 mix, which ensures that
+// the seeds for adjacent stream indices are unrelated even though the indices themselves are sequential.
+void Eidos_PrepareRNGStreams(int p_count);
+void Eidos_FreeRNGStreams(void);
+
+extern std::vector<Eidos_RNG_State> gEidos_RNG_Streams;
+
+inline __attribute__((always_inline)) Eidos_RNG_State &Eidos_RNGStream(int p_stream_index)
+{
+#if DEBUG
+	if ((p_stream_index < 0) || (p_stream_index >= (int)gEidos_RNG_Streams.size()))
+		EIDOS_TERMINATION << "ERROR (Eidos_RNGStream): (internal error) RNG stream index out of range." << EidosTerminate(nullptr);
+#endif
+	
+	return gEidos_RNG_Streams[p_stream_index];
+}
+
+inline __attribute__((always_inline)) uint64_t Eidos_RNGStreamSeed(uint64_t p_base_seed, uint64_t p_stream_index)
+{
+	uint64_t z = p_base_seed + (p_stream_index + 1) * 0x9E3779B97F4A7C15ULL;
+	
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+inline void Eidos_SeedRNGStream(Eidos_RNG_State &p_rng, uint64_t p_base_seed, uint64_t p_stream_index)
+{
+	Eidos_SetRNGSeed(p_rng, (unsigned long int)Eidos_RNGStreamSeed(p_base_seed, p_stream_index));
+}
 
 
 // This code is copied and modified from taus.c in the GSL library because we want to be able to inline taus_get().
@@ -179,16 +227,16 @@ inline __attribute__((always_inline)) uint32_t Eidos_rng_uniform_int(gsl_rng *p_
 
 #ifndef USE_GSL_POISSON
 
-static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu)
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(Eidos_RNG_State &p_rng, double p_mu)
 {
 	// Defer to the GSL for large values of mu; see comments above.
 	if (p_mu > 250)
-		return gsl_ran_poisson(EIDOS_GSL_RNG, p_mu);
+		return gsl_ran_poisson(p_rng.gsl_rng_, p_mu);
 	
 	unsigned int x = 0;
 	double p = exp(-p_mu);
 	double s = p;
-	double u = Eidos_rng_uniform(EIDOS_GSL_RNG);
+	double u = Eidos_rng_uniform(p_rng.gsl_rng_);
 	
 	while (u > s)
 	{
@@ -203,11 +251,11 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 }
 
 // This version allows the caller to supply a precalculated exp(-mu) value
-static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu, double p_exp_neg_mu)
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(Eidos_RNG_State &p_rng, double p_mu, double p_exp_neg_mu)
 {
 	// Defer to the GSL for large values of mu; see comments above.
 	if (p_mu > 250)
-		return gsl_ran_poisson(EIDOS_GSL_RNG, p_mu);
+		return gsl_ran_poisson(p_rng.gsl_rng_, p_mu);
 	
 	// Test consistency; normally this is commented out
 	//if (p_exp_neg_mu != exp(-p_mu))
@@ -216,7 +264,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 	unsigned int x = 0;
 	double p = p_exp_neg_mu;
 	double s = p;
-	double u = Eidos_rng_uniform(EIDOS_GSL_RNG);
+	double u = Eidos_rng_uniform(p_rng.gsl_rng_);
 	
 	while (u > s)
 	{
@@ -231,7 +279,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 }
 
 // This version specifies that the count is guaranteed not to be zero; zero has been ruled out by a previous test
-static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson_NONZERO(double p_mu, double p_exp_neg_mu)
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson_NONZERO(Eidos_RNG_State &p_rng, double p_mu, double p_exp_neg_mu)
 {
 	// Defer to the GSL for large values of mu; see comments above.
 	if (p_mu > 250)
@@ -240,7 +288,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 		
 		do
 		{
-			result = gsl_ran_poisson(EIDOS_GSL_RNG, p_mu);
+			result = gsl_ran_poisson(p_rng.gsl_rng_, p_mu);
 		}
 		while (result == 0);
 		
@@ -254,7 +302,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 	unsigned int x = 0;
 	double p = p_exp_neg_mu;
 	double s = p;
-	double u = Eidos_rng_uniform_pos(EIDOS_GSL_RNG);	// exclude 0.0 so u != s after rescaling
+	double u = Eidos_rng_uniform_pos(p_rng.gsl_rng_);	// exclude 0.0 so u != s after rescaling
 	
 	// rescale u so that (u > s) is true in the first round
 	u = u * (1.0 - s) + s;
@@ -276,6 +324,11 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 	return x;
 }
 
+// These versions use gEidos_RNG
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu) { return Eidos_FastRandomPoisson(gEidos_RNG, p_mu); }
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu, double p_exp_neg_mu) { return Eidos_FastRandomPoisson(gEidos_RNG, p_mu, p_exp_neg_mu); }
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson_NONZERO(double p_mu, double p_exp_neg_mu) { return Eidos_FastRandomPoisson_NONZERO(gEidos_RNG, p_mu, p_exp_neg_mu); }
+
 double Eidos_FastRandomPoisson_PRECALCULATE(double p_mu);	// exp(-mu); can underflow to zero, in which case the GSL will be used
 
 
@@ -354,22 +407,22 @@ double Eidos_FastRandomPoisson_PRECALCULATE(double p_mu);	// exp(-mu); can under
 #define Eidos_MT64_LM 0x7FFFFFFFULL /* Least significant 31 bits */
 
 /* initializes mt[NN] with a seed */
-void Eidos_MT64_init_genrand64(uint64_t seed);
+void Eidos_MT64_init_genrand64(Eidos_RNG_State &p_rng, uint64_t seed);
 
 /* initialize by an array with array-length */
 void Eidos_MT64_init_by_array64(uint64_t init_key[], uint64_t key_length);
 
 /* BCH: fill the next Eidos_MT64_NN words; used internally by genrand64_int64() */
-void _Eidos_MT64_fill();
+void _Eidos_MT64_fill(Eidos_RNG_State &p_rng);
 
 /* generates a random number on [0, 2^64-1]-interval */
-inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(void)
+inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(Eidos_RNG_State &p_rng)
 {
 	/* generate NN words at one time */
-	if (gEidos_RNG.mti_ >= Eidos_MT64_NN)
-		_Eidos_MT64_fill();
+	if (p_rng.mti_ >= Eidos_MT64_NN)
+		_Eidos_MT64_fill(p_rng);
 	
-	uint64_t x = gEidos_RNG.mt_[gEidos_RNG.mti_++];
+	uint64_t x = p_rng.mt_[p_rng.mti_++];
 	
 	x ^= (x >> 29) & 0x5555555555555555ULL;
 	x ^= (x << 17) & 0x71D67FFFEDA60000ULL;
@@ -379,6 +432,11 @@ inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(void)
 	return x;
 }
 
+inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(void)
+{
+	return Eidos_MT64_genrand64_int64(gEidos_RNG);
+}
+
 /* generates a random number on [0, 2^63-1]-interval */
 inline __attribute__((always_inline)) int64_t Eidos_MT64_genrand64_int63(void)
 {
@@ -404,7 +462,7 @@ inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real3(void)
 }
 
 /* BCH: generates a random integer in [0, p_n - 1]; parallel to Eidos_rng_uniform_int() above */
-inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64_t p_n)
+inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(Eidos_RNG_State &p_rng, uint64_t p_n)
 {
 	// OK, so.  The GSL's uniform int method, whose logic we replicate in Eidos_rng_uniform_int(), makes sure
 	// that the probability of each integer is exactly equal by figuring out a scaling, and then looping on
@@ -415,7 +473,12 @@ inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64
 	// in anywhere near the full range of the generator; we just need a couple of orders of magnitude more
 	// headroom than UINT32_MAX provides.  If we start to use this for a wider range of p_n (such as making it
 	// available in the Eidos APIs), this decision would need to be revisited.  BCH 12 May 2018
-	return Eidos_MT64_genrand64_int64() % p_n;
+	return Eidos_MT64_genrand64_int64(p_rng) % p_n;
+}
+
+inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64_t p_n)
+{
+	return Eidos_rng_uniform_int_MT64(gEidos_RNG, p_n);
 }
 
 
@@ -428,27 +491,32 @@ inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64
 
 // optimization of this is possible assuming each bit returned by the RNG is independent and usable as a random boolean.
 // the independence of all 64 bits seems to be a solid assumption for the MT64 generator, as far as I can tell.
-static inline __attribute__((always_inline)) bool Eidos_RandomBool()
+static inline __attribute__((always_inline)) bool Eidos_RandomBool(Eidos_RNG_State &p_rng)
 {
 	bool retval;
 	
-	if (gEidos_RNG.random_bool_bit_counter_ > 0)
+	if (p_rng.random_bool_bit_counter_ > 0)
 	{
-		gEidos_RNG.random_bool_bit_counter_--;
-		gEidos_RNG.random_bool_bit_buffer_ >>= 1;
-		retval = gEidos_RNG.random_bool_bit_buffer_ & 0x01;
+		p_rng.random_bool_bit_counter_--;
+		p_rng.random_bool_bit_buffer_ >>= 1;
+		retval = p_rng.random_bool_bit_buffer_ & 0x01;
 	}
 	else
 	{
-		gEidos_RNG.random_bool_bit_buffer_ = Eidos_MT64_genrand64_int64();	// MT64 provides 64 independent bits
-		gEidos_RNG.random_bool_bit_counter_ = 63;				// 64 good bits originally, and we're about to use one
+		p_rng.random_bool_bit_buffer_ = Eidos_MT64_genrand64_int64(p_rng);	// MT64 provides 64 independent bits
+		p_rng.random_bool_bit_counter_ = 63;				// 64 good bits originally, and we're about to use one
 		
-		retval = gEidos_RNG.random_bool_bit_buffer_ & 0x01;
+		retval = p_rng.random_bool_bit_buffer_ & 0x01;
 	}
 	
 	return retval;
 }
 
+static inline __attribute__((always_inline)) bool Eidos_RandomBool()
+{
+	return Eidos_RandomBool(gEidos_RNG);
+}
+
 
 #endif /* defined(__Eidos__eidos_rng__) */
 